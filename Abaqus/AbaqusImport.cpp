@@ -39,6 +39,10 @@ SOFTWARE.*/
 #include <FEBioLink/FEBioModule.h>
 #include <FEBioLink/FEBioClass.h>
 #include <sstream>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 ////using namespace std;
 
 //-----------------------------------------------------------------------------
@@ -93,14 +97,70 @@ bool AbaqusImport::UpdateData(bool bsave)
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::read_line(char* szline, FILE* fp)
+AbaqusImport::InputFile::InputFile()
+{
+	m_pos = m_end = nullptr;
+	m_eof = false;
+}
+
+//-----------------------------------------------------------------------------
+bool AbaqusImport::InputFile::Open(const char* szfile)
+{
+	Close();
+	if (m_file.Open(szfile) == false) return false;
+	m_pos = m_file.Data();
+	m_end = m_pos + m_file.Size();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void AbaqusImport::InputFile::Close()
+{
+	m_file.Close();
+	m_pos = m_end = nullptr;
+	m_eof = false;
+}
+
+//-----------------------------------------------------------------------------
+bool AbaqusImport::InputFile::gets(char* szline, int n)
+{
+	if (m_pos >= m_end) { m_eof = true; return false; }
+
+	const char* sz = m_pos;
+	int l = 0;
+	while ((sz < m_end) && (*sz != '\n'))
+	{
+		if (l < n - 2) szline[l++] = *sz;
+		++sz;
+	}
+	if (sz < m_end) { szline[l++] = '\n'; ++sz; }
+	szline[l] = 0;
+	m_pos = sz;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+float AbaqusImport::InputFile::progress() const
+{
+	if (m_end == nullptr) return 1.0f;
+	const char* szbeg = m_end - (ptrdiff_t)m_file.Size();
+	return (float)(m_pos - szbeg) / (float)(m_end - szbeg);
+}
+
+//-----------------------------------------------------------------------------
+float AbaqusImport::GetFileProgress() const
+{
+	return m_file.progress();
+}
+
+//-----------------------------------------------------------------------------
+bool AbaqusImport::read_line(char* szline, InputFile& fp)
 {
 	// read a line but skip over comments (i.e.lines that start with **)
 	do
 	{
-		if (fgets(szline, 255, fp) == nullptr) return false;
+		if (fp.gets(szline, 256) == false) return false;
 		++m_nline;
-		if (feof(fp)) return false;
 	}
 	while ((szline[0] == '\n') || (szline[0] == '\r') || (strncmp(szline,"**", 2) == 0));
 
@@ -112,7 +172,199 @@ bool AbaqusImport::read_line(char* szline, FILE* fp)
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::skip_keyword(char* szline, FILE* fp)
+void AbaqusImport::read_block(char* szline, InputFile& fp, const char*& szbeg, const char*& szend)
+{
+	const char* sz = szbeg = fp.pos();
+	const char* end = fp.end();
+	while (sz < end)
+	{
+		// a keyword line starts with a single *
+		if ((sz[0] == '*') && ((sz + 1 >= end) || (sz[1] != '*'))) break;
+		while ((sz < end) && (*sz != '\n')) ++sz;
+		if (sz < end) ++sz;
+		++m_nline;
+	}
+	szend = sz;
+	fp.seek(sz);
+
+	// read the next keyword
+	read_line(szline, fp);
+}
+
+//-----------------------------------------------------------------------------
+void AbaqusImport::set_block_line(int nline0, const char* szbeg, const char* sz)
+{
+	m_nline = nline0 + (int)std::count(szbeg, sz, '\n') + 1;
+}
+
+//=============================================================================
+// Helper functions for parsing data blocks directly from the (memory-mapped) file.
+// These don't rely on null-terminated strings, so they can be used on the file buffer.
+
+// skip spaces and tabs (but not the end of the line)
+static inline const char* skip_blanks(const char* sz, const char* szend)
+{
+	while ((sz < szend) && ((*sz == ' ') || (*sz == '\t') || (*sz == '\r'))) ++sz;
+	return sz;
+}
+
+// go to the start of the next line
+static inline const char* next_line(const char* sz, const char* szend)
+{
+	while ((sz < szend) && (*sz != '\n')) ++sz;
+	return (sz < szend ? sz + 1 : sz);
+}
+
+// skip over empty lines and comments
+static inline const char* skip_comments(const char* sz, const char* szend)
+{
+	while (sz < szend)
+	{
+		const char* ch = skip_blanks(sz, szend);
+		if ((ch < szend) && (*ch != '\n') && ((*ch != '*') || (ch + 1 >= szend) || (ch[1] != '*'))) break;
+		sz = next_line(sz, szend);
+	}
+	return sz;
+}
+
+static inline const char* parse_int(const char* sz, const char* szend, int& n, bool& ok)
+{
+	sz = skip_blanks(sz, szend);
+	bool neg = false;
+	if ((sz < szend) && ((*sz == '-') || (*sz == '+'))) { neg = (*sz == '-'); ++sz; }
+	const char* sz0 = sz;
+	int v = 0;
+	while ((sz < szend) && (*sz >= '0') && (*sz <= '9')) { v = 10 * v + (*sz - '0'); ++sz; }
+	n = (neg ? -v : v);
+	ok = (sz != sz0);
+	return sz;
+}
+
+static inline const char* parse_double(const char* sz, const char* szend, double& d, bool& ok)
+{
+	static const double p10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	sz = skip_blanks(sz, szend);
+	const char* sz0 = sz;
+	bool neg = false;
+	if ((sz < szend) && ((*sz == '-') || (*sz == '+'))) { neg = (*sz == '-'); ++sz; }
+
+	// read the mantissa digits (nd counts the significant digits, ne is the decimal exponent)
+	unsigned long long m = 0;
+	int nd = 0, ne = 0;
+	bool digits = false;
+	while ((sz < szend) && (*sz >= '0') && (*sz <= '9'))
+	{
+		if (nd < 19) { m = 10 * m + (*sz - '0'); if (m) nd++; }
+		else ne++;
+		++sz;
+		digits = true;
+	}
+	if ((sz < szend) && (*sz == '.'))
+	{
+		++sz;
+		while ((sz < szend) && (*sz >= '0') && (*sz <= '9'))
+		{
+			if (nd < 19) { m = 10 * m + (*sz - '0'); if (m) nd++; ne--; }
+			++sz;
+			digits = true;
+		}
+	}
+	if (digits == false) { ok = false; return sz0; }
+	bool exact = (nd < 19);
+
+	// read the exponent
+	if ((sz < szend) && ((*sz == 'e') || (*sz == 'E')))
+	{
+		const char* ch = sz + 1;
+		bool eneg = false;
+		if ((ch < szend) && ((*ch == '-') || (*ch == '+'))) { eneg = (*ch == '-'); ++ch; }
+		if ((ch < szend) && (*ch >= '0') && (*ch <= '9'))
+		{
+			int e = 0;
+			while ((ch < szend) && (*ch >= '0') && (*ch <= '9')) { if (e < 10000) e = 10 * e + (*ch - '0'); ++ch; }
+			ne += (eneg ? -e : e);
+			sz = ch;
+		}
+	}
+
+	ok = true;
+	if (exact && (m < (1ull << 53)) && (ne >= -22) && (ne <= 22))
+	{
+		// fast path: the result is correctly rounded
+		double v = (double)m;
+		v = (ne < 0 ? v / p10[-ne] : v * p10[ne]);
+		d = (neg ? -v : v);
+		return sz;
+	}
+
+	// let the C library handle everything else
+	char buf[128];
+	int l = (int)(sz - sz0);
+	if (l > 127) l = 127;
+	for (int i = 0; i < l; ++i) buf[i] = sz0[i];
+	buf[l] = 0;
+	d = atof(buf);
+	return sz;
+}
+
+// move past the next comma on this line (returns false if there is none)
+static inline bool next_field(const char*& sz, const char* szend)
+{
+	sz = skip_blanks(sz, szend);
+	if ((sz >= szend) || (*sz != ',')) return false;
+	++sz;
+	return true;
+}
+
+// Read n comma-separated integers. A record continues on the next line if a line ends with a comma.
+static const char* parse_record(const char* sz, const char* szend, int* v, int n, bool& ok)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		if (i > 0)
+		{
+			if (next_field(sz, szend) == false) { ok = false; return sz; }
+			const char* ch = skip_blanks(sz, szend);
+			if ((ch >= szend) || (*ch == '\n')) sz = skip_comments(next_line(ch, szend), szend);
+		}
+		sz = parse_int(sz, szend, v[i], ok);
+		if (ok == false) return sz;
+	}
+	return sz;
+}
+
+// Split the data block [szbeg, szend) in at most nchunks ranges that start at the beginning of a record.
+static void split_block(const char* szbeg, const char* szend, std::vector<const char*>& start)
+{
+	int nchunks = 1;
+#ifdef _OPENMP
+	if (szend - szbeg > (1 << 18)) nchunks = omp_get_max_threads();
+#endif
+	start.assign(nchunks + 1, szend);
+	start[0] = szbeg;
+	size_t nbytes = szend - szbeg;
+	for (int i = 1; i < nchunks; ++i)
+	{
+		const char* sz = szbeg + (nbytes / nchunks) * i;
+		if (sz < start[i - 1]) sz = start[i - 1];
+
+		// find the start of a line that does not continue a record
+		while (sz < szend)
+		{
+			sz = next_line(sz, szend);
+			const char* ch = sz - 1;
+			while ((ch > szbeg) && ((ch[-1] == ' ') || (ch[-1] == '\t') || (ch[-1] == '\r'))) --ch;
+			if ((ch <= szbeg) || (ch[-1] != ',')) break;
+		}
+		start[i] = sz;
+	}
+}
+
+//-----------------------------------------------------------------------------
+bool AbaqusImport::skip_keyword(char* szline, InputFile& fp)
 {
 	do
 	{
@@ -171,6 +423,128 @@ bool szicmp(const char* sz1, const char* sz2)
 	return true;
 }
 
+// Parse the records of a data block concurrently. The parse function is called for each chunk
+// and returns the position of the record that failed, or nullptr on success.
+template <typename T, typename F>
+static const char* parse_block(const char* szbeg, const char* szend, std::vector<T>& data, F parse)
+{
+	std::vector<const char*> start;
+	split_block(szbeg, szend, start);
+	int nchunks = (int)start.size() - 1;
+
+	std::vector< std::vector<T> > chunk(nchunks);
+	std::vector<const char*> err(nchunks, nullptr);
+#pragma omp parallel for schedule(static, 1)
+	for (int i = 0; i < nchunks; ++i)
+	{
+		err[i] = parse(start[i], start[i + 1], chunk[i]);
+	}
+
+	size_t n = 0;
+	for (int i = 0; i < nchunks; ++i)
+	{
+		if (err[i]) return err[i];
+		n += chunk[i].size();
+	}
+
+	data.reserve(data.size() + n);
+	for (int i = 0; i < nchunks; ++i) data.insert(data.end(), chunk[i].begin(), chunk[i].end());
+	return nullptr;
+}
+
+// parse node records (id, x, y, z). Empty fields are interpreted as zero.
+static const char* parse_nodes(const char* sz, const char* szend, std::vector<AbaqusModel::NODE>& nodes)
+{
+	AbaqusModel::NODE n;
+	n.n = 0;
+	bool ok = true;
+	while ((sz = skip_comments(sz, szend)) < szend)
+	{
+		const char* szline = sz;
+		sz = parse_int(sz, szend, n.id, ok);
+		if (ok == false) return szline;
+
+		double* r[3] = { &n.x, &n.y, &n.z };
+		for (int i = 0; i < 3; ++i)
+		{
+			if (next_field(sz, szend) == false) return szline;
+			const char* ch = skip_blanks(sz, szend);
+			if ((ch >= szend) || (*ch == ',') || (*ch == '\n')) { *r[i] = 0.0; sz = ch; }
+			else
+			{
+				sz = parse_double(sz, szend, *r[i], ok);
+				if (ok == false) return szline;
+			}
+		}
+
+		nodes.push_back(n);
+		sz = next_line(sz, szend);
+	}
+	return nullptr;
+}
+
+// parse element records (id, n1, ..., nN) of the given type
+static const char* parse_elements(const char* sz, const char* szend, int ntype, int N, std::vector<AbaqusModel::ELEMENT>& elems)
+{
+	AbaqusModel::ELEMENT el;
+	el.lid = -1;
+	int v[AbaqusModel::Max_Nodes + 1];
+	bool ok = true;
+	while ((sz = skip_comments(sz, szend)) < szend)
+	{
+		const char* szline = sz;
+		sz = parse_record(sz, szend, v, N + 1, ok);
+		if (ok == false) return szline;
+
+		el.type = ntype;
+		el.id = v[0];
+		for (int i = 0; i < N; ++i) el.n[i] = v[i + 1];
+
+		// make sure to copy the last node for triangles
+		if (ntype == FE_TRI3) el.n[3] = el.n[2];
+
+		// check for pyramid elements
+		if (ntype == FE_HEX8)
+		{
+			if ((el.n[7] == el.n[4]) &&
+				(el.n[6] == el.n[4]) && 
+				(el.n[5] == el.n[4])) el.type = FE_PYRA5;
+		}
+
+		// check for pyramid elements
+		if (ntype == FE_HEX20)
+		{
+			if ((el.n[7] == el.n[4]) &&
+				(el.n[6] == el.n[4]) &&
+				(el.n[5] == el.n[4])) el.type = FE_PYRA13;
+		}
+
+		elems.push_back(el);
+		sz = next_line(sz, szend);
+	}
+	return nullptr;
+}
+
+// parse comma-separated lists of ids. Like the sscanf based parser, reading a line
+// stops at the first value that is not an integer (e.g. a set name).
+static const char* parse_ids(const char* sz, const char* szend, std::vector<int>& ids)
+{
+	bool ok = true;
+	while ((sz = skip_comments(sz, szend)) < szend)
+	{
+		int n;
+		sz = parse_int(sz, szend, n, ok);
+		while (ok)
+		{
+			ids.push_back(n);
+			if (next_field(sz, szend) == false) break;
+			sz = parse_int(sz, szend, n, ok);
+		}
+		sz = next_line(sz, szend);
+	}
+	return nullptr;
+}
+
 //-----------------------------------------------------------------------------
 //! Load an Abaqus model file
 bool AbaqusImport::Load(const char* szfile)
@@ -188,20 +562,22 @@ bool AbaqusImport::Load(const char* szfile)
 #endif
 
 	// try to open the file
-	if (Open(szfile, "rt") == false) return errf("Failed opening file %s", szfile);
+	Reset();
+	if (m_file.Open(szfile) == false) return errf("Failed opening file %s", szfile);
+	SetFileName(szfile);
 
 	// parse the file
 	try
 	{
-		if (parse_file(m_fp) == false) return false;
+		if (parse_file(m_file) == false) { m_file.Close(); return false; }
 	}
 	catch (...)
 	{
-		Close();
+		m_file.Close();
 		return false;
 	}
 
-	Close();
+	m_file.Close();
 
 	// build the model
 	if (build_model() == false) return false;
@@ -211,14 +587,14 @@ bool AbaqusImport::Load(const char* szfile)
 
 //-----------------------------------------------------------------------------
 //! Parse an abaqus model file
-bool AbaqusImport::parse_file(FILE* fp)
+bool AbaqusImport::parse_file(InputFile& fp)
 {
 	// get the first line
 	char szline[256];
 	if (!read_line(szline, fp)) return errf("Error while reading file");
 
 	// parse the keywords
-	while (!feof(fp))
+	while (!fp.eof())
 	{
 		// find what keyword this is
 		if (szicnt(szline, "*HEADING"))	// read the heading
@@ -374,14 +750,14 @@ bool AbaqusImport::parse_file(FILE* fp)
 			fprintf(stderr, "Reading file %s\n", szfile);
 #endif
 			// try to open the file
-			FILE* fpi = fopen(szfile, "rt");
-			if (fpi == 0) return errf("Failed including %s\n", szfile);
+			InputFile fpi;
+			if (fpi.Open(szfile) == false) return errf("Failed including %s\n", szfile);
 
 			// parse the file
 			bool bret = parse_file(fpi);
 
 			// close the file
-			fclose(fpi);
+			fpi.Close();
 
 			if (bret == false) return false;
 
@@ -466,13 +842,13 @@ const char* AbaqusImport::find_attribute(AbaqusImport::ATTRIBUTE* pa, int nmax,
 
 //-----------------------------------------------------------------------------
 
-bool AbaqusImport::read_heading(char* szline, FILE* fp)
+bool AbaqusImport::read_heading(char* szline, InputFile& fp)
 {
 	int n = 0;
 	do
 	{
 		read_line(szline, fp);
-		if (feof(fp)) return false;
+		if (fp.eof()) return false;
 
 		if (n == 0) strncpy(m_szTitle, szline, AbaqusModel::Max_Title);
 	}
@@ -484,7 +860,7 @@ bool AbaqusImport::read_heading(char* szline, FILE* fp)
 
 //-----------------------------------------------------------------------------
 
-bool AbaqusImport::read_nodes(char* szline, FILE* fp)
+bool AbaqusImport::read_nodes(char* szline, InputFile& fp)
 {
 	// parse the szline for optional parameters
 	ATTRIBUTE att[MAX_ATTRIB];
@@ -493,39 +869,18 @@ bool AbaqusImport::read_nodes(char* szline, FILE* fp)
 	// get the active part
 	AbaqusModel::PART& part = *m_inp.GetActivePart(true);
 
-	// read the nodes
-	AbaqusModel::NODE n;
-	n.x = n.y = n.z = 0;
-	read_line(szline, fp);
-	char* ch;
-	int nc = 0;
-	while (!feof(fp) && (szline[0] != '*'))
-	{
-		// parse the line
-		ch = szline;
-		sscanf(ch, "%d", &n.id);
+	// find the node data
+	int nline0 = m_nline;
+	const char* szbeg = nullptr, *szend = nullptr;
+	read_block(szline, fp, szbeg, szend);
 
-		ch = strchr(ch, ',');
-		if (ch == 0) return false;
-		++ch;
-		sscanf(ch, "%lg", &n.x);
-
-		ch = strchr(ch, ','); 
-		if (ch==0) return false;
-		++ch;
-		sscanf(ch, "%lg", &n.y);
-
-		ch = strchr(ch, ','); 
-		if (ch==0) return false;
-		++ch;
-		sscanf(ch, "%lg", &n.z);
+	// read the nodes
+	std::vector<AbaqusModel::NODE> nodes;
+	const char* szerr = parse_block(szbeg, szend, nodes, parse_nodes);
+	if (szerr) { set_block_line(nline0, szbeg, szerr); return false; }
 
-		// add the node to the list
-		part.AddNode(n);
-
-		// read the next line
-		read_line(szline, fp);
-	}
+	// add the nodes to the part
+	part.AddNodes(nodes);
 
 	// build the node-look up table
 	part.BuildNLT();
@@ -535,7 +890,7 @@ bool AbaqusImport::read_nodes(char* szline, FILE* fp)
 
 //-----------------------------------------------------------------------------
 
-bool AbaqusImport::read_ngen(char* szline, FILE* fp)
+bool AbaqusImport::read_ngen(char* szline, InputFile& fp)
 {
 	int i;
 
@@ -562,7 +917,7 @@ bool AbaqusImport::read_ngen(char* szline, FILE* fp)
 	read_line(szline, fp);
 
 	int l1, l2, lc, linc;
-	while (!feof(fp) && (szline[0] != '*'))
+	while (!fp.eof() && (szline[0] != '*'))
 	{
 		// parse the line
 		sscanf(szline, "%d,%d,%d,%d", &l1, &l2, &linc, &lc);
@@ -625,13 +980,13 @@ bool AbaqusImport::read_ngen(char* szline, FILE* fp)
 
 //-----------------------------------------------------------------------------
 
-bool AbaqusImport::read_nfill(char* szline, FILE* fp)
+bool AbaqusImport::read_nfill(char* szline, InputFile& fp)
 {
 	// get the active part
 	AbaqusModel::PART& part = *m_inp.GetActivePart();
 
 	read_line(szline, fp);
-	while (!feof(fp) && (szline[0] != '*'))
+	while (!fp.eof() && (szline[0] != '*'))
 	{
 		char* ch1 = strchr(szline, ',');
 		if (ch1) *ch1 = 0; else return false;
@@ -652,8 +1007,8 @@ bool AbaqusImport::read_nfill(char* szline, FILE* fp)
 		double t;
 		for (int l=1; l<nl; ++l)
 		{
-			list<AbaqusModel::Tnode_itr>::iterator n1 = ns1->node.begin();
-			list<AbaqusModel::Tnode_itr>::iterator n2 = ns2->node.begin();
+			vector<AbaqusModel::Tnode_itr>::iterator n1 = ns1->node.begin();
+			vector<AbaqusModel::Tnode_itr>::iterator n2 = ns2->node.begin();
 
 			t = (double) l / (double) nl;
 
@@ -677,7 +1032,7 @@ bool AbaqusImport::read_nfill(char* szline, FILE* fp)
 
 //-----------------------------------------------------------------------------
 
-bool AbaqusImport::read_elements(char* szline, FILE* fp)
+bool AbaqusImport::read_elements(char* szline, InputFile& fp)
 {
 	// scan the element line for optional parameters
 	ATTRIBUTE att[MAX_ATTRIB];
@@ -726,7 +1081,7 @@ bool AbaqusImport::read_elements(char* szline, FILE* fp)
 			}
 			else {
 				errf("Element type %s not supported (line %d)", sz, m_nline); 
-				skip_keyword(szline, m_fp); 
+				skip_keyword(szline, fp); 
 				return true;
 			}
 		}
@@ -744,7 +1099,7 @@ bool AbaqusImport::read_elements(char* szline, FILE* fp)
 
 	// get the active part
 	AbaqusModel::PART* pg = m_inp.GetActivePart();
-	if (pg == 0) { skip_keyword(szline, m_fp); return true; }
+	if (pg == 0) { skip_keyword(szline, fp); return true; }
 	AbaqusModel::PART& part = *pg;
 
 	// find the element set
@@ -755,11 +1110,6 @@ bool AbaqusImport::read_elements(char* szline, FILE* fp)
 		if (ps == nullptr) ps = part.AddElementSet(szset);
 	}
 
-	// read the elements
-	read_line(szline, fp);
-	AbaqusModel::ELEMENT el;
-	AbaqusModel::Telem_itr pe;
-
 	int N = 0;
 	switch (ntype)
 	{
@@ -781,76 +1131,33 @@ bool AbaqusImport::read_elements(char* szline, FILE* fp)
 		return false;
 	};
 
-	int nc = 0;
-	while (!feof(fp) && (szline[0] != '*'))
-	{
-		// set the element type
-		el.type = ntype;
-
-		// parse the line
-		char* ch = szline;
+	// find the element data
+	int nline0 = m_nline;
+	const char* szbeg = nullptr, *szend = nullptr;
+	read_block(szline, fp, szbeg, szend);
 
-		// get the element id
-		sscanf(ch, "%d", &el.id);
-		ch = strchr(ch, ',');
-		if (ch == 0) return false; else ++ch;
-
-		// read the node numbers
-		for (int i=0; i<N; ++i)
-		{
-			sscanf(ch, "%d", &el.n[i]);
-
-			if (i!=N-1)
-			{
-				// find the next comma
-				ch = strchr(ch, ',');
-				if (ch == 0) return false;
-
-				// if we've reached at the end of the line
-				// then we load the next line
-				if (strlen(ch) == 1 || strcmp(ch,", ") == 0)
-				{
-					read_line(szline, fp);
-					ch = szline;
-				}
-				else ++ch;
-			}
-		}
-
-		// make sure to copy the last node for triangles
-		if (ntype == FE_TRI3) el.n[3] = el.n[2];
-
-		// check for pyramid elements
-		if (ntype == FE_HEX8)
-		{
-			if ((el.n[7] == el.n[4]) &&
-				(el.n[6] == el.n[4]) && 
-				(el.n[5] == el.n[4])) el.type = FE_PYRA5;
-		}
-
-        // check for pyramid elements
-        if (ntype == FE_HEX20)
-        {
-            if ((el.n[7] == el.n[4]) &&
-                (el.n[6] == el.n[4]) &&
-                (el.n[5] == el.n[4])) el.type = FE_PYRA13;
-        }
-        
-		// add the element to the list
-		part.AddElement(el);
+	// read the elements
+	std::vector<AbaqusModel::ELEMENT> elems;
+	const char* szerr = parse_block(szbeg, szend, elems, [=](const char* s0, const char* s1, std::vector<AbaqusModel::ELEMENT>& el) {
+		return parse_elements(s0, s1, ntype, N, el);
+	});
+	if (szerr) { set_block_line(nline0, szbeg, szerr); return false; }
 
-		// add the element to the elementset
-		if (ps != nullptr) ps->elem.push_back(el.id);
+	// add the elements to the list
+	part.AddElements(elems);
 
-		// read the next line
-		read_line(szline, fp);
+	// add the elements to the elementset
+	if (ps != nullptr)
+	{
+		ps->elem.reserve(ps->elem.size() + elems.size());
+		for (const AbaqusModel::ELEMENT& el : elems) ps->elem.push_back(el.id);
 	}
 	
 	return true;
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::read_spring_elements(char* szline, FILE* fp)
+bool AbaqusImport::read_spring_elements(char* szline, InputFile& fp)
 {
 	ATTRIBUTE att[MAX_ATTRIB];
 	int natt = parse_line(szline, att);
@@ -869,7 +1176,7 @@ bool AbaqusImport::read_spring_elements(char* szline, FILE* fp)
 		AbaqusModel::SPRING_ELEMENT el;
 
 		int nc = 0;
-		while (!feof(fp) && (szline[0] != '*'))
+		while (!fp.eof() && (szline[0] != '*'))
 		{
 			// parse the line
 			char* ch = szline;
@@ -920,7 +1227,7 @@ bool AbaqusImport::read_spring_elements(char* szline, FILE* fp)
 		AbaqusModel::SPRING_ELEMENT el;
 
 		int nc = 0;
-		while (!feof(fp) && (szline[0] != '*'))
+		while (!fp.eof() && (szline[0] != '*'))
 		{
 			ATTRIBUTE att[MAX_ATTRIB];
 			int natt = parse_line(szline, att);
@@ -980,7 +1287,7 @@ bool AbaqusImport::read_spring_elements(char* szline, FILE* fp)
 
 //-----------------------------------------------------------------------------
 
-bool AbaqusImport::read_element_sets(char* szline, FILE* fp)
+bool AbaqusImport::read_element_sets(char* szline, InputFile& fp)
 {
 	// read the attributes
 	ATTRIBUTE att[MAX_ATTRIB];
@@ -1002,7 +1309,7 @@ bool AbaqusImport::read_element_sets(char* szline, FILE* fp)
 	if (pg == 0)
 	{
 		errf("Error reading ELSET (line %d)", m_nline);
-		skip_keyword(szline, m_fp);
+		skip_keyword(szline, fp);
 		return true;
 	}
 	AbaqusModel::PART& part = *pg;
@@ -1034,7 +1341,7 @@ bool AbaqusImport::read_element_sets(char* szline, FILE* fp)
 		int n1, n2, n;
 		read_line(szline, fp);
 		AbaqusModel::Telem_itr it;
-		while (!feof(fp) && (szline[0] != '*'))
+		while (!fp.eof() && (szline[0] != '*'))
 		{
 			// parse the line
 			int nread = sscanf(szline, "%d,%d,%d", &n1, &n2, &n);
@@ -1053,19 +1360,18 @@ bool AbaqusImport::read_element_sets(char* szline, FILE* fp)
 	}
 	else
 	{
-		int n[16], nr;
-		read_line(szline, fp);
+		const char* szbeg = nullptr, *szend = nullptr;
+		read_block(szline, fp, szbeg, szend);
+
+		std::vector<int> ids;
+		parse_block(szbeg, szend, ids, parse_ids);
+
+		pset->elem.reserve(pset->elem.size() + ids.size());
 		AbaqusModel::Telem_itr it;
-		while (!feof(fp) && (szline[0] != '*'))
+		for (int id : ids)
 		{
-			nr = sscanf(szline, "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d", &n[0],&n[1],&n[2],&n[3],&n[4],&n[5],&n[6],&n[7],&n[8],&n[9],&n[10],&n[11],&n[12],&n[13],&n[14],&n[15]);
-			for (int i=0; i<nr; ++i)
-			{
-				it = part.FindElement(n[i]);
-				if (it != part.m_Elem.end() && (it->id != -1)) pset->elem.push_back(it->id);
-			}
-			// read the next line
-			read_line(szline, fp);
+			it = part.FindElement(id);
+			if (it != part.m_Elem.end() && (it->id != -1)) pset->elem.push_back(it->id);
 		}
 	}
 
@@ -1074,7 +1380,7 @@ bool AbaqusImport::read_element_sets(char* szline, FILE* fp)
 
 //-----------------------------------------------------------------------------
 
-bool AbaqusImport::read_node_sets(char* szline, FILE* fp)
+bool AbaqusImport::read_node_sets(char* szline, InputFile& fp)
 {
 	// read the attributes
 	ATTRIBUTE att[MAX_ATTRIB];
@@ -1118,7 +1424,7 @@ bool AbaqusImport::read_node_sets(char* szline, FILE* fp)
 
 		int n1, n2, n;
 		read_line(szline, fp);
-		while (!feof(fp) && (szline[0] != '*'))
+		while (!fp.eof() && (szline[0] != '*'))
 		{
 			// parse the line
 			int nread = sscanf(szline, "%d,%d,%d", &n1, &n2, &n);
@@ -1139,7 +1445,6 @@ bool AbaqusImport::read_node_sets(char* szline, FILE* fp)
 	}
 	else
 	{
-		int i, nr, n[16];
 		AbaqusModel::Tnode_itr it;
 
 		// get/create the node set
@@ -1147,22 +1452,20 @@ bool AbaqusImport::read_node_sets(char* szline, FILE* fp)
 //		if (pset == part.m_NSet.end()) pset = part.AddNodeSet(szname);
 		AbaqusModel::NODE_SET* pset = part.AddNodeSet(szname);
 
-		read_line(szline, fp);
-		while (!feof(fp) && (szline[0] != '*'))
-		{
-			// read the nodes
-			nr = sscanf(szline, "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d",&n[0],&n[1],&n[2],&n[3],&n[4],&n[5],&n[6],&n[7],&n[8],&n[9],&n[10],&n[11],&n[12],&n[13],&n[14],&n[15]);
+		// read the nodes
+		const char* szbeg = nullptr, *szend = nullptr;
+		read_block(szline, fp, szbeg, szend);
 
-			// add the elements to the list
-			for (i=0; i<nr; ++i)
-			{
-				it = part.FindNode(n[i]);
-				if (it == part.m_Node.end()) return false;
-				pset->node.push_back(it);
-			}
+		std::vector<int> ids;
+		parse_block(szbeg, szend, ids, parse_ids);
 
-			// read the next line
-			read_line(szline, fp);
+		// add the nodes to the list
+		pset->node.reserve(pset->node.size() + ids.size());
+		for (int id : ids)
+		{
+			it = part.FindNode(id);
+			if (it == part.m_Node.end()) return false;
+			pset->node.push_back(it);
 		}
 	}
 
@@ -1171,7 +1474,7 @@ bool AbaqusImport::read_node_sets(char* szline, FILE* fp)
 
 //-----------------------------------------------------------------------------
 
-bool AbaqusImport::read_surface(char* szline, FILE* fp)
+bool AbaqusImport::read_surface(char* szline, InputFile& fp)
 {
 	// read the attributes
 	ATTRIBUTE att[MAX_ATTRIB];
@@ -1225,7 +1528,7 @@ bool AbaqusImport::read_surface(char* szline, FILE* fp)
 	char* ch;
 	int ne;
 	int nf;
-	while (!feof(fp) && (szline[0] != '*'))
+	while (!fp.eof() && (szline[0] != '*'))
 	{
 		// find the comma
 		ch = strchr(szline, ',');
@@ -1291,7 +1594,7 @@ bool AbaqusImport::read_surface(char* szline, FILE* fp)
 
 //-----------------------------------------------------------------------------
 
-bool AbaqusImport::read_materials(char *szline, FILE *fp)
+bool AbaqusImport::read_materials(char* szline, InputFile& fp)
 {
 	AbaqusModel::MATERIAL& mat = *m_inp.AddMaterial("");
 	mat.dens = 1.0;
@@ -1302,7 +1605,7 @@ bool AbaqusImport::read_materials(char *szline, FILE *fp)
 	if (szname) strcpy(mat.szname, szname);
 
 	read_line(szline, fp);
-	while (!feof(fp))
+	while (!fp.eof())
 	{
 		if (szicnt(szline, "*DENSITY"))
 		{
@@ -1413,7 +1716,7 @@ bool AbaqusImport::read_materials(char *szline, FILE *fp)
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::read_part(char* szline, FILE* fp)
+bool AbaqusImport::read_part(char* szline, InputFile& fp)
 {
 	if (m_inp.CurrentPart()) return errf("Error in file: new part was started before END PART was detected. (line %d)", m_nline);
 	ATTRIBUTE att[MAX_ATTRIB];
@@ -1431,7 +1734,7 @@ bool AbaqusImport::read_part(char* szline, FILE* fp)
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::read_end_part(char* szline, FILE* fp)
+bool AbaqusImport::read_end_part(char* szline, InputFile& fp)
 {
 	// make sure we are in a part defintion
 	if (m_inp.CurrentPart() == 0) return errf("ERROR in file: END PART detected but no part was defined. (line %d)", m_nline);
@@ -1443,7 +1746,7 @@ bool AbaqusImport::read_end_part(char* szline, FILE* fp)
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::read_instance(char* szline, FILE* fp)
+bool AbaqusImport::read_instance(char* szline, InputFile& fp)
 {
 	ATTRIBUTE att[MAX_ATTRIB];
 	int natt = parse_line(szline, att);
@@ -1535,7 +1838,7 @@ bool AbaqusImport::read_instance(char* szline, FILE* fp)
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::read_end_instance(char* szline, FILE* fp)
+bool AbaqusImport::read_end_instance(char* szline, InputFile& fp)
 {
 	AbaqusModel::ASSEMBLY* asmbly = m_inp.GetCurrentAssembly();
 	if (asmbly == nullptr) return errf("end instance encountered without active assembly.");
@@ -1548,7 +1851,7 @@ bool AbaqusImport::read_end_instance(char* szline, FILE* fp)
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::read_assembly(char* szline, FILE* fp)
+bool AbaqusImport::read_assembly(char* szline, InputFile& fp)
 {
 	// make sure we don't have an assembly yet
 	AbaqusModel::ASSEMBLY* asmbly = m_inp.GetAssembly();
@@ -1575,7 +1878,7 @@ bool AbaqusImport::read_assembly(char* szline, FILE* fp)
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::read_end_assembly(char* szline, FILE* fp)
+bool AbaqusImport::read_end_assembly(char* szline, InputFile& fp)
 {
 	if (m_inp.GetCurrentAssembly() == nullptr) return errf("no assembly was active when END ASSEMBLY was found.");
 	m_inp.SetCurrentAssembly(nullptr);
@@ -1585,10 +1888,10 @@ bool AbaqusImport::read_end_assembly(char* szline, FILE* fp)
 
 //-----------------------------------------------------------------------------
 
-bool AbaqusImport::read_surface_interaction(char* szline, FILE* fp)
+bool AbaqusImport::read_surface_interaction(char* szline, InputFile& fp)
 {
 	read_line(szline, fp);
-	while (!feof(fp) && (szline[0] != '*'))
+	while (!fp.eof() && (szline[0] != '*'))
 	{
 		read_line(szline, fp);
 	}
@@ -2037,7 +2340,6 @@ GObject* AbaqusImport::build_part(AbaqusModel::PART* pg)
 
 						vec3d a = vec3d(e.val[0], e.val[1], e.val[2]);
 						vec3d b = vec3d(e.val[3], e.val[4], e.val[5]);
-						FSElement& el = pm->Element(eid);
 
 						vec3d e1 = a; e1.Normalize();
 						vec3d e3 = a ^ b; e3.Normalize();
@@ -2048,8 +2350,8 @@ GObject* AbaqusImport::build_part(AbaqusModel::PART* pg)
 						Q[1][0] = e1.y; Q[1][1] = e2.y; Q[1][2] = e3.y;
 						Q[2][0] = e1.z; Q[2][1] = e2.z; Q[2][2] = e3.z;
 
-						el.m_Qactive = true;
-						el.m_Q = Q;
+						pm->SetElementMaterialAxesActive(eid, true);
+						pm->SetElementMaterialAxes(eid, Q);
 					}
 				}
 			}
@@ -2089,7 +2391,6 @@ GObject* AbaqusImport::build_part(AbaqusModel::PART* pg)
 
 						vec3d a = vec3d(e.val[0], e.val[1], e.val[2]);
 						vec3d b = vec3d(e.val[3], e.val[4], e.val[5]);
-						FSElement& el = pm->Element(eid);
 
 						vec3d e1 = a; e1.Normalize();
 						vec3d e3 = a ^ b; e3.Normalize();
@@ -2100,8 +2401,8 @@ GObject* AbaqusImport::build_part(AbaqusModel::PART* pg)
 						Q[1][0] = e1.y; Q[1][1] = e2.y; Q[1][2] = e3.y;
 						Q[2][0] = e1.z; Q[2][1] = e2.z; Q[2][2] = e3.z;
 
-						el.m_Qactive = true;
-						el.m_Q = Q;
+						pm->SetElementMaterialAxesActive(eid, true);
+						pm->SetElementMaterialAxes(eid, Q);
 					}
 				}
 			}
@@ -2232,7 +2533,7 @@ GObject* AbaqusImport::build_part(AbaqusModel::PART* pg)
 			{
 				FSNodeSet* pg = new FSNodeSet(pm);
 				pg->SetName(ns->second->szname);
-				list<AbaqusModel::Tnode_itr>::iterator pn = ns->second->node.begin();
+				vector<AbaqusModel::Tnode_itr>::iterator pn = ns->second->node.begin();
 				nn = (int) ns->second->node.size();
 				for (j=0; j<nn; ++j, ++pn) pg->add((*pn)->id);
 				pm->AddFENodeSet(pg);
@@ -2265,7 +2566,7 @@ GObject* AbaqusImport::build_part(AbaqusModel::PART* pg)
 	if (pg->Springs() > 0)
 	{
 		int NS = pg->Springs();
-		list<AbaqusModel::SPRING_ELEMENT>::iterator ps;
+		vector<AbaqusModel::SPRING_ELEMENT>::iterator ps;
 		int n = 1;
 		for (ps = pg->m_Spring.begin(); ps != pg->m_Spring.end(); ++ps, ++n)
 		{
@@ -2359,7 +2660,7 @@ FSSurface* AbaqusImport::build_surface(AbaqusModel::SURFACE* si)
 	FSSurface* ps = new FSSurface(pm);
 	ps->SetName(si->szname);
 	nf = (int)si->face.size();
-	list<AbaqusModel::FACE>::iterator pf = si->face.begin();
+	vector<AbaqusModel::FACE>::iterator pf = si->face.begin();
 	AbaqusModel::Telem_itr pe;
 	for (int j = 0; j<nf; ++j, ++pf)
 	{
@@ -2480,7 +2781,7 @@ FSNodeSet* AbaqusImport::build_nodeset(AbaqusModel::NODE_SET* ns)
 	FSMesh* pm = part->m_po->GetFEMesh();
 
 	FSNodeSet* nset = new FSNodeSet(pm);
-	list<AbaqusModel::Tnode_itr>::iterator it = ns->node.begin();
+	vector<AbaqusModel::Tnode_itr>::iterator it = ns->node.begin();
 	for (it; it != ns->node.end(); ++it)
 	{
 		nset->add((*it)->n);
@@ -2505,7 +2806,7 @@ FSNodeSet* AbaqusImport::find_nodeset(AbaqusModel::NODE_SET* ns)
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::read_step(char* szline, FILE* fp)
+bool AbaqusImport::read_step(char* szline, InputFile& fp)
 {
 	ATTRIBUTE att[MAX_ATTRIB];
 	parse_line(szline, att);
@@ -2516,7 +2817,7 @@ bool AbaqusImport::read_step(char* szline, FILE* fp)
 	step->time = 1;
 
 	// parse till END STEP
-	while (!feof(fp))
+	while (!fp.eof())
 	{
 		if (szicnt(szline, "*STATIC"))
 		{
@@ -2551,7 +2852,7 @@ bool AbaqusImport::read_step(char* szline, FILE* fp)
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::read_boundary(char* szline, FILE* fp)
+bool AbaqusImport::read_boundary(char* szline, InputFile& fp)
 {
 	AbaqusModel::BOUNDARY BC;
 	ATTRIBUTE att[MAX_ATTRIB];
@@ -2568,7 +2869,7 @@ bool AbaqusImport::read_boundary(char* szline, FILE* fp)
 	int ndof = -1;
 	double val = 0.0;
 
-	while (!feof(fp) && (szline[0] != '*'))
+	while (!fp.eof() && (szline[0] != '*'))
 	{
 		int n = parse_line(szline, att);
 		if (n == 4)
@@ -2615,7 +2916,7 @@ bool AbaqusImport::read_boundary(char* szline, FILE* fp)
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::read_dsload(char* szline, FILE* fp)
+bool AbaqusImport::read_dsload(char* szline, InputFile& fp)
 {
 	AbaqusModel::DSLOAD P;
 	ATTRIBUTE att[MAX_ATTRIB];
@@ -2628,7 +2929,7 @@ bool AbaqusImport::read_dsload(char* szline, FILE* fp)
 	}
 
 	read_line(szline, fp);
-	while (!feof(fp) && (szline[0] != '*'))
+	while (!fp.eof() && (szline[0] != '*'))
 	{
 		int n = parse_line(szline, att);
 		if (n == 3)
@@ -2648,7 +2949,7 @@ bool AbaqusImport::read_dsload(char* szline, FILE* fp)
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::read_solid_section(char* szline, FILE* fp)
+bool AbaqusImport::read_solid_section(char* szline, InputFile& fp)
 {
 	ATTRIBUTE att[MAX_ATTRIB];
 	int n = parse_line(szline, att);
@@ -2668,7 +2969,7 @@ bool AbaqusImport::read_solid_section(char* szline, FILE* fp)
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::read_shell_section(char* szline, FILE* fp)
+bool AbaqusImport::read_shell_section(char* szline, InputFile& fp)
 {
 	ATTRIBUTE att[MAX_ATTRIB];
 	int n = parse_line(szline, att);
@@ -2692,7 +2993,7 @@ bool AbaqusImport::read_shell_section(char* szline, FILE* fp)
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::read_static(char* szline, FILE* fp)
+bool AbaqusImport::read_static(char* szline, InputFile& fp)
 {
 	// read the next line
 	read_line(szline, fp);
@@ -2713,7 +3014,7 @@ bool AbaqusImport::read_static(char* szline, FILE* fp)
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::read_orientation(char* szline, FILE* fp)
+bool AbaqusImport::read_orientation(char* szline, InputFile& fp)
 {
 	ATTRIBUTE att[MAX_ATTRIB];
 	parse_line(szline, att);
@@ -2734,7 +3035,7 @@ bool AbaqusImport::read_orientation(char* szline, FILE* fp)
 }
 
 //-----------------------------------------------------------------------------
-bool AbaqusImport::read_distribution(char* szline, FILE* fp)
+bool AbaqusImport::read_distribution(char* szline, InputFile& fp)
 {
 	ATTRIBUTE att[MAX_ATTRIB];
 	parse_line(szline, att);
@@ -2745,7 +3046,7 @@ bool AbaqusImport::read_distribution(char* szline, FILE* fp)
 	strcpy(D.m_szname, szname);
 
 	read_line(szline, fp);
-	while (!feof(fp) && (szline[0] != '*'))
+	while (!fp.eof() && (szline[0] != '*'))
 	{
 		int n = parse_line(szline, att);
 		AbaqusModel::Distribution::ENTRY e;
@@ -2768,7 +3069,7 @@ bool AbaqusImport::read_distribution(char* szline, FILE* fp)
 	return true;
 }
 
-bool AbaqusImport::read_amplitude(char* szline, FILE* fp)
+bool AbaqusImport::read_amplitude(char* szline, InputFile& fp)
 {
 	ATTRIBUTE att[MAX_ATTRIB];
 	parse_line(szline, att);
@@ -2820,7 +3121,7 @@ bool AbaqusImport::read_amplitude(char* szline, FILE* fp)
 	return true;
 }
 
-bool AbaqusImport::read_contact_pair(char* szline, FILE* fp)
+bool AbaqusImport::read_contact_pair(char* szline, InputFile& fp)
 {
 	ATTRIBUTE att[MAX_ATTRIB];
 	parse_line(szline, att);
@@ -2857,7 +3158,7 @@ bool AbaqusImport::read_contact_pair(char* szline, FILE* fp)
 	return true;
 }
 
-bool AbaqusImport::read_spring(char* szline, FILE* fp)
+bool AbaqusImport::read_spring(char* szline, InputFile& fp)
 {
 	ATTRIBUTE att[MAX_ATTRIB];
 	int natt = parse_line(szline, att);
@@ -2879,7 +3180,7 @@ bool AbaqusImport::read_spring(char* szline, FILE* fp)
 	read_line(szline, fp);
 	LoadCurve& lc = springset->m_lc;
 	lc.Clear();
-	while (!feof(fp) && (szline[0] != '*'))
+	while (!fp.eof() && (szline[0] != '*'))
 	{
 		double x, y;
 		sscanf(szline, "%lg,%lg", &y, &x);
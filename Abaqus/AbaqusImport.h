@@ -27,6 +27,7 @@ SOFTWARE.*/
 #pragma once
 #include <MeshIO/FSFileImport.h>
 #include <FEMLib/FSProject.h>
+#include <FSCore/MemoryMappedFile.h>
 #include "AbaqusModel.h"
 
 #include <list>
@@ -49,6 +50,41 @@ class AbaqusImport : public FSFileImport
 public:
 	class Exception{};
 
+	// Memory-mapped input file. The keyword parsers read it line by line, but large
+	// data blocks (nodes, elements, sets) are accessed directly so that they can be
+	// parsed concurrently.
+	class InputFile
+	{
+	public:
+		InputFile();
+
+		bool Open(const char* szfile);
+		void Close();
+
+		// copy the next line into szline (including the end-of-line character, like fgets).
+		// At most n-1 characters are copied; the rest of a longer line is skipped.
+		bool gets(char* szline, int n);
+
+		// returns true when a read was attempted past the end of the file
+		bool eof() const { return m_eof; }
+
+		// current read position and end of file
+		const char* pos() const { return m_pos; }
+		const char* end() const { return m_end; }
+
+		// move the read position (must be at the start of a line)
+		void seek(const char* sz) { m_pos = sz; }
+
+		// fraction of the file that was read
+		float progress() const;
+
+	private:
+		MemoryMappedFile	m_file;
+		const char*			m_pos;
+		const char*			m_end;
+		bool				m_eof;
+	};
+
 public:	// import options
 	bool	m_bnodesets;	// read node sets
 	bool	m_belemsets;	// read element sets
@@ -66,9 +102,18 @@ public:
 
 	bool UpdateData(bool bsave) override;
 
+	float GetFileProgress() const override;
+
 protected:
 	// read a line and increment line counter
-	bool read_line(char* szline, FILE* fp);
+	bool read_line(char* szline, InputFile& fp);
+
+	// find the data lines that follow the current position, up to the next keyword.
+	// The range is returned in [szbeg, szend) and the next keyword line is read into szline.
+	void read_block(char* szline, InputFile& fp, const char*& szbeg, const char*& szend);
+
+	// set the line counter to the line of sz in a block that started at line nline0
+	void set_block_line(int nline0, const char* szbeg, const char* sz);
 
 	// build the model
 	bool build_model();
@@ -91,41 +136,41 @@ protected:
 	FSNodeSet* find_nodeset(AbaqusModel::NODE_SET* ns);
 
 	// Keyword parsers
-	bool read_heading            (char* szline, FILE* fp);
-	bool read_nodes              (char* szline, FILE* fp);
-	bool read_ngen               (char* szline, FILE* fp);
-	bool read_nfill              (char* szline, FILE* fp);
-	bool read_elements           (char* szline, FILE* fp);
-	bool read_element_sets       (char* szline, FILE* fp);
-	bool read_node_sets          (char* szline, FILE* fp);
-	bool read_surface            (char* szline, FILE* fp);
-	bool read_surface_interaction(char* szline, FILE* fp);
-	bool read_materials          (char* szline, FILE* fp);
-	bool read_part               (char* szline, FILE* fp);
-	bool read_end_part           (char* szline, FILE* fp);
-	bool read_instance           (char* szline, FILE* fp);
-	bool read_end_instance       (char* szline, FILE* fp);
-	bool read_assembly           (char* szline, FILE* fp);
-	bool read_end_assembly       (char* szline, FILE* fp);
-	bool read_spring_elements    (char* szline, FILE* fp);
-	bool read_step				 (char* szline, FILE* fp);
-	bool read_boundary           (char* szline, FILE* fp);
-	bool read_dsload             (char* szline, FILE* fp);
-	bool read_solid_section      (char* szline, FILE* fp);
-	bool read_shell_section      (char* szline, FILE* fp);
-	bool read_static             (char* szline, FILE* fp);
-	bool read_orientation        (char* szline, FILE* fp);
-	bool read_distribution       (char* szline, FILE* fp);
-	bool read_amplitude          (char* szline, FILE* fp);
-	bool read_contact_pair       (char* szline, FILE* fp);
-	bool read_spring             (char* szline, FILE* fp);
+	bool read_heading            (char* szline, InputFile& fp);
+	bool read_nodes              (char* szline, InputFile& fp);
+	bool read_ngen               (char* szline, InputFile& fp);
+	bool read_nfill              (char* szline, InputFile& fp);
+	bool read_elements           (char* szline, InputFile& fp);
+	bool read_element_sets       (char* szline, InputFile& fp);
+	bool read_node_sets          (char* szline, InputFile& fp);
+	bool read_surface            (char* szline, InputFile& fp);
+	bool read_surface_interaction(char* szline, InputFile& fp);
+	bool read_materials          (char* szline, InputFile& fp);
+	bool read_part               (char* szline, InputFile& fp);
+	bool read_end_part           (char* szline, InputFile& fp);
+	bool read_instance           (char* szline, InputFile& fp);
+	bool read_end_instance       (char* szline, InputFile& fp);
+	bool read_assembly           (char* szline, InputFile& fp);
+	bool read_end_assembly       (char* szline, InputFile& fp);
+	bool read_spring_elements    (char* szline, InputFile& fp);
+	bool read_step				 (char* szline, InputFile& fp);
+	bool read_boundary           (char* szline, InputFile& fp);
+	bool read_dsload             (char* szline, InputFile& fp);
+	bool read_solid_section      (char* szline, InputFile& fp);
+	bool read_shell_section      (char* szline, InputFile& fp);
+	bool read_static             (char* szline, InputFile& fp);
+	bool read_orientation        (char* szline, InputFile& fp);
+	bool read_distribution       (char* szline, InputFile& fp);
+	bool read_amplitude          (char* szline, InputFile& fp);
+	bool read_contact_pair       (char* szline, InputFile& fp);
+	bool read_spring             (char* szline, InputFile& fp);
 
 	// skip until we find the next keyword
-	bool skip_keyword(char* szline, FILE* fp);
+	bool skip_keyword(char* szline, InputFile& fp);
 
 protected:
 	// parse a file for keywords
-	bool parse_file(FILE* fp);
+	bool parse_file(InputFile& fp);
 
 	// parse the line for attributes
 	int parse_line(const char* szline, ATTRIBUTE* pa);
@@ -141,5 +186,7 @@ private:
 
 	AbaqusModel		m_inp;
 
+	InputFile	m_file;	// the main input file
+
 	int	m_nline;	// current line number
 };
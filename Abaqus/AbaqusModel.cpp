@@ -340,6 +340,32 @@ AbaqusModel::Tnode_itr AbaqusModel::PART::AddNode(AbaqusModel::NODE& n)
 	return m_Node.end();
 }
 
+//-----------------------------------------------------------------------------
+void AbaqusModel::PART::AddNodes(const vector<AbaqusModel::NODE>& nodes)
+{
+	if (nodes.empty()) return;
+
+	// nodes are usually listed in increasing order, in which case they can be appended
+	bool sorted = (m_Node.empty() || (nodes[0].id > m_Node.back().id));
+	for (size_t i = 1; sorted && (i < nodes.size()); ++i)
+	{
+		if (nodes[i].id <= nodes[i - 1].id) sorted = false;
+	}
+
+	if (sorted)
+	{
+		m_Node.insert(m_Node.end(), nodes.begin(), nodes.end());
+	}
+	else
+	{
+		for (size_t i = 0; i < nodes.size(); ++i)
+		{
+			NODE n = nodes[i];
+			AddNode(n);
+		}
+	}
+}
+
 //-----------------------------------------------------------------------------
 AbaqusModel::Tnode_itr AbaqusModel::PART::FindNode(int id)
 {
@@ -347,7 +373,7 @@ AbaqusModel::Tnode_itr AbaqusModel::PART::FindNode(int id)
 	return m_NLT[id - m_ioff];
 }
 
-list<AbaqusModel::SPRING_ELEMENT>::iterator AbaqusModel::PART::AddSpring(AbaqusModel::SPRING_ELEMENT& s)
+AbaqusModel::Tspring_itr AbaqusModel::PART::AddSpring(AbaqusModel::SPRING_ELEMENT& s)
 {
 	m_Spring.push_back(s);
 	return --m_Spring.end();
@@ -369,6 +395,28 @@ void AbaqusModel::PART::AddElement(AbaqusModel::ELEMENT& newElem)
 	m_Elem[nid] = newElem;
 }
 
+//-----------------------------------------------------------------------------
+void AbaqusModel::PART::AddElements(const vector<AbaqusModel::ELEMENT>& elems)
+{
+	if (elems.empty()) return;
+
+	// grow the element list only once
+	int maxId = -1;
+	for (const ELEMENT& el : elems) if (el.id > maxId) maxId = el.id;
+	if (maxId >= (int)m_Elem.size())
+	{
+		int oldSize = (int)m_Elem.size();
+		int newSize = maxId + 1000;
+		m_Elem.resize(newSize);
+		for (int i = oldSize; i < newSize; ++i) m_Elem[i].id = -1;
+	}
+
+	for (const ELEMENT& el : elems)
+	{
+		if (el.id >= 0) m_Elem[el.id] = el;
+	}
+}
+
 //-----------------------------------------------------------------------------
 
 vector<AbaqusModel::ELEMENT>::iterator AbaqusModel::PART::FindElement(int id)
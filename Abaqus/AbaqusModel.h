@@ -74,7 +74,7 @@ public:
 		int	id;
 		int	n[2];
 	};
-	typedef list<SPRING_ELEMENT>::iterator Tspring_itr;
+	typedef vector<SPRING_ELEMENT>::iterator Tspring_itr;
 
 	// Face
 	struct FACE
@@ -90,7 +90,7 @@ public:
 	{
 		char		szname[Max_Name + 1];
 		PART*		part;
-		list<Tnode_itr>	node;
+		vector<Tnode_itr>	node;
 	};
 
 	// Element set
@@ -105,7 +105,7 @@ public:
 	struct SURFACE
 	{
 		char szname[Max_Name + 1];	// surface name
-		list<FACE> face;			// face list
+		vector<FACE> face;			// face list
 		PART*		part;
 	};
 
@@ -200,9 +200,15 @@ public:
 		// add a node
 		Tnode_itr AddNode(NODE& n);
 
+		// add a list of nodes
+		void AddNodes(const vector<NODE>& nodes);
+
 		// add an element
 		void AddElement(ELEMENT& n);
 
+		// add a list of elements
+		void AddElements(const vector<ELEMENT>& elems);
+
 		// add a spring
 		Tspring_itr AddSpring(SPRING_ELEMENT& n);
 
@@ -255,7 +261,7 @@ public:
 		char m_szname[256];
 		vector<NODE>				m_Node;		// list of nodes
 		vector<ELEMENT>				m_Elem;		// list of elements
-		list<SPRING_ELEMENT>		m_Spring;	// list of springs
+		vector<SPRING_ELEMENT>		m_Spring;	// list of springs
 		map<string, NODE_SET*>		m_NSet;		// node sets
 		map<string, ELEMENT_SET*>	m_ESet;		// element sets
 		map<string, SURFACE*>		m_Surf;		// surfaces
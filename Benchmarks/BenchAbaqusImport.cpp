@@ -0,0 +1,171 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+// Benchmark for the Abaqus reader (AbaqusImport).
+// Writes an input deck with an n x n x n C3D8 mesh (a *NODE block, an *ELEMENT block 
+// and an *NSET with all nodes) and times how long it takes to import it. As a baseline, 
+// it also times parsing the node and element lines with fgets/sscanf, which is how 
+// the reader used to parse the data lines (this only parses, it doesn't build a model).
+//
+// usage: BenchAbaqusImport [n = 100]
+#include "BenchTools.h"
+#include <Abaqus/AbaqusImport.h>
+#include <FEMLib/FSProject.h>
+#include <GeomLib/GObject.h>
+#include <MeshLib/FEMesh.h>
+#include <vector>
+#include <cstring>
+
+static bool writeDeck(const std::string& fileName, int n)
+{
+	FILE* fp = fopen(fileName.c_str(), "wt");
+	if (fp == nullptr) return false;
+
+	const int m = n + 1;
+	const double h = 1.0 / n;
+	fprintf(fp, "*HEADING\nbenchmark deck\n");
+
+	fprintf(fp, "*NODE\n");
+	for (int k = 0; k < m; ++k)
+		for (int j = 0; j < m; ++j)
+			for (int i = 0; i < m; ++i)
+			{
+				int id = k * m * m + j * m + i + 1;
+				fprintf(fp, "%d, %.8g, %.8g, %.8g\n", id, i * h, j * h, k * h);
+			}
+
+	fprintf(fp, "*ELEMENT, TYPE=C3D8, ELSET=EALL\n");
+	int eid = 1;
+	for (int k = 0; k < n; ++k)
+		for (int j = 0; j < n; ++j)
+			for (int i = 0; i < n; ++i)
+			{
+				int n0 = k * m * m + j * m + i + 1;
+				int n1 = n0 + 1, n2 = n1 + m, n3 = n0 + m;
+				fprintf(fp, "%d, %d, %d, %d, %d, %d, %d, %d, %d\n", eid++, n0, n1, n2, n3, n0 + m * m, n1 + m * m, n2 + m * m, n3 + m * m);
+			}
+
+	fprintf(fp, "*NSET, NSET=ALLNODES\n");
+	const int nn = m * m * m;
+	for (int i = 1; i <= nn; ++i) fprintf(fp, "%d%s", i, ((i % 16 == 0) || (i == nn) ? "\n" : ", "));
+
+	fclose(fp);
+	return true;
+}
+
+// parse the node and element lines with fgets/sscanf
+static bool parseBaseline(const std::string& fileName, int& nodes, int& elems)
+{
+	FILE* fp = fopen(fileName.c_str(), "rt");
+	if (fp == nullptr) return false;
+
+	std::vector<double> r;
+	std::vector<int> e;
+	char szline[256];
+	int block = 0;
+	nodes = elems = 0;
+	while (fgets(szline, 255, fp))
+	{
+		if (szline[0] == '*')
+		{
+			if      (strncmp(szline, "*NODE"   , 5) == 0) block = 1;
+			else if (strncmp(szline, "*ELEMENT", 8) == 0) block = 2;
+			else block = 0;
+		}
+		else if (block == 1)
+		{
+			int id; double x, y, z;
+			if (sscanf(szline, "%d,%lg,%lg,%lg", &id, &x, &y, &z) != 4) { fclose(fp); return false; }
+			r.push_back(x); r.push_back(y); r.push_back(z);
+			nodes++;
+		}
+		else if (block == 2)
+		{
+			int id, m[8];
+			if (sscanf(szline, "%d,%d,%d,%d,%d,%d,%d,%d,%d", &id, m, m + 1, m + 2, m + 3, m + 4, m + 5, m + 6, m + 7) != 9) { fclose(fp); return false; }
+			e.insert(e.end(), m, m + 8);
+			elems++;
+		}
+	}
+	fclose(fp);
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	int n = Bench::intArg(argc, argv, 1, 100);
+	if (n < 1) n = 1;
+	const int nodes = (n + 1) * (n + 1) * (n + 1);
+	const int elems = n * n * n;
+
+	Bench::header("Abaqus import");
+	printf("%d nodes, %d C3D8 elements\n", nodes, elems);
+
+	std::string fileName = Bench::tempFile("febio_bench.inp");
+	if (writeDeck(fileName, n) == false)
+	{
+		printf("Failed writing the test deck.\n");
+		return 1;
+	}
+
+	bool bok = true;
+
+	int bn = 0, be = 0;
+	Bench::Timer tb;
+	if (parseBaseline(fileName, bn, be) && (bn == nodes) && (be == elems))
+		Bench::report("baseline (fgets/sscanf, parse only)", tb.seconds(), elems, "elements");
+	else
+	{
+		printf("baseline parse failed\n");
+		bok = false;
+	}
+
+	FSProject prj;
+	AbaqusImport reader(prj);
+	Bench::Timer t;
+	if (reader.Load(fileName.c_str()))
+	{
+		double sec = t.seconds();
+		GModel& mdl = prj.GetFSModel().GetModel();
+		FSMesh* mesh = (mdl.Objects() > 0 ? mdl.Object(0)->GetFEMesh() : nullptr);
+		Bench::report("AbaqusImport", sec, elems, "elements");
+		if ((mesh == nullptr) || (mesh->Nodes() != nodes) || (mesh->Elements() != elems))
+		{
+			printf("  unexpected mesh size\n");
+			bok = false;
+		}
+	}
+	else
+	{
+		printf("AbaqusImport: %s\n", reader.GetErrorString().c_str());
+		bok = false;
+	}
+
+	remove(fileName.c_str());
+
+	return (bok ? 0 : 1);
+}
@@ -0,0 +1,146 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+// Benchmark for the element storage of FSMesh.
+// Builds a TET4 mesh of an n x n x n grid (6 tets per cell) and reports the memory 
+// used by the elements and the time to build, traverse and copy them. The traversal 
+// computes the total volume, which is checked (it must be 1).
+// Finally, a fiber and material axes are assigned to all elements, which allocates
+// the mesh's attribute arrays, and the memory cost per element is reported.
+//
+// usage: BenchElementStorage [n = 100] [repetitions = 5]
+#include "BenchTools.h"
+#include <MeshLib/FEMesh.h>
+#include <cmath>
+
+int main(int argc, char* argv[])
+{
+	int n = Bench::intArg(argc, argv, 1, 100);
+	int nrep = Bench::intArg(argc, argv, 2, 5);
+	if (n < 1) n = 1;
+	if (nrep < 1) nrep = 1;
+
+	const int m = n + 1;
+	const int nodes = m * m * m;
+	const int elems = 6 * n * n * n;
+
+	Bench::header("Element storage");
+	printf("%d nodes, %d TET4 elements\n", nodes, elems);
+	printf("sizeof(FSElement)           = %d bytes\n", (int)sizeof(FSElement));
+	printf("element storage             = %.1f MB\n", (double)elems * sizeof(FSElement) / (1024.0 * 1024.0));
+
+	// the 6 tets of a cell (all share the cell diagonal 0-6)
+	const int tet[6][4] = { {0,1,2,6}, {0,2,3,6}, {0,3,7,6}, {0,7,4,6}, {0,4,5,6}, {0,5,1,6} };
+
+	FSMesh mesh;
+	Bench::Timer tb;
+	mesh.Create(nodes, elems);
+	const double h = 1.0 / n;
+	for (int k = 0; k < m; ++k)
+		for (int j = 0; j < m; ++j)
+			for (int i = 0; i < m; ++i)
+				mesh.Node(k * m * m + j * m + i).r = vec3d(i * h, j * h, k * h);
+
+	#pragma omp parallel for
+	for (int c = 0; c < n * n * n; ++c)
+	{
+		int i = c % n, j = (c / n) % n, k = c / (n * n);
+		int n0 = k * m * m + j * m + i;
+		int v[8] = { n0, n0 + 1, n0 + 1 + m, n0 + m, n0 + m * m, n0 + 1 + m * m, n0 + 1 + m + m * m, n0 + m + m * m };
+		for (int l = 0; l < 6; ++l)
+		{
+			FSElement& el = mesh.Element(6 * c + l);
+			el.SetType(FE_TET4);
+			el.m_gid = 0;
+			for (int q = 0; q < 4; ++q) el.m_node[q] = v[tet[l][q]];
+		}
+	}
+	Bench::report("build", tb.seconds(), elems, "elements");
+
+	// traverse the elements
+	double vol = 0.0;
+	double tv = Bench::bestOf(nrep, [&]() {
+		double V = 0.0;
+		#pragma omp parallel for reduction(+:V)
+		for (int i = 0; i < elems; ++i)
+		{
+			const FSElement& el = mesh.Element(i);
+			const vec3d& r0 = mesh.Node(el.m_node[0]).r;
+			vec3d a = mesh.Node(el.m_node[1]).r - r0;
+			vec3d b = mesh.Node(el.m_node[2]).r - r0;
+			vec3d c = mesh.Node(el.m_node[3]).r - r0;
+			V += fabs(a * (b ^ c)) / 6.0;
+		}
+		vol = V;
+	});
+	Bench::report("traverse (volume)", tv, elems, "elements");
+
+	// copy the mesh
+	double tc = Bench::bestOf(nrep, [&]() {
+		FSMesh copy(mesh);
+	});
+	Bench::report("copy mesh", tc, elems, "elements");
+
+	// fibers on all elements
+	Bench::Timer ta;
+	for (int i = 0; i < elems; ++i) mesh.SetElementFiber(i, vec3d(1, 0, 0));
+	Bench::report("set fibers (100%)", ta.seconds(), elems, "elements");
+	size_t fiberBytes = mesh.ElementAttributes().MemorySize();
+	printf("fiber storage               = %.1f MB (%.1f bytes/element)\n", fiberBytes / (1024.0 * 1024.0), (double)fiberBytes / elems);
+
+	// material axes on all elements
+	Bench::Timer tq;
+	for (int i = 0; i < elems; ++i) mesh.SetElementMaterialAxes(i, vec3d(1, 0, 0), vec3d(0, 1, 0));
+	Bench::report("set material axes (100%)", tq.seconds(), elems, "elements");
+	size_t attBytes = mesh.ElementAttributes().MemorySize();
+	printf("fiber + axes storage        = %.1f MB (%.1f bytes/element)\n", attBytes / (1024.0 * 1024.0), (double)attBytes / elems);
+
+	// copying now includes the attributes
+	double tca = Bench::bestOf(nrep, [&]() {
+		FSMesh copy(mesh);
+	});
+	Bench::report("copy mesh (with attributes)", tca, elems, "elements");
+
+	// check that the attributes survive removing every other element
+	for (int i = 0; i < elems; ++i) mesh.Element(i).m_ntag = (i % 2);
+	mesh.SetElementFiber(1, vec3d(0, 0, 1));
+	mesh.SetElementFiber(2, vec3d(0, 1, 0));
+	mesh.RemoveElements(1);
+	if ((mesh.Elements() != (elems + 1) / 2) || (mesh.ElementFiber(1).y != 1.0) || !mesh.IsElementMaterialAxesActive(1))
+	{
+		printf("element attributes were not compacted with the elements\n");
+		return 1;
+	}
+
+	if (fabs(vol - 1.0) > 1e-6)
+	{
+		printf("unexpected volume %lg\n", vol);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,130 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+// Benchmark for the fiber ODF analysis (CFiberODFAnalysis).
+// Generates an n^3 8-bit image of parallel fibers (a sinusoidal stripe pattern), 
+// splits it into d x d x d sub-volumes and times the analysis. 
+// Requires SimpleITK. The legend bar of the analysis needs a QGuiApplication, so on 
+// a machine without a display run it with "-platform offscreen".
+//
+// usage: BenchFiberODF [n = 256] [d = 4]
+#include "BenchTools.h"
+#include <ImageLib/ImageModel.h>
+#include <ImageLib/ImageSource.h>
+#include <ImageLib/FiberODFAnalysis.h>
+#include <ImageLib/3DImage.h>
+#include <QGuiApplication>
+#include <vector>
+#include <cstdint>
+
+// a stack of fibers that run along the x-axis
+static bool writeFiberImage(const std::string& fileName, int n)
+{
+	FILE* fp = fopen(fileName.c_str(), "wb");
+	if (fp == nullptr) return false;
+
+	const double pi = 3.14159265358979323846;
+	const double period = 8.0;
+	std::vector<uint8_t> slice((size_t)n * n);
+	for (int k = 0; k < n; ++k)
+	{
+		for (int j = 0; j < n; ++j)
+			for (int i = 0; i < n; ++i)
+			{
+				double f = sin(2.0 * pi * j / period) * sin(2.0 * pi * k / period);
+				slice[(size_t)j * n + i] = (uint8_t)(127.5 + 127.5 * f);
+			}
+		fwrite(slice.data(), 1, slice.size(), fp);
+	}
+	fclose(fp);
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	QGuiApplication app(argc, argv);
+
+	// (Qt removes the options it handles from argv)
+	int n = Bench::intArg(argc, argv, 1, 256);
+	int d = Bench::intArg(argc, argv, 2, 4);
+	if (n < 16) n = 16;
+	if (d < 1) d = 1;
+
+	Bench::header("Fiber ODF analysis");
+	printf("image %d^3, %d x %d x %d sub-volumes\n", n, d, d, d);
+
+#ifdef HAS_ITK
+	std::string fileName = Bench::tempFile("febio_bench_fibers.raw");
+	if (writeFiberImage(fileName, n) == false)
+	{
+		printf("Failed writing the test image.\n");
+		return 1;
+	}
+
+	CImageModel img(nullptr);
+	img.SetImageSource(new CRawImageSource(&img, fileName, CImage::UINT_8, n, n, n, BOX(0, 0, 0, n, n, n), false));
+	bool bok = img.Load();
+	remove(fileName.c_str());
+	if (bok == false)
+	{
+		printf("Failed reading the test image.\n");
+		return 1;
+	}
+
+	CFiberODFAnalysis* odf = new CFiberODFAnalysis(&img);
+	img.AddImageAnalysis(odf);
+	odf->SetIntValue(CFiberODFAnalysis::XDIV, d);
+	odf->SetIntValue(CFiberODFAnalysis::YDIV, d);
+	odf->SetIntValue(CFiberODFAnalysis::ZDIV, d);
+
+	Bench::Timer t;
+	odf->run();
+	double sec = t.seconds();
+	Bench::report("ODF analysis", sec, odf->ODFs(), "sub-volumes");
+
+	// every sub-volume should have an ODF
+	int nbad = 0;
+	for (int i = 0; i < odf->ODFs(); ++i)
+	{
+		CODF* pi = odf->GetODF(i);
+		if ((pi == nullptr) || (pi->IsValid() == false)) nbad++;
+	}
+	if ((odf->ODFs() != d * d * d) || (nbad > 0))
+	{
+		printf("%d of %d sub-volumes were not processed\n", nbad, odf->ODFs());
+		return 1;
+	}
+
+	// (the fibers of the test image run along the x-axis)
+	CODF* p0 = odf->GetODF(0);
+	printf("mean direction of the first sub-volume: %.3f %.3f %.3f\n", p0->m_meanDir.x, p0->m_meanDir.y, p0->m_meanDir.z);
+	return 0;
+#else
+	printf("This benchmark requires SimpleITK.\n");
+	return 0;
+#endif
+}
@@ -0,0 +1,247 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+// Benchmark for the point location (FEFindElement).
+// Builds a HEX8 mesh of an n x n x n grid of the unit cube and times
+//  - building the search tree (Init),
+//  - locating random points one at a time (FindElement) and all at once (FindElements),
+//  - locating points along straight lines with the previous element as the hint, 
+//    like the stream line and particle flow plots do,
+//  - updating the tree after the nodes moved (Refit) and locating points in the 
+//    deformed mesh.
+// The points are generated inside known elements, so every result is checked.
+//
+// usage: BenchFindElement [n = 50] [points = 1000000] [repetitions = 5]
+#include "BenchTools.h"
+#include <MeshLib/FEMesh.h>
+#include <MeshLib/FEFindElement.h>
+#include <vector>
+#include <cmath>
+
+// random numbers in [0,1)
+struct Random
+{
+	unsigned int seed = 1234u;
+	double operator () () { seed = 1664525u * seed + 1013904223u; return (double)(seed >> 8) / 16777216.0; }
+};
+
+// The point with iso-parametric coordinates r in HEX8 element el
+static vec3f hexPoint(FSMesh& mesh, const FSElement& el, const double r[3])
+{
+	const double s[8][3] = { {-1,-1,-1}, {1,-1,-1}, {1,1,-1}, {-1,1,-1}, {-1,-1,1}, {1,-1,1}, {1,1,1}, {-1,1,1} };
+	vec3d x(0, 0, 0);
+	for (int i = 0; i < 8; ++i)
+	{
+		double H = 0.125 * (1 + s[i][0] * r[0]) * (1 + s[i][1] * r[1]) * (1 + s[i][2] * r[2]);
+		x += mesh.Node(el.m_node[i]).r * H;
+	}
+	return to_vec3f(x);
+}
+
+// random points, each inside a random element (stored in elem)
+static void randomPoints(FSMesh& mesh, int N, std::vector<vec3f>& x, std::vector<int>& elem)
+{
+	Random rnd;
+	int NE = mesh.Elements();
+	x.resize(N);
+	elem.resize(N);
+	for (int i = 0; i < N; ++i)
+	{
+		int ne = (int)(rnd() * NE);
+		if (ne >= NE) ne = NE - 1;
+		double r[3] = { 1.8 * rnd() - 0.9, 1.8 * rnd() - 0.9, 1.8 * rnd() - 0.9 };
+		x[i] = hexPoint(mesh, mesh.Element(ne), r);
+		elem[i] = ne;
+	}
+}
+
+// number of results that differ from the expected elements
+static int countErrors(const std::vector<int>& found, const std::vector<int>& expected)
+{
+	int nerr = 0;
+	for (size_t i = 0; i < expected.size(); ++i) if (found[i] != expected[i]) nerr++;
+	return nerr;
+}
+
+int main(int argc, char* argv[])
+{
+	int n = Bench::intArg(argc, argv, 1, 50);
+	int N = Bench::intArg(argc, argv, 2, 1000000);
+	int nrep = Bench::intArg(argc, argv, 3, 5);
+	if (n < 2) n = 2;
+	if (N < 1) N = 1;
+	if (nrep < 1) nrep = 1;
+
+	const int m = n + 1;
+	const int nodes = m * m * m;
+	const int elems = n * n * n;
+
+	Bench::header("Find element");
+	printf("%d nodes, %d HEX8 elements, %d points\n", nodes, elems, N);
+
+	FSMesh mesh;
+	mesh.Create(nodes, elems);
+	const double h = 1.0 / n;
+	for (int k = 0; k < m; ++k)
+		for (int j = 0; j < m; ++j)
+			for (int i = 0; i < m; ++i)
+				mesh.Node(k * m * m + j * m + i).r = vec3d(i * h, j * h, k * h);
+
+	for (int c = 0; c < elems; ++c)
+	{
+		int i = c % n, j = (c / n) % n, k = c / (n * n);
+		int n0 = k * m * m + j * m + i;
+		FSElement& el = mesh.Element(c);
+		el.SetType(FE_HEX8);
+		el.m_gid = 0;
+		int v[8] = { n0, n0 + 1, n0 + 1 + m, n0 + m, n0 + m * m, n0 + 1 + m * m, n0 + 1 + m + m * m, n0 + m + m * m };
+		for (int q = 0; q < 8; ++q) el.m_node[q] = v[q];
+	}
+	mesh.BuildMesh();
+
+	FEFindElement find(mesh);
+	double sec = Bench::bestOf(nrep, [&]() { find.Init(1); });
+	Bench::report("build tree (Init)", sec, elems, "elements");
+
+	std::vector<vec3f> x;
+	std::vector<int> expected;
+	randomPoints(mesh, N, x, expected);
+
+	// one point at a time
+	std::vector<int> found(N, -1);
+	sec = Bench::bestOf(nrep, [&]() {
+		for (int i = 0; i < N; ++i)
+		{
+			double r[3];
+			if (find.FindElement(x[i], found[i], r) == false) found[i] = -1;
+		}
+	});
+	Bench::report("FindElement (random points)", sec, N, "points");
+	int nerr = countErrors(found, expected);
+
+	// all at once
+	std::vector<int> elem;
+	std::vector<vec3d> r;
+	sec = Bench::bestOf(nrep, [&]() { elem.clear(); find.FindElements(x, elem, r); });
+	Bench::report("FindElements (random points)", sec, N, "points");
+	nerr += countErrors(elem, expected);
+
+	// Points along straight lines through the mesh, spaced a fraction of an element apart.
+	// Each point uses the element of the previous point on its line as its hint.
+	std::vector<vec3f> xl;
+	std::vector<int> lineStart;
+	Random rnd;
+	while ((int)xl.size() < N)
+	{
+		lineStart.push_back((int)xl.size());
+		vec3d p(rnd(), rnd(), rnd());
+		vec3d d(2 * rnd() - 1, 2 * rnd() - 1, 2 * rnd() - 1); d.Normalize();
+		d *= 0.3 * h;
+		while ((p.x > 0) && (p.x < 1) && (p.y > 0) && (p.y < 1) && (p.z > 0) && (p.z < 1) && ((int)xl.size() < N))
+		{
+			xl.push_back(to_vec3f(p));
+			p += d;
+		}
+	}
+	lineStart.push_back((int)xl.size());
+	int lines = (int)lineStart.size() - 1;
+	printf("%d lines\n", lines);
+
+	// (on the regular grid, the element follows from the coordinates)
+	std::vector<int> expectedl(N);
+	for (int i = 0; i < N; ++i)
+	{
+		int ci = (int)(xl[i].x / h); if (ci >= n) ci = n - 1;
+		int cj = (int)(xl[i].y / h); if (cj >= n) cj = n - 1;
+		int ck = (int)(xl[i].z / h); if (ck >= n) ck = n - 1;
+		expectedl[i] = ck * n * n + cj * n + ci;
+	}
+
+	std::vector<int> foundl(N, -1);
+	auto traceLines = [&](bool useHint) {
+		for (int l = 0; l < lines; ++l)
+		{
+			int nhint = -1;
+			for (int i = lineStart[l]; i < lineStart[l + 1]; ++i)
+			{
+				double q[3];
+				bool bfound = (useHint ? find.FindElement(xl[i], foundl[i], q, nhint) : find.FindElement(xl[i], foundl[i], q));
+				if (bfound == false) foundl[i] = -1;
+				nhint = foundl[i];
+			}
+		}
+	};
+	sec = Bench::bestOf(nrep, [&]() { traceLines(false); });
+	Bench::report("FindElement (lines, no hint)", sec, N, "points");
+	sec = Bench::bestOf(nrep, [&]() { traceLines(true); });
+	Bench::report("FindElement (lines, hint)", sec, N, "points");
+	// (points on element faces can go either way)
+	int nerrl = countErrors(foundl, expectedl);
+
+	// The batched version uses the elements that were passed in as hints.
+	// Here, the hint is the element of the previous point.
+	std::vector<int> hints(N);
+	for (int l = 0; l < lines; ++l)
+	{
+		hints[lineStart[l]] = -1;
+		for (int i = lineStart[l] + 1; i < lineStart[l + 1]; ++i) hints[i] = expectedl[i - 1];
+	}
+	sec = Bench::bestOf(nrep, [&]() { elem = hints; find.FindElements(xl, elem, r); });
+	Bench::report("FindElements (lines, hint)", sec, N, "points");
+	nerrl += countErrors(elem, expectedl);
+
+	// deform the mesh and update the tree
+	for (int i = 0; i < nodes; ++i)
+	{
+		vec3d& ri = mesh.Node(i).r;
+		const double pi = 3.14159265358979323846;
+		ri.x += 0.1 * sin(pi * ri.y) * sin(pi * ri.z);
+		ri.y += 0.1 * sin(pi * ri.x) * sin(pi * ri.z);
+	}
+	sec = Bench::bestOf(nrep, [&]() { find.Refit(); });
+	Bench::report("update tree (Refit)", sec, elems, "elements");
+
+	randomPoints(mesh, N, x, expected);
+	sec = Bench::bestOf(nrep, [&]() { elem.clear(); find.FindElements(x, elem, r); });
+	Bench::report("FindElements (after Refit)", sec, N, "points");
+	nerr += countErrors(elem, expected);
+
+	// compare with rebuilding the tree
+	sec = Bench::bestOf(nrep, [&]() { find.Init(1); });
+	Bench::report("rebuild tree (Init)", sec, elems, "elements");
+	sec = Bench::bestOf(nrep, [&]() { elem.clear(); find.FindElements(x, elem, r); });
+	Bench::report("FindElements (after Init)", sec, N, "points");
+	nerr += countErrors(elem, expected);
+
+	if (nerrl > 0) printf("%d points on the lines were placed in a neighboring element\n", nerrl);
+	if (nerr > 0)
+	{
+		printf("%d random points were not found in their element\n", nerr);
+		return 1;
+	}
+	return 0;
+}
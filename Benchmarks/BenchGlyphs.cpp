@@ -0,0 +1,235 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+// Benchmark for the glyphs of the vector plot (CGLVectorPlot).
+// Places N arrows with random positions and directions in the unit cube, copies them 
+// into one triangle mesh (GLGlyph::AddToMesh) and times building and drawing that mesh, 
+// for an increasing number of glyphs. For comparison, the glyphs are also drawn 
+// the way the plot used to do it, i.e. with a few GLU calls per glyph. 
+// Drawing needs an OpenGL context. The driver renders into an offscreen frame buffer, 
+// so on a machine without a display run it with "-platform offscreen". When no context 
+// can be created, only the build times are reported.
+//
+// usage: BenchGlyphs [max glyphs = 1000000] [repetitions = 5]
+#include "BenchTools.h"
+#include <GL/glew.h>
+#include <GLLib/GLGlyph.h>
+#include <GLLib/GLMesh.h>
+#include <QGuiApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#ifdef __APPLE__
+#include <OpenGL/GLU.h>
+#else
+#include <GL/glu.h>
+#endif
+#include <vector>
+#include <cmath>
+
+// the arrow glyphs
+struct Glyphs
+{
+	std::vector<vec3f>		r;	// position
+	std::vector<vec3f>		v;	// unit direction
+	std::vector<GLColor>	c;	// color
+	float	L;					// length
+};
+
+static Glyphs randomGlyphs(int N)
+{
+	Glyphs g;
+	g.r.resize(N);
+	g.v.resize(N);
+	g.c.resize(N);
+	g.L = 0.02f;
+
+	unsigned int seed = 1234u;
+	auto rnd = [&]() { seed = 1664525u * seed + 1013904223u; return (float)(seed >> 8) / 16777216.f; };
+	for (int i = 0; i < N; ++i)
+	{
+		g.r[i] = vec3f(rnd(), rnd(), rnd());
+		vec3f v(2.f * rnd() - 1.f, 2.f * rnd() - 1.f, 2.f * rnd() - 1.f);
+		if (v.Length() < 1e-3f) v = vec3f(0.f, 0.f, 1.f);
+		v.Normalize();
+		g.v[i] = v;
+		g.c[i] = GLColor::FromRGBf(fabs(v.x), fabs(v.y), fabs(v.z));
+	}
+	return g;
+}
+
+// the same arrow that the vector plot uses (for an aspect ratio of 1)
+static void arrowTemplate(GLGlyph& glyph)
+{
+	glyph.AddCylinder(0.05f, 0.05f, 0.f, 0.9f, 5);
+	glyph.AddCylinder(0.15f, 0.f, 0.81f, 1.01f, 10);
+}
+
+// copy all glyphs into the mesh (see CGLVectorPlot::BuildGlyphs)
+static void buildMesh(GLTriMesh& mesh, const GLGlyph& glyph, const Glyphs& g)
+{
+	int N = (int)g.r.size();
+	mesh.Create(N * glyph.Triangles(), GLMesh::FLAG_NORMAL | GLMesh::FLAG_COLOR);
+	mesh.BeginMesh();
+	for (int i = 0; i < N; ++i)
+	{
+		vec3f R[3];
+		GLGlyph::RotateZTo(g.v[i], R);
+		vec3f A[3] = { R[0] * g.L, R[1] * g.L, R[2] * g.L };
+		glyph.AddToMesh(mesh, g.r[i], A, R, g.c[i]);
+	}
+	mesh.EndMesh();
+}
+
+// draw the glyphs one by one, the way the vector plot did before it used a glyph mesh
+static void drawGLU(GLUquadricObj* pglyph, const Glyphs& g)
+{
+	const float L = g.L;
+	float l0 = L * .9f;
+	float l1 = L * .2f;
+	float r0 = L * 0.05f;
+	float r1 = L * 0.15f;
+
+	int N = (int)g.r.size();
+	for (int i = 0; i < N; ++i)
+	{
+		const vec3f& r = g.r[i];
+		const vec3f& v = g.v[i];
+		glColor3ub(g.c[i].r, g.c[i].g, g.c[i].b);
+
+		glPushMatrix();
+		glTranslatef(r.x, r.y, r.z);
+
+		// rotate the z-axis onto v
+		float w = acos(v.z < -1.f ? -1.f : (v.z > 1.f ? 1.f : v.z)) * 180.f / 3.14159265f;
+		vec3f p(-v.y, v.x, 0.f);
+		if (p.Length() > 1e-6f) glRotatef(w, p.x, p.y, p.z);
+		else if (v.z < 0.f) glRotatef(180.f, 1.f, 0.f, 0.f);
+
+		gluCylinder(pglyph, r0, r0, l0, 5, 1);
+		glTranslatef(0.f, 0.f, l0 * 0.9f);
+		gluCylinder(pglyph, r1, 0, l1, 10, 1);
+		glPopMatrix();
+	}
+}
+
+static void beginFrame()
+{
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(-0.1, 1.1, -0.1, 1.1, -2.0, 2.0);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+}
+
+int main(int argc, char* argv[])
+{
+	QGuiApplication app(argc, argv);
+
+	// (Qt removes the options it handles from argv)
+	int maxGlyphs = Bench::intArg(argc, argv, 1, 1000000);
+	int nrep = Bench::intArg(argc, argv, 2, 5);
+	if (maxGlyphs < 1000) maxGlyphs = 1000;
+	if (nrep < 1) nrep = 1;
+
+	Bench::header("Vector plot glyphs");
+
+	// set up an offscreen context
+	QOffscreenSurface surface;
+	surface.create();
+	QOpenGLContext context;
+	QOpenGLFramebufferObject* fbo = nullptr;
+	bool hasGL = (context.create() && context.makeCurrent(&surface));
+	if (hasGL)
+	{
+		QOpenGLFramebufferObjectFormat fmt;
+		fmt.setAttachment(QOpenGLFramebufferObject::Depth);
+		fbo = new QOpenGLFramebufferObject(512, 512, fmt);
+		glewExperimental = GL_TRUE;
+		hasGL = (fbo->bind() && (glewInit() == GLEW_OK));
+	}
+	if (hasGL)
+	{
+		glViewport(0, 0, 512, 512);
+		glEnable(GL_DEPTH_TEST);
+		printf("OpenGL: %s\n", (const char*)glGetString(GL_RENDERER));
+	}
+	else printf("No OpenGL context. Only the build times are reported.\n");
+
+	GLGlyph glyph;
+	arrowTemplate(glyph);
+	printf("%d triangles per glyph\n", (int)glyph.Triangles());
+
+	GLUquadricObj* pglyph = nullptr;
+	if (hasGL)
+	{
+		pglyph = gluNewQuadric();
+		gluQuadricNormals(pglyph, GLU_SMOOTH);
+	}
+
+	for (int N = 1000; N <= maxGlyphs; N *= 10)
+	{
+		printf("\n%d glyphs\n", N);
+		Glyphs g = randomGlyphs(N);
+
+		GLTriMesh mesh;
+		mesh.SetRenderMode(GLMesh::VBOMode);
+		double sec = Bench::bestOf(nrep, [&]() { buildMesh(mesh, glyph, g); });
+		Bench::report("build glyph mesh", sec, N, "glyphs");
+
+		// every glyph should be in the mesh
+		if (mesh.Vertices() != 3 * N * glyph.Triangles())
+		{
+			printf("The glyph mesh has %d vertices (expected %d).\n", (int)mesh.Vertices(), (int)(3 * N * glyph.Triangles()));
+			return 1;
+		}
+
+		if (hasGL == false) continue;
+
+		// the first draw uploads the mesh to the GPU
+		beginFrame();
+		Bench::Timer t;
+		mesh.Render();
+		glFinish();
+		Bench::report("first draw (VBO upload)", t.seconds(), N, "glyphs");
+
+		sec = Bench::bestOf(nrep, [&]() { beginFrame(); mesh.Render(); glFinish(); });
+		Bench::report("draw glyph mesh (VBO)", sec, N, "glyphs");
+
+		// (this gets slow quickly)
+		if (N <= 100000)
+		{
+			sec = Bench::bestOf(nrep, [&]() { beginFrame(); drawGLU(pglyph, g); glFinish(); });
+			Bench::report("draw per glyph (GLU)", sec, N, "glyphs");
+		}
+	}
+
+	if (pglyph) gluDeleteQuadric(pglyph);
+	delete fbo;
+	return 0;
+}
@@ -0,0 +1,311 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+// Benchmark for the nearest neighbour searches (FSKDTree).
+// Times building the kd-tree and finding the nearest point, the k nearest points and 
+// the points within a radius, for a uniform point cloud and for a highly clustered one. 
+// The nearest point searches are compared with the two-pivot search that FSNNQuery used
+// before it was based on the kd-tree (a copy of it is included below). That search 
+// gets very slow, so it only runs the first "old queries" queries.
+// The results of the first 1000 queries are checked against a brute force search.
+//
+// usage: BenchKDTree [points = 200000] [queries = 200000] [old queries = 10000]
+#include "BenchTools.h"
+#include <MeshTools/FSKDTree.h>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// The nearest neighbour search of the previous version of FSNNQuery. The points are 
+// sorted by their distance to a pivot, and the search scans the shell around the query
+// point that is bounded by the distances to two pivots.
+class TwoPivotQuery
+{
+	struct NODE
+	{
+		int		i;	// index of node
+		vec3d	r;	// position of node
+		double	d1;	// distance to pivot 1
+		double	d2;	// distance to pivot 2
+	};
+
+public:
+	TwoPivotQuery(const std::vector<vec3d>& pts) : m_ps(pts) { m_imin = 0; }
+
+	void Init()
+	{
+		int N = (int)m_ps.size();
+
+		// the pivots are the furthest point of the first point, and the furthest point of that one
+		m_q1 = furthest(m_ps[0]);
+		m_q2 = furthest(m_q1);
+
+		m_bk.resize(N);
+		for (int i = 0; i < N; ++i)
+		{
+			const vec3d& r = m_ps[i];
+			m_bk[i].i = i;
+			m_bk[i].r = r;
+			m_bk[i].d1 = (m_q1 - r) * (m_q1 - r);
+			m_bk[i].d2 = (m_q2 - r) * (m_q2 - r);
+		}
+		std::sort(m_bk.begin(), m_bk.end(), [](const NODE& a, const NODE& b) { return a.d1 < b.d1; });
+		m_imin = 0;
+	}
+
+	int Find(const vec3d& x)
+	{
+		// set the initial search radii
+		double d1 = sqrt((m_q1 - x) * (m_q1 - x));
+		double rmin1 = 0, rmax1 = 2 * d1;
+		double d2 = sqrt((m_q2 - x) * (m_q2 - x));
+		double rmin2 = 0, rmax2 = 2 * d2;
+
+		// start with the last found item
+		vec3d r = m_ps[m_imin];
+		double dmin = (r - x) * (r - x);
+		double d = sqrt(dmin);
+
+		if (d1 - d > rmin1) rmin1 = d1 - d;
+		if (d1 + d < rmax1) rmax1 = d1 + d;
+		double rmin1s = rmin1 * rmin1;
+		double rmax1s = rmax1 * rmax1;
+
+		if (d2 - d > rmin2) rmin2 = d2 - d;
+		if (d2 + d < rmax2) rmax2 = d2 + d;
+		double rmin2s = rmin2 * rmin2;
+		double rmax2s = rmax2 * rmax2;
+
+		// the first item with d(i, q1) >= rmin1
+		int i0 = (int)(std::lower_bound(m_bk.begin(), m_bk.end(), rmin1s, [](const NODE& a, double v) { return a.d1 < v; }) - m_bk.begin());
+
+		for (int i = i0; i < (int)m_bk.size(); ++i)
+		{
+			const NODE& n = m_bk[i];
+			if (n.d1 > rmax1s) break;
+			if ((n.d2 >= rmin2s) && (n.d2 <= rmax2s))
+			{
+				d = (n.r - x) * (n.r - x);
+				if (d < dmin)
+				{
+					dmin = d;
+					d = sqrt(dmin);
+					m_imin = n.i;
+
+					if (d1 + d < rmax1) rmax1 = d1 + d;
+					rmax1s = rmax1 * rmax1;
+
+					if (d2 - d > rmin2) rmin2 = d2 - d;
+					if (d2 + d < rmax2) rmax2 = d2 + d;
+					rmin2s = rmin2 * rmin2;
+					rmax2s = rmax2 * rmax2;
+				}
+			}
+		}
+		return m_imin;
+	}
+
+private:
+	vec3d furthest(const vec3d& r0) const
+	{
+		vec3d q = r0;
+		double dmax = 0;
+		for (const vec3d& r : m_ps)
+		{
+			double d = (r - r0) * (r - r0);
+			if (d > dmax) { q = r; dmax = d; }
+		}
+		return q;
+	}
+
+private:
+	const std::vector<vec3d>&	m_ps;
+	std::vector<NODE>	m_bk;
+	vec3d	m_q1, m_q2;	// pivots
+	int		m_imin;		// last found index
+};
+
+// random numbers in [0,1)
+struct Random
+{
+	unsigned int seed = 1234u;
+	double operator () () { seed = 1664525u * seed + 1013904223u; return (double)(seed >> 8) / 16777216.0; }
+
+	// normal distribution (Box-Muller)
+	double normal()
+	{
+		double u = 1.0 - (*this)(), v = (*this)();
+		return sqrt(-2.0 * log(u)) * cos(2.0 * 3.14159265358979323846 * v);
+	}
+};
+
+static void uniformCloud(Random& rnd, int N, std::vector<vec3d>& x)
+{
+	x.resize(N);
+	for (int i = 0; i < N; ++i) x[i] = vec3d(rnd(), rnd(), rnd());
+}
+
+// 20 gaussian clusters in the unit cube. Half of them are very tight.
+static void clusteredCloud(Random& rnd, int N, std::vector<vec3d>& x)
+{
+	const int C = 20;
+	vec3d c[C];
+	double s[C];
+	for (int i = 0; i < C; ++i)
+	{
+		c[i] = vec3d(rnd(), rnd(), rnd());
+		s[i] = (i % 2 == 0 ? 1e-4 : 0.02);
+	}
+
+	x.resize(N);
+	for (int i = 0; i < N; ++i)
+	{
+		int k = i % C;
+		x[i] = c[k] + vec3d(rnd.normal(), rnd.normal(), rnd.normal()) * s[k];
+	}
+}
+
+static double dist2(const vec3d& a, const vec3d& b) { return (a - b) * (a - b); }
+
+// runs the benchmark for one point cloud. Returns the number of wrong results.
+static int runCloud(const char* name, const std::vector<vec3d>& pts, const std::vector<vec3d>& x, int nold, int nrep)
+{
+	const int N = (int)pts.size();
+	const int Q = (int)x.size();
+	const int K = 8;
+	// (about 16 points per sphere in a uniform cloud)
+	const double R = pow(3.0 * 16.0 / (4.0 * 3.14159265358979323846 * N), 1.0 / 3.0);
+
+	printf("\n%s: %d points, %d queries\n", name, N, Q);
+
+	FSKDTree tree;
+	double sec = Bench::bestOf(nrep, [&]() { tree.Build(pts); });
+	Bench::report("kd-tree build", sec, N, "points");
+
+	std::vector<int> nearest(Q);
+	sec = Bench::bestOf(nrep, [&]() {
+		for (int i = 0; i < Q; ++i) nearest[i] = tree.FindNearest(x[i]);
+	});
+	Bench::report("kd-tree nearest", sec, Q, "queries");
+
+	std::vector<int> batch;
+	sec = Bench::bestOf(nrep, [&]() { tree.FindNearest(x, batch); });
+	Bench::report("kd-tree nearest (batch)", sec, Q, "queries");
+
+	std::vector<int> items;
+	size_t nknn = 0;
+	sec = Bench::bestOf(nrep, [&]() {
+		nknn = 0;
+		for (int i = 0; i < Q; ++i) { tree.FindNearest(x[i], K, items); nknn += items.size(); }
+	});
+	Bench::report("kd-tree 8 nearest", sec, Q, "queries");
+
+	size_t nrad = 0;
+	sec = Bench::bestOf(nrep, [&]() {
+		nrad = 0;
+		for (int i = 0; i < Q; ++i) { tree.FindRadius(x[i], R, items); nrad += items.size(); }
+	});
+	Bench::report("kd-tree radius", sec, Q, "queries");
+	printf("(%.1f points per radius query)\n", (double)nrad / Q);
+
+	// the old search
+	if (nold > Q) nold = Q;
+	TwoPivotQuery old(pts);
+	Bench::Timer t;
+	old.Init();
+	Bench::report("two-pivot init", t.seconds(), N, "points");
+
+	std::vector<int> oldNearest(nold);
+	t.start();
+	for (int i = 0; i < nold; ++i) oldNearest[i] = old.Find(x[i]);
+	Bench::report("two-pivot nearest", t.seconds(), nold, "queries");
+
+	// check against a brute force search
+	// (when points are at the same distance, only the distance is compared)
+	int nerr = 0;
+	int ncheck = (Q < 1000 ? Q : 1000);
+	std::vector<double> d(N);
+	std::vector<int> ref;
+	t.start();
+	for (int i = 0; i < ncheck; ++i)
+	{
+		for (int j = 0; j < N; ++j) d[j] = dist2(pts[j], x[i]);
+		double dmin = *std::min_element(d.begin(), d.end());
+
+		if (dist2(pts[nearest[i]], x[i]) != dmin) nerr++;
+		if (batch[i] != nearest[i]) nerr++;
+		if ((i < nold) && (dist2(pts[oldNearest[i]], x[i]) != dmin)) nerr++;
+
+		// k nearest: compare the distances
+		tree.FindNearest(x[i], K, items);
+		std::vector<double> dk(d);
+		std::nth_element(dk.begin(), dk.begin() + (K - 1), dk.end());
+		if (((int)items.size() != K) || (dist2(pts[items[K - 1]], x[i]) != dk[K - 1])) nerr++;
+
+		// radius
+		tree.FindRadius(x[i], R, items);
+		ref.clear();
+		for (int j = 0; j < N; ++j) if (d[j] <= R * R) ref.push_back(j);
+		if (items != ref) nerr++;
+	}
+	Bench::report("brute force (all queries)", t.seconds(), ncheck, "queries");
+
+	if (nerr > 0) printf("%d of %d checked queries gave wrong results\n", nerr, ncheck);
+	return nerr;
+}
+
+int main(int argc, char* argv[])
+{
+	int N = Bench::intArg(argc, argv, 1, 200000);
+	int Q = Bench::intArg(argc, argv, 2, 200000);
+	int nold = Bench::intArg(argc, argv, 3, 10000);
+	int nrep = 3;
+	if (N < 100) N = 100;
+	if (Q < 1) Q = 1;
+	if (nold < 0) nold = 0;
+
+	Bench::header("Nearest neighbour search");
+
+	Random rnd;
+	std::vector<vec3d> pts, x;
+	int nerr = 0;
+
+	uniformCloud(rnd, N, pts);
+	uniformCloud(rnd, Q, x);
+	nerr += runCloud("uniform", pts, x, nold, nrep);
+
+	// half of the queries are near the clusters, the others are anywhere in the cube
+	clusteredCloud(rnd, N, pts);
+	std::vector<vec3d> xc;
+	clusteredCloud(rnd, Q / 2, xc);
+	uniformCloud(rnd, Q - Q / 2, x);
+	for (int i = 0; i < Q / 2; ++i) x.push_back(xc[i]);
+	for (int i = Q - 1; i > 0; --i) std::swap(x[i], x[(int)(rnd() * (i + 1))]);
+	nerr += runCloud("clustered", pts, x, nold, nrep);
+
+	return (nerr == 0 ? 0 : 1);
+}
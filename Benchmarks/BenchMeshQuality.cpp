@@ -0,0 +1,148 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+// Benchmark for the mesh quality evaluation (FEMeshValuator), per element type.
+// Builds HEX8, PENTA6 and TET4 meshes of an n x n x n grid of the unit cube, 
+// and HEX20 and TET10 meshes by converting those. For each mesh, it times the 
+// evaluation of the element volume and the Jacobian, and the statistics pass 
+// (range, average and histogram). The total volume is checked (it must be 1).
+//
+// usage: BenchMeshQuality [n = 50] [repetitions = 3]
+#include "BenchTools.h"
+#include <MeshLib/FEMesh.h>
+#include <MeshTools/FEMeshValuator.h>
+#include <MeshTools/FEModifier.h>
+#include <cmath>
+
+// create a mesh of the unit cube with n^3 cells, where each cell is split into
+// the given sub-elements (lists of cell corner indices)
+static FSMesh* buildGridMesh(int n, int elemType, int nodesPerElem, int subElems, const int (*sub)[8])
+{
+	const int m = n + 1;
+	const int cells = n * n * n;
+	FSMesh* mesh = new FSMesh;
+	mesh->Create(m * m * m, subElems * cells);
+
+	const double h = 1.0 / n;
+	for (int k = 0; k < m; ++k)
+		for (int j = 0; j < m; ++j)
+			for (int i = 0; i < m; ++i)
+				mesh->Node(k * m * m + j * m + i).r = vec3d(i * h, j * h, k * h);
+
+	for (int c = 0; c < cells; ++c)
+	{
+		int i = c % n, j = (c / n) % n, k = c / (n * n);
+		int n0 = k * m * m + j * m + i;
+		int v[8] = { n0, n0 + 1, n0 + 1 + m, n0 + m, n0 + m * m, n0 + 1 + m * m, n0 + 1 + m + m * m, n0 + m + m * m };
+		for (int l = 0; l < subElems; ++l)
+		{
+			FSElement& el = mesh->Element(subElems * c + l);
+			el.SetType(elemType);
+			el.m_gid = 0;
+			for (int q = 0; q < nodesPerElem; ++q) el.m_node[q] = v[sub[l][q]];
+		}
+	}
+
+	mesh->RebuildMesh();
+	return mesh;
+}
+
+static bool runMesh(const char* name, FSMesh* mesh, int nrep)
+{
+	if (mesh == nullptr)
+	{
+		printf("%s: failed creating the mesh\n", name);
+		return false;
+	}
+
+	int NE = mesh->Elements();
+	printf("%s (%d elements)\n", name, NE);
+
+	FEMeshValuator eval(*mesh);
+	const int fields[2] = { FEMeshValuator::ELEMENT_VOLUME, FEMeshValuator::JACOBIAN };
+	const char* fieldNames[2] = { "  volume", "  jacobian" };
+	double vol = 0.0;
+	for (int i = 0; i < 2; ++i)
+	{
+		double t = Bench::bestOf(nrep, [&]() { eval.Evaluate(fields[i]); });
+		Bench::report(fieldNames[i], t, NE, "elements");
+
+		FEMeshDataStats stats;
+		double ts = Bench::bestOf(nrep, [&]() { stats = FEMeshValuator::GetDataStats(mesh->GetMeshData(), 100); });
+		Bench::report("  statistics", ts, NE, "elements");
+
+		if (fields[i] == FEMeshValuator::ELEMENT_VOLUME) vol = stats.vavg * stats.count;
+	}
+
+	if (fabs(vol - 1.0) > 1e-6)
+	{
+		printf("  unexpected volume %lg\n", vol);
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	int n = Bench::intArg(argc, argv, 1, 50);
+	int nrep = Bench::intArg(argc, argv, 2, 3);
+	if (n < 1) n = 1;
+	if (nrep < 1) nrep = 1;
+
+	Bench::header("Mesh quality");
+	printf("grid %d x %d x %d\n", n, n, n);
+
+	const int hex[1][8] = { {0,1,2,3,4,5,6,7} };
+	const int penta[2][8] = { {0,1,2,4,5,6}, {0,2,3,4,6,7} };
+	const int tet[6][8] = { {0,1,2,6}, {0,2,3,6}, {0,3,7,6}, {0,7,4,6}, {0,4,5,6}, {0,5,1,6} };
+
+	bool bok = true;
+
+	FSMesh* hex8 = buildGridMesh(n, FE_HEX8, 8, 1, hex);
+	bok &= runMesh("HEX8", hex8, nrep);
+
+	FEHex8ToHex20 toHex20;
+	FSMesh* hex20 = toHex20.Apply(hex8);
+	bok &= runMesh("HEX20", hex20, nrep);
+	delete hex20;
+	delete hex8;
+
+	FSMesh* penta6 = buildGridMesh(n, FE_PENTA6, 6, 2, penta);
+	bok &= runMesh("PENTA6", penta6, nrep);
+	delete penta6;
+
+	FSMesh* tet4 = buildGridMesh(n, FE_TET4, 4, 6, tet);
+	bok &= runMesh("TET4", tet4, nrep);
+
+	FETet4ToTet10 toTet10;
+	FSMesh* tet10 = toTet10.Apply(tet4);
+	bok &= runMesh("TET10", tet10, nrep);
+	delete tet10;
+	delete tet4;
+
+	return (bok ? 0 : 1);
+}
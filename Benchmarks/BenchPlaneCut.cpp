@@ -0,0 +1,124 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+// Benchmark for the plane cut extraction (CGLPlaneCutPlot).
+// Creates a post model with an n x n x n HEX8 mesh of a cube and sweeps a cut plane 
+// (with an oblique normal) through it, like dragging the offset slider. The first 
+// update also calculates the element projections that are used to find the cut 
+// elements. The following updates only change the offset, so they reuse them.
+//
+// usage: BenchPlaneCut [n = 100] [steps = 20]
+#include "BenchTools.h"
+#include <PostLib/FEPostModel.h>
+#include <PostLib/FEPostMesh.h>
+#include <PostLib/FEState.h>
+#include <PostLib/Material.h>
+#include <PostGL/GLModel.h>
+#include <PostGL/GLPlaneCutPlot.h>
+
+using namespace Post;
+
+// a post model with a HEX8 mesh of the cube [-0.5,0.5]^3
+static FEPostModel* buildModel(int n)
+{
+	FEPostModel* fem = new FEPostModel;
+
+	Material mat;
+	fem->AddMaterial(mat);
+
+	const int m = n + 1;
+	FEPostMesh* pm = new FEPostMesh();
+	pm->Create(m * m * m, n * n * n);
+
+	const double h = 1.0 / n;
+	for (int k = 0; k < m; ++k)
+		for (int j = 0; j < m; ++j)
+			for (int i = 0; i < m; ++i)
+				pm->Node(k * m * m + j * m + i).r = vec3d(i * h - 0.5, j * h - 0.5, k * h - 0.5);
+	fem->AddMesh(pm);
+
+	for (int c = 0; c < n * n * n; ++c)
+	{
+		int i = c % n, j = (c / n) % n, k = c / (n * n);
+		int n0 = k * m * m + j * m + i;
+		FSElement& el = pm->Element(c);
+		el.SetType(FE_HEX8);
+		int v[8] = { n0, n0 + 1, n0 + 1 + m, n0 + m, n0 + m * m, n0 + 1 + m * m, n0 + 1 + m + m * m, n0 + m + m * m };
+		for (int q = 0; q < 8; ++q) el.m_node[q] = v[q];
+		el.m_MatID = 0;
+	}
+
+	pm->BuildMesh();
+	fem->UpdateBoundingBox();
+
+	FEState* ps = new FEState(0.f, fem, fem->GetFEMesh(0));
+	fem->AddState(ps);
+
+	return fem;
+}
+
+int main(int argc, char* argv[])
+{
+	int n = Bench::intArg(argc, argv, 1, 100);
+	int steps = Bench::intArg(argc, argv, 2, 20);
+	if (n < 1) n = 1;
+	if (steps < 1) steps = 1;
+
+	Bench::header("Plane cut");
+	printf("%d HEX8 elements, %d offsets\n", n * n * n, steps);
+
+	FEPostModel* fem = buildModel(n);
+	CGLModel* glm = new CGLModel(fem);
+
+	CGLPlaneCutPlot* pcp = new CGLPlaneCutPlot();
+	glm->AddPlot(pcp, false);
+	pcp->SetPlaneNormal(vec3d(1, 2, 3));
+
+	// the plane passes through the center of the cube at offset 0
+	double offmax = 0.5;
+
+	// first update (includes the element projections)
+	pcp->SetPlaneOffset(0.f);
+	Bench::Timer t0;
+	pcp->UpdatePlaneCut();
+	Bench::report("first update", t0.seconds(), n * n * n, "elements");
+
+	// sweep the plane through the model
+	Bench::Timer t;
+	for (int i = 0; i < steps; ++i)
+	{
+		double f = (steps > 1 ? -offmax + 2.0 * offmax * i / (steps - 1) : 0.0);
+		pcp->SetPlaneOffset((float)f);
+		pcp->UpdatePlaneCut();
+	}
+	double sec = t.seconds();
+	Bench::report("offset updates (average)", sec / steps, n * n * n, "elements");
+
+	delete glm;
+	delete fem;
+	return 0;
+}
@@ -0,0 +1,152 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+// Benchmark for the STL reader (STLimport).
+// Writes a binary and an ASCII STL file of a triangulated n x n grid and times 
+// how long it takes to read them. All vertices of the grid are shared by several 
+// facets, so the timings include the vertex merging.
+//
+// usage: BenchSTLImport [n = 700]
+#include "BenchTools.h"
+#include <MeshIO/STLimport.h>
+#include <FEMLib/FSProject.h>
+#include <GeomLib/GObject.h>
+#include <MeshLib/FEMesh.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// vertex coordinates of facet i (two facets per grid cell)
+static void gridFacet(int n, int i, float v[9])
+{
+	int c = i / 2;
+	int x = c % n, y = c / n;
+	int q[4][2] = { {x, y}, {x + 1, y}, {x + 1, y + 1}, {x, y + 1} };
+	int t[2][3] = { {0, 1, 2}, {0, 2, 3} };
+	const int* ti = t[i % 2];
+	for (int j = 0; j < 3; ++j)
+	{
+		v[3 * j    ] = (float)q[ti[j]][0];
+		v[3 * j + 1] = (float)q[ti[j]][1];
+		v[3 * j + 2] = 0.f;
+	}
+}
+
+static bool writeBinarySTL(const std::string& fileName, int n)
+{
+	FILE* fp = fopen(fileName.c_str(), "wb");
+	if (fp == nullptr) return false;
+
+	char head[80] = { 0 };
+	fwrite(head, 1, 80, fp);
+	uint32_t nf = 2 * n * n;
+	fwrite(&nf, sizeof(nf), 1, fp);
+
+	std::vector<char> buf(50, 0);
+	float nrm[3] = { 0.f, 0.f, 1.f };
+	for (uint32_t i = 0; i < nf; ++i)
+	{
+		float v[9];
+		gridFacet(n, i, v);
+		memcpy(&buf[0], nrm, 12);
+		memcpy(&buf[12], v, 36);
+		fwrite(buf.data(), 1, 50, fp);
+	}
+	fclose(fp);
+	return true;
+}
+
+static bool writeAsciiSTL(const std::string& fileName, int n)
+{
+	FILE* fp = fopen(fileName.c_str(), "wt");
+	if (fp == nullptr) return false;
+
+	fprintf(fp, "solid grid\n");
+	int nf = 2 * n * n;
+	for (int i = 0; i < nf; ++i)
+	{
+		float v[9];
+		gridFacet(n, i, v);
+		fprintf(fp, "  facet normal 0 0 1\n    outer loop\n");
+		for (int j = 0; j < 3; ++j) fprintf(fp, "      vertex %g %g %g\n", v[3 * j], v[3 * j + 1], v[3 * j + 2]);
+		fprintf(fp, "    endloop\n  endfacet\n");
+	}
+	fprintf(fp, "endsolid grid\n");
+	fclose(fp);
+	return true;
+}
+
+static bool readSTL(const std::string& fileName, const char* what, int n)
+{
+	FSProject prj;
+	STLimport reader(prj);
+
+	Bench::Timer t;
+	bool bret = reader.Load(fileName.c_str());
+	double sec = t.seconds();
+	if (bret == false)
+	{
+		printf("%s: %s\n", what, reader.GetErrorString().c_str());
+		return false;
+	}
+
+	GModel& mdl = prj.GetFSModel().GetModel();
+	FSMesh* mesh = (mdl.Objects() > 0 ? mdl.Object(0)->GetFEMesh() : nullptr);
+	int nodes = (mesh ? mesh->Nodes() : 0);
+	Bench::report(what, sec, 2.0 * n * n, "facets");
+	if (nodes != (n + 1) * (n + 1))
+	{
+		printf("  unexpected node count %d (expected %d)\n", nodes, (n + 1) * (n + 1));
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	int n = Bench::intArg(argc, argv, 1, 700);
+	if (n < 1) n = 1;
+
+	Bench::header("STL import");
+	printf("grid %d x %d, %d facets\n", n, n, 2 * n * n);
+
+	std::string binFile = Bench::tempFile("febio_bench_binary.stl");
+	std::string ascFile = Bench::tempFile("febio_bench_ascii.stl");
+	if (!writeBinarySTL(binFile, n) || !writeAsciiSTL(ascFile, n))
+	{
+		printf("Failed writing the test files.\n");
+		return 1;
+	}
+
+	bool bok = readSTL(binFile, "binary", n);
+	bok &= readSTL(ascFile, "ascii", n);
+
+	remove(binFile.c_str());
+	remove(ascFile.c_str());
+
+	return (bok ? 0 : 1);
+}
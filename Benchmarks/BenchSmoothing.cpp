@@ -0,0 +1,179 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+// Benchmark for the mesh smoothing kernels (FEMeshSmoothingModifier).
+// Generates a noisy triangulated torus as a stand-in for a scanned surface and 
+// smooths it with Laplacian smoothing. It compares the serial Gauss-Seidel update 
+// (the nodes are moved in place, which is how the kernel used to work) with the 
+// parallel Jacobi-style kernel of the modifier, with a fixed number of iterations and 
+// with the tolerance-based early stop. For each run it reports the time and the mean 
+// distance of the nodes to the exact torus, so that the convergence can be compared.
+//
+// usage: BenchSmoothing [nu = 2000] [iterations = 100]
+#include "BenchTools.h"
+#include <MeshLib/FEMesh.h>
+#include <MeshLib/FENodeNodeList.h>
+#include <MeshTools/FEMeshSmoothingModifier.h>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
+static const double R0 = 1.0;	// major radius
+static const double R1 = 0.3;	// minor radius
+
+// a torus with nu x nv quads, split into triangles. The radius has some noise.
+static FSMesh* buildTorus(int nu, int nv, double noise)
+{
+	FSMesh* mesh = new FSMesh;
+	mesh->Create(nu * nv, 2 * nu * nv);
+
+	const double pi = 3.14159265358979323846;
+	uint32_t seed = 12345;
+	for (int j = 0; j < nv; ++j)
+		for (int i = 0; i < nu; ++i)
+		{
+			seed = 1664525u * seed + 1013904223u;
+			double e = noise * ((double)(seed >> 8) / (double)(1 << 24) - 0.5);
+			double u = 2.0 * pi * i / nu, v = 2.0 * pi * j / nv;
+			double r = R1 * (1.0 + e);
+			mesh->Node(j * nu + i).r = vec3d((R0 + r * cos(v)) * cos(u), (R0 + r * cos(v)) * sin(u), r * sin(v));
+		}
+
+	for (int j = 0; j < nv; ++j)
+		for (int i = 0; i < nu; ++i)
+		{
+			int n0 = j * nu + i;
+			int n1 = j * nu + (i + 1) % nu;
+			int n2 = ((j + 1) % nv) * nu + (i + 1) % nu;
+			int n3 = ((j + 1) % nv) * nu + i;
+			int t[2][3] = { {n0, n1, n2}, {n0, n2, n3} };
+			for (int l = 0; l < 2; ++l)
+			{
+				FSElement& el = mesh->Element(2 * n0 + l);
+				el.SetType(FE_TRI3);
+				el.m_gid = 0;
+				for (int q = 0; q < 3; ++q) el.m_node[q] = t[l][q];
+			}
+		}
+
+	mesh->RebuildMesh();
+	return mesh;
+}
+
+// mean distance of the nodes to the exact torus
+static double torusError(FSMesh& mesh)
+{
+	int NN = mesh.Nodes();
+	double sum = 0.0;
+	#pragma omp parallel for reduction(+:sum)
+	for (int i = 0; i < NN; ++i)
+	{
+		const vec3d& r = mesh.Node(i).r;
+		double a = sqrt(r.x * r.x + r.y * r.y) - R0;
+		sum += fabs(sqrt(a * a + r.z * r.z) - R1);
+	}
+	return sum / NN;
+}
+
+// serial Gauss-Seidel Laplacian smoothing (the nodes are updated in place)
+static void gaussSeidelSmoothing(FSMesh* pm, int niter, double w)
+{
+	std::vector<int> hashmap(pm->Nodes(), 0);
+	for (int i = 0; i < pm->Edges(); ++i)
+	{
+		FSEdge& ed = pm->Edge(i);
+		hashmap[ed.n[0]] = hashmap[ed.n[1]] = -1;
+	}
+
+	FSNodeNodeList NNL(pm);
+	int NN = pm->Nodes();
+	for (int j = 0; j < niter; ++j)
+	{
+		for (int i = 0; i < NN; ++i)
+		{
+			int nval = NNL.Valence(i);
+			if ((hashmap[i] != 0) || (nval == 0)) continue;
+
+			FSNode& ni = pm->Node(i);
+			vec3d r(0, 0, 0);
+			for (int k = 0; k < nval; ++k) r += pm->Node(NNL.Node(i, k)).r;
+			r /= nval;
+			ni.r = r * w + ni.r * (1 - w);
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int nu = Bench::intArg(argc, argv, 1, 2000);
+	int niter = Bench::intArg(argc, argv, 2, 100);
+	if (nu < 8) nu = 8;
+	if (niter < 1) niter = 1;
+	int nv = nu / 4 + 1;
+	const double w = 0.5;
+
+	Bench::header("Laplacian smoothing");
+
+	FSMesh* mesh = buildTorus(nu, nv, 0.05);
+	printf("%d nodes, %d triangles, %d iterations\n", mesh->Nodes(), mesh->Elements(), niter);
+	printf("%-36s %10s   mean error %.4g\n", "input", "", torusError(*mesh));
+
+	// Gauss-Seidel
+	{
+		FSMesh* pm = new FSMesh(*mesh);
+		Bench::Timer t;
+		gaussSeidelSmoothing(pm, niter, w);
+		double sec = t.seconds();
+		Bench::report("Gauss-Seidel (serial)", sec, pm->Nodes(), "nodes");
+		printf("%-36s %10s   mean error %.4g\n", "", "", torusError(*pm));
+		delete pm;
+	}
+
+	// Jacobi, with a fixed number of iterations and with the early stop
+	double tols[2] = { 0.0, 1e-5 };
+	const char* names[2] = { "Jacobi (parallel)", "Jacobi (parallel, tolerance 1e-5)" };
+	for (int l = 0; l < 2; ++l)
+	{
+		FEMeshSmoothingModifier mod;
+		mod.m_method = 0;
+		mod.m_iteration = niter;
+		mod.m_threshold1 = w;
+		mod.SetFloatValue(0, tols[l]);
+
+		Bench::Timer t;
+		FSMesh* pm = mod.Apply(mesh);
+		double sec = t.seconds();
+		if (pm == nullptr) { printf("smoothing failed\n"); return 1; }
+		Bench::report(names[l], sec, pm->Nodes(), "nodes");
+		printf("%-36s %10s   mean error %.4g\n", "", "", torusError(*pm));
+		delete pm;
+	}
+	printf("(the modifier timings include copying and rebuilding the mesh)\n");
+
+	delete mesh;
+	return 0;
+}
@@ -0,0 +1,358 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+// Benchmark for the tiff reader (CTiffImageSource).
+// Writes a 16-bit multi-page tiff stack, uncompressed, PackBits and (when zlib is 
+// available) Deflate compressed, both as a classic tiff and as a BigTIFF, and times 
+// how long it takes to read them. The pages are split in strips of 16 rows. 
+// The pixel values are a checkerboard of constant blocks and a gradient, so the 
+// compressed strips have both runs and literals. All voxels are checked after 
+// reading.
+//
+// usage: BenchTiffReader [nx = 512] [ny = 512] [nz = 256] [repetitions = 3]
+#include "BenchTools.h"
+#include <ImageLib/TiffReader.h>
+#include <ImageLib/3DImage.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// tiff constants used by the writer
+enum {
+	TIFF_SHORT = 3,
+	TIFF_LONG = 4,
+	TIFF_LONG8 = 16,
+
+	COMPRESS_NONE = 1,
+	COMPRESS_DEFLATE = 8,
+	COMPRESS_PACKBITS = 32773
+};
+
+const int ROWS_PER_STRIP = 16;
+
+// pixel value of voxel (i,j,k)
+static uint16_t pixelValue(int i, int j, int k)
+{
+	if (((i / 32) + (j / 32)) % 2) return 0x0404;
+	return (uint16_t)((i * 37 + j * 11 + k * 5) & 0xFFF);
+}
+
+// little endian writers
+static void put16(std::vector<uint8_t>& b, uint16_t v)
+{
+	b.push_back((uint8_t)(v & 0xFF));
+	b.push_back((uint8_t)(v >> 8));
+}
+
+static void put32(std::vector<uint8_t>& b, uint32_t v)
+{
+	put16(b, (uint16_t)(v & 0xFFFF));
+	put16(b, (uint16_t)(v >> 16));
+}
+
+static void put64(std::vector<uint8_t>& b, uint64_t v)
+{
+	put32(b, (uint32_t)(v & 0xFFFFFFFF));
+	put32(b, (uint32_t)(v >> 32));
+}
+
+// PackBits encoding of one row
+static void packBits(const uint8_t* src, size_t n, std::vector<uint8_t>& out)
+{
+	size_t i = 0;
+	while (i < n)
+	{
+		// length of the run that starts at i
+		size_t run = 1;
+		while ((i + run < n) && (run < 128) && (src[i + run] == src[i])) ++run;
+
+		if (run >= 3)
+		{
+			out.push_back((uint8_t)(257 - run));
+			out.push_back(src[i]);
+			i += run;
+		}
+		else
+		{
+			// literals, up to the next run of three or more bytes
+			size_t j = i;
+			while ((j < n) && (j - i < 128))
+			{
+				if ((j + 2 < n) && (src[j] == src[j + 1]) && (src[j] == src[j + 2])) break;
+				++j;
+			}
+			out.push_back((uint8_t)(j - i - 1));
+			out.insert(out.end(), src + i, src + j);
+			i = j;
+		}
+	}
+}
+
+// encode the rows [j0, j1) of page k
+static bool encodeStrip(int nx, int j0, int j1, int k, int compression, std::vector<uint8_t>& out)
+{
+	size_t rowSize = 2 * (size_t)nx;
+	std::vector<uint8_t> raw;
+	raw.reserve(rowSize * (j1 - j0));
+	for (int j = j0; j < j1; ++j)
+		for (int i = 0; i < nx; ++i) put16(raw, pixelValue(i, j, k));
+
+	out.clear();
+	switch (compression)
+	{
+	case COMPRESS_NONE:
+		out = raw;
+		break;
+	case COMPRESS_PACKBITS:
+		for (int j = j0; j < j1; ++j) packBits(&raw[(j - j0) * rowSize], rowSize, out);
+		break;
+#ifdef HAVE_ZLIB
+	case COMPRESS_DEFLATE:
+	{
+		uLongf size = compressBound((uLong)raw.size());
+		out.resize(size);
+		if (compress2(out.data(), &size, raw.data(), (uLong)raw.size(), Z_DEFAULT_COMPRESSION) != Z_OK) return false;
+		out.resize(size);
+	}
+	break;
+#endif
+	default:
+		return false;
+	}
+	return true;
+}
+
+// Writes the stack. Each page is written as its IFD, followed by the strip offsets 
+// and byte counts (if they don't fit in the IFD) and the strip data, so the offset 
+// of the next IFD is known when the IFD is written.
+static bool writeTiff(const std::string& fileName, int nx, int ny, int nz, int compression, bool bigTiff)
+{
+	FILE* fp = fopen(fileName.c_str(), "wb");
+	if (fp == nullptr) return false;
+
+	const uint64_t countSize = (bigTiff ? 8 : 2);
+	const uint64_t entrySize = (bigTiff ? 20 : 12);
+	const uint64_t valueSize = (bigTiff ? 8 : 4);
+	const int entries = 9;
+	const int offsetType = (bigTiff ? TIFF_LONG8 : TIFF_LONG);
+
+	std::vector<uint8_t> b;
+	if (bigTiff)
+	{
+		b.push_back('I'); b.push_back('I');
+		put16(b, 43); put16(b, 8); put16(b, 0);
+		put64(b, 16);
+	}
+	else
+	{
+		b.push_back('I'); b.push_back('I');
+		put16(b, 42);
+		put32(b, 8);
+	}
+	uint64_t pos = b.size();
+	bool bok = (fwrite(b.data(), 1, b.size(), fp) == b.size());
+
+	int strips = (ny + ROWS_PER_STRIP - 1) / ROWS_PER_STRIP;
+	std::vector<std::vector<uint8_t> > stripData(strips);
+	for (int k = 0; bok && (k < nz); ++k)
+	{
+		for (int s = 0; s < strips; ++s)
+		{
+			int j0 = s * ROWS_PER_STRIP;
+			int j1 = std::min(j0 + ROWS_PER_STRIP, ny);
+			if (encodeStrip(nx, j0, j1, k, compression, stripData[s]) == false) { bok = false; break; }
+		}
+		if (bok == false) break;
+
+		// layout of this page
+		uint64_t ifdSize = countSize + entries * entrySize + valueSize;
+		uint64_t arraySize = strips * valueSize;
+		bool external = (arraySize > valueSize);
+		uint64_t offsetsPos = pos + ifdSize;
+		uint64_t countsPos = offsetsPos + (external ? arraySize : 0);
+		uint64_t dataPos = countsPos + (external ? arraySize : 0);
+
+		std::vector<uint64_t> offsets(strips), counts(strips);
+		uint64_t end = dataPos;
+		for (int s = 0; s < strips; ++s)
+		{
+			offsets[s] = end;
+			counts[s] = stripData[s].size();
+			end += counts[s];
+		}
+		// IFDs must start on a word boundary
+		uint64_t pad = (end % 2);
+		uint64_t next = (k < nz - 1 ? end + pad : 0);
+
+		b.clear();
+		auto entry = [&](uint16_t tag, uint16_t type, uint64_t count) {
+			put16(b, tag); put16(b, type);
+			if (bigTiff) put64(b, count); else put32(b, (uint32_t)count);
+		};
+		auto value = [&](uint64_t v) {
+			if (bigTiff) put64(b, v); else put32(b, (uint32_t)v);
+		};
+		auto shortValue = [&](uint16_t v) {
+			put16(b, v); put16(b, 0);
+			if (bigTiff) put32(b, 0);
+		};
+		auto array = [&](const std::vector<uint64_t>& v, uint64_t arrayPos) {
+			if (external) value(arrayPos);
+			else value(v[0]);
+		};
+
+		if (bigTiff) put64(b, entries); else put16(b, entries);
+		entry(256, TIFF_LONG, 1); value(nx);
+		entry(257, TIFF_LONG, 1); value(ny);
+		entry(258, TIFF_SHORT, 1); shortValue(16);
+		entry(259, TIFF_SHORT, 1); shortValue((uint16_t)compression);
+		entry(262, TIFF_SHORT, 1); shortValue(1);
+		entry(273, offsetType, strips); array(offsets, offsetsPos);
+		entry(277, TIFF_SHORT, 1); shortValue(1);
+		entry(278, TIFF_LONG, 1); value(ROWS_PER_STRIP);
+		entry(279, offsetType, strips); array(counts, countsPos);
+		if (bigTiff) put64(b, next); else put32(b, (uint32_t)next);
+
+		if (external)
+		{
+			for (int s = 0; s < strips; ++s) { if (bigTiff) put64(b, offsets[s]); else put32(b, (uint32_t)offsets[s]); }
+			for (int s = 0; s < strips; ++s) { if (bigTiff) put64(b, counts[s]); else put32(b, (uint32_t)counts[s]); }
+		}
+		bok &= (fwrite(b.data(), 1, b.size(), fp) == b.size());
+
+		for (int s = 0; bok && (s < strips); ++s)
+			bok &= (fwrite(stripData[s].data(), 1, stripData[s].size(), fp) == stripData[s].size());
+		if (pad) bok &= (fputc(0, fp) != EOF);
+
+		pos = end + pad;
+	}
+	fclose(fp);
+
+	// a classic tiff cannot address more than 4GB
+	if (!bigTiff && (pos > 0xFFFFFFFFull)) bok = false;
+
+	return bok;
+}
+
+static bool readTiff(const std::string& fileName, const char* what, int nx, int ny, int nz, int nrep)
+{
+	FILE* fp = fopen(fileName.c_str(), "rb");
+	if (fp == nullptr) return false;
+	fseek(fp, 0, SEEK_END);
+	double fileSize = (double)ftell(fp);
+	fclose(fp);
+
+	bool bret = true;
+	std::string err;
+	double sec = Bench::bestOf(nrep, [&]() {
+		CTiffImageSource src(nullptr, fileName);
+		if (src.Load() == false) { bret = false; err = src.GetErrorString(); }
+	});
+	if (bret == false)
+	{
+		printf("%s: %s\n", what, err.c_str());
+		return false;
+	}
+
+	double mb = 2.0 * nx * ny * nz / 1.0e6;
+	char sz[64];
+	snprintf(sz, sizeof(sz), "%s (%.0f%%)", what, 100.0 * fileSize / (2.0 * nx * ny * nz));
+	Bench::report(sz, sec, mb, "MB");
+
+	// read it again to check the voxels
+	CTiffImageSource src(nullptr, fileName);
+	if (src.Load() == false) return false;
+	C3DImage* im = src.Get3DImage();
+	if ((im == nullptr) || (im->Width() != nx) || (im->Height() != ny) || (im->Depth() != nz) || (im->PixelType() != CImage::UINT_16))
+	{
+		printf("  unexpected image size or type\n");
+		return false;
+	}
+
+	const uint8_t* pb = im->GetBytes();
+	int nerr = 0;
+	for (int k = 0; k < nz; ++k)
+		for (int j = 0; j < ny; ++j)
+			for (int i = 0; i < nx; ++i)
+			{
+				uint16_t v;
+				memcpy(&v, pb + 2 * (((size_t)k * ny + j) * nx + i), 2);
+				if (v != pixelValue(i, j, k)) nerr++;
+			}
+	if (nerr > 0)
+	{
+		printf("  %d voxels differ\n", nerr);
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	int nx = Bench::intArg(argc, argv, 1, 512);
+	int ny = Bench::intArg(argc, argv, 2, 512);
+	int nz = Bench::intArg(argc, argv, 3, 256);
+	int nrep = Bench::intArg(argc, argv, 4, 3);
+	if (nx < 1) nx = 1;
+	if (ny < 1) ny = 1;
+	if (nz < 1) nz = 1;
+	if (nrep < 1) nrep = 1;
+
+	Bench::header("Tiff reader");
+	printf("stack %d x %d x %d, 16-bit, %d rows per strip\n", nx, ny, nz, ROWS_PER_STRIP);
+
+	struct Variant { const char* name; int compression; bool bigTiff; };
+	std::vector<Variant> variants = {
+		{ "uncompressed", COMPRESS_NONE, false },
+		{ "uncompressed, BigTIFF", COMPRESS_NONE, true },
+		{ "PackBits", COMPRESS_PACKBITS, false },
+		{ "PackBits, BigTIFF", COMPRESS_PACKBITS, true },
+#ifdef HAVE_ZLIB
+		{ "Deflate", COMPRESS_DEFLATE, false },
+		{ "Deflate, BigTIFF", COMPRESS_DEFLATE, true },
+#endif
+	};
+
+	std::string file = Bench::tempFile("febio_bench_stack.tif");
+	bool bok = true;
+	for (Variant& v : variants)
+	{
+		if (writeTiff(file, nx, ny, nz, v.compression, v.bigTiff) == false)
+		{
+			printf("Failed writing the test file (%s).\n", v.name);
+			bok = false;
+		}
+		else bok &= readTiff(file, v.name, nx, ny, nz, nrep);
+		remove(file.c_str());
+	}
+
+	return (bok ? 0 : 1);
+}
@@ -0,0 +1,104 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Helpers that are shared by the benchmark drivers.
+namespace Bench {
+
+// wall clock timer
+class Timer
+{
+public:
+	Timer() { start(); }
+
+	void start() { m_start = std::chrono::steady_clock::now(); }
+
+	double seconds() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+	}
+
+private:
+	std::chrono::steady_clock::time_point m_start;
+};
+
+// runs f nrep times and returns the best time (in seconds)
+template <class F> double bestOf(int nrep, F f)
+{
+	double best = 0.0;
+	for (int i = 0; i < nrep; ++i)
+	{
+		Timer t;
+		f();
+		double sec = t.seconds();
+		if ((i == 0) || (sec < best)) best = sec;
+	}
+	return best;
+}
+
+// the value of the n-th command line argument, or def if it was not given
+inline int intArg(int argc, char* argv[], int n, int def)
+{
+	return (argc > n ? atoi(argv[n]) : def);
+}
+
+// a file in the system's temp directory
+inline std::string tempFile(const std::string& name)
+{
+	return (std::filesystem::temp_directory_path() / name).string();
+}
+
+inline int maxThreads()
+{
+#ifdef _OPENMP
+	return omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+// print a timing line: the time and the throughput (items per second)
+inline void report(const char* what, double sec, double items, const char* unit)
+{
+	printf("%-36s %10.3f s %14.4g %s/s\n", what, sec, (sec > 0 ? items / sec : 0.0), unit);
+}
+
+inline void header(const char* title)
+{
+	printf("%s (%d threads)\n", title, maxThreads());
+}
+
+} // namespace Bench
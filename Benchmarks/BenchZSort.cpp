@@ -0,0 +1,107 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+// Benchmark for the depth sort of transparent faces (GLZSorter).
+// Generates the centers of nf faces in a unit cube and sorts them back to front 
+// along a view direction. The sorter is compared with the std::map based sort that 
+// CGLModel used to do every frame, and with std::stable_sort on (depth, index) pairs.
+//
+// usage: BenchZSort [nf = 2000000] [repetitions = 5]
+#include "BenchTools.h"
+#include <GLLib/GLZSort.h>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdint>
+
+int main(int argc, char* argv[])
+{
+	int nf = Bench::intArg(argc, argv, 1, 2000000);
+	int nrep = Bench::intArg(argc, argv, 2, 5);
+	if (nf < 1) nf = 1;
+	if (nrep < 1) nrep = 1;
+
+	Bench::header("Depth sort");
+	printf("%d faces, best of %d\n", nf, nrep);
+
+	// face centers (a simple LCG, so that runs are reproducible)
+	std::vector<float> r(3 * (size_t)nf);
+	uint32_t seed = 12345;
+	for (size_t i = 0; i < r.size(); ++i)
+	{
+		seed = 1664525u * seed + 1013904223u;
+		r[i] = (float)(seed >> 8) / (float)(1 << 24);
+	}
+
+	// view direction
+	const float v[3] = { 0.267261f, 0.534522f, 0.801784f };
+	auto depth = [&](int i) {
+		const float* c = &r[3 * (size_t)i];
+		return c[0] * v[0] + c[1] * v[1] + c[2] * v[2];
+	};
+
+	// std::map, as CGLModel used to do it
+	size_t mapFaces = 0;
+	double tmap = Bench::bestOf(nrep, [&]() {
+		std::map<double, int> zmap;
+		for (int i = 0; i < nf; ++i) zmap[depth(i)] = i;
+		std::vector<int> order; order.reserve(zmap.size());
+		for (auto& it : zmap) order.push_back(it.second);
+		mapFaces = order.size();
+	});
+	Bench::report("std::map", tmap, nf, "faces");
+	if (mapFaces != (size_t)nf) printf("  (std::map dropped %d faces with equal depth)\n", (int)(nf - mapFaces));
+
+	// std::stable_sort
+	std::vector<unsigned int> ref;
+	double tstd = Bench::bestOf(nrep, [&]() {
+		std::vector<std::pair<float, unsigned int> > zi(nf);
+		for (int i = 0; i < nf; ++i) zi[i] = { depth(i), (unsigned int)i };
+		std::stable_sort(zi.begin(), zi.end(), [](const std::pair<float, unsigned int>& a, const std::pair<float, unsigned int>& b) { return a.first < b.first; });
+		ref.resize(nf);
+		for (int i = 0; i < nf; ++i) ref[i] = zi[i].second;
+	});
+	Bench::report("std::stable_sort", tstd, nf, "faces");
+
+	// GLZSorter (the buffers are reused between frames, like in CGLModel)
+	GLZSorter sorter;
+	double tz = Bench::bestOf(nrep, [&]() {
+		sorter.Resize(nf);
+		#pragma omp parallel for
+		for (int i = 0; i < nf; ++i) sorter.SetDepth(i, depth(i));
+		sorter.Sort();
+	});
+	Bench::report("GLZSorter", tz, nf, "faces");
+
+	if (sorter.SortedItems() != ref)
+	{
+		printf("GLZSorter order differs from std::stable_sort\n");
+		return 1;
+	}
+
+	return 0;
+}
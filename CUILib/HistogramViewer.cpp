@@ -28,6 +28,7 @@ SOFTWARE.*/
 #include "HistogramViewer.h"
 #include <ImageLib/ImageModel.h>
 #include <ImageLib/3DImage.h>
+#include <ImageLib/ImageStatistics.h>
 #include <QBoxLayout>
 #include <QCheckBox>
 #include <QSpinBox>
@@ -112,9 +113,20 @@ template<class pType> void GetValues(C3DImage* im, histogram& values)
 		values[i].first = (range * i) / (bins - 1) + min;
 	}
 
-	int nx = im->Width();
-	int ny = im->Height();
-	int nz = im->Depth();
+	// 8- and 16-bit images keep the count of each value in their statistics
+	const CImageStatistics& stats = im->GetStatistics();
+	if (stats.HasValueCounts())
+	{
+		const std::vector<size_t>& counts = stats.ValueCounts();
+		int v0 = stats.LowestValue();
+		for (size_t i = 0; i < counts.size(); ++i)
+		{
+			if (counts[i] == 0) continue;
+			int n = ((v0 + (int)i) - min) / range * (bins - 1);
+			values[n].second += counts[i];
+		}
+		return;
+	}
 
 #pragma omp parallel firstprivate(data)
 	{
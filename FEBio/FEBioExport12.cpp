@@ -1185,8 +1185,7 @@ void FEBioExport12::WriteGeometrySection()
 
 		for (int j = 0; j<pm->Elements(); ++j)
 		{
-			FEElement_& e = pm->ElementRef(j);
-			if (e.m_Qactive) {
+			if (pm->IsElementMaterialAxesActive(j)) {
 				bdata = true;
 				break;
 			}
@@ -1475,7 +1474,7 @@ void FEBioExport12::WriteGeometryElementData()
 			if (pmat) ptiso = dynamic_cast<FSTransverselyIsotropic*>(pmat->GetMaterialProperties());
 
 			elem.set_attribute(nid, e.m_nid);
-			if (e.IsShell() || e.m_Qactive || (ptiso && (ptiso->GetFiberMaterial()->m_naopt == FE_FIBER_USER)))
+			if (e.IsShell() || pm->IsElementMaterialAxesActive(j) || (ptiso && (ptiso->GetFiberMaterial()->m_naopt == FE_FIBER_USER)))
 			{
 				m_xml.add_branch(elem, false);
 				if (e.IsShell()) m_xml.add_leaf("thickness", e.m_h, e.Nodes());
@@ -1483,13 +1482,13 @@ void FEBioExport12::WriteGeometryElementData()
 				// export fiber direction, otherwise export local material orientation
 				if (ptiso) 
 				{
-					vec3d a = T.LocalToGlobalNormal(e.m_fiber);
+					vec3d a = T.LocalToGlobalNormal(pm->ElementFiber(j));
 					m_xml.add_leaf("fiber", a);
 				}
-				else if (e.m_Qactive)
+				else if (pm->IsElementMaterialAxesActive(j))
 				{
-					// e.m_Q is in local coordinates, so transform it to global coordinates
-					mat3d& Q = e.m_Q;
+					// the material axes are in local coordinates, so transform them to global coordinates
+					mat3d Q = pm->ElementMaterialAxes(j);
 					vec3d a(Q[0][0], Q[1][0], Q[2][0]);
 					vec3d d(Q[0][1], Q[1][1], Q[2][1]);
 					a = T.LocalToGlobalNormal(a);
@@ -386,8 +386,7 @@ bool FEBioExport25::PrepareExport(FSProject& prj)
 		FSMesh* pm = model.Object(i)->GetFEMesh();
 		for (int j=0; j<pm->Elements(); ++j)
 		{
-			FEElement_& e = pm->ElementRef(j);
-			if (e.m_Qactive) {
+			if (pm->IsElementMaterialAxesActive(j)) {
 				m_bdata = true;
 				break;
 			}
@@ -3051,8 +3050,7 @@ void FEBioExport25::WriteMeshDataMaterialFibers()
 				int nid = el.add_attribute("lid", 0);
 				for (int j=0; j<NE; ++j)
 				{
-					FEElement_& e = pm->ElementRef(elSet.elem[j]);
-					vec3d a = T.LocalToGlobalNormal(e.m_fiber);
+					vec3d a = T.LocalToGlobalNormal(pm->ElementFiber(elSet.elem[j]));
 					el.set_attribute(nid, j+1);
 					el.value(a);
 					m_xml.add_leaf(el, false);
@@ -3080,8 +3078,7 @@ void FEBioExport25::WriteMeshDataMaterialAxes()
 		int NE = (int) elSet.elem.size();
 		for (int j=0; j<NE; ++j)
 		{
-			FEElement_& el = pm->ElementRef(elSet.elem[j]);
-			if (el.m_Qactive) { bwrite = true; break; }
+			if (pm->IsElementMaterialAxesActive(elSet.elem[j])) { bwrite = true; break; }
 		}
 
 		// okay, let's get to work
@@ -3098,11 +3095,11 @@ void FEBioExport25::WriteMeshDataMaterialAxes()
 
 				for (int j=0; j<NE; ++j)
 				{
-					FEElement_& e = pm->ElementRef(elSet.elem[j]);
-					if (e.m_Qactive)
+					int eid = elSet.elem[j];
+					if (pm->IsElementMaterialAxesActive(eid))
 					{
-						// e.m_Q is in local coordinates, so transform it to global coordinates
-						mat3d& Q = e.m_Q;
+						// the material axes are in local coordinates, so transform them to global coordinates
+						mat3d Q = pm->ElementMaterialAxes(eid);
 						vec3d a(Q[0][0], Q[1][0], Q[2][0]);
 						vec3d d(Q[0][1], Q[1][1], Q[2][1]);
 						a = T.LocalToGlobalNormal(a);
@@ -393,8 +393,7 @@ bool FEBioExport4::PrepareExport(FSProject& prj)
 		FSMesh* pm = model.Object(i)->GetFEMesh();
 		for (int j = 0; j < pm->Elements(); ++j)
 		{
-			FEElement_& e = pm->ElementRef(j);
-			if (e.m_Qactive) {
+			if (pm->IsElementMaterialAxesActive(j)) {
 				m_bdata = true;
 				break;
 			}
@@ -2493,10 +2492,10 @@ void FEBioExport4::WriteMeshDataMaterialFibers()
 				int nid = el.add_attribute("lid", 0);
 				for (int j = 0; j < NE; ++j)
 				{
-					FEElement_& e = pm->ElementRef(elSet.m_elem[j]);
-					if (e.CanExport())
+					int eid = elSet.m_elem[j];
+					if (pm->ElementRef(eid).CanExport())
 					{
-						vec3d a = T.LocalToGlobalNormal(e.m_fiber);
+						vec3d a = T.LocalToGlobalNormal(pm->ElementFiber(eid));
 						el.set_attribute(nid, j + 1);
 						el.value(a);
 						m_xml.add_leaf(el, false);
@@ -2525,8 +2524,8 @@ void FEBioExport4::WriteMeshDataMaterialAxes()
 		int NE = (int)elSet.m_elem.size();
 		for (int j = 0; j < NE; ++j)
 		{
-			FEElement_& el = pm->ElementRef(elSet.m_elem[j]);
-			if (el.m_Qactive && el.CanExport()) { bwrite = true; break; }
+			int eid = elSet.m_elem[j];
+			if (pm->IsElementMaterialAxesActive(eid) && pm->ElementRef(eid).CanExport()) { bwrite = true; break; }
 		}
 
 		// okay, let's get to work
@@ -2543,11 +2542,11 @@ void FEBioExport4::WriteMeshDataMaterialAxes()
 
 				for (int j = 0; j < NE; ++j)
 				{
-					FEElement_& e = pm->ElementRef(elSet.m_elem[j]);
-					if (e.m_Qactive && e.CanExport())
+					int eid = elSet.m_elem[j];
+					if (pm->IsElementMaterialAxesActive(eid) && pm->ElementRef(eid).CanExport())
 					{
-						// e.m_Q is in local coordinates, so transform it to global coordinates
-						mat3d& Q = e.m_Q;
+						// the material axes are in local coordinates, so transform them to global coordinates
+						mat3d Q = pm->ElementMaterialAxes(eid);
 						vec3d a(Q[0][0], Q[1][0], Q[2][0]);
 						vec3d d(Q[0][1], Q[1][1], Q[2][1]);
 						a = T.LocalToGlobalNormal(a);
@@ -740,11 +740,11 @@ bool FEBioFormat25::ParseMeshDataSection(XMLTag& tag)
 			// TODO: Not sure if this is always true! Looks like some 
 			// data is read into the actual mesh. The test for Qactive
 			// is a hack! Need to figure this out! 
-			if (e1.m_Qactive)
+			if (psrc->IsElementMaterialAxesActive(j))
 			{
-				e0.m_Q = e1.m_Q;
-				e0.m_Qactive = e1.m_Qactive;
-				e0.m_fiber = e1.m_fiber;
+				pdst->SetElementMaterialAxes(j, psrc->ElementMaterialAxes(j));
+				pdst->SetElementMaterialAxesActive(j, psrc->IsElementMaterialAxesActive(j));
+				pdst->SetElementFiber(j, psrc->ElementFiber(j));
 			}
 		}
 	}
@@ -840,7 +840,6 @@ bool FEBioFormat25::ParseElementData(XMLTag& tag)
 				if (lid >= 0)
 				{
 					int id = dom->ElementID(lid);
-					FSElement& el = mesh->Element(id);
 					tag.value(a);
 					a.Normalize();
 					// set up a orthonormal coordinate system
@@ -851,10 +850,10 @@ bool FEBioFormat25::ParseElementData(XMLTag& tag)
 					// make sure they are unit vectors
 					b.Normalize();
 					c.Normalize();
-					el.m_Q = mat3d(a.x, b.x, c.x,
+					mesh->SetElementMaterialAxes(id, mat3d(a.x, b.x, c.x,
 						a.y, b.y, c.y,
-						a.z, b.z, c.z);
-					el.m_fiber = a;
+						a.z, b.z, c.z));
+					mesh->SetElementFiber(id, a);
 				}
 				++tag;
 			} while (!tag.isend());
@@ -878,8 +877,6 @@ bool FEBioFormat25::ParseElementData(XMLTag& tag)
 				if (lid >= 0)
 				{
 					int id = dom->ElementID(lid);
-					FSElement& el = mesh->Element(id);
-
 					vec3d a, d;
 					++tag;
 					do
@@ -888,7 +885,7 @@ bool FEBioFormat25::ParseElementData(XMLTag& tag)
 						else if (tag == "d") tag.value(d);
 						++tag;
 					} while (!tag.isend());
-					el.setAxes(a, d);
+					mesh->SetElementMaterialAxes(id, a, d);
 				}
 				++tag;
 			} while (!tag.isend());
@@ -909,7 +906,6 @@ bool FEBioFormat25::ParseElementData(XMLTag& tag)
 					if ((lid >= 0) && (it != items.end()))
 					{
 						int id = *it; // looks like this is already zero-based
-						FSElement& el = mesh->Element(id);
 						vec3d a, d;
 						++tag;
 						do
@@ -918,7 +914,7 @@ bool FEBioFormat25::ParseElementData(XMLTag& tag)
 							else if (tag == "d") tag.value(d);
 							++tag;
 						} while (!tag.isend());
-						el.setAxes(a, d);
+						mesh->SetElementMaterialAxes(id, a, d);
 					}
 					++it;
 					++tag;
@@ -1253,9 +1253,7 @@ bool FEBioFormat3::ParseMeshDataSection(XMLTag& tag)
 			{
 				e0.m_h[k] = e1.m_h[k];
 			}
-            e0.m_Q = e1.m_Q;
-            e0.m_Qactive = e1.m_Qactive;
-            e0.m_fiber = e1.m_fiber;
+            pdst->CopyElementAttributes(j, *psrc, j);
 		}
 	}
 
@@ -1461,7 +1459,6 @@ bool FEBioFormat3::ParseElementDataSection(XMLTag& tag)
 				if (lid >= 0)
 				{
 					int id = dom->ElementID(lid);
-					FSElement& el = mesh->Element(id);
 					tag.value(a);
 					a.Normalize();
 					// set up a orthonormal coordinate system
@@ -1472,10 +1469,10 @@ bool FEBioFormat3::ParseElementDataSection(XMLTag& tag)
 					// make sure they are unit vectors
 					b.Normalize();
 					c.Normalize();
-					el.m_Q = mat3d(a.x, b.x, c.x,
+					mesh->SetElementMaterialAxes(id, mat3d(a.x, b.x, c.x,
 						a.y, b.y, c.y,
-						a.z, b.z, c.z);
-					el.m_fiber = a;
+						a.z, b.z, c.z));
+					mesh->SetElementFiber(id, a);
 				}
 				++tag;
 			} while (!tag.isend());
@@ -1500,8 +1497,6 @@ bool FEBioFormat3::ParseElementDataSection(XMLTag& tag)
 				if (lid >= 0)
 				{
 					int id = dom->ElementID(lid);
-					FSElement& el = mesh->Element(id);
-
 					++tag;
 					do
 					{
@@ -1512,10 +1507,10 @@ bool FEBioFormat3::ParseElementDataSection(XMLTag& tag)
 					a.Normalize();
 					c = a ^ d; c.Normalize();
 					b = c ^ a; b.Normalize();
-					el.m_Q = mat3d(a.x, b.x, c.x,
+					mesh->SetElementMaterialAxes(id, mat3d(a.x, b.x, c.x,
 						a.y, b.y, c.y,
-						a.z, b.z, c.z);
-					el.m_Qactive = true;
+						a.z, b.z, c.z));
+					mesh->SetElementMaterialAxesActive(id, true);
 				}
 				++tag;
 			} while (!tag.isend());
@@ -243,8 +243,6 @@ bool FEBioFormatOld::ParseGeometrySection(XMLTag& tag)
 					{
 						if (tag == "fiber")
 						{
-							FSElement& el = pm->Element(id);
-
 							vec3d a;
 
 							// read the fiber direction
@@ -264,18 +262,17 @@ bool FEBioFormatOld::ParseGeometrySection(XMLTag& tag)
 							c.Normalize();
 
 							// assign to element
-							mat3d& m = el.m_Q;
+							mat3d m;
 							m.zero();
 							m[0][0] = a.x; m[0][1] = b.x; m[0][2] = c.x;
 							m[1][0] = a.y; m[1][1] = b.y; m[1][2] = c.y;
 							m[2][0] = a.z; m[2][1] = b.z; m[2][2] = c.z;
 
-							el.m_fiber = a;
+							pm->SetElementMaterialAxes(id, m);
+							pm->SetElementFiber(id, a);
 						}
 						else if (tag == "mat_axis")
 						{
-							FSElement& el = pm->Element(id);
-
 							vec3d a, d;
 
 							++tag;
@@ -297,13 +294,14 @@ bool FEBioFormatOld::ParseGeometrySection(XMLTag& tag)
 							c.Normalize();
 
 							// assign to element
-							mat3d& m = el.m_Q;
+							mat3d m;
 							m.zero();
 							m[0][0] = a.x; m[0][1] = b.x; m[0][2] = c.x;
 							m[1][0] = a.y; m[1][1] = b.y; m[1][2] = c.y;
 							m[2][0] = a.z; m[2][1] = b.z; m[2][2] = c.z;
 
-							el.m_Qactive = true;
+							pm->SetElementMaterialAxes(id, m);
+							pm->SetElementMaterialAxesActive(id, true);
 						}
 						else if (tag == "thickness")
 						{
@@ -315,7 +313,7 @@ bool FEBioFormatOld::ParseGeometrySection(XMLTag& tag)
 						{
 							FSElement& el = pm->Element(id);
 							if (!el.IsBeam()) return false;
-							tag.value(el.m_a0);
+							{ double a0 = 0.0; tag.value(a0); pm->SetElementCrossSectionArea(id, a0); }
 						}
 						else ParseUnknownTag(tag);
 
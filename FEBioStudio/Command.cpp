@@ -61,6 +61,11 @@ VIEW_STATE CCommand::GetViewState()
 	return m_state; 
 }
 
+size_t CCommand::GetMemorySize() const
+{
+	return sizeof(CCommand);
+}
+
 //=============================================================================
 
 CCmdGroup::CCmdGroup() : CCommand("Group") {}
@@ -91,3 +96,10 @@ void CCmdGroup::SetViewState(VIEW_STATE state)
 	CCommand::SetViewState(state);
 	for (int i = 0; i < m_Cmd.size(); i++) m_Cmd[i]->SetViewState(state);
 }
+
+size_t CCmdGroup::GetMemorySize() const
+{
+	size_t size = CCommand::GetMemorySize();
+	for (int i = 0; i < m_Cmd.size(); i++) size += m_Cmd[i]->GetMemorySize();
+	return size;
+}
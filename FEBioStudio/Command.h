@@ -81,6 +81,10 @@ public:
 	virtual void SetViewState(VIEW_STATE state);
 	VIEW_STATE GetViewState();
 
+	// approximate memory (in bytes) held by this command for undo/redo.
+	// Used by the command manager to limit the size of the undo stack.
+	virtual size_t GetMemorySize() const;
+
 protected:
 	// doc/view state variables
 	VIEW_STATE	m_state;
@@ -113,6 +117,8 @@ public:
 
 	void SetViewState(VIEW_STATE state) override;
 
+	size_t GetMemorySize() const override;
+
 protected:
 	CCmdPtrArray	m_Cmd;	// array of pointer to commands
 };
@@ -44,11 +44,11 @@ CBasicCmdManager::~CBasicCmdManager()
 void CBasicCmdManager::AddCommand(CCommand* pcmd)
 {
 	// push the command
-	m_Undo.push(pcmd);
+	m_Undo.push_back(pcmd);
 
 	// clear the redo stack
 	int N = (int)m_Redo.size();
-	for (int i = 0; i<N; i++) { delete m_Redo.top(); m_Redo.pop(); }
+	for (int i = 0; i<N; i++) { delete m_Redo.back(); m_Redo.pop_back(); }
 }
 
 bool CBasicCmdManager::DoCommand(CCommand* pcmd)
@@ -78,11 +78,11 @@ bool CBasicCmdManager::DoCommand(CCommand* pcmd)
 	}
 
 	// add it to the undo stack
-	m_Undo.push(pcmd);
+	m_Undo.push_back(pcmd);
 
 	// clear the redo stack
 	int N = (int)m_Redo.size();
-	for (int i = 0; i<N; i++) { delete m_Redo.top(); m_Redo.pop(); }
+	for (int i = 0; i<N; i++) { delete m_Redo.back(); m_Redo.pop_back(); }
 
 	return true;
 }
@@ -92,13 +92,13 @@ void CBasicCmdManager::UndoCommand()
 	if (m_Undo.empty() == false)
 	{
 		// pop the command from the undo stack
-		CCommand* pcmd = m_Undo.top(); m_Undo.pop();
+		CCommand* pcmd = m_Undo.back(); m_Undo.pop_back();
 
 		// unexecute it
 		pcmd->UnExecute();
 
 		// push it on the redo stack
-		m_Redo.push(pcmd);
+		m_Redo.push_back(pcmd);
 	}
 }
 
@@ -107,13 +107,13 @@ void CBasicCmdManager::RedoCommand()
 	if (m_Redo.empty() == false)
 	{
 		// pop the command from the redo stack
-		CCommand* pcmd = m_Redo.top(); m_Redo.pop();
+		CCommand* pcmd = m_Redo.back(); m_Redo.pop_back();
 
 		// execute it
 		pcmd->Execute();
 
 		// push it on the undo stack
-		m_Undo.push(pcmd);
+		m_Undo.push_back(pcmd);
 	}
 }
 
@@ -121,23 +121,29 @@ void CBasicCmdManager::Clear()
 {
 	// clear undo stack
 	int N = (int)m_Undo.size();
-	for (int i = 0; i<N; i++) { delete m_Undo.top(); m_Undo.pop(); }
+	for (int i = 0; i<N; i++) { delete m_Undo.back(); m_Undo.pop_back(); }
 
 	// clear redo stack
 	N = (int)m_Redo.size();
-	for (int i = 0; i<N; i++) { delete m_Redo.top(); m_Redo.pop(); }
+	for (int i = 0; i<N; i++) { delete m_Redo.back(); m_Redo.pop_back(); }
 }
 
-const char* CBasicCmdManager::GetUndoCmdName() { return (m_Undo.size() ? m_Undo.top()->GetName() : 0); }
-const char* CBasicCmdManager::GetRedoCmdName() { return (m_Redo.size() ? m_Redo.top()->GetName() : 0); }
+const char* CBasicCmdManager::GetUndoCmdName() { return (m_Undo.size() ? m_Undo.back()->GetName() : 0); }
+const char* CBasicCmdManager::GetRedoCmdName() { return (m_Redo.size() ? m_Redo.back()->GetName() : 0); }
 
 //////////////////////////////////////////////////////////////////////
 // CCommandManager
 //////////////////////////////////////////////////////////////////////
 
+size_t CCommandManager::m_memBudget = 0;
+
+void CCommandManager::SetMemoryBudget(size_t bytes) { m_memBudget = bytes; }
+size_t CCommandManager::GetMemoryBudget() { return m_memBudget; }
+
 CCommandManager::CCommandManager(CUndoDocument* pdoc)
 {
 	m_pDoc = pdoc;
+	m_discarded = 0;
 }
 
 CCommandManager::~CCommandManager()
@@ -154,6 +160,8 @@ void CCommandManager::AddCommand(CCommand* pcmd)
     }
 	
 	CBasicCmdManager::AddCommand(pcmd);
+
+	EnforceMemoryBudget();
 }
 
 bool CCommandManager::DoCommand(CCommand* pcmd)
@@ -165,6 +173,7 @@ bool CCommandManager::DoCommand(CCommand* pcmd)
     }
 
 	m_err.clear();
+	m_discarded = 0;
 
 	// execute the command
 	try
@@ -201,11 +210,13 @@ bool CCommandManager::DoCommand(CCommand* pcmd)
 	}
 		
 	// add it to the undo stack
-	m_Undo.push(pcmd);
+	m_Undo.push_back(pcmd);
 
 	// clear the redo stack
 	int N = (int)m_Redo.size();
-	for (int i=0; i<N; i++) { delete m_Redo.top(); m_Redo.pop(); }
+	for (int i=0; i<N; i++) { delete m_Redo.back(); m_Redo.pop_back(); }
+
+	EnforceMemoryBudget();
 
 	return true;
 }
@@ -213,7 +224,7 @@ bool CCommandManager::DoCommand(CCommand* pcmd)
 void CCommandManager::UndoCommand()
 {
 	// pop the command from the undo stack
-	CCommand* pcmd = m_Undo.top(); m_Undo.pop();
+	CCommand* pcmd = m_Undo.back(); m_Undo.pop_back();
 
 	// reset the view state
     CGLDocument* glDoc = dynamic_cast<CGLDocument*>(m_pDoc);
@@ -226,13 +237,13 @@ void CCommandManager::UndoCommand()
 	pcmd->UnExecute();
 
 	// push it on the redo stack
-	m_Redo.push(pcmd);
+	m_Redo.push_back(pcmd);
 }
 
 void CCommandManager::RedoCommand()
 {
 	// pop the command from the redo stack
-	CCommand* pcmd = m_Redo.top(); m_Redo.pop();
+	CCommand* pcmd = m_Redo.back(); m_Redo.pop_back();
 
 	// reset the view state
 	CGLDocument* glDoc = dynamic_cast<CGLDocument*>(m_pDoc);
@@ -245,5 +256,24 @@ void CCommandManager::RedoCommand()
 	pcmd->Execute();
 
 	// push it on the undo stack
-	m_Undo.push(pcmd);
+	m_Undo.push_back(pcmd);
+}
+
+void CCommandManager::EnforceMemoryBudget()
+{
+	m_discarded = 0;
+	if (m_memBudget == 0) return;
+
+	size_t total = 0;
+	for (CCommand* pcmd : m_Undo) total += pcmd->GetMemorySize();
+	for (CCommand* pcmd : m_Redo) total += pcmd->GetMemorySize();
+
+	// discard the oldest commands, but always keep the last one so it can be undone
+	while ((total > m_memBudget) && (m_Undo.size() > 1))
+	{
+		CCommand* pcmd = m_Undo.front(); m_Undo.pop_front();
+		total -= pcmd->GetMemorySize();
+		delete pcmd;
+		m_discarded++;
+	}
 }
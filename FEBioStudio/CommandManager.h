@@ -25,13 +25,15 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.*/
 
 #pragma once
-#include <stack>
+#include <deque>
 #include <string>
 
 class CCommand;
 class CUndoDocument;
 
-typedef std::stack<CCommand*> CCmdStack;
+// The back of the stack is the most recent command. A deque is used so that
+// the oldest commands can be removed when the undo stack grows too large.
+typedef std::deque<CCommand*> CCmdStack;
 
 class CBasicCmdManager
 {
@@ -79,6 +81,25 @@ public:
 
 	void RedoCommand() override;
 
+public:
+	// Set the maximum memory (in bytes) that the undo/redo stacks may use.
+	// When exceeded, the oldest undo commands are discarded. Zero (the default) 
+	// means no limit.
+	static void SetMemoryBudget(size_t bytes);
+	static size_t GetMemoryBudget();
+
+	// The number of undo commands that were discarded by the last command that 
+	// was added, because the memory budget was exceeded.
+	int DiscardedCommands() const { return m_discarded; }
+
+protected:
+	// remove the oldest undo commands until the memory budget is met
+	void EnforceMemoryBudget();
+
 protected:
 	CUndoDocument* m_pDoc; // pointer to the current document
+
+	int		m_discarded;	// commands discarded by EnforceMemoryBudget
+
+	static size_t	m_memBudget;
 };
@@ -2135,6 +2135,11 @@ void CCmdDeleteFESelection::UnExecute()
 	FSMesh* pm = m_pnew; m_pnew = m_pold; m_pold = pm;
 }
 
+size_t CCmdDeleteFESelection::GetMemorySize() const
+{
+	return sizeof(CCmdDeleteFESelection) + (m_pnew ? MeshMemorySize(*m_pnew) : 0);
+}
+
 //=============================================================================
 // CCmdDeleteFESurfaceSelection
 //-----------------------------------------------------------------------------
@@ -2706,9 +2711,26 @@ void CCmdUnhideAll::UnExecute()
 // CCmdApplyFEModifier
 //-----------------------------------------------------------------------------
 
+// Set the node positions of the object's mesh from a delta and update the object.
+// The mesh itself is not replaced, so other commands that refer to it remain valid.
+static void applyNodeDelta(GObject* po, const FSNodePositionDelta& delta, bool undo, bool bup = false)
+{
+	FSMesh* pm = po->GetFEMesh();
+	assert(pm);
+	if (pm == nullptr) return;
+
+	delta.Apply(*pm, undo);
+	pm->UpdateBoundingBox();
+	pm->UpdateNormals();
+
+	// this rebuilds the render mesh and updates the geometry
+	po->ReplaceFEMesh(pm, bup);
+}
+
 CCmdApplyFEModifier::CCmdApplyFEModifier(FEModifier* pmod, GObject* po, FSGroup* selection) : CCommand(pmod->GetName())
 {
 	m_pnew = 0;
+	m_bdelta = false;
 
 	m_pobj = po;
 	m_psel = selection;
@@ -2722,6 +2744,12 @@ CCmdApplyFEModifier::CCmdApplyFEModifier(FEModifier* pmod, GObject* po, FSGroup*
 
 void CCmdApplyFEModifier::Execute()
 {
+	if (m_bdelta)
+	{
+		applyNodeDelta(m_pobj, m_delta, false);
+		return;
+	}
+
 	if (m_pnew == 0)
 	{
 		// create a new mesh
@@ -2735,6 +2763,16 @@ void CCmdApplyFEModifier::Execute()
 
 		// make sure the new mesh is selected
 		if (m_pobj) m_pobj->Select();
+
+		// If the modifier only moved nodes (e.g. smoothing), we keep the current mesh
+		// and only store the node positions that changed.
+		if (m_pold && (m_pnew != m_pold) && m_delta.Build(*m_pold, *m_pnew))
+		{
+			delete m_pnew; m_pnew = nullptr;
+			m_bdelta = true;
+			applyNodeDelta(m_pobj, m_delta, false);
+			return;
+		}
 	}
 
 	if (m_pnew)
@@ -2762,6 +2800,12 @@ void CCmdApplyFEModifier::Execute()
 
 void CCmdApplyFEModifier::UnExecute()
 {
+	if (m_bdelta)
+	{
+		applyNodeDelta(m_pobj, m_delta, true);
+		return;
+	}
+
 	// get the FSModel
 	if (m_pnew)
 	{
@@ -2774,6 +2818,10 @@ void CCmdApplyFEModifier::UnExecute()
 	}
 }
 
+size_t CCmdApplyFEModifier::GetMemorySize() const
+{
+	return sizeof(CCmdApplyFEModifier) + m_delta.MemorySize() + (m_pnew ? MeshMemorySize(*m_pnew) : 0);
+}
 
 //=============================================================================
 // CCmdApplySurfaceModifier
@@ -2864,11 +2912,34 @@ CCmdChangeFEMesh::CCmdChangeFEMesh(GObject* po, FSMesh* pm, bool bup) : CCommand
 	m_update = bup;
 	m_po = po;
 	m_pnew = pm;
+	m_bdelta = false;
+	m_bfirst = true;
 }
 
 void CCmdChangeFEMesh::Execute()
 {
+	if (m_bdelta)
+	{
+		applyNodeDelta(m_po, m_delta, false, m_update);
+		return;
+	}
+
 	FSMesh* pm = m_po->GetFEMesh();
+
+	// If the new mesh only differs in its node positions, we keep the current mesh
+	// and only store the node positions that changed.
+	if (m_bfirst)
+	{
+		m_bfirst = false;
+		if (pm && m_pnew && m_delta.Build(*pm, *m_pnew))
+		{
+			delete m_pnew; m_pnew = nullptr;
+			m_bdelta = true;
+			applyNodeDelta(m_po, m_delta, false, m_update);
+			return;
+		}
+	}
+
 	m_po->ReplaceFEMesh(m_pnew, m_update);
 
 	m_pnew = pm;
@@ -2876,9 +2947,20 @@ void CCmdChangeFEMesh::Execute()
 
 void CCmdChangeFEMesh::UnExecute()
 {
+	if (m_bdelta)
+	{
+		applyNodeDelta(m_po, m_delta, true, m_update);
+		return;
+	}
+
 	Execute();
 }
 
+size_t CCmdChangeFEMesh::GetMemorySize() const
+{
+	return sizeof(CCmdChangeFEMesh) + m_delta.MemorySize() + (m_pnew ? MeshMemorySize(*m_pnew) : 0);
+}
+
 
 CCmdChangeFENodes::CCmdChangeFENodes(GObject* po, const std::vector<vec3d>& newPos) : CCommand("Change mesh")
 {
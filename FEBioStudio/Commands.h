@@ -42,6 +42,7 @@ SOFTWARE.*/
 #include <MeshTools/FESurfaceModifier.h>
 #include <GeomLib/GSurfaceMeshObject.h>
 #include <GLLib/GLCamera.h>
+#include <MeshLib/FEMeshDelta.h>
 
 class ObjectMeshList;
 class MeshLayer;
@@ -909,6 +910,8 @@ public:
 	void Execute();
 	void UnExecute();
 
+	size_t GetMemorySize() const override;
+
 protected:
 	GMeshObject*	m_pobj;
 	FSMesh*			m_pold;
@@ -1073,12 +1076,17 @@ public:
 	void Execute();
 	void UnExecute();
 
+	size_t GetMemorySize() const override;
+
 protected:
 	GObject*		m_pobj;
 	FSMesh*			m_pold;	// old, unmodified mesh
 	FSMesh*			m_pnew;	// new, modified mesh
 	FEModifier*		m_pmod;
 	FSGroup*		m_psel;
+
+	FSNodePositionDelta	m_delta;	// used instead of m_pnew when the modifier only moved nodes
+	bool				m_bdelta;
 };
 
 //-----------------------------------------------------------------------------
@@ -1111,10 +1119,16 @@ public:
 	void Execute();
 	void UnExecute();
 
+	size_t GetMemorySize() const override;
+
 protected:
 	bool		m_update;
 	GObject*	m_po;
 	FSMesh*		m_pnew;
+
+	FSNodePositionDelta	m_delta;	// used instead of m_pnew when only the nodes moved
+	bool				m_bdelta;
+	bool				m_bfirst;
 };
 
 class CCmdChangeFENodes : public CCommand
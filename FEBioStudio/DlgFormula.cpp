@@ -34,7 +34,7 @@ SOFTWARE.*/
 #include <QValidator>
 #include <QMessageBox>
 #include <QCheckBox>
-#include <FECore/MathObject.h>
+#include <FSCore/MathKernel.h>
 
 CDlgFormula::CDlgFormula(QWidget* parent) : QDialog(parent)
 {
@@ -138,8 +138,8 @@ std::vector<vec2d> CDlgFormula::GetPoints()
 	int samples = GetSamples();
 
 	std::vector<vec2d> pts;
-	MSimpleExpression m;
-	MVariable* tvar = m.AddVariable("t");
+	MathKernel m;
+	m.AddVariable("t");
 	bool b = m.Create(smath);
 	if (b == false)
 	{
@@ -147,13 +147,10 @@ std::vector<vec2d> CDlgFormula::GetPoints()
 	}
 	else
 	{
-		for (int i = 0; i < samples; ++i)
-		{
-			double x = fmin + i * (fmax - fmin) / (samples - 1);
-			tvar->value(x);
-			double y = m.value();
-			pts.push_back(vec2d(x, y));
-		}
+		std::vector<double> t(samples), y;
+		for (int i = 0; i < samples; ++i) t[i] = fmin + i * (fmax - fmin) / (samples - 1);
+		m.value(samples, t, y);
+		for (int i = 0; i < samples; ++i) pts.push_back(vec2d(t[i], y[i]));
 	}
 
 	return pts;
@@ -418,6 +418,7 @@ void CUndoDocument::AddCommand(CCommand* pcmd)
 	UpdateSelection();
 	CMainWindow* wnd = GetMainWindow();
 	wnd->AddLogEntry(QString("Executing command: %1\n").arg(pcmd->GetName()));
+	ReportDiscardedCommands();
 }
 
 //-----------------------------------------------------------------------------
@@ -432,6 +433,7 @@ void CUndoDocument::AddCommand(CCommand* pcmd, const std::string& s)
 		wnd->AddLogEntry(QString("Executing command: %1 (%2)\n").arg(pcmd->GetName()).arg(QString::fromStdString(s)));
 	}
 	else wnd->AddLogEntry(QString("Executing command: %1\n").arg(pcmd->GetName()));
+	ReportDiscardedCommands();
 }
 
 //-----------------------------------------------------------------------------
@@ -447,6 +449,7 @@ bool CUndoDocument::DoCommand(CCommand* pcmd, bool b)
 	bool ret = m_pCmd->DoCommand(pcmd);
 	SetModifiedFlag();
 	if (b) UpdateSelection();
+	ReportDiscardedCommands();
 	return ret;
 }
 
@@ -463,9 +466,21 @@ bool CUndoDocument::DoCommand(CCommand* pcmd, const std::string& s, bool b)
 	bool ret = m_pCmd->DoCommand(pcmd);
 	SetModifiedFlag();
 	UpdateSelection(b);
+	ReportDiscardedCommands();
 	return ret;
 }
 
+//-----------------------------------------------------------------------------
+void CUndoDocument::ReportDiscardedCommands()
+{
+	int n = m_pCmd->DiscardedCommands();
+	if (n > 0)
+	{
+		CMainWindow* wnd = GetMainWindow();
+		wnd->AddLogEntry(QString("Undo memory limit reached: the %1 oldest undo step(s) were discarded.\n").arg(n));
+	}
+}
+
 //-----------------------------------------------------------------------------
 const std::string& CUndoDocument::GetCommandErrorString() const
 {
@@ -263,6 +263,10 @@ public:
 
     virtual void UpdateSelection(bool breport = true);
 
+protected:
+	// tell the user when undo commands were discarded to stay within the undo memory budget
+	void ReportDiscardedCommands();
+
 signals:
 	void doCommand(QString s);
 
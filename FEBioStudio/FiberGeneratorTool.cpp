@@ -438,7 +438,7 @@ void CFiberGeneratorTool::OnApply()
 				FSElement& el = pm->Element(i);
 				if (el.m_ntag == 1)
 				{
-					el.m_fiber = grad[i];
+					pm->SetElementFiber(i, grad[i]);
 				}
 			}
 		}
@@ -470,12 +470,13 @@ void CFiberGeneratorTool::OnApply()
 				vec3d a3 = a1 ^ a2;
 
 				// setup rotation matrix
-				mat3d& Q = el.m_Q;
+				mat3d Q;
 				Q[0][0] = a1.x; Q[0][1] = a2.x; Q[0][2] = a3.x;
 				Q[1][0] = a1.y; Q[1][1] = a2.y; Q[1][2] = a3.y;
 				Q[2][0] = a1.z; Q[2][1] = a2.z; Q[2][2] = a3.z;
 
-				el.m_Qactive = true;
+				pm->SetElementMaterialAxes(i, Q);
+				pm->SetElementMaterialAxesActive(i, true);
 			}
 		}
 	}
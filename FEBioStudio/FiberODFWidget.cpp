@@ -952,11 +952,17 @@ void CFiberODFWidget::on_copyEFD_triggered()
     auto it = elemList->First();
 
     std::vector<FEElement_*> elems;
+    std::vector<int> elemIDs;
     for(int i = 0; i < NE; ++i, ++it)
     {
         elems.push_back(it->m_pi);
+        elemIDs.push_back(it->m_lid);
     }
 
+    // the material axes are stored in the mesh, which is not safe to grow
+    // from several threads, so we collect them here and set them afterwards.
+    std::vector<mat3d> axes(NE);
+
     #pragma omp parallel for
     for (int i = 0; i < NE; ++i)
     {
@@ -1021,8 +1027,13 @@ void CFiberODFWidget::on_copyEFD_triggered()
         pdata->set(i*3+2, eVal[2]);
 
         // Set mat axis
-        el->m_Q = mat3d(eVec[0], eVec[1], eVec[2]);
-        el->m_Qactive = true;
+        axes[i] = mat3d(eVec[0], eVec[1], eVec[2]);
+    }
+
+    for (int i = 0; i < NE; ++i)
+    {
+        mesh->SetElementMaterialAxes(elemIDs[i], axes[i]);
+        mesh->SetElementMaterialAxesActive(elemIDs[i], true);
     }
     delete elemList;
 
@@ -1465,13 +1465,13 @@ void CGLModelScene::RenderLocalMaterialAxes(CGLContext& rc)
 						if (pgm) pmat = pgm->GetMaterialProperties();
 
 						rel.m_nelem = j;
-						if (el.m_Qactive)
+						if (pm->IsElementMaterialAxesActive(j))
 						{
 							vec3d c(0, 0, 0);
 							for (int k = 0; k < el.Nodes(); ++k) c += pm->NodePosition(el.m_node[k]);
 							c /= el.Nodes();
 
-							mat3d Q = el.m_Q;
+							mat3d Q = pm->ElementMaterialAxes(j);
 							vec3d q;
 							for (int k = 0; k < 3; ++k) {
 								q = vec3d(Q[0][k], Q[1][k], Q[2][k]);
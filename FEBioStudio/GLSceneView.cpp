@@ -220,6 +220,9 @@ void CGLSceneView::RenderScene()
 		rc.m_settings = GetViewSettings();
 		rc.m_view = nullptr;
 		scene->Render(rc);
+
+		// some renderers draw a draft first and refine it on the next frame
+		if (rc.m_redraw) QTimer::singleShot(0, this, SLOT(repaint()));
 	}
 }
 
@@ -50,6 +50,7 @@ SOFTWARE.*/
 #include <GLLib/GLContext.h>
 #include <QMenu>
 #include <QMessageBox>
+#include <QTimer>
 #include <PostGL/GLPlaneCutPlot.h>
 #include "Commands.h"
 #include <chrono>
@@ -1375,6 +1376,7 @@ void CGLView::RenderScene()
 	rc.m_view = this;
 	rc.m_cam = &cam;
 	rc.m_settings = view;
+	rc.m_redraw = false;
 
 	if (scene)
 	{
@@ -1385,6 +1387,9 @@ void CGLView::RenderScene()
 		m_fps = (sec != 0 ? 1.0 / sec : 0);
 	}
 
+	// some renderers draw a draft first and refine it on the next frame
+	if (rc.m_redraw) QTimer::singleShot(0, this, SLOT(repaint()));
+
 	cam.PositionInScene();
 	RenderPivot();
 
@@ -65,6 +65,7 @@ SOFTWARE.*/
 #include <PostGL/GLPlotGroup.h>
 #include <PostLib/FEMeshData_T.h>
 #include <FECore/MathObject.h>
+#include <FSCore/MathKernel.h>
 #include <FECore/MObjBuilder.h>
 #include <QApplication>
 #include <QClipboard>
@@ -752,8 +753,9 @@ void MathPlot::draw(QPainter& p)
 		}
 	}
 
-	MSimpleExpression m;
-	MVariable* xvar = m.AddVariable("x");
+	// The _data function is not thread-safe, so the expression is evaluated serially.
+	MathKernel m;
+	m.AddVariable("x");
 	m.Create(m_math);
 
 	QRectF vr = m_graph->m_viewRect;
@@ -765,9 +767,7 @@ void MathPlot::draw(QPainter& p)
 	{
 		double x = vr.left() + (i - sr.left())*(vr.right() - vr.left())/ (sr.right() - sr.left());
 
-		xvar->value(x);
-
-		double y = m.value();
+		double y = m.value(x);
 		
 		p1 = m_graph->ViewToScreen(QPointF(x,y));
 
@@ -2337,143 +2337,21 @@ void CModelGraphWindow::addSelectedNodes()
 	Post::FEPostModel& fem = *doc->GetFSModel();
 	Post::FEPostMesh& mesh = *fem.GetFEMesh(0);
 
-	int nsteps = m_lastState - m_firstState + 1;
-	vector<float> xdata(nsteps);
-	vector<float> ydata(nsteps);
-
 	// get the selected nodes
+	vector<int> sel;
+	vector<QString> labels;
 	int NN = mesh.Nodes();
-	switch (m_xtype)
-	{
-	case 0: // time values
+	for (int i = 0; i < NN; i++)
 	{
-		for (int i = 0; i<NN; i++)
+		FSNode& node = mesh.Node(i);
+		if (node.IsSelected())
 		{
-			FSNode& node = mesh.Node(i);
-			if (node.IsSelected())
-			{
-				for (int j = 0; j<nsteps; j++) xdata[j] = fem.GetState(j + m_firstState)->m_time;
-
-				// evaluate y-field
-				TrackNodeHistory(i, &ydata[0], m_dataY, m_firstState, m_lastState);
-
-				CPlotData* plot = nextData();
-				plot->setLabel(QString("N%1").arg(i + 1));
-				for (int j = 0; j<nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
-			}
+			sel.push_back(i);
+			labels.push_back(QString("N%1").arg(i + 1));
 		}
 	}
-	break;
-	case 1: // step values
-	{
-		for (int i = 0; i<NN; i++)
-		{
-			FSNode& node = mesh.Node(i);
-			if (node.IsSelected())
-			{
-				for (int j = 0; j<nsteps; j++) xdata[j] = (float)j + 1.f + m_firstState;
-
-				// evaluate y-field
-				TrackNodeHistory(i, &ydata[0], m_dataY, m_firstState, m_lastState);
 
-				CPlotData* plot = nextData();
-				plot->setLabel(QString("N%1").arg(i + 1));
-				for (int j = 0; j<nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
-			}
-		}
-	}
-	break;
-	case 2: // scatter
-	{
-		for (int i = 0; i<NN; i++)
-		{
-			FSNode& node = mesh.Node(i);
-			if (node.IsSelected())
-			{
-				TrackNodeHistory(i, &xdata[0], m_dataX, m_firstState, m_lastState);
-
-				// evaluate y-field
-				TrackNodeHistory(i, &ydata[0], m_dataY, m_firstState, m_lastState);
-
-				CPlotData* plot = nextData();
-				plot->setLabel(QString("N%1").arg(i + 1));
-				for (int j = 0; j<nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
-			}
-		}
-	}
-	break;
-	case 3: // time-scatter
-	{
-		vector<int> sel;
-		for (int i = 0; i < NN; i++)
-		{
-			FSNode& node = mesh.Node(i);
-			if (node.IsSelected()) sel.push_back(i);
-		}
-
-		if (sel.empty() == false)
-		{
-			int states = fem.GetStates();
-
-			int state0 = m_firstState;
-			int state1 = m_lastState;
-
-			if (state0 < 0) state0 = 0;
-			if (state0 >= states) state0 = states - 1;
-
-			if (state1 < 0) state1 = 0;
-			if (state1 >= states) state1 = states - 1;
-
-			if (state1 < state0)
-			{
-				int tmp = state0;
-				state0 = state1;
-				state1 = tmp;
-			}
-
-			int ninc = m_incState;
-			if (ninc < 1) ninc = 1;
-
-			int nsteps = state1 - state0 + 1;
-			if (nsteps / ninc > 32) nsteps = 32 * ninc;
-
-			for (int i = state0; i < state0 + nsteps; i += ninc)
-			{
-				CPlotData* plot = nextData();
-				plot->setLabel(QString("%1").arg(fem.GetState(i)->m_time));
-			}
-
-			for (int i = 0; i < (int)sel.size(); i++)
-			{
-				FSNode& node = mesh.Node(sel[i]);
-				if (node.IsSelected())
-				{
-					// evaluate x-field
-					TrackNodeHistory(sel[i], &xdata[0], m_dataX, state0, state0 + nsteps - 1);
-
-					// evaluate y-field
-					TrackNodeHistory(sel[i], &ydata[0], m_dataY, state0, state0 + nsteps - 1);
-
-					int m = 0;
-					for (int j = 0; j < nsteps; j += ninc)
-					{
-						CPlotData& p = GetPlotWidget()->getPlotData(m++);
-						p.addPoint(xdata[j], ydata[j]);
-					}
-				}
-			}
-
-			// sort the plots 
-			int nplots = GetPlotWidget()->plots();
-			for (int i = 0; i < nplots; ++i)
-			{
-				CPlotData& data = GetPlotWidget()->getPlotData(i);
-				data.sort();
-			}
-		}
-	}
-	break;
-	}
+	addHistoryPlots(Post::FEPostModel::NODE_HISTORY, sel, labels);
 }
 
 //-----------------------------------------------------------------------------
@@ -2483,38 +2361,21 @@ void CModelGraphWindow::addSelectedEdges()
 	Post::FEPostModel& fem = *doc->GetFSModel();
 	Post::FEPostMesh& mesh = *fem.GetFEMesh(0);
 
-	int nsteps = m_lastState - m_firstState + 1;
-	vector<float> xdata(nsteps);
-	vector<float> ydata(nsteps);
-
-	// get the selected nodes
+	// get the selected edges
+	vector<int> sel;
+	vector<QString> labels;
 	int NL = mesh.Edges();
 	for (int i = 0; i<NL; i++)
 	{
 		FSEdge& edge = mesh.Edge(i);
 		if (edge.IsSelected())
 		{
-			// evaluate x-field
-			switch (m_xtype)
-			{
-			case 0:
-				for (int j = 0; j<nsteps; j++) xdata[j] = fem.GetState(j + m_firstState)->m_time;
-				break;
-			case 1:
-				for (int j = 0; j<nsteps; j++) xdata[j] = (float)j + 1.f + m_firstState;
-				break;
-			default:
-				TrackEdgeHistory(i, &xdata[0], m_dataX, m_firstState, m_lastState);
-			}
-
-			// evaluate y-field
-			TrackEdgeHistory(i, &ydata[0], m_dataY, m_firstState, m_lastState);
-
-			CPlotData* plot = nextData();
-			plot->setLabel(QString("L%1").arg(i + 1));
-			for (int j = 0; j<nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
+			sel.push_back(i);
+			labels.push_back(QString("L%1").arg(i + 1));
 		}
 	}
+
+	addHistoryPlots(Post::FEPostModel::EDGE_HISTORY, sel, labels);
 }
 
 //-----------------------------------------------------------------------------
@@ -2524,124 +2385,21 @@ void CModelGraphWindow::addSelectedFaces()
 	Post::FEPostModel& fem = *doc->GetFSModel();
 	Post::FEPostMesh& mesh = *fem.GetFEMesh(0);
 
-	int nsteps = m_lastState - m_firstState + 1;
-	vector<float> xdata(nsteps);
-	vector<float> ydata(nsteps);
-
 	// get the selected faces
+	vector<int> sel;
+	vector<QString> labels;
 	int NF = mesh.Faces();
-	switch (m_xtype)
+	for (int i = 0; i < NF; ++i)
 	{
-	case 0:
-		for (int i = 0; i < NF; ++i)
+		FSFace& f = mesh.Face(i);
+		if (f.IsSelected())
 		{
-			FSFace& f = mesh.Face(i);
-			if (f.IsSelected())
-			{
-				// evaluate x-field
-				for (int j = 0; j < nsteps; j++) xdata[j] = fem.GetState(j + m_firstState)->m_time;
-
-				// evaluate y-field
-				TrackFaceHistory(i, &ydata[0], m_dataY, m_firstState, m_lastState);
-
-				CPlotData* plot = nextData();
-				plot->setLabel(QString("F%1").arg(i + 1));
-				for (int j = 0; j < nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
-			}
-		}
-		break;
-	case 1:
-		for (int i = 0; i < NF; ++i)
-		{
-			FSFace& f = mesh.Face(i);
-			if (f.IsSelected())
-			{
-				for (int j = 0; j < nsteps; j++) xdata[j] = (float)j + 1.f + m_firstState;
-
-				// evaluate y-field
-				TrackFaceHistory(i, &ydata[0], m_dataY, m_firstState, m_lastState);
-
-				CPlotData* plot = nextData();
-				plot->setLabel(QString("F%1").arg(i + 1));
-				for (int j = 0; j < nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
-			}
+			sel.push_back(i);
+			labels.push_back(QString("F%1").arg(i + 1));
 		}
-		break;
-	case 2:
-		for (int i = 0; i < NF; ++i)
-		{
-			FSFace& f = mesh.Face(i);
-			if (f.IsSelected())
-			{
-				// evaluate x-field
-				TrackFaceHistory(i, &xdata[0], m_dataX, m_firstState, m_lastState);
-
-				// evaluate y-field
-				TrackFaceHistory(i, &ydata[0], m_dataY, m_firstState, m_lastState);
-
-				CPlotData* plot = nextData();
-				plot->setLabel(QString("F%1").arg(i + 1));
-				for (int j = 0; j < nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
-			}
-		}
-		break;
-	case 3:	// time-scatter
-	{
-		vector<int> sel;
-		for (int i = 0; i < NF; i++)
-		{
-			FSFace& face = mesh.Face(i);
-			if (face.IsSelected()) sel.push_back(i);
-		}
-
-		if (sel.empty() == false)
-		{
-			int nsteps = m_lastState - m_firstState + 1;
-
-			int ninc = m_incState;
-			if (ninc < 1) ninc = 1;
-
-			if (nsteps / ninc > 32) nsteps = 32*ninc;
-
-			for (int i = m_firstState; i < m_firstState + nsteps; i += ninc)
-			{
-				CPlotData* plot = nextData();
-				plot->setLabel(QString("%1").arg(fem.GetState(i)->m_time));
-			}
-
-			for (int i = 0; i < (int)sel.size(); i++)
-			{
-				FSFace& face = mesh.Face(sel[i]);
-
-				// evaluate x-field
-				TrackFaceHistory(sel[i], &xdata[0], m_dataX, m_firstState, m_lastState);
-
-				// evaluate y-field
-				TrackFaceHistory(sel[i], &ydata[0], m_dataY, m_firstState, m_lastState);
-
-				int m = 0;
-				for (int j = 0; j < nsteps; ++j)
-				{
-					CPlotData& p = GetPlotWidget()->getPlotData(m++);
-					p.addPoint(xdata[j], ydata[j]);
-				}
-			}
-
-			// sort the plots 
-			CPlotWidget* w = GetPlotWidget();
-			int nplots = w->plots();
-			for (int i = 0; i < nplots; ++i)
-			{
-				CPlotData& data = GetPlotWidget()->getPlotData(i);
-				data.sort();
-			}
-
-			if (w->autoRangeUpdate())
-				w->fitToData(false);
-		}
-	}
-	break;
 	}
+
+	addHistoryPlots(Post::FEPostModel::FACE_HISTORY, sel, labels);
 }
 
 //-----------------------------------------------------------------------------
@@ -2651,213 +2409,127 @@ void CModelGraphWindow::addSelectedElems()
 	Post::FEPostModel& fem = *doc->GetFSModel();
 	Post::FEPostMesh& mesh = *fem.GetFEMesh(0);
 
-	int nsteps = m_lastState - m_firstState + 1;
-	vector<float> xdata(nsteps);
-	vector<float> ydata(nsteps);
-
 	// get the selected elements
+	vector<int> sel;
+	vector<QString> labels;
 	int NE = mesh.Elements();
-	switch (m_xtype)
+	for (int i = 0; i < NE; i++)
 	{
-	case 0:
-		for (int i = 0; i < NE; i++)
+		FEElement_& e = mesh.ElementRef(i);
+		if (e.IsSelected())
 		{
-			FEElement_& e = mesh.ElementRef(i);
-			if (e.IsSelected())
-			{
-				// evaluate x-field
-				for (int j = 0; j < nsteps; j++) xdata[j] = fem.GetState(j + m_firstState)->m_time;
-
-				// evaluate y-field
-				TrackElementHistory(i, &ydata[0], m_dataY, m_firstState, m_lastState);
-
-				CPlotData* plot = nextData();
-				for (int j = 0; j < nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
-				plot->setLabel(QString("E%1").arg(e.GetID()));
-			}
+			sel.push_back(i);
+			labels.push_back(QString("E%1").arg(e.GetID()));
 		}
-		break;
-	case 1:
-		for (int i = 0; i < NE; i++)
-		{
-			FEElement_& e = mesh.ElementRef(i);
-			if (e.IsSelected())
-			{
-				// evaluate x-field
-				for (int j = 0; j < nsteps; j++) xdata[j] = (float)j + 1.f + m_firstState;
+	}
 
-				// evaluate y-field
-				TrackElementHistory(i, &ydata[0], m_dataY, m_firstState, m_lastState);
+	addHistoryPlots(Post::FEPostModel::ELEM_HISTORY, sel, labels);
+}
 
-				CPlotData* plot = nextData();
-				for (int j = 0; j < nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
-				plot->setLabel(QString("E%1").arg(e.GetID()));
-			}
-		}
-		break;
-	case 2:
-		for (int i = 0; i < NE; i++)
-		{
-			FEElement_& e = mesh.ElementRef(i);
-			if (e.IsSelected())
-			{
-				// evaluate x-field
-				TrackElementHistory(i, &xdata[0], m_dataX, m_firstState, m_lastState);
+//-----------------------------------------------------------------------------
+// Add the time history plots of a list of mesh items. The histories of all items
+// are evaluated at once by the model, which returns them as a (states x items) matrix.
+void CModelGraphWindow::addHistoryPlots(int itemType, const std::vector<int>& items, const std::vector<QString>& labels)
+{
+	if (items.empty()) return;
 
-				// evaluate y-field
-				TrackElementHistory(i, &ydata[0], m_dataY, m_firstState, m_lastState);
+	CPostDocument* doc = GetPostDoc();
+	Post::FEPostModel& fem = *doc->GetFSModel();
+	int NI = (int)items.size();
 
-				CPlotData* plot = nextData();
-				for (int j = 0; j < nsteps; ++j) plot->addPoint(xdata[j], ydata[j]);
-				plot->setLabel(QString("E%1").arg(e.GetID()));
-			}
-		}
-		break;
-	case 3:	// time-scatter
+	vector<float> xval, yval;
+	switch (m_xtype)
 	{
-		vector<int> sel;
-		for (int i = 0; i < NE; i++)
+	case 0: // time values
+	case 1: // step values
+	case 2: // scatter
+	{
+		// evaluate y-field
+		int nsteps = fem.EvaluateHistory(itemType, items, m_dataY, m_firstState, m_lastState, yval);
+
+		// evaluate x-field
+		vector<float> xdata(nsteps);
+		if (m_xtype == 0)
 		{
-			FEElement_& e = mesh.ElementRef(i);
-			if (e.IsSelected()) sel.push_back(i);
+			for (int j = 0; j < nsteps; j++) xdata[j] = fem.GetState(j + m_firstState)->m_time;
 		}
-
-		if (sel.empty() == false)
+		else if (m_xtype == 1)
 		{
-			int ninc = m_incState;
-			if (ninc < 1) ninc = 1;
-
-			int nsteps = m_lastState - m_firstState + 1;
-			if (nsteps / ninc > 32) nsteps = 32 * ninc;
-
-			for (int i = m_firstState; i < m_firstState + nsteps; i += ninc)
-			{
-				CPlotData* plot = nextData();
-				plot->setLabel(QString("%1").arg(fem.GetState(i)->m_time));
-			}
-
-			for (int i = 0; i < (int)sel.size(); i++)
-			{
-				FEElement_& e = mesh.ElementRef(sel[i]);
-				if (e.IsSelected())
-				{
-					// evaluate x-field
-					TrackElementHistory(sel[i], &xdata[0], m_dataX, m_firstState, m_lastState);
-
-					// evaluate y-field
-					TrackElementHistory(sel[i], &ydata[0], m_dataY, m_firstState, m_lastState);
-
-					int m = 0;
-					for (int j = 0; j < nsteps; j += ninc)
-					{
-						CPlotData& p = GetPlotWidget()->getPlotData(m++);
-						p.addPoint(xdata[j], ydata[j]);
-					}
-				}
-			}
+			for (int j = 0; j < nsteps; j++) xdata[j] = (float)j + 1.f + m_firstState;
+		}
+		else fem.EvaluateHistory(itemType, items, m_dataX, m_firstState, m_lastState, xval);
 
-			// sort the plots 
-			CPlotWidget* w = GetPlotWidget();
-			int nplots = w->plots();
-			for (int i = 0; i < nplots; ++i)
+		for (int i = 0; i < NI; ++i)
+		{
+			CPlotData* plot = nextData();
+			plot->setLabel(labels[i]);
+			for (int j = 0; j < nsteps; ++j)
 			{
-				CPlotData& data = GetPlotWidget()->getPlotData(i);
-				data.sort();
+				float x = (m_xtype == 2 ? xval[j*NI + i] : xdata[j]);
+				plot->addPoint(x, yval[j*NI + i]);
 			}
-
-			if (w->autoRangeUpdate())
-				w->fitToData(false);
 		}
 	}
 	break;
-	}
-}
-
-//-----------------------------------------------------------------------------
-// Calculate time history of a node
-
-void CModelGraphWindow::TrackNodeHistory(int node, float* pval, int nfield, int nmin, int nmax)
-{
-	CPostDocument* doc = GetPostDoc();
-	Post::FEPostModel& fem = *doc->GetFSModel();
+	case 3: // time-scatter
+	{
+		int states = fem.GetStates();
 
-	int nsteps = fem.GetStates();
-	if (nmin <       0) nmin = 0;
-	if (nmax == -1) nmax = nsteps - 1;
-	if (nmax >= nsteps) nmax = nsteps - 1;
-	if (nmax <    nmin) nmax = nmin;
-	int nn = nmax - nmin + 1;
+		int state0 = m_firstState;
+		int state1 = m_lastState;
 
-	Post::NODEDATA nd;
-	for (int n = 0; n<nn; n++)
-	{
-		fem.EvaluateNode(node, n + nmin, nfield, nd);
-		pval[n] = nd.m_val;
-	}
-}
+		if (state0 < 0) state0 = 0;
+		if (state0 >= states) state0 = states - 1;
 
-//-----------------------------------------------------------------------------
-// Calculate time history of a edge
-void CModelGraphWindow::TrackEdgeHistory(int edge, float* pval, int nfield, int nmin, int nmax)
-{
-	CPostDocument* doc = GetPostDoc();
-	Post::FEPostModel& fem = *doc->GetFSModel();
+		if (state1 < 0) state1 = 0;
+		if (state1 >= states) state1 = states - 1;
 
-	int nsteps = fem.GetStates();
-	if (nmin <       0) nmin = 0;
-	if (nmax == -1) nmax = nsteps - 1;
-	if (nmax >= nsteps) nmax = nsteps - 1;
-	if (nmax <    nmin) nmax = nmin;
-	int nn = nmax - nmin + 1;
+		if (state1 < state0)
+		{
+			int tmp = state0;
+			state0 = state1;
+			state1 = tmp;
+		}
 
-	Post::EDGEDATA nd;
-	for (int n = 0; n<nn; n++)
-	{
-		fem.EvaluateEdge(edge, n + nmin, nfield, nd);
-		pval[n] = nd.m_val;
-	}
-}
+		int ninc = m_incState;
+		if (ninc < 1) ninc = 1;
 
-//-----------------------------------------------------------------------------
-// Calculate time history of a face
-void CModelGraphWindow::TrackFaceHistory(int nface, float* pval, int nfield, int nmin, int nmax)
-{
-	CPostDocument* doc = GetPostDoc();
-	Post::FEPostModel& fem = *doc->GetFSModel();
+		int nsteps = state1 - state0 + 1;
+		if (nsteps / ninc > 32) nsteps = 32 * ninc;
 
-	int nsteps = fem.GetStates();
-	if (nmin <       0) nmin = 0;
-	if (nmax == -1) nmax = nsteps - 1;
-	if (nmax >= nsteps) nmax = nsteps - 1;
-	if (nmax <    nmin) nmax = nmin;
-	int nn = nmax - nmin + 1;
+		for (int i = state0; i < state0 + nsteps; i += ninc)
+		{
+			CPlotData* plot = nextData();
+			plot->setLabel(QString("%1").arg(fem.GetState(i)->m_time));
+		}
 
-	float data[FSFace::MAX_NODES], val;
-	for (int n = 0; n<nn; n++)
-	{
-		fem.EvaluateFace(nface, n + nmin, nfield, data, val);
-		pval[n] = val;
-	}
-}
+		// evaluate x- and y-fields
+		fem.EvaluateHistory(itemType, items, m_dataX, state0, state0 + nsteps - 1, xval);
+		fem.EvaluateHistory(itemType, items, m_dataY, state0, state0 + nsteps - 1, yval);
 
-//-----------------------------------------------------------------------------
-// Calculate time history of an element
-void CModelGraphWindow::TrackElementHistory(int nelem, float* pval, int nfield, int nmin, int nmax)
-{
-	CPostDocument* doc = GetPostDoc();
-	Post::FEPostModel& fem = *doc->GetFSModel();
+		for (int i = 0; i < NI; i++)
+		{
+			int m = 0;
+			for (int j = 0; j < nsteps; j += ninc)
+			{
+				CPlotData& p = GetPlotWidget()->getPlotData(m++);
+				p.addPoint(xval[j*NI + i], yval[j*NI + i]);
+			}
+		}
 
-	int nsteps = fem.GetStates();
-	if (nmin <       0) nmin = 0;
-	if (nmax == -1) nmax = nsteps - 1;
-	if (nmax >= nsteps) nmax = nsteps - 1;
-	if (nmax <    nmin) nmax = nmin;
-	int nn = nmax - nmin + 1;
+		// sort the plots 
+		CPlotWidget* w = GetPlotWidget();
+		int nplots = w->plots();
+		for (int i = 0; i < nplots; ++i)
+		{
+			CPlotData& data = GetPlotWidget()->getPlotData(i);
+			data.sort();
+		}
 
-	float data[FSElement::MAX_NODES] = { 0.f }, val;
-	for (int n = 0; n<nn; n++)
-	{
-		fem.EvaluateElement(nelem, n + nmin, nfield, data, val);
-		pval[n] = val;
+		if (w->autoRangeUpdate())
+			w->fitToData(false);
+	}
+	break;
 	}
 }
+
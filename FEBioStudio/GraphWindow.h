@@ -427,10 +427,6 @@ public:
 
 private:
 	// track mesh data
-	void TrackElementHistory(int nelem, float* pval, int nfield, int nmin = 0, int nmax = -1);
-	void TrackFaceHistory(int nface, float* pval, int nfield, int nmin = 0, int nmax = -1);
-	void TrackEdgeHistory(int edge, float* pval, int nfield, int nmin = 0, int nmax = -1);
-	void TrackNodeHistory(int node, float* pval, int nfield, int nmin = 0, int nmax = -1);
 	void TrackObjectHistory(int nobj, float* pval, int nfield);
 
 private:
@@ -438,6 +434,7 @@ private:
 	void addSelectedEdges();
 	void addSelectedFaces();
 	void addSelectedElems();
+	void addHistoryPlots(int itemType, const std::vector<int>& items, const std::vector<QString>& labels);
 	void addObjectData(int n);
 	void addGlobalData(Post::ModelDataField* pdf, int n);
 	void addProbeData(Post::GLPointProbe* probe);
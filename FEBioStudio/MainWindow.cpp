@@ -68,6 +68,7 @@ SOFTWARE.*/
 #include "Encrypter.h"
 #include "DlgImportXPLT.h"
 #include "Commands.h"
+#include "CommandManager.h"
 #include <XPLTLib/xpltFileReader.h>
 #include <GeomLib/GModel.h>
 #include "DocManager.h"
@@ -1783,6 +1784,7 @@ void CMainWindow::writeSettings()
 		settings.setValue("defaultUnits", ui->m_settings.defaultUnits);
 		settings.setValue("loadFEBioConfigFile", ui->m_settings.loadFEBioConfigFile);
 		settings.setValue("febioConfigFileName", ui->m_settings.febioConfigFileName);
+		settings.setValue("undoMemoryBudget", (qulonglong)(CCommandManager::GetMemoryBudget() / (1024 * 1024)));
 
 		settings.setValue("bgColor1", (int)vs.m_col1.to_uint());
 		settings.setValue("bgColor2", (int)vs.m_col2.to_uint());
@@ -1910,6 +1912,8 @@ void CMainWindow::readSettings()
 		ui->m_settings.defaultUnits = settings.value("defaultUnits", 0).toInt();
 		ui->m_settings.loadFEBioConfigFile = settings.value("loadFEBioConfigFile", true).toBool();
 		ui->m_settings.febioConfigFileName = settings.value("febioConfigFileName", ui->m_settings.febioConfigFileName).toString();
+		size_t undoBudget = settings.value("undoMemoryBudget", (qulonglong)(CCommandManager::GetMemoryBudget() / (1024 * 1024))).toULongLong();
+		CCommandManager::SetMemoryBudget(undoBudget * 1024 * 1024);
 
 		vs.m_col1 = GLColor(settings.value("bgColor1", (int)vs.m_col1.to_uint()).toInt());
 		vs.m_col2 = GLColor(settings.value("bgColor2", (int)vs.m_col2.to_uint()).toInt());
@@ -162,66 +162,34 @@ void CMeshInspector::UpdateFEMeshData(FSMesh* pm, int ndata)
 	eval.SetCurvatureExtQuad(curvatureExtQuad);
 
 	int NE = pm->Elements();
-	vector<double> v; v.reserve(NE*FSElement::MAX_NODES);
-	double vmax = -1e99, vmin = 1e99, vavg = 0;
+	double vmax = 0, vmin = 0, vavg = 0;
 	eval.Evaluate(ndata);
 	Mesh_Data& data = pm->GetMeshData();
+	FEMeshDataStats stats;
 	if (data.IsValid())
 	{
 		for (int i = 0; i < NE; ++i)
 		{
 			FSElement& el = pm->Element(i);
-			int ne = el.Nodes();
-			if (ET[el.Type()])
-			{
-				if (data[i].tag)
-				{
-					for (int j = 0; j < ne; ++j)
-					{
-						double vj = data.GetElementValue(i, j);
-						vavg += vj;
-						v.push_back(vj);
-					}
-				}
-			}
-			else
-			{
-				data.SetElementDataTag(i, 0);
-			}
+			if (ET[el.Type()] == false) data.SetElementDataTag(i, 0);
 		}
 		data.UpdateValueRange();
-		data.GetValueRange(vmin, vmax);
+
+		// the histogram is limited by the width of the plot
+		stats = FEMeshValuator::GetDataStats(data, width() / 3);
+		vmin = stats.vmin;
+		vmax = stats.vmax;
+		vavg = stats.vavg;
 	}
-	int NC = v.size();
-	if (NC > 0) vavg /= (double)NC; else { vmin = vmax = vavg = 0.0; }
+	double NC = (double)stats.count;
 	ui->stats->setRange(vmin, vmax, vavg);
 
 	ui->sel->setRange(vmin, vmax);
 
-	// determine number of bins
-	// sqrt rule
-//	int M = (int)ceil(sqrt((double)NC));
-
-	// sturges rule
-	int M = (int)ceil(log2(NC) + 1);
-
-	// rice rule
-//	int M = (int)ceil(2.0*pow(NC, 1.0/3.0));
-
-	if (M < 1) M = 1;
-	if (M > width() / 3) M = width() / 3;
-
 	if (fabs(vmax - vmin) < 1e-5) vmax++;
-	vector<double> bin; bin.assign(M, 0.0);
-	double ymax = 0;
-	for (int i = 0; i<NC; ++i)
-	{
-		int n = (int)(M*(v[i] - vmin) / (vmax - vmin));
-		if (n < 0) n = 0;
-		if (n >= M) n = M - 1;
-		if (n >= 0) bin[n] += 1;
-		if (bin[n] > ymax) ymax = bin[n];
-	}
+	vector<double> bin = stats.bins;
+	if (bin.empty()) bin.assign(1, 0.0);
+	int M = (int)bin.size();
 
 	if (ui->logScale->isChecked())
 	{
@@ -670,7 +670,7 @@ vec3d FSOldFiberMaterial::GetLocalFiberVector(FEElementRef& el)
 	break;
 	case FE_FIBER_USER:
 	{
-		return el->m_fiber;
+		return el.m_pmesh->ElementFiber(el.m_nelem);
 	}
 	break;
 	case FE_FIBER_ANGLES:
@@ -391,7 +391,7 @@ vec3d FSVec3dValuator::GetFiberVector(const FEElementRef& el)
 {
 	switch (m_naopt)
 	{
-	case FE_FIBER_USER: return el->m_fiber; break;
+	case FE_FIBER_USER: return el.m_pmesh->ElementFiber(el.m_nelem); break;
 	case FE_FIBER_LOCAL:
 	{
 		vec3d v(0, 0, 0);
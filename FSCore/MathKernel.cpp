@@ -0,0 +1,131 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#include "stdafx.h"
+#include "MathKernel.h"
+#include <ctype.h>
+
+MathKernel::MathKernel()
+{
+	m_bvalid = false;
+}
+
+//-----------------------------------------------------------------------------
+void MathKernel::Clear()
+{
+	m_math.Clear();
+	m_var.clear();
+	m_expr.clear();
+	m_bvalid = false;
+}
+
+//-----------------------------------------------------------------------------
+int MathKernel::AddVariable(const std::string& name)
+{
+	int n = FindVariable(name);
+	if (n >= 0) return n;
+
+	m_math.AddVariable(name);
+	m_var.push_back(name);
+	return (int)m_var.size() - 1;
+}
+
+//-----------------------------------------------------------------------------
+int MathKernel::FindVariable(const std::string& name) const
+{
+	for (int i = 0; i < (int)m_var.size(); ++i)
+	{
+		if (m_var[i] == name) return i;
+	}
+	return -1;
+}
+
+//-----------------------------------------------------------------------------
+bool MathKernel::Create(const std::string& expr)
+{
+	m_expr = expr;
+	m_bvalid = m_math.Create(expr.empty() ? std::string("0") : expr);
+	return m_bvalid;
+}
+
+//-----------------------------------------------------------------------------
+double MathKernel::value(const std::vector<double>& var) const
+{
+	if (m_bvalid == false) return 0.0;
+	return m_math.value_s(var);
+}
+
+//-----------------------------------------------------------------------------
+double MathKernel::value(double x) const
+{
+	std::vector<double> var(1, x);
+	return value(var);
+}
+
+//-----------------------------------------------------------------------------
+void MathKernel::value(int N, const std::vector<double>& var, std::vector<double>& val) const
+{
+	val.assign(N, 0.0);
+	if ((m_bvalid == false) || (N <= 0)) return;
+
+	int nvar = Variables();
+	#pragma omp parallel
+	{
+		std::vector<double> v(nvar);
+
+		#pragma omp for schedule(static)
+		for (int i = 0; i < N; ++i)
+		{
+			for (int j = 0; j < nvar; ++j) v[j] = var[i*nvar + j];
+			val[i] = m_math.value_s(v);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+std::vector<std::string> MathKernel::Identifiers(const std::string& expr)
+{
+	std::vector<std::string> ids;
+	size_t n = expr.size();
+	size_t i = 0;
+	while (i < n)
+	{
+		char c = expr[i];
+		if (isalpha((unsigned char)c) || (c == '_'))
+		{
+			size_t i0 = i;
+			while ((i < n) && (isalnum((unsigned char)expr[i]) || (expr[i] == '_'))) ++i;
+			ids.push_back(expr.substr(i0, i - i0));
+		}
+		else if (isdigit((unsigned char)c) || (c == '.'))
+		{
+			// skip numbers (including exponents like 1e-3)
+			while ((i < n) && (isalnum((unsigned char)expr[i]) || (expr[i] == '.'))) ++i;
+		}
+		else ++i;
+	}
+	return ids;
+}
@@ -0,0 +1,82 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#pragma once
+#include <FECore/MathObject.h>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// A math expression that is parsed once and can then be evaluated many times.
+// Variables are identified by the order in which they were added. The value
+// functions do not modify the expression, so once Create was called they can
+// be called concurrently from multiple threads.
+class MathKernel
+{
+public:
+	MathKernel();
+
+	// clear the expression and all variables
+	void Clear();
+
+	// add a variable (must be done before Create). Returns the index of the variable.
+	int AddVariable(const std::string& name);
+
+	// find a variable's index (or -1 if not found)
+	int FindVariable(const std::string& name) const;
+
+	int Variables() const { return (int)m_var.size(); }
+	const std::string& VariableName(int i) const { return m_var[i]; }
+
+	// parse the expression. An empty expression evaluates to zero.
+	bool Create(const std::string& expr);
+
+	bool IsValid() const { return m_bvalid; }
+
+	const std::string& Expression() const { return m_expr; }
+
+	// evaluate for the variable values (in the order they were added)
+	double value(const std::vector<double>& var) const;
+
+	// evaluate an expression of a single variable
+	double value(double x) const;
+
+	// evaluate the expression for N sets of variable values (in parallel).
+	// The values are stored per evaluation point, i.e. var has size N*Variables().
+	void value(int N, const std::vector<double>& var, std::vector<double>& val) const;
+
+	// returns the identifiers that appear in an expression
+	static std::vector<std::string> Identifiers(const std::string& expr);
+
+private:
+	mutable MSimpleExpression	m_math;	// value_s does not modify the expression
+	std::vector<std::string>	m_var;
+	std::string					m_expr;
+	bool						m_bvalid;
+
+	MathKernel(const MathKernel&) = delete;
+	void operator = (const MathKernel&) = delete;
+};
@@ -0,0 +1,125 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "MemoryMappedFile.h"
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MemoryMappedFile::MemoryMappedFile()
+{
+	m_data = nullptr;
+	m_size = 0;
+#ifdef WIN32
+	m_hfile = INVALID_HANDLE_VALUE;
+	m_hmap = nullptr;
+#else
+	m_fd = -1;
+#endif
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	Close();
+}
+
+#ifdef WIN32
+bool MemoryMappedFile::Open(const char* szfile)
+{
+	Close();
+	if ((szfile == nullptr) || (szfile[0] == 0)) return false;
+
+	HANDLE hfile = CreateFileA(szfile, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hfile == INVALID_HANDLE_VALUE) return false;
+	m_hfile = hfile;
+
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(hfile, &size) == FALSE) { Close(); return false; }
+	m_size = (size_t)size.QuadPart;
+
+	// empty files cannot be mapped, but are otherwise valid
+	if (m_size == 0) { Close(); return false; }
+
+	HANDLE hmap = CreateFileMappingA(hfile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (hmap == NULL) { Close(); return false; }
+	m_hmap = hmap;
+
+	void* p = MapViewOfFile(hmap, FILE_MAP_READ, 0, 0, 0);
+	if (p == NULL) { Close(); return false; }
+	m_data = (const char*)p;
+
+	return true;
+}
+
+void MemoryMappedFile::Close()
+{
+	if (m_data) UnmapViewOfFile((LPCVOID)m_data);
+	if (m_hmap) CloseHandle((HANDLE)m_hmap);
+	if (m_hfile != INVALID_HANDLE_VALUE) CloseHandle((HANDLE)m_hfile);
+	m_data = nullptr;
+	m_hmap = nullptr;
+	m_hfile = INVALID_HANDLE_VALUE;
+	m_size = 0;
+}
+#else
+bool MemoryMappedFile::Open(const char* szfile)
+{
+	Close();
+	if ((szfile == nullptr) || (szfile[0] == 0)) return false;
+
+	int fd = open(szfile, O_RDONLY);
+	if (fd < 0) return false;
+	m_fd = fd;
+
+	struct stat st;
+	if ((fstat(fd, &st) != 0) || (st.st_size <= 0)) { Close(); return false; }
+	m_size = (size_t)st.st_size;
+
+	void* p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (p == MAP_FAILED) { Close(); return false; }
+	m_data = (const char*)p;
+
+	// we'll read the file front to back (at least per thread)
+	madvise(p, m_size, MADV_SEQUENTIAL);
+
+	return true;
+}
+
+void MemoryMappedFile::Close()
+{
+	if (m_data) munmap((void*)m_data, m_size);
+	if (m_fd >= 0) close(m_fd);
+	m_data = nullptr;
+	m_fd = -1;
+	m_size = 0;
+}
+#endif
@@ -0,0 +1,70 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include <stddef.h>
+
+//-----------------------------------------------------------------------------
+// Read-only view of a file that is mapped into memory. This is used by readers
+// that need random (or parallel) access to the entire file contents, without
+// reading the file through a FILE stream first.
+class MemoryMappedFile
+{
+public:
+	MemoryMappedFile();
+	~MemoryMappedFile();
+
+	// map the file. Returns false if the file could not be opened or mapped.
+	bool Open(const char* szfile);
+
+	// unmap the file
+	void Close();
+
+	// is a file currently mapped?
+	bool IsOpen() const { return (m_data != nullptr); }
+
+	// pointer to the start of the file contents
+	const char* Data() const { return m_data; }
+
+	// size of the file in bytes
+	size_t Size() const { return m_size; }
+
+private:
+	MemoryMappedFile(const MemoryMappedFile&) = delete;
+	void operator = (const MemoryMappedFile&) = delete;
+
+private:
+	const char*	m_data;
+	size_t		m_size;
+
+#ifdef WIN32
+	void*	m_hfile;
+	void*	m_hmap;
+#else
+	int		m_fd;
+#endif
+};
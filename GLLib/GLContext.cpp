@@ -32,6 +32,7 @@ CGLContext::CGLContext()
 	m_cam = nullptr;
 	m_view = nullptr;
 	m_x = m_y = 0;
+	m_redraw = false;
 }
 
 CGLContext::~CGLContext(void)
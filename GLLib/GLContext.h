@@ -42,5 +42,8 @@ public:
 	CGLCamera*	m_cam;
 	int			m_x, m_y;
 
+	// set by renderers that need another frame (e.g. to refine a draft)
+	bool		m_redraw;
+
 	GLViewSettings	m_settings;
 };
@@ -0,0 +1,189 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "GLGlyph.h"
+#include "GLMesh.h"
+#include <math.h>
+
+//-----------------------------------------------------------------------------
+GLGlyph::GLGlyph()
+{
+}
+
+//-----------------------------------------------------------------------------
+void GLGlyph::Clear()
+{
+	m_vert.clear();
+}
+
+//-----------------------------------------------------------------------------
+void GLGlyph::AddTriangle(const Vertex& a, const Vertex& b, const Vertex& c)
+{
+	m_vert.push_back(a);
+	m_vert.push_back(b);
+	m_vert.push_back(c);
+}
+
+//-----------------------------------------------------------------------------
+void GLGlyph::AddCylinder(float r0, float r1, float z0, float z1, int slices)
+{
+	if (slices < 3) slices = 3;
+
+	// normals of a cone are tilted by the change in radius
+	float h = z1 - z0;
+	float dr = r0 - r1;
+	float L = sqrt(h*h + dr*dr);
+	if (L == 0.f) return;
+	float nxy = h / L;
+	float nz = dr / L;
+
+	for (int i = 0; i < slices; ++i)
+	{
+		float w0 = 2.f*(float)PI*i / slices;
+		float w1 = 2.f*(float)PI*(i + 1) / slices;
+		float c0 = cos(w0), s0 = sin(w0);
+		float c1 = cos(w1), s1 = sin(w1);
+
+		Vertex b0 = { vec3f(r0*c0, r0*s0, z0), vec3f(nxy*c0, nxy*s0, nz) };
+		Vertex b1 = { vec3f(r0*c1, r0*s1, z0), vec3f(nxy*c1, nxy*s1, nz) };
+		Vertex t0 = { vec3f(r1*c0, r1*s0, z1), vec3f(nxy*c0, nxy*s0, nz) };
+		Vertex t1 = { vec3f(r1*c1, r1*s1, z1), vec3f(nxy*c1, nxy*s1, nz) };
+
+		if (r0 != 0.f) AddTriangle(b0, b1, t1);
+		if (r1 != 0.f) AddTriangle(b0, t1, t0);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void GLGlyph::AddSphere(float R, int slices, int stacks)
+{
+	if (slices < 3) slices = 3;
+	if (stacks < 2) stacks = 2;
+
+	for (int j = 0; j < stacks; ++j)
+	{
+		// polar angles of the upper (p0) and lower (p1) ring
+		float p0 = (float)PI*j / stacks;
+		float p1 = (float)PI*(j + 1) / stacks;
+		for (int i = 0; i < slices; ++i)
+		{
+			float w0 = 2.f*(float)PI*i / slices;
+			float w1 = 2.f*(float)PI*(i + 1) / slices;
+
+			vec3f u0(sin(p0)*cos(w0), sin(p0)*sin(w0), cos(p0));
+			vec3f u1(sin(p0)*cos(w1), sin(p0)*sin(w1), cos(p0));
+			vec3f l0(sin(p1)*cos(w0), sin(p1)*sin(w0), cos(p1));
+			vec3f l1(sin(p1)*cos(w1), sin(p1)*sin(w1), cos(p1));
+
+			Vertex vu0 = { u0*R, u0 };
+			Vertex vu1 = { u1*R, u1 };
+			Vertex vl0 = { l0*R, l0 };
+			Vertex vl1 = { l1*R, l1 };
+
+			// skip the degenerate triangles at the poles
+			if (j != stacks - 1) AddTriangle(vl0, vl1, vu1);
+			if (j != 0) AddTriangle(vl0, vu1, vu0);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+void GLGlyph::AddBox(float wx, float wy, float wz)
+{
+	const float n[6][3] = { {1,0,0}, {-1,0,0}, {0,1,0}, {0,-1,0}, {0,0,1}, {0,0,-1} };
+	const float r[6][4][3] = {
+		{ { 1,-1,-1}, { 1, 1,-1}, { 1, 1, 1}, { 1,-1, 1} },
+		{ {-1, 1,-1}, {-1,-1,-1}, {-1,-1, 1}, {-1, 1, 1} },
+		{ { 1, 1,-1}, {-1, 1,-1}, {-1, 1, 1}, { 1, 1, 1} },
+		{ {-1,-1,-1}, { 1,-1,-1}, { 1,-1, 1}, {-1,-1, 1} },
+		{ {-1,-1, 1}, { 1,-1, 1}, { 1, 1, 1}, {-1, 1, 1} },
+		{ {-1,-1,-1}, {-1, 1,-1}, { 1, 1,-1}, { 1,-1,-1} }
+	};
+
+	for (int i = 0; i < 6; ++i)
+	{
+		vec3f ni(n[i][0], n[i][1], n[i][2]);
+		Vertex v[4];
+		for (int j = 0; j < 4; ++j)
+		{
+			v[j].r = vec3f(wx*r[i][j][0], wy*r[i][j][1], wz*r[i][j][2]);
+			v[j].n = ni;
+		}
+		AddTriangle(v[0], v[1], v[2]);
+		AddTriangle(v[0], v[2], v[3]);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void GLGlyph::AddToMesh(GLTriMesh& mesh, const vec3f& c, const vec3f A[3], const vec3f B[3], const GLColor& col) const
+{
+	size_t N = m_vert.size();
+	for (size_t i = 0; i < N; ++i)
+	{
+		const Vertex& v = m_vert[i];
+		vec3f r = c + A[0] * v.r.x + A[1] * v.r.y + A[2] * v.r.z;
+		vec3f n = B[0] * v.n.x + B[1] * v.n.y + B[2] * v.n.z;
+		n.Normalize();
+		mesh.AddVertex(r, n, col);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// This is the shortest rotation from z to v, i.e. the same rotation the plots used
+// to apply with glRotate. If v points in the negative z-direction, the rotation is
+// 180 degrees around the x-axis.
+void GLGlyph::RotateZTo(const vec3f& v, vec3f R[3])
+{
+	R[0] = vec3f(1, 0, 0);
+	R[1] = vec3f(0, 1, 0);
+	R[2] = vec3f(0, 0, 1);
+
+	float L = v.Length();
+	if (L == 0.f) return;
+	vec3f d = v*(1.f / L);
+
+	// rotation axis k = z x d and sine/cosine of the rotation angle
+	float kx = -d.y, ky = d.x;
+	float s2 = kx*kx + ky*ky;
+	float c = d.z;
+	if (s2 < 1e-12f)
+	{
+		if (c < 0.f)
+		{
+			R[1] = vec3f(0, -1, 0);
+			R[2] = vec3f(0, 0, -1);
+		}
+		return;
+	}
+
+	// Rodrigues' formula
+	float f = (1.f - c) / s2;
+	R[0] = vec3f(1.f + f*(kx*kx - s2), f*kx*ky, -ky);
+	R[1] = vec3f(f*kx*ky, 1.f + f*(ky*ky - s2), kx);
+	R[2] = vec3f(ky, -kx, c);
+}
@@ -0,0 +1,149 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include <FSCore/math3d.h>
+#include <FSCore/color.h>
+#include <vector>
+
+class GLTriMesh;
+
+//-----------------------------------------------------------------------------
+// A glyph template, i.e. a small triangle mesh in a local coordinate system, that 
+// can be copied many times into a GLTriMesh. This is used by plots that render
+// many glyphs (e.g. vector and tensor plots), so that all glyphs can be rendered 
+// with a single draw call instead of one GLU call per glyph.
+// The glyph's axis is the local z-axis.
+class GLGlyph
+{
+public:
+	struct Vertex
+	{
+		vec3f	r;	// position
+		vec3f	n;	// normal
+	};
+
+public:
+	GLGlyph();
+
+	void Clear();
+
+	bool IsEmpty() const { return m_vert.empty(); }
+
+	// number of triangles
+	size_t Triangles() const { return m_vert.size() / 3; }
+
+	// Add the side of a cylinder or cone (same as gluCylinder with one stack).
+	// The radius goes from r0 at z0 to r1 at z1.
+	void AddCylinder(float r0, float r1, float z0, float z1, int slices);
+
+	// Add a sphere (same as gluSphere)
+	void AddSphere(float R, int slices, int stacks);
+
+	// Add a box of size 2*wx x 2*wy x 2*wz (same as glx::drawBox)
+	void AddBox(float wx, float wy, float wz);
+
+	// Add a copy of the glyph to the mesh. A vertex p is mapped to c + A*p and a normal
+	// n to B*n (normalized), where A and B are given by their columns. The mesh 
+	// must be created with normals and colors.
+	void AddToMesh(GLTriMesh& mesh, const vec3f& c, const vec3f A[3], const vec3f B[3], const GLColor& col) const;
+
+public:
+	// Calculate the columns of a rotation that maps the z-axis to the direction of v.
+	static void RotateZTo(const vec3f& v, vec3f R[3]);
+
+private:
+	void AddTriangle(const Vertex& a, const Vertex& b, const Vertex& c);
+
+private:
+	std::vector<Vertex>	m_vert;	// three vertices per triangle
+};
+
+//-----------------------------------------------------------------------------
+// Keeps track of the items (nodes, faces or elements) and positions of the glyphs
+// in a plot's glyph mesh, so that the mesh is only rebuilt when the glyphs change.
+// The items are only collected again when the plot was invalidated, or when the
+// mesh or its revision (which changes with visibility and node positions) changed.
+class GLGlyphCache
+{
+public:
+	GLGlyphCache() {}
+
+	// force the items to be collected and the glyph mesh to be rebuilt
+	void Invalidate() { m_bupdate = true; }
+
+	// Returns true if the glyph mesh needs to be rebuilt. The function collect(items, pos)
+	// is only called when the glyph items may have changed.
+	template <class Collect>
+	bool Update(const void* mesh, int meshRevision, float scale, Collect collect)
+	{
+		bool rebuild = m_bupdate || (scale != m_scale);
+		if (m_bupdate || (mesh != m_mesh) || (meshRevision != m_meshRev))
+		{
+			std::vector<int> items;
+			std::vector<vec3f> pos;
+			collect(items, pos);
+			if (rebuild || !SameGlyphs(items, pos))
+			{
+				m_item.swap(items);
+				m_pos.swap(pos);
+				rebuild = true;
+			}
+			m_mesh = mesh;
+			m_meshRev = meshRevision;
+		}
+		m_scale = scale;
+		m_bupdate = false;
+		return rebuild;
+	}
+
+	size_t Glyphs() const { return m_item.size(); }
+
+	int Item(size_t i) const { return m_item[i]; }
+	const vec3f& Position(size_t i) const { return m_pos[i]; }
+
+private:
+	bool SameGlyphs(const std::vector<int>& items, const std::vector<vec3f>& pos) const
+	{
+		if (items != m_item) return false;
+		for (size_t i = 0; i < pos.size(); ++i)
+		{
+			const vec3f& a = pos[i];
+			const vec3f& b = m_pos[i];
+			if ((a.x != b.x) || (a.y != b.y) || (a.z != b.z)) return false;
+		}
+		return true;
+	}
+
+private:
+	std::vector<int>	m_item;				// items of the glyphs in the mesh
+	std::vector<vec3f>	m_pos;				// positions of the glyphs in the mesh
+	float				m_scale = 0.f;		// scale factor used for the glyph mesh
+	bool				m_bupdate = true;	// glyphs need to be collected and rebuilt
+	const void*			m_mesh = nullptr;	// mesh the items were collected from
+	int					m_meshRev = -1;		// revision of that mesh
+};
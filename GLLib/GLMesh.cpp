@@ -118,6 +118,10 @@ void GLMesh::BeginMesh()
 {
 	m_vertexCount = 0;
 	m_bvalid = false;
+
+	// any index list is no longer valid
+	if (m_ind) { delete[] m_ind; m_ind = nullptr; }
+	m_useIndices = false;
 }
 
 void GLMesh::EndMesh()
@@ -227,7 +231,9 @@ void GLMesh::RenderVBO()
 	if (m_initVBO == false) return;
 
 	glEnableClientState(GL_VERTEX_ARRAY);
-	if (m_flags & FLAG_NORMAL) glEnableClientState(GL_NORMAL_ARRAY);
+	if (m_flags & FLAG_NORMAL ) glEnableClientState(GL_NORMAL_ARRAY);
+	if (m_flags & FLAG_TEXTURE) glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	if (m_flags & FLAG_COLOR  ) glEnableClientState(GL_COLOR_ARRAY);
 
 	glBindBuffer(GL_ARRAY_BUFFER, m_vbo[VERTEX_DATA]);
 	glVertexPointer(3, GL_FLOAT, 0, 0);
@@ -260,7 +266,9 @@ void GLMesh::RenderVBO()
 	if (m_useIndices) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
 	glDisableClientState(GL_VERTEX_ARRAY);
-	if (m_flags & FLAG_NORMAL) glDisableClientState(GL_NORMAL_ARRAY);
+	if (m_flags & FLAG_NORMAL ) glDisableClientState(GL_NORMAL_ARRAY);
+	if (m_flags & FLAG_TEXTURE) glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	if (m_flags & FLAG_COLOR  ) glDisableClientState(GL_COLOR_ARRAY);
 }
 
 void GLMesh::InitVBO()
@@ -317,7 +325,7 @@ void GLMesh::InitVBO()
 }
 
 //===================================================================================
-GLTriMesh::GLTriMesh() : GLMesh(GL_TRIANGLES) {}
+GLTriMesh::GLTriMesh() : GLMesh(GL_TRIANGLES) { m_bzsorted = false; }
 
 void GLTriMesh::Create(size_t maxTriangles, unsigned int flags)
 {
@@ -330,44 +338,43 @@ void GLTriMesh::ZSortFaces(const CGLCamera& cam)
 	if (m_renderMode == VBOMode) return;
 
 	if (m_bvalid == false) return;
-	m_bvalid = false;
-	delete[] m_ind;
 
 	unsigned int faces = m_vertexCount / 3; assert((m_vertexCount % 3) == 0);
 
-	// first, build a list of faces
-	vec3d r[3];
-	std::vector<pair<double, int> > zmap(faces);
-	for (int i = 0; i < faces; ++i)
-	{
-		r[0] = vec3d(m_vr[9 * i], m_vr[9 * i + 1], m_vr[9 * i + 2]);
-		r[1] = vec3d(m_vr[9 * i + 3], m_vr[9 * i + 4], m_vr[9 * i + 5]);
-		r[2] = vec3d(m_vr[9 * i + 6], m_vr[9 * i + 7], m_vr[9 * i + 8]);
+	// If the faces were already sorted and the vertex data didn't change (which
+	// would have cleared m_ind), we only need to re-sort when the view direction changed.
+	if (m_bzsorted && m_ind && (m_zsort.Size() == faces) && !m_zsort.ViewChanged(cam)) return;
 
-		// get the face center
-		vec3d o = (r[0] + r[1] + r[2]) / 3.0;
+	m_bvalid = false;
+	delete[] m_ind;
 
-		// convert to eye coordinates
+	// calculate the depth of the face centers in eye coordinates
+	m_zsort.Resize(faces);
+	const float* vr = m_vr;
+#pragma omp parallel for
+	for (int i = 0; i < (int)faces; ++i)
+	{
+		const float* v = vr + 9 * i;
+		vec3d o((v[0] + v[3] + v[6]) / 3.0, (v[1] + v[4] + v[7]) / 3.0, (v[2] + v[5] + v[8]) / 3.0);
 		vec3d q = cam.WorldToCam(o);
-
-		// add it to the z-list
-		zmap[i] = pair<double, int>(q.z, i);
+		m_zsort.SetDepth(i, (float)q.z);
 	}
 
 	// sort it
-	std::sort(zmap.begin(), zmap.end(), [](const pair<double, int>& a, const pair<double, int>& b) { return a.first < b.first; });
+	const std::vector<unsigned int>& order = m_zsort.Sort();
+	m_zsort.SetView(cam);
 
 	// build the new index list
 	m_ind = new unsigned int[3 * faces];
-	std::vector< pair<double, int> >::iterator it = zmap.begin();
-	for (int i = 0; i < faces; ++i, ++it)
+	for (int i = 0; i < (int)faces; ++i)
 	{
-		int n = it->second;
+		unsigned int n = order[i];
 		m_ind[3 * i] = 3 * n;
 		m_ind[3 * i + 1] = 3 * n + 1;
 		m_ind[3 * i + 2] = 3 * n + 2;
 	}
 	m_useIndices = true;
+	m_bzsorted = true;
 	m_bvalid = true;
 }
 
@@ -378,6 +385,7 @@ void GLTriMesh::SortBackwards()
 
 	if (m_bvalid == false) return;
 	m_bvalid = false;
+	m_bzsorted = false;
 	delete[] m_ind;
 
 	unsigned int faces = m_vertexCount / 3; assert((m_vertexCount % 3) == 0);
@@ -403,6 +411,7 @@ void GLTriMesh::SortForwards()
 
 	if (m_bvalid == false) return;
 	m_bvalid = false;
+	m_bzsorted = false;
 	delete[] m_ind;
 	m_ind = nullptr;
 	m_useIndices = false;
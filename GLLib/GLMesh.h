@@ -26,6 +26,7 @@ SOFTWARE.*/
 #pragma once
 #include <FSCore/math3d.h>
 #include <FSCore/color.h>
+#include "GLZSort.h"
 
 class GMesh;
 class CGLCamera;
@@ -274,6 +275,10 @@ public:
 	// sort backwards/forwards
 	void SortBackwards();
 	void SortForwards();
+
+private:
+	GLZSorter	m_zsort;
+	bool		m_bzsorted;	// is the index list from ZSortFaces?
 };
 
 inline void GLTriMesh::AddTriangle(const vec3d& r0, const vec3d& r1, const vec3d& r2)
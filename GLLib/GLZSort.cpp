@@ -0,0 +1,191 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "GLZSort.h"
+#include "GLCamera.h"
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Changes in view direction smaller than this (roughly 0.25 degrees) do not trigger a re-sort
+const double VIEW_TOLERANCE = 0.99999;
+
+// below this number of items the sort is not split over threads
+const size_t MIN_PARALLEL_ITEMS = 65536;
+
+//-----------------------------------------------------------------------------
+// Convert a float to an unsigned int that has the same sort order
+static inline unsigned int floatKey(float f)
+{
+	unsigned int u;
+	memcpy(&u, &f, sizeof(float));
+	return (u & 0x80000000u ? ~u : u | 0x80000000u);
+}
+
+//-----------------------------------------------------------------------------
+GLZSorter::GLZSorter()
+{
+	m_bview = false;
+}
+
+//-----------------------------------------------------------------------------
+void GLZSorter::Resize(size_t n)
+{
+	m_key.resize(n);
+	m_order.resize(n);
+	m_tmpKey.resize(n);
+	m_tmpOrder.resize(n);
+}
+
+//-----------------------------------------------------------------------------
+void GLZSorter::SetDepth(size_t i, float z)
+{
+	// (adding zero turns -0 into +0, so both get the same key)
+	m_key[i] = floatKey(z + 0.0f);
+}
+
+//-----------------------------------------------------------------------------
+// LSD radix sort of the keys, using 8 bits per pass. Each thread histograms and
+// scatters a contiguous block of items, which keeps the sort stable.
+const std::vector<unsigned int>& GLZSorter::Sort()
+{
+	size_t n = m_key.size();
+	for (size_t i = 0; i < n; ++i) m_order[i] = (unsigned int)i;
+	if (n < 2) return m_order;
+
+	int nt = 1;
+#ifdef _OPENMP
+	if (n >= MIN_PARALLEL_ITEMS) nt = omp_get_max_threads();
+#endif
+	m_hist.assign(256 * nt, 0);
+
+	unsigned int* key = m_key.data();
+	unsigned int* ord = m_order.data();
+	unsigned int* tmpKey = m_tmpKey.data();
+	unsigned int* tmpOrd = m_tmpOrder.data();
+	unsigned int* hist = m_hist.data();
+
+	for (int pass = 0; pass < 4; ++pass)
+	{
+		int shift = 8 * pass;
+
+		// count the digits of each block
+#pragma omp parallel for num_threads(nt) schedule(static,1)
+		for (int t = 0; t < nt; ++t)
+		{
+			unsigned int* h = hist + 256 * t;
+			for (int j = 0; j < 256; ++j) h[j] = 0;
+			size_t i0 = (n * t) / nt;
+			size_t i1 = (n * (t + 1)) / nt;
+			for (size_t i = i0; i < i1; ++i) h[(key[i] >> shift) & 0xFF]++;
+		}
+
+		// convert to offsets (in digit-major, block-minor order)
+		unsigned int offset = 0;
+		bool skip = false;
+		for (int j = 0; j < 256; ++j)
+		{
+			unsigned int count = 0;
+			for (int t = 0; t < nt; ++t)
+			{
+				unsigned int c = hist[256 * t + j];
+				hist[256 * t + j] = offset + count;
+				count += c;
+			}
+			if (count == n) { skip = true; break; }
+			offset += count;
+		}
+
+		// all keys have the same digit, so this pass won't change the order
+		if (skip) continue;
+
+		// scatter
+#pragma omp parallel for num_threads(nt) schedule(static,1)
+		for (int t = 0; t < nt; ++t)
+		{
+			unsigned int* h = hist + 256 * t;
+			size_t i0 = (n * t) / nt;
+			size_t i1 = (n * (t + 1)) / nt;
+			for (size_t i = i0; i < i1; ++i)
+			{
+				unsigned int k = key[i];
+				unsigned int m = h[(k >> shift) & 0xFF]++;
+				tmpKey[m] = k;
+				tmpOrd[m] = ord[i];
+			}
+		}
+
+		unsigned int* p = key; key = tmpKey; tmpKey = p;
+		p = ord; ord = tmpOrd; tmpOrd = p;
+	}
+
+	// make sure the results end up in the member buffers
+	if (key != m_key.data())
+	{
+		m_key.swap(m_tmpKey);
+		m_order.swap(m_tmpOrder);
+	}
+
+	return m_order;
+}
+
+//-----------------------------------------------------------------------------
+// The camera z-coordinate is an affine function of the world position, so its
+// gradient determines the depth order.
+static vec3d viewDirection(const CGLCamera& cam)
+{
+	double z0 = cam.WorldToCam(vec3d(0, 0, 0)).z;
+	vec3d v;
+	v.x = cam.WorldToCam(vec3d(1, 0, 0)).z - z0;
+	v.y = cam.WorldToCam(vec3d(0, 1, 0)).z - z0;
+	v.z = cam.WorldToCam(vec3d(0, 0, 1)).z - z0;
+	v.unit();
+	return v;
+}
+
+//-----------------------------------------------------------------------------
+bool GLZSorter::ViewChanged(const CGLCamera& cam) const
+{
+	if (m_bview == false) return true;
+	vec3d v = viewDirection(cam);
+	return (v*m_view < VIEW_TOLERANCE);
+}
+
+//-----------------------------------------------------------------------------
+void GLZSorter::SetView(const CGLCamera& cam)
+{
+	m_view = viewDirection(cam);
+	m_bview = true;
+}
+
+//-----------------------------------------------------------------------------
+void GLZSorter::Invalidate()
+{
+	m_bview = false;
+}
@@ -0,0 +1,81 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include <FSCore/math3d.h>
+#include <vector>
+
+class CGLCamera;
+
+//-----------------------------------------------------------------------------
+// Sorts items (e.g. faces) from back to front for rendering transparent geometry.
+// The depth keys are stored in a flat array and sorted with a (parallel) radix sort.
+// Items with the same depth keep their original order. The buffers are reused
+// between calls, so that sorting every frame does not allocate any memory.
+class GLZSorter
+{
+public:
+	GLZSorter();
+
+	// prepare for sorting n items. The depth of each item must then be set with SetDepth.
+	void Resize(size_t n);
+
+	// number of items
+	size_t Size() const { return m_key.size(); }
+
+	// set the (camera-space) depth of item i. Thread-safe for different items.
+	void SetDepth(size_t i, float z);
+
+	// sort the items from back to front (i.e. increasing camera z) and return the sorted item indices
+	const std::vector<unsigned int>& Sort();
+
+	// the sorted item indices of the last call to Sort
+	const std::vector<unsigned int>& SortedItems() const { return m_order; }
+
+public:
+	// Returns true if the view direction changed since the last call to SetView.
+	// Only the direction matters, since camera translations don't change the depth order.
+	bool ViewChanged(const CGLCamera& cam) const;
+
+	// store the current view direction of the camera
+	void SetView(const CGLCamera& cam);
+
+	// forget the stored view direction, so that ViewChanged returns true
+	void Invalidate();
+
+private:
+	std::vector<unsigned int>	m_key;		// depth keys
+	std::vector<unsigned int>	m_order;	// sorted item indices
+
+	// temporary buffers
+	std::vector<unsigned int>	m_tmpKey;
+	std::vector<unsigned int>	m_tmpOrder;
+	std::vector<unsigned int>	m_hist;
+
+	vec3d	m_view;		// view direction of last sort
+	bool	m_bview;	// is m_view valid?
+};
@@ -184,7 +184,7 @@ GSurfaceMeshObject::GSurfaceMeshObject(GObject* po) : GObject(GSURFACEMESH_OBJEC
 			int n1 = pm->Node(src.n[1]).m_ntag;
 
 			FSEdge* pe = nullptr;
-			const std::vector<int>& el = NEL.EdgeIndexList(n0);
+			FSAdjacencyRange<int> el = NEL.EdgeIndexList(n0);
 			for (int k = 0; k < el.size(); ++k)
 			{
 				FSEdge& e = m_surfmesh->Edge(el[k]);
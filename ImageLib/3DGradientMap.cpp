@@ -26,56 +26,219 @@ SOFTWARE.*/
 
 #include "stdafx.h"
 #include "3DGradientMap.h"
+#include <limits>
+
+//-----------------------------------------------------------------------------
+// Calculates the gradient at voxel (i,j,k) in voxel units. Central differences
+// are used in the interior and one-sided differences at the boundary.
+template<class pType> static inline void voxelGradient(const pType* data, int nx, int ny, int nz, int i, int j, int k, float g[3])
+{
+	const size_t sy = (size_t)nx;
+	const size_t sz = (size_t)nx*ny;
+	const size_t n = sz*k + sy*j + i;
+
+	// x-component
+	if (nx == 1) g[0] = 0.f;
+	else if (i == 0) g[0] = (float)data[n + 1] - (float)data[n];
+	else if (i == nx - 1) g[0] = (float)data[n] - (float)data[n - 1];
+	else g[0] = ((float)data[n + 1] - (float)data[n - 1]) * 0.5f;
+
+	// y-component
+	if (ny == 1) g[1] = 0.f;
+	else if (j == 0) g[1] = (float)data[n + sy] - (float)data[n];
+	else if (j == ny - 1) g[1] = (float)data[n] - (float)data[n - sy];
+	else g[1] = ((float)data[n + sy] - (float)data[n - sy]) * 0.5f;
+
+	// z-component
+	if (nz == 1) g[2] = 0.f;
+	else if (k == 0) g[2] = (float)data[n + sz] - (float)data[n];
+	else if (k == nz - 1) g[2] = (float)data[n] - (float)data[n - sz];
+	else g[2] = ((float)data[n + sz] - (float)data[n - sz]) * 0.5f;
+}
 
 //=============================================================================
 // C3DGradientMap
 //=============================================================================
 
-C3DGradientMap::C3DGradientMap(C3DImage& im, BOX box) : m_im(im), m_box(box)
+C3DGradientMap::C3DGradientMap(C3DImage& im, BOX box, int storage) : m_im(im), m_box(box), m_storage(storage)
 {
-
+	m_pb = nullptr;
+	m_nx = m_ny = m_nz = 0;
+	m_pixelType = -1;
+	m_qscale = 1.f;
+	SetBoundingBox(box);
 }
 
 C3DGradientMap::~C3DGradientMap()
 {
 }
 
-template<class pType> vec3f C3DGradientMap::ValueTemplate(int i, int j, int k)
+void C3DGradientMap::SetStorage(int storage)
 {
-    pType* data = (pType*)m_im.GetBytes();
+	if (storage != m_storage) Invalidate();
+	m_storage = storage;
+}
 
-    // get the image dimensions
+void C3DGradientMap::SetBoundingBox(const BOX& box)
+{
+	m_box = box;
+
+	// the stored gradients are in voxel units, so this only changes the scale factors
 	int nx = m_im.Width();
 	int ny = m_im.Height();
 	int nz = m_im.Depth();
 
-	float dxi = (nx - 1.f) / (float)m_box.Width();
-	float dyi = (ny - 1.f) / (float)m_box.Height();
-	float dzi = (nz - 1.f) / (float)m_box.Depth();
+	float q = (m_storage == INT16 ? 1.f / m_qscale : 1.f);
+	m_scale[0] = q * (nx - 1.f) / (float)m_box.Width();
+	m_scale[1] = q * (ny - 1.f) / (float)m_box.Height();
+	m_scale[2] = q * (nz - 1.f) / (float)m_box.Depth();
+}
 
-    // calculate the gradient
-	vec3f r;
+void C3DGradientMap::Invalidate()
+{
+	m_gradf.clear(); m_gradf.shrink_to_fit();
+	m_gradq.clear(); m_gradq.shrink_to_fit();
+	m_pb = nullptr;
+	m_nx = m_ny = m_nz = 0;
+	m_pixelType = -1;
+}
 
-    // x-component
-	if (i == 0) r.x = ((float)data[nx*(k*ny + j) + i + 1] - (float)data[nx*(k*ny + j) + i]) * dxi;
-	else if (i == nx - 1) r.x = ((float)data[nx*(k*ny + j) + i] - (float)data[nx*(k*ny + j) + i - 1]) * dxi;
-	else r.x = ((float)data[nx*(k*ny + j) + i + 1] - (float)data[nx*(k*ny + j) + i - 1]) * (0.5f*dxi);
+int C3DGradientMap::StorageForBudget(C3DImage& im, size_t maxBytes)
+{
+	size_t voxels = (size_t)im.Width() * (size_t)im.Height() * (size_t)im.Depth();
+	if (voxels * 3 * sizeof(float) <= maxBytes) return FLOAT;
+	if (voxels * 3 * sizeof(int16_t) <= maxBytes) return INT16;
+	return ON_THE_FLY;
+}
 
-	// y-component
-	if (j == 0) r.y = ((float)data[nx*(k*ny + j + 1) + i] - (float)data[nx*(k*ny + j) + i]) * dyi;
-	else if (j == ny - 1) r.y = ((float)data[nx*(k*ny + j) + i] - (float)data[nx*(k*ny + j - 1) + i]) * dyi;
-	else r.y = ((float)data[nx*(k*ny + j + 1) + i] - (float)data[nx*(k*ny + j - 1) + i]) * (0.5f*dyi);
+void C3DGradientMap::Update()
+{
+	if (m_storage == ON_THE_FLY)
+	{
+		Invalidate();
+		SetBoundingBox(m_box);
+		return;
+	}
 
-	// z-component
-	if (k == 0) r.z = ((float)data[nx*((k + 1)*ny + j) + i] - (float)data[nx*(k*ny + j) + i]) * dzi;
-	else if (k == nz - 1) r.z = ((float)data[nx*(k*ny + j) + i] - (float)data[nx*((k - 1)*ny + j) + i]) * dzi;
-	else r.z = ((float)data[nx*((k + 1)*ny + j) + i] - (float)data[nx*((k - 1)*ny + j) + i]) * (0.5f*dzi);
+	// see if the image has changed
+	if ((m_pb == m_im.GetBytes()) && (m_nx == m_im.Width()) && (m_ny == m_im.Height()) && (m_nz == m_im.Depth()) && (m_pixelType == m_im.PixelType()))
+	{
+		if (!m_gradf.empty() || !m_gradq.empty()) return;
+	}
 
-    return r;
+	Invalidate();
+	if (m_im.GetBytes() == nullptr) return;
+
+	switch (m_im.PixelType())
+	{
+	case CImage::UINT_8    : BuildTemplate<uint8_t >(); break;
+	case CImage::INT_8     : BuildTemplate<int8_t  >(); break;
+	case CImage::UINT_16   : BuildTemplate<uint16_t>(); break;
+	case CImage::INT_16    : BuildTemplate<int16_t >(); break;
+	case CImage::UINT_32   : BuildTemplate<uint32_t>(); break;
+	case CImage::INT_32    : BuildTemplate<int32_t >(); break;
+	case CImage::UINT_RGB8 : BuildTemplate<uint8_t >(); break;
+	case CImage::INT_RGB8  : BuildTemplate<int8_t  >(); break;
+	case CImage::UINT_RGB16: BuildTemplate<uint16_t>(); break;
+	case CImage::INT_RGB16 : BuildTemplate<int16_t >(); break;
+	case CImage::REAL_32   : BuildTemplate<float   >(); break;
+	case CImage::REAL_64   : BuildTemplate<double  >(); break;
+	default:
+		assert(false);
+		return;
+	}
+
+	m_pb = m_im.GetBytes();
+	m_nx = m_im.Width();
+	m_ny = m_im.Height();
+	m_nz = m_im.Depth();
+	m_pixelType = m_im.PixelType();
+
+	SetBoundingBox(m_box);
+}
+
+template<class pType> void C3DGradientMap::BuildTemplate()
+{
+	const pType* data = (const pType*)m_im.GetBytes();
+
+	int nx = m_im.Width();
+	int ny = m_im.Height();
+	int nz = m_im.Depth();
+	size_t N = (size_t)nx * (size_t)ny * (size_t)nz;
+
+	if (m_storage == FLOAT)
+	{
+		m_gradf.resize(3 * N);
+		float* pg = m_gradf.data();
+
+		#pragma omp parallel for schedule(dynamic)
+		for (int k = 0; k < nz; ++k)
+		{
+			float* g = pg + 3 * (size_t)nx * ny * k;
+			for (int j = 0; j < ny; ++j)
+				for (int i = 0; i < nx; ++i, g += 3) voxelGradient(data, nx, ny, nz, i, j, k, g);
+		}
+	}
+	else if (m_storage == INT16)
+	{
+		// The components can't be larger than the image range, 
+		// so that is mapped to the range of a 16-bit integer.
+		double vmin, vmax;
+		m_im.GetMinMax(vmin, vmax);
+		double range = vmax - vmin;
+		m_qscale = (range > 0 ? (float)(std::numeric_limits<int16_t>::max() / range) : 1.f);
+		const float qmax = (float)std::numeric_limits<int16_t>::max();
+		const float qs = m_qscale;
+
+		m_gradq.resize(3 * N);
+		int16_t* pq = m_gradq.data();
+
+		#pragma omp parallel for schedule(dynamic)
+		for (int k = 0; k < nz; ++k)
+		{
+			int16_t* q = pq + 3 * (size_t)nx * ny * k;
+			float g[3];
+			for (int j = 0; j < ny; ++j)
+				for (int i = 0; i < nx; ++i, q += 3)
+				{
+					voxelGradient(data, nx, ny, nz, i, j, k, g);
+					for (int l = 0; l < 3; ++l)
+					{
+						float v = g[l] * qs;
+						if (v > qmax) v = qmax; else if (v < -qmax) v = -qmax;
+						q[l] = (int16_t)(v < 0 ? v - 0.5f : v + 0.5f);
+					}
+				}
+		}
+	}
+}
+
+template<class pType> vec3f C3DGradientMap::ValueTemplate(int i, int j, int k)
+{
+	float g[3];
+	voxelGradient((const pType*)m_im.GetBytes(), m_im.Width(), m_im.Height(), m_im.Depth(), i, j, k, g);
+
+	float dxi = (m_im.Width () - 1.f) / (float)m_box.Width();
+	float dyi = (m_im.Height() - 1.f) / (float)m_box.Height();
+	float dzi = (m_im.Depth () - 1.f) / (float)m_box.Depth();
+
+	return vec3f(g[0] * dxi, g[1] * dyi, g[2] * dzi);
 }
 
 vec3f C3DGradientMap::Value(int i, int j, int k)
 {
+	// use the precomputed gradient if it is available
+	if (!m_gradf.empty())
+	{
+		const float* g = &m_gradf[3 * ((size_t)m_nx * ((size_t)k * m_ny + j) + i)];
+		return vec3f(g[0] * m_scale[0], g[1] * m_scale[1], g[2] * m_scale[2]);
+	}
+	else if (!m_gradq.empty())
+	{
+		const int16_t* q = &m_gradq[3 * ((size_t)m_nx * ((size_t)k * m_ny + j) + i)];
+		return vec3f(q[0] * m_scale[0], q[1] * m_scale[1], q[2] * m_scale[2]);
+	}
+
 	switch (m_im.PixelType())
     {
     case CImage::UINT_8:
@@ -87,9 +250,9 @@ vec3f C3DGradientMap::Value(int i, int j, int k)
     case CImage::INT_16:
         return ValueTemplate<int16_t>(i, j, k);
     case CImage::UINT_32:
-        return ValueTemplate<uint16_t>(i, j, k);
+        return ValueTemplate<uint32_t>(i, j, k);
     case CImage::INT_32:
-        return ValueTemplate<int16_t>(i, j, k);
+        return ValueTemplate<int32_t>(i, j, k);
     case CImage::UINT_RGB8:
         return ValueTemplate<uint8_t>(i, j, k);
     case CImage::INT_RGB8:
@@ -27,15 +27,43 @@ SOFTWARE.*/
 #pragma once
 #include "3DImage.h"
 #include <FSCore/box.h>
+#include <vector>
 
 //-----------------------------------------------------------------------------
-//! A class for calculating gradient data on a 3D image
+//! A class for calculating gradient data on a 3D image.
+//! The gradient can be calculated on the fly, or it can be precomputed for
+//! all voxels, which is faster when the same voxels are evaluated repeatedly
+//! (e.g. by the marching cubes algorithm) but requires additional memory.
 class C3DGradientMap
 {
 public:
-	C3DGradientMap(C3DImage& im, BOX box);
+	enum Storage {
+		ON_THE_FLY,		// calculate the gradient when it is requested (no extra memory)
+		FLOAT,			// precomputed, three floats per voxel (12 bytes per voxel)
+		INT16			// precomputed, quantized to three 16-bit integers per voxel (6 bytes per voxel)
+	};
+
+public:
+	C3DGradientMap(C3DImage& im, BOX box, int storage = ON_THE_FLY);
 	~C3DGradientMap();
 
+	void SetStorage(int storage);
+	int GetStorage() const { return m_storage; }
+
+	void SetBoundingBox(const BOX& box);
+
+	// Build the precomputed gradient if the image has changed since it was last built.
+	// This must be called before Value is used with precomputed storage.
+	// (Callers that modify the image data in place must call Invalidate first.)
+	void Update();
+
+	// clear the precomputed gradient
+	void Invalidate();
+
+	// the precomputed storage that fits in the memory budget. 
+	// (Falls back to ON_THE_FLY if neither FLOAT nor INT16 fits.)
+	static int StorageForBudget(C3DImage& im, size_t maxBytes);
+
 	// get a vector value
 	vec3f Value(int i, int j, int k);
 
@@ -43,8 +71,23 @@ private:
     template<class pType>
     vec3f ValueTemplate(int i, int j, int k);
 
+    template<class pType>
+    void BuildTemplate();
+
 private:
 	C3DImage&	m_im;
 	BOX	m_box;
-};
+	int	m_storage;
 
+	// the precomputed gradient (in voxel units)
+	std::vector<float>		m_gradf;
+	std::vector<int16_t>	m_gradq;
+
+	float	m_scale[3];	// converts stored values to physical gradients
+
+	// the image the precomputed gradient was built for
+	uint8_t*	m_pb;
+	int			m_nx, m_ny, m_nz;
+	int			m_pixelType;
+	float		m_qscale;	// quantization scale
+};
@@ -26,12 +26,14 @@ SOFTWARE.*/
 
 #include "stdafx.h"
 #include "3DImage.h"
+#include "ImageStatistics.h"
 #include <stdio.h>
 #include <math.h>
 #include <memory>
 #include <cstring>
 #include <string>
 #include <algorithm>
+#include <limits>
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -42,6 +44,7 @@ C3DImage::C3DImage() : m_pb(nullptr), m_cx(0), m_cy(0), m_cz(0), m_bps(1),
 {
 	m_maxValue = 1;
 	m_minValue = 0;
+	m_stats = nullptr;
 }
 
 C3DImage::~C3DImage()
@@ -51,6 +54,7 @@ C3DImage::~C3DImage()
 
 void C3DImage::CleanUp()
 {
+	Modified();
 	if(m_pb) delete [] m_pb;
 	m_pb = nullptr;
 	m_cx = m_cy = m_cz = 0;
@@ -62,6 +66,9 @@ bool C3DImage::Create(int nx, int ny, int nz, uint8_t* data, int pixelType)
     if(nx*ny*nz == 0)
       return false;
 
+	// the image data will change, so the pyramid and statistics are no longer valid
+	Modified();
+
 	// reallocate data if necessary
 	if ((nx*ny*nz != m_cx*m_cy*m_cz) || (m_pixelType != pixelType))
 	{
@@ -900,87 +907,37 @@ void C3DImage::GetSampledSliceZ(CImage& im, double f)
     }
 }
 
-template <class pType> void C3DImage::CalcMinMaxValue()
+void C3DImage::GetMinMax(double& min, double& max, bool recalc)
 {
-    size_t N  = m_cx*m_cy*m_cz;
-    if(IsRGB())
-    {
-        N *= 3;
-    }
-
-    pType* data = (pType*)m_pb;
-
-    double maxValue = data[0], minValue = data[0];
-    #pragma omp parallel shared(maxValue, minValue) firstprivate(data)
+	if (recalc)
 	{
-		double threadMax = data[0], threadMin = data[0];
-        #pragma omp for
-		for (int i = 0; i < N; ++i)
+		const CImageStatistics& stats = GetStatistics();
+		if (stats.count > 0)
 		{
-			if (data[i] > threadMax) threadMax = data[i];
-			if (data[i] < threadMin) threadMin = data[i];
-		}
-        
-        #pragma omp critical
-		{
-			if (threadMax > maxValue) maxValue = threadMax;
-			if (threadMin < minValue) minValue = threadMin;
+			m_minValue = stats.min;
+			m_maxValue = stats.max;
 		}
 	}
 
-	m_maxValue = maxValue;
-	m_minValue = minValue;
+	min = m_minValue;
+	max = m_maxValue;
 }
 
-void C3DImage::GetMinMax(double& min, double& max, bool recalc)
+const CImageStatistics& C3DImage::GetStatistics()
 {
-    if(recalc)
-    {
-        switch (m_pixelType)
-        {
-        case CImage::UINT_8:
-            CalcMinMaxValue<uint8_t>();
-            break;
-        case CImage::INT_8:
-            CalcMinMaxValue<int8_t>();
-            break;
-        case CImage::UINT_16:
-            CalcMinMaxValue<uint16_t>();
-            break;
-        case CImage::INT_16:
-            CalcMinMaxValue<int16_t>();
-            break;
-        case CImage::UINT_32:
-            CalcMinMaxValue<uint32_t>();
-            break;
-        case CImage::INT_32:
-            CalcMinMaxValue<int32_t>();
-            break;
-        case CImage::UINT_RGB8:
-            CalcMinMaxValue<uint8_t>();
-            break;
-        case CImage::INT_RGB8:
-            CalcMinMaxValue<int8_t>();
-            break;
-        case CImage::UINT_RGB16:
-            CalcMinMaxValue<uint16_t>();
-            break;
-        case CImage::INT_RGB16:
-            CalcMinMaxValue<int16_t>();
-            break;
-        case CImage::REAL_32:
-            CalcMinMaxValue<float>();
-            break;
-        case CImage::REAL_64:
-            CalcMinMaxValue<double>();
-            break;
-        default:
-            assert(false);
-        }
-    }
+	if (m_stats == nullptr)
+	{
+		m_stats = new CImageStatistics;
+		m_stats->Calculate(*this);
+	}
+	return *m_stats;
+}
 
-    min = m_minValue;
-    max = m_maxValue;
+void C3DImage::Modified()
+{
+	ClearLevels();
+	delete m_stats;
+	m_stats = nullptr;
 }
 
 template <class pType> void C3DImage::ZeroTemplate(int channels)
@@ -993,6 +950,7 @@ template <class pType> void C3DImage::ZeroTemplate(int channels)
 
 void C3DImage::Zero()
 {
+	Modified();
     switch (m_pixelType)
     {
     case CImage::UINT_8:
@@ -1034,4 +992,144 @@ void C3DImage::Zero()
     default:
         assert(false);
     }
-}
\ No newline at end of file
+}
+
+//-----------------------------------------------------------------------------
+// size of a dimension at a pyramid level
+static int levelSize(int n, int level)
+{
+	if (n <= 1) return n;
+	return ((n - 1) >> level) + 1;
+}
+
+int C3DImage::Levels() const
+{
+	int nmax = std::max({ m_cx, m_cy, m_cz });
+	if (nmax <= 0) return 0;
+
+	// add levels until all dimensions are one
+	int levels = 1;
+	while (nmax > 1) { nmax = (nmax + 1) / 2; levels++; }
+	return levels;
+}
+
+int C3DImage::LevelForSize(int nx, int ny, int nz) const
+{
+	int levels = Levels();
+	for (int i = 0; i < levels; ++i)
+	{
+		if ((levelSize(m_cx, i) <= nx) && (levelSize(m_cy, i) <= ny) && (levelSize(m_cz, i) <= nz)) return i;
+	}
+	return (levels > 0 ? levels - 1 : 0);
+}
+
+int C3DImage::LevelForVoxels(size_t maxVoxels) const
+{
+	int levels = Levels();
+	for (int i = 0; i < levels; ++i)
+	{
+		size_t voxels = (size_t)levelSize(m_cx, i) * (size_t)levelSize(m_cy, i) * (size_t)levelSize(m_cz, i);
+		if (voxels <= maxVoxels) return i;
+	}
+	return (levels > 0 ? levels - 1 : 0);
+}
+
+C3DImage* C3DImage::GetLevel(int n)
+{
+	int levels = Levels();
+	if (n >= levels) n = levels - 1;
+	if (n <= 0) return this;
+
+	// build the missing levels from the finest one that is available
+	while ((int)m_levels.size() < n)
+	{
+		C3DImage* src = (m_levels.empty() ? this : m_levels.back());
+		C3DImage* im = src->CreateNextLevel();
+		if (im == nullptr) return src;
+		m_levels.push_back(im);
+	}
+
+	return m_levels[n - 1];
+}
+
+void C3DImage::ClearLevels()
+{
+	for (size_t i = 0; i < m_levels.size(); ++i) delete m_levels[i];
+	m_levels.clear();
+}
+
+// Averages blocks of 2x2x2 voxels. At odd dimensions, the last voxel is repeated.
+template <class pType> void C3DImage::Downsample(C3DImage& dst, int channels)
+{
+	int nx = dst.m_cx;
+	int ny = dst.m_cy;
+	int nz = dst.m_cz;
+
+	const pType* s = (const pType*)m_pb;
+	pType* d = (pType*)dst.m_pb;
+
+	size_t sx = (size_t)m_cx * channels;
+	size_t sxy = sx * m_cy;
+
+	#pragma omp parallel for
+	for (int k = 0; k < nz; ++k)
+	{
+		int k0 = std::min(2 * k, m_cz - 1), k1 = std::min(2 * k + 1, m_cz - 1);
+		for (int j = 0; j < ny; ++j)
+		{
+			int j0 = std::min(2 * j, m_cy - 1), j1 = std::min(2 * j + 1, m_cy - 1);
+			pType* dj = d + ((size_t)k * ny + j) * nx * channels;
+			for (int i = 0; i < nx; ++i)
+			{
+				int i0 = std::min(2 * i, m_cx - 1), i1 = std::min(2 * i + 1, m_cx - 1);
+				for (int c = 0; c < channels; ++c)
+				{
+					size_t a0 = k0 * sxy + j0 * sx + c;
+					size_t a1 = k0 * sxy + j1 * sx + c;
+					size_t a2 = k1 * sxy + j0 * sx + c;
+					size_t a3 = k1 * sxy + j1 * sx + c;
+					size_t b0 = (size_t)i0 * channels, b1 = (size_t)i1 * channels;
+					double v = (double)s[a0 + b0] + (double)s[a0 + b1] + (double)s[a1 + b0] + (double)s[a1 + b1]
+						     + (double)s[a2 + b0] + (double)s[a2 + b1] + (double)s[a3 + b0] + (double)s[a3 + b1];
+					v *= 0.125;
+					if (std::numeric_limits<pType>::is_integer) v = floor(v + 0.5);
+					dj[i * channels + c] = (pType)v;
+				}
+			}
+		}
+	}
+}
+
+C3DImage* C3DImage::CreateNextLevel()
+{
+	if ((m_pb == nullptr) || ((m_cx <= 1) && (m_cy <= 1) && (m_cz <= 1))) return nullptr;
+
+	C3DImage* im = new C3DImage;
+	if (im->Create(levelSize(m_cx, 1), levelSize(m_cy, 1), levelSize(m_cz, 1), nullptr, m_pixelType) == false)
+	{
+		delete im;
+		return nullptr;
+	}
+	im->m_box = m_box;
+	im->m_orientation = m_orientation;
+
+	switch (m_pixelType)
+	{
+	case CImage::UINT_8    : Downsample<uint8_t >(*im); break;
+	case CImage::INT_8     : Downsample<int8_t  >(*im); break;
+	case CImage::UINT_16   : Downsample<uint16_t>(*im); break;
+	case CImage::INT_16    : Downsample<int16_t >(*im); break;
+	case CImage::UINT_32   : Downsample<uint32_t>(*im); break;
+	case CImage::INT_32    : Downsample<int32_t >(*im); break;
+	case CImage::UINT_RGB8 : Downsample<uint8_t >(*im, 3); break;
+	case CImage::INT_RGB8  : Downsample<int8_t  >(*im, 3); break;
+	case CImage::UINT_RGB16: Downsample<uint16_t>(*im, 3); break;
+	case CImage::INT_RGB16 : Downsample<int16_t >(*im, 3); break;
+	case CImage::REAL_32   : Downsample<float   >(*im); break;
+	case CImage::REAL_64   : Downsample<double  >(*im); break;
+	default:
+		assert(false);
+	}
+
+	return im;
+}
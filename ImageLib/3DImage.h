@@ -27,8 +27,11 @@ SOFTWARE.*/
 #pragma once
 #include "Image.h"
 #include <string>
+#include <vector>
 #include <FSCore/box.h>
 
+class CImageStatistics;
+
 //-----------------------------------------------------------------------------
 // A class for representing 3D image stacks
 class C3DImage
@@ -72,12 +75,39 @@ public:
 	void GetSampledSliceZ(CImage& im, double f);
 
 	uint8_t* GetBytes() { return m_pb; }
-	void SetBytes(uint8_t* bytes) {m_pb = bytes; }
+	void SetBytes(uint8_t* bytes) { Modified(); m_pb = bytes; }
 
+	// The value range of the image. When recalc is true the range is taken from the 
+	// statistics (which are only calculated if they are not cached). Otherwise the 
+	// last range that was found is returned.
     void GetMinMax(double& min, double& max, bool recalc = true);
 
+	// Statistics of the image values. These are calculated when they are first 
+	// requested and are kept until the image data changes.
+	const CImageStatistics& GetStatistics();
+
+	// Drops the cached pyramid levels and statistics. Code that modifies the
+	// image buffer directly must call this when it is done.
+	void Modified();
+
 	void Zero();
 
+public:
+	// The multi-resolution pyramid of this image. Level 0 is the image itself and each 
+	// following level is downsampled by a factor of two in each direction. Levels are 
+	// built when they are first requested and are kept until the image data changes.
+	int Levels() const;
+	C3DImage* GetLevel(int n);
+
+	// the finest level whose dimensions do not exceed (nx, ny, nz)
+	int LevelForSize(int nx, int ny, int nz) const;
+
+	// the finest level that does not have more than maxVoxels voxels
+	int LevelForVoxels(size_t maxVoxels) const;
+
+	// delete the cached levels
+	void ClearLevels();
+
 private:
     template <class pType> 
     void CopySliceX(pType* dest, int n, int channels = 1);
@@ -98,10 +128,12 @@ private:
     void CopySampledSliceZ(pType* dest, double f, int channels = 1);
 
     template <class pType>
-    void CalcMinMaxValue();
+    void ZeroTemplate(int channels = 1);
 
     template <class pType>
-    void ZeroTemplate(int channels = 1);
+    void Downsample(C3DImage& dst, int channels = 1);
+
+	C3DImage* CreateNextLevel();
 
 protected:
 	uint8_t*	m_pb;	// image data
@@ -113,5 +145,8 @@ protected:
 
     BOX     m_box; // physical bounds
     mat3d m_orientation; // rotation matrix
+
+	std::vector<C3DImage*>	m_levels;	// cached pyramid levels (starting at level 1)
+	CImageStatistics*		m_stats;	// cached statistics (or null)
 };
 
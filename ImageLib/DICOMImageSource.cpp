@@ -27,6 +27,9 @@ SOFTWARE.*/
 #include "DICOMImageSource.h"
 #include <ImageLib/ImageModel.h>
 #include <ImageLib/3DImage.h>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
 
 #ifdef HAS_DCMTK
 #include <dcmtk/dcmimgle/dcmimage.h>
@@ -94,38 +97,39 @@ bool CDICOMImageSource::Load()
     BOX box(nx, ny, nz, nx+tempImage->getWidthHeightRatio(), ny+tempImage->getHeightWidthRatio(), nz+1.0);
     GetImageModel()->SetBoundingBox(box);
 
-    size_t size = nx*ny*nz*bps;
-    size_t sliceSize = nx*ny*bps;
-
-    uint8_t* data = new uint8_t[size];
-
-    const uint8_t* temp;
-
-    for(int file = 0; file < m_filenames.size(); file++)
-    {
-        auto dicomImage = std::make_unique<DicomImage>(m_filenames[file].c_str());
-        rawData = dicomImage->getInterData();
-
-        temp = static_cast<const uint8_t*>(rawData->getData());
-
-        for(size_t index = 0; index < sliceSize; index++)
-        {
-            data[file*sliceSize + index] = temp[index];
-        }
-
-    }
-    // memcpy(data, static_cast<const uint8_t*>(rawData->getData()), size);
+    const size_t sliceSize = nx*ny*bps;
+    const bool multiFrame = (m_filenames.size() == 1);
+    tempImage.reset();
 
     C3DImage* im = new C3DImage();
-    if (im->Create(nx, ny, nz, data, pixelType) == false)
+    if (im->Create(nx, ny, nz, nullptr, pixelType) == false)
     {
         delete im;
         return false;
     }
 
-    AssignImage(im);
+    // The slices are decoded concurrently, straight into the image buffer.
+    // For a multi-frame file, each slice is a frame; otherwise each slice is a file.
+    setCurrentTask("Reading DICOM slices ...");
+    return ReadSlices(im, [&](int n, uint8_t* dest) {
+
+        std::unique_ptr<DicomImage> dicomImage;
+        if (multiFrame)
+            dicomImage = std::make_unique<DicomImage>(m_filenames[0].c_str(), CIF_UsePartialAccessToPixelData, n, 1);
+        else
+            dicomImage = std::make_unique<DicomImage>(m_filenames[n].c_str());
+
+        const DiPixel* pixels = dicomImage->getInterData();
+        if (pixels == nullptr) return false;
+
+        if ((dicomImage->getWidth() != nx) || (dicomImage->getHeight() != ny) || (pixels->getRepresentation() != type))
+        {
+            throw std::runtime_error("All images in the stack must have the same pixel dimensions and type.");
+        }
 
-    return true;
+        std::memcpy(dest, pixels->getData(), sliceSize);
+        return true;
+    });
 }
 
 void CDICOMImageSource::Save(OArchive& ar)
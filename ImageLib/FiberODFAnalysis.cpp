@@ -40,6 +40,9 @@ SOFTWARE.*/
 #include <GLWLib/GLWidgetManager.h>
 #include <GLLib/glx.h>
 #include <FEBioOpt/FEBioOpt.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #ifdef min
 #undef min
@@ -119,40 +122,22 @@ public:
         return sum;
     }
 
-    // This function generates the ODF from the subvolume image
-    bool generateODF(CODF& odf, sitk::Image& img, int nsh)
+    // This function projects the power spectrum of the subvolume image onto the unit sphere. 
+    // The sphere points are found with the (shared) query. 
+    // Note that the image is overwritten with the filtered power spectrum
+    void reduceSubVolume(sitk::Image& img, const FSNNQuery& query, std::vector<double>& reduced, bool bprogress)
     {
         // process the image (apply butterworth and calculate power spectrum)
-        // Note that the image is overwritten with the filtered power spectrum
         processImage(img);
 
-        // allocate odf
-        odf.m_sphHarmonics.resize(nsh);
-
         // project image onto unit sphere
-        std::vector<double> reduced = std::vector<double>(NPTS, 0);
-        reduceAmp(img, reduced);
-
-        // see if user cancelled
-        if (parent->IsCanceled()) { parent->clear(); return false; }
-
-        // odf = A*B*reduced
-        vector<double> Bxr(parent->m_B.rows(), 0.0);
-        parent->m_B.mult(reduced, Bxr);
-        parent->m_A.mult(Bxr, odf.m_odf);
-        parent->updateProgressIncrement(0.75);
-
-        // normalize odf
-        parent->normalizeODF(&odf);
-
-        // Calculate spherical harmonics
-        parent->m_B.mult(odf.m_odf, odf.m_sphHarmonics);
-
-        // Recalc ODF based on spherical harmonics
-        parent->m_T.mult(odf.m_sphHarmonics, odf.m_odf);
-
-        parent->normalizeODF(&odf);
+        reduced.assign(NPTS, 0.0);
+        reduceAmp(img, query, reduced, bprogress);
+    }
 
+    // This function finishes the ODF after its values and spherical harmonics were calculated
+    void finishODF(CODF& odf)
+    {
         // Calcualte ODF_GFA
         odf.m_GFA = stddev(odf.m_odf) / rms(odf.m_odf);
 
@@ -162,7 +147,6 @@ public:
 
         // do the fitting stats
         if (parent->GetBoolValue(FITTING)) parent->calculateFits(&odf);
-        return true;
     }
 
     // Note that the returned image is now a filtered power spectrum
@@ -319,7 +303,7 @@ public:
         }
     }
 
-    void reduceAmp(sitk::Image& img, std::vector<double>& reduced)
+    void reduceAmp(sitk::Image& img, const FSNNQuery& query, std::vector<double>& reduced, bool bprogress)
     {
         float* data = img.GetBufferAsFloat();
 
@@ -333,11 +317,9 @@ public:
 
         double zcount = 0;
 
-        #pragma omp parallel shared(img)
+        // the queries are thread-safe, so all threads can share the search tree
+        #pragma omp parallel shared(img, query)
         {
-            FSNNQuery query(&parent->m_points);
-            query.Init();
-            
             std::vector<double> tmp(NPTS, 0.0);
 
             #pragma omp for schedule(dynamic)
@@ -371,10 +353,13 @@ public:
                     }
                 }
 
-                #pragma omp critical
+                if (bprogress)
                 {
-                    zcount++;
-                    parent->updateProgressIncrement(0.5*zcount / nz);
+                    #pragma omp critical
+                    {
+                        zcount++;
+                        parent->updateProgressIncrement(0.75*zcount / nz);
+                    }
                 }
             }
 
@@ -534,6 +519,26 @@ void CFiberODFAnalysis::GenerateSubVolumes()
 			}
 }
 
+// Upper limit of the memory used by the subvolumes that are processed concurrently
+const size_t MAX_SUBVOLUME_MEMORY = ((size_t)4) << 30;
+
+// Approximate memory needed to process one voxel of a subvolume
+// (image, padded complex FFT and its shifted copy, power spectrum)
+const size_t SUBVOLUME_BYTES_PER_VOXEL = 24;
+
+// Number of subvolumes per worker that are processed before the ODFs are calculated.
+const int ODF_BATCH_WORKLOAD = 4;
+
+// number of threads that may be used by a parallel region
+static int MaxThreads()
+{
+#ifdef _OPENMP
+	return omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
 // calculate mean image intensity
 double meanImageIntensity(sitk::Image& img)
 {
@@ -603,9 +608,6 @@ void CFiberODFAnalysis::run()
     double zDivSizePhys = zppd*spacing[2];
     double radius = std::min({xDivSizePhys, yDivSizePhys, zDivSizePhys})*0.375;
 
-    sitk::ExtractImageFilter extractFilter;
-    extractFilter.SetSize(std::vector<unsigned int> {xDivSize, yDivSize, zDivSize});
-
 	// copy point data to vector<vec3d> which is convenient for certain parts of the algorithm (i.e. reduceAmp)
 	m_points.resize(NPTS);
 	for (int index = 0; index < NPTS; index++)
@@ -613,6 +615,10 @@ void CFiberODFAnalysis::run()
 		m_points[index] = vec3d(XCOORDS[index], YCOORDS[index], ZCOORDS[index]);
 	}
 
+	// the search tree for projecting the power spectra onto the sphere points
+	FSNNQuery query(&m_points);
+	query.Init();
+
 	// calculate the spherical coordinates of the points
     vector<double> theta(NPTS);
 	vector<double> phi(NPTS);
@@ -628,60 +634,144 @@ void CFiberODFAnalysis::run()
 	matrix transposeT = m_T.transpose();
 	m_B = (transposeT*(m_T)).inverse()*transposeT;
 
+	// collect the subvolumes that need to be processed
+	assert(xDiv * yDiv * zDiv == m_ODFs.size());
+	vector<int> subVolumes;
+	for (int i = 0; i < (int)m_ODFs.size(); ++i)
+	{
+		if ((m_processSelectedOnly == false) || (m_ODFs[i]->m_selected)) subVolumes.push_back(i);
+	}
+
+	// The subvolumes are processed concurrently, but the number of workers is limited
+	// so that the images of the subvolumes in flight fit in the memory budget. Nested 
+	// parallel regions (i.e. the image filters) run serially on each worker.
+	size_t subVolumeBytes = (size_t)xDivSize * yDivSize * zDivSize * SUBVOLUME_BYTES_PER_VOXEL;
+	int workers = MaxThreads();
+	if (subVolumeBytes > 0)
+	{
+		size_t maxWorkers = MAX_SUBVOLUME_MEMORY / subVolumeBytes;
+		if (maxWorkers < 1) maxWorkers = 1;
+		if (maxWorkers < (size_t)workers) workers = (int)maxWorkers;
+	}
+
+	// The ODFs are calculated in batches, so that the spherical harmonics fits 
+	// become matrix-matrix products.
+	int batchSize = ODF_BATCH_WORKLOAD * workers;
+
 	// start the loop over the subvolumes
-	m_totalSteps = xDiv * yDiv * zDiv;
-	assert(m_totalSteps == m_ODFs.size());
+	m_totalSteps = (int)subVolumes.size();
+	if (m_totalSteps == 0) m_totalSteps = 1;
+	m_stepsCompleted = 0;
 	m_progress = 0;
 	double maxIntensity = -1;
 	setCurrentTask("Building ODFs ...");
-	for (int currentZ = 0; currentZ < zDiv; ++currentZ)
-		for (int currentY = 0; currentY < yDiv; ++currentY)
-			for (int currentX = 0; currentX < xDiv; ++currentX)
+	for (int batch0 = 0; batch0 < (int)subVolumes.size(); batch0 += batchSize)
+	{
+		int nb = std::min(batchSize, (int)subVolumes.size() - batch0);
+
+		// report progress
+		std::stringstream ss;
+		ss << "Building ODFs (" << batch0 + 1 << "-" << batch0 + nb << "/" << subVolumes.size() << ")...";
+		m_task = ss.str();
+		setCurrentTask(m_task.c_str(), m_progress);
+
+		// extract the subvolumes and project their power spectra onto the sphere
+		matrix R(NPTS, nb); R.zero();
+		vector<double> meanIntensity(nb, 0.0);
+		int stepsCompleted = m_stepsCompleted;
+		#pragma omp parallel for num_threads(workers) schedule(dynamic, 1) if (workers > 1)
+		for (int j = 0; j < nb; ++j)
+		{
+			// see if user cancelled
+			if (IsCanceled()) continue;
+
+			// calculate the subvolume's position in the grid
+			int n = subVolumes[batch0 + j];
+			int currentX = n % xDiv;
+			int currentY = (n / xDiv) % yDiv;
+			int currentZ = n / (xDiv * yDiv);
+
+			// extract the sub-image
+			sitk::ExtractImageFilter extractFilter;
+			extractFilter.SetSize(std::vector<unsigned int> {xDivSize, yDivSize, zDivSize});
+			extractFilter.SetIndex(std::vector<int> {
+				(int)(xDivSize* currentX* (1 - xOverlap)),
+					(int)(yDivSize* currentY* (1 - yOverlap)),
+					(int)(zDivSize* currentZ* (1 - zOverlap))});
+			sitk::Image current = extractFilter.Execute(img);
+
+			// Let's check the mean intensity of subvolume
+			// If the mean intensity is zero, all voxel values are zero and the analysis will just produce nans.
+			meanIntensity[j] = meanImageIntensity(current);
+			if (meanIntensity[j] != 0)
 			{
-				// see if user cancelled
-				if (IsCanceled()) { clear(); return; }
-
-				// calculate sub-volume index
-				m_stepsCompleted = currentX + currentY * xDiv + currentZ * xDiv * yDiv;
-
-				// process the next subvolume
-				CODF& odf = *(m_ODFs[m_stepsCompleted]);
-				if ((m_processSelectedOnly == false) || (odf.m_selected))
-				{
-					// check and report progress
-					std::stringstream ss;
-					Log("\n\n");
-					ss << "Building ODFs (" << m_stepsCompleted + 1 << "/" << m_totalSteps << ")...";
-					m_task = ss.str();
-					setCurrentTask(m_task.c_str(), m_progress);
-
-					// extract the sub-image
-					extractFilter.SetIndex(std::vector<int> {
-						(int)(xDivSize* currentX* (1 - xOverlap)),
-							(int)(yDivSize* currentY* (1 - yOverlap)),
-							(int)(zDivSize* currentZ* (1 - zOverlap))});
-					sitk::Image current = extractFilter.Execute(img);
-
-					// Let's check the mean intensity of subvolume
-					// If the mean intensity is zero, all voxel values are zero and the analysis will just produce nans.
-					double meanIntensity = meanImageIntensity(current);
-					if (meanIntensity != 0)
-					{
-						if (meanIntensity > maxIntensity) maxIntensity = meanIntensity;
-
-						// generate the odf from the image
-						bool b = m_imp->generateODF(odf, current, C->columns());
-						odf.m_meanIntensity = meanIntensity;
-
-						// delete image
-						current = sitk::Image();
-					}
-					else Log("subvolume %d skipped due to zero mean intensity\n", m_stepsCompleted);
-				}
-
-				updateProgressIncrement(1.0);
+				vector<double> reduced;
+				m_imp->reduceSubVolume(current, query, reduced, (workers == 1));
+				for (int k = 0; k < NPTS; ++k) R[k][j] = reduced[k];
 			}
 
+			// delete image
+			current = sitk::Image();
+
+			#pragma omp critical
+			{
+				m_stepsCompleted = ++stepsCompleted;
+				updateProgressIncrement(0.0);
+			}
+		}
+
+		if (IsCanceled()) { clear(); return; }
+
+		// collect the subvolumes with a nonzero intensity
+		vector<int> valid;
+		for (int j = 0; j < nb; ++j)
+		{
+			if (meanIntensity[j] != 0) valid.push_back(j);
+			else Log("subvolume %d skipped due to zero mean intensity\n", subVolumes[batch0 + j]);
+		}
+		int nv = (int)valid.size();
+		if (nv == 0) continue;
+
+		matrix Rv(NPTS, nv);
+		for (int k = 0; k < NPTS; ++k)
+			for (int j = 0; j < nv; ++j) Rv[k][j] = R[k][valid[j]];
+
+		// odf = A*B*reduced
+		matrix ODF = m_A*(m_B*Rv);
+
+		// normalize the odfs
+		for (int j = 0; j < nv; ++j)
+		{
+			CODF& odf = *m_ODFs[subVolumes[batch0 + valid[j]]];
+			for (int k = 0; k < NPTS; ++k) odf.m_odf[k] = ODF[k][j];
+			normalizeODF(&odf);
+			for (int k = 0; k < NPTS; ++k) ODF[k][j] = odf.m_odf[k];
+		}
+
+		// Calculate spherical harmonics
+		matrix SH = m_B*ODF;
+
+		// Recalc ODF based on spherical harmonics
+		ODF = m_T*SH;
+
+		int nsh = C->columns();
+		for (int j = 0; j < nv; ++j)
+		{
+			CODF& odf = *m_ODFs[subVolumes[batch0 + valid[j]]];
+			odf.m_sphHarmonics.resize(nsh);
+			for (int k = 0; k < nsh; ++k) odf.m_sphHarmonics[k] = SH[k][j];
+			for (int k = 0; k < NPTS; ++k) odf.m_odf[k] = ODF[k][j];
+			normalizeODF(&odf);
+
+			odf.m_meanIntensity = meanIntensity[valid[j]];
+			if (odf.m_meanIntensity > maxIntensity) maxIntensity = odf.m_meanIntensity;
+
+			// build the meshes and fits
+			Log("\n\n");
+			m_imp->finishODF(odf);
+		}
+	}
+
     // normalize mean intensities
     for(auto odf : m_ODFs)
     {
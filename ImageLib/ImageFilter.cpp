@@ -30,6 +30,7 @@ SOFTWARE.*/
 #include "3DImage.h"
 #include <PostGL/GLModel.h>
 #include <MeshLib/FEFindElement.h>
+#include <MeshLib/MeshTools.h>
 #include "ImageFilterSITK.h"
 #include <limits>
 
@@ -84,20 +85,28 @@ template<class pType> void ThresholdImageFilter::FitlerTemplate()
     int nx = image->Width();
 	int ny = image->Height();
 	int nz = image->Depth();
-    uint8_t* dest_buf = new uint8_t[nx * ny * nz * image->BPS()];
+    uint8_t* dest_buf = new uint8_t[(size_t)nx * ny * nz * image->BPS()];
     pType* filteredBytes = (pType*)dest_buf;
-    
-    for(int i = 0; i < image->Width()*image->Height()*image->Depth(); i++)
+
+    // values per slice (all channels of RGB images are thresholded)
+    size_t sliceSize = (size_t)nx * ny * (image->IsRGB() ? 3 : 1);
+
+    #pragma omp parallel for
+    for(int k = 0; k < nz; k++)
     {
-        if(originalBytes[i] > max || originalBytes[i] < min)
+        const pType* src = originalBytes + k * sliceSize;
+        pType* dst = filteredBytes + k * sliceSize;
+        for(size_t i = 0; i < sliceSize; i++)
         {
-            filteredBytes[i] = 0;
+            if(src[i] > max || src[i] < min)
+            {
+                dst[i] = 0;
+            }
+            else
+            {
+                dst[i] = src[i];
+            }
         }
-        else
-        {
-            filteredBytes[i] = originalBytes[i];
-        }
-
     }
 
     C3DImage* imageToFilter = m_model->GetImageSource()->GetImageToFilter();
@@ -342,6 +351,56 @@ WarpImageFilter::WarpImageFilter(Post::CGLModel* glm)
 	AddBoolParam(true, "scale_dim", "Scale dimensions");
 }
 
+// A point location that was found by walking from the previous voxel's element is 
+// only accepted when the point lies well inside that element (by this margin in 
+// iso-parametric coordinates). Near element boundaries more than one element can 
+// contain the point, and then the full search is used so that the same element is
+// picked as before.
+static const double WARP_HINT_MARGIN = 0.01;
+
+static bool insideWithMargin2D(FEElement_& el, const double q[2], const double m)
+{
+	switch (el.Type())
+	{
+	case FE_TRI3 : return (q[0] >= m) && (q[1] >= m) && (q[0] + q[1] <= 1.0 - m);
+	case FE_QUAD4: return (q[0] >= -1.0 + m) && (q[0] <= 1.0 - m) && (q[1] >= -1.0 + m) && (q[1] <= 1.0 - m);
+	}
+	return false;
+}
+
+// Same as FindElement2D, but the element nhint is tried first.
+static bool findElement2D(const vec2d& p, int& elem, double q[2], FSMesh* mesh, int nhint)
+{
+	if (nhint >= 0)
+	{
+		FSElement& el = mesh->Element(nhint);
+		vec3d x[FSElement::MAX_NODES];
+		for (int i = 0; i < el.Nodes(); ++i) x[i] = mesh->Node(el.m_node[i]).r;
+
+		double r[2] = { 0.0, 0.0 };
+		if (project_inside_element2d(el, x, p, r) && insideWithMargin2D(el, r, WARP_HINT_MARGIN))
+		{
+			elem = nhint;
+			q[0] = r[0];
+			q[1] = r[1];
+			return true;
+		}
+	}
+
+	q[0] = q[1] = 0.0;
+	return FindElement2D(p, elem, q, mesh);
+}
+
+// Same as FEFindElement::FindElement, but the search first walks from element nhint.
+// The tree is only searched (once) when the walk fails or ends near an element boundary.
+static bool findElement3D(FEFindElement& fe, FSMesh* mesh, const vec3f& x, int& elem, double q[3], int nhint)
+{
+	if ((nhint >= 0) && fe.WalkToElement(x, elem, q, nhint) && IsInsideElement(mesh->Element(elem), q, -WARP_HINT_MARGIN)) return true;
+
+	q[0] = q[1] = q[2] = 0.0;
+	return fe.FindElement(x, elem, q);
+}
+
 template<class pType> void WarpImageFilter::FitlerTemplate()
 {
     if ((m_model == nullptr) || (m_glm == nullptr)) return;
@@ -376,7 +435,7 @@ template<class pType> void WarpImageFilter::FitlerTemplate()
 	int ny = (dimScale ? (int)(sy*im->Height()) : im->Height());
 	int nz = (dimScale ? (int)(sz*im->Depth ()) : im->Depth ());
 
-	uint8_t* dst_buf = new uint8_t[nx * ny * nz * im->BPS()];
+	uint8_t* dst_buf = new uint8_t[(size_t)nx * (size_t)ny * (size_t)nz * im->BPS()];
 	pType* dst = (pType*)dst_buf;
 
 	double wx = (nx < 2 ? 0 : 1.0 / (nx - 1.0));
@@ -386,12 +445,16 @@ template<class pType> void WarpImageFilter::FitlerTemplate()
 	vec3d r0 = box.r0();
 	vec3d r1 = box.r1();
 
+	// Each scan line is processed by one thread. Consecutive voxels on a scan line
+	// are usually in the same or a neighboring element, so the element of the 
+	// previous voxel is used as the starting point of the search.
 	if (im->Depth() == 1)
 	{
-        #pragma omp parallel for
+        #pragma omp parallel for schedule(dynamic)
 		for (int j = 0; j < ny; ++j)
 		{
-            int index = j*nx;
+            size_t index = (size_t)j*nx;
+			int hint = -1;
 			for (int i = 0; i < nx; ++i)
 			{
 				// get the spatial coordinates of the voxel
@@ -402,15 +465,16 @@ template<class pType> void WarpImageFilter::FitlerTemplate()
 				int elem = -1;
 				double q[2] = { 0 };
 				vec2d p(x, y);
-				if (FindElement2D(p, elem, q, mesh))
+				if (findElement2D(p, elem, q, mesh, hint))
 				{
+					hint = elem;
+
 					// map to reference configuration
 					FSElement& el = mesh->Element(elem);
-					int ne = el.Nodes();
 					vec3f r[FSElement::MAX_NODES];
-					for (int j = 0; j < el.Nodes(); ++j)
+					for (int l = 0; l < el.Nodes(); ++l)
 					{
-						r[j] = ps->m_Node[el.m_node[j]].m_rt;
+						r[l] = ps->m_Node[el.m_node[l]].m_rt;
 					}
 
 					// sample 
@@ -431,43 +495,45 @@ template<class pType> void WarpImageFilter::FitlerTemplate()
 		fe.Init();
 
 		// 3D case
-		for (int k = 0; k < nz; ++k)
+		const int lines = ny * nz;
+        #pragma omp parallel for schedule(dynamic)
+		for (int line = 0; line < lines; ++line)
 		{
-            #pragma omp parallel for
-			for (int j = 0; j < ny; ++j)
+			int j = line % ny;
+			int k = line / ny;
+            size_t index = ((size_t)k*ny + j)*nx;
+			int hint = -1;
+
+			for (int i = 0; i < nx; ++i)
 			{
-                int index = k*ny*nx+j*nx;
+				// get the spatial coordinates of the voxel
+				double x = r0.x + (r1.x - r0.x) * (i * wx);
+				double y = r0.y + (r1.y - r0.y) * (j * wy);
+				double z = r0.z + (r1.z - r0.z) * (k * wz);
 
-				for (int i = 0; i < nx; ++i)
+				// find which element this belongs to
+				int elem = -1;
+				double q[3] = { 0 };
+				if (findElement3D(fe, mesh, vec3f(x, y, z), elem, q, hint))
 				{
-					// get the spatial coordinates of the voxel
-					double x = r0.x + (r1.x - r0.x) * (i * wx);
-					double y = r0.y + (r1.y - r0.y) * (j * wy);
-					double z = r0.z + (r1.z - r0.z) * (k * wz);
-
-					// find which element this belongs to
-					int elem = -1;
-					double q[3] = { 0 };
-					if (fe.FindElement(vec3f(x, y, z), elem, q))
-					{
-						// map to reference configuration
-						FSElement& el = mesh->Element(elem);
-						int ne = el.Nodes();
-						vec3f p[FSElement::MAX_NODES];
-						for (int j = 0; j < el.Nodes(); ++j)
-						{
-							p[j] = ps->m_Node[el.m_node[j]].m_rt;
-						}
-
-						// sample 
-						vec3f s = el.eval(p, q[0], q[1], q[2]);
-						pType b = im->ValueAtGlobalPos(to_vec3d(s));
-						dst[index+i] = b;
-					}
-					else
+					hint = elem;
+
+					// map to reference configuration
+					FSElement& el = mesh->Element(elem);
+					vec3f p[FSElement::MAX_NODES];
+					for (int l = 0; l < el.Nodes(); ++l)
 					{
-						dst[index+i] = 0;
+						p[l] = ps->m_Node[el.m_node[l]].m_rt;
 					}
+
+					// sample 
+					vec3f s = el.eval(p, q[0], q[1], q[2]);
+					pType b = im->ValueAtGlobalPos(to_vec3d(s));
+					dst[index+i] = b;
+				}
+				else
+				{
+					dst[index+i] = 0;
 				}
 			}
 		}
@@ -0,0 +1,230 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "ImageReslicer.h"
+#include <algorithm>
+#include <limits>
+#include <assert.h>
+
+// slices are sampled in tiles of TILE_SIZE x TILE_SIZE pixels
+static const int TILE_SIZE = 64;
+
+//-----------------------------------------------------------------------------
+// Integer pixels are clamped and rounded to nearest, floating point pixels are copied.
+template <class pType, class Real> static inline pType toPixel(Real v)
+{
+	if (std::numeric_limits<pType>::is_integer)
+	{
+		const Real vmin = (Real)std::numeric_limits<pType>::min();
+		const Real vmax = (Real)std::numeric_limits<pType>::max();
+		v = (v < vmin ? vmin : (v > vmax ? vmax : v));
+		v += (v < 0 ? (Real)-0.5 : (Real)0.5);
+	}
+	return (pType)v;
+}
+
+//=============================================================================
+CImageReslicer::CImageReslicer()
+{
+	m_im = nullptr;
+}
+
+void CImageReslicer::SetImage(C3DImage* im)
+{
+	m_im = im;
+}
+
+bool CImageReslicer::GetSliceX(CImage& im, double f)
+{
+	if (m_im == nullptr) return false;
+	return GetSlice(im, vec3d(f, 0, 0), vec3d(0, 1, 0), vec3d(0, 0, 1), m_im->Height(), m_im->Depth());
+}
+
+bool CImageReslicer::GetSliceY(CImage& im, double f)
+{
+	if (m_im == nullptr) return false;
+	return GetSlice(im, vec3d(0, f, 0), vec3d(1, 0, 0), vec3d(0, 0, 1), m_im->Width(), m_im->Depth());
+}
+
+bool CImageReslicer::GetSliceZ(CImage& im, double f)
+{
+	if (m_im == nullptr) return false;
+	return GetSlice(im, vec3d(0, 0, f), vec3d(1, 0, 0), vec3d(0, 1, 0), m_im->Width(), m_im->Height());
+}
+
+bool CImageReslicer::GetSlice(CImage& im, const vec3d& r0, const vec3d& u, const vec3d& v, int nx, int ny)
+{
+	if ((m_im == nullptr) || (m_im->GetBytes() == nullptr)) return false;
+	if ((nx <= 0) || (ny <= 0)) return false;
+
+	int pixelType = m_im->PixelType();
+	if ((im.Width() != nx) || (im.Height() != ny) || (im.PixelType() != pixelType))
+		im.Create(nx, ny, nullptr, pixelType);
+
+	// step sizes between pixels
+	vec3d du = (nx > 1 ? u / (double)(nx - 1) : vec3d(0, 0, 0));
+	vec3d dv = (ny > 1 ? v / (double)(ny - 1) : vec3d(0, 0, 0));
+
+	// 32-bit integers and doubles need double precision, 
+	// for the other types single precision is sufficient.
+	switch (pixelType)
+	{
+	case CImage::UINT_8    : Sample<uint8_t , float , 1>(im, r0, du, dv); break;
+	case CImage::INT_8     : Sample<int8_t  , float , 1>(im, r0, du, dv); break;
+	case CImage::UINT_16   : Sample<uint16_t, float , 1>(im, r0, du, dv); break;
+	case CImage::INT_16    : Sample<int16_t , float , 1>(im, r0, du, dv); break;
+	case CImage::UINT_32   : Sample<uint32_t, double, 1>(im, r0, du, dv); break;
+	case CImage::INT_32    : Sample<int32_t , double, 1>(im, r0, du, dv); break;
+	case CImage::UINT_RGB8 : Sample<uint8_t , float , 3>(im, r0, du, dv); break;
+	case CImage::INT_RGB8  : Sample<int8_t  , float , 3>(im, r0, du, dv); break;
+	case CImage::UINT_RGB16: Sample<uint16_t, float , 3>(im, r0, du, dv); break;
+	case CImage::INT_RGB16 : Sample<int16_t , float , 3>(im, r0, du, dv); break;
+	case CImage::REAL_32   : Sample<float   , float , 1>(im, r0, du, dv); break;
+	case CImage::REAL_64   : Sample<double  , double, 1>(im, r0, du, dv); break;
+	default:
+		assert(false);
+		return false;
+	}
+
+	return true;
+}
+
+// The slice is processed in tiles, which are distributed over the threads. Each
+// tile row is processed in two passes. The first pass calculates the voxel offsets
+// and interpolation weights of all pixels in the row. It has no branches, so that
+// the compiler can vectorize it. The second pass gathers the eight neighbouring
+// voxels and blends them.
+template <class pType, class Real, int channels>
+void CImageReslicer::Sample(CImage& im, const vec3d& r0, const vec3d& du, const vec3d& dv)
+{
+	C3DImage& im3d = *m_im;
+	const int cx = im3d.Width();
+	const int cy = im3d.Height();
+	const int cz = im3d.Depth();
+
+	const int nx = im.Width();
+	const int ny = im.Height();
+
+	const pType* src = (const pType*)im3d.GetBytes();
+	pType* dst = (pType*)im.GetBytes();
+
+	// convert to voxel coordinates
+	const double xmax = cx - 1, ymax = cy - 1, zmax = cz - 1;
+	const vec3d p0(r0.x * xmax, r0.y * ymax, r0.z * zmax);
+	const vec3d pu(du.x * xmax, du.y * ymax, du.z * zmax);
+	const vec3d pv(dv.x * xmax, dv.y * ymax, dv.z * zmax);
+
+	// the last voxel at which interpolation can start
+	const int ilast = std::max(cx - 2, 0);
+	const int jlast = std::max(cy - 2, 0);
+	const int klast = std::max(cz - 2, 0);
+
+	// strides and offsets to the neighbouring voxels
+	const int64_t sx = channels;
+	const int64_t sy = (int64_t)cx * channels;
+	const int64_t sz = (int64_t)cx * cy * channels;
+	const int64_t ox = (cx > 1 ? sx : 0);
+	const int64_t oy = (cy > 1 ? sy : 0);
+	const int64_t oz = (cz > 1 ? sz : 0);
+
+	// points slightly outside the image (due to round-off) are still considered inside
+	const double eps = 1e-6;
+
+	const int tilesX = (nx + TILE_SIZE - 1) / TILE_SIZE;
+	const int tilesY = (ny + TILE_SIZE - 1) / TILE_SIZE;
+	const int tiles = tilesX * tilesY;
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int tile = 0; tile < tiles; ++tile)
+	{
+		int64_t off[TILE_SIZE];
+		Real wx[TILE_SIZE], wy[TILE_SIZE], wz[TILE_SIZE];
+		int inside[TILE_SIZE];
+
+		const int i0 = (tile % tilesX) * TILE_SIZE;
+		const int j0 = (tile / tilesX) * TILE_SIZE;
+		const int i1 = std::min(i0 + TILE_SIZE, nx);
+		const int j1 = std::min(j0 + TILE_SIZE, ny);
+		const int n = i1 - i0;
+
+		for (int j = j0; j < j1; ++j)
+		{
+			// position of the first pixel of this tile row
+			const vec3d p = p0 + pu * (double)i0 + pv * (double)j;
+
+			// pass 1: offsets and weights
+			for (int l = 0; l < n; ++l)
+			{
+				double x = p.x + pu.x * l;
+				double y = p.y + pu.y * l;
+				double z = p.z + pu.z * l;
+
+				inside[l] = (x >= -eps) & (x <= xmax + eps) & (y >= -eps) & (y <= ymax + eps) & (z >= -eps) & (z <= zmax + eps);
+
+				x = (x < 0 ? 0 : (x > xmax ? xmax : x));
+				y = (y < 0 ? 0 : (y > ymax ? ymax : y));
+				z = (z < 0 ? 0 : (z > zmax ? zmax : z));
+
+				int ix = (int)x; ix = (ix > ilast ? ilast : ix);
+				int iy = (int)y; iy = (iy > jlast ? jlast : iy);
+				int iz = (int)z; iz = (iz > klast ? klast : iz);
+
+				wx[l] = (Real)(x - ix);
+				wy[l] = (Real)(y - iy);
+				wz[l] = (Real)(z - iz);
+				off[l] = ix * sx + iy * sy + iz * sz;
+			}
+
+			// pass 2: gather and blend
+			pType* d = dst + ((int64_t)j * nx + i0) * channels;
+			for (int l = 0; l < n; ++l)
+			{
+				if (inside[l] == 0)
+				{
+					for (int c = 0; c < channels; ++c) *d++ = 0;
+					continue;
+				}
+
+				const Real rx = wx[l], ry = wy[l], rz = wz[l];
+				const pType* s = src + off[l];
+				for (int c = 0; c < channels; ++c, ++s)
+				{
+					Real c00 = (Real)s[0      ] + rx * ((Real)s[ox          ] - (Real)s[0      ]);
+					Real c10 = (Real)s[oy     ] + rx * ((Real)s[ox + oy     ] - (Real)s[oy     ]);
+					Real c01 = (Real)s[oz     ] + rx * ((Real)s[ox + oz     ] - (Real)s[oz     ]);
+					Real c11 = (Real)s[oy + oz] + rx * ((Real)s[ox + oy + oz] - (Real)s[oy + oz]);
+
+					Real c0 = c00 + ry * (c10 - c00);
+					Real c1 = c01 + ry * (c11 - c01);
+
+					*d++ = toPixel<pType, Real>(c0 + rz * (c1 - c0));
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,63 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include "3DImage.h"
+
+//-----------------------------------------------------------------------------
+// Samples planar slices with any orientation through a 3D image (multi-planar
+// reformatting). Planes are defined in normalized image coordinates. (0,0,0) is
+// the first voxel and (1,1,1) the last voxel, as in C3DImage::Peek. Values are
+// interpolated trilinearly. The slice is divided into tiles that are processed
+// in parallel.
+class CImageReslicer
+{
+public:
+	CImageReslicer();
+
+	// set the image that is sampled
+	void SetImage(C3DImage* im);
+	C3DImage* GetImage() { return m_im; }
+
+	// Sample the plane through r0 that is spanned by u and v. Pixel (i,j) of the
+	// slice is the image value at r0 + u*i/(nx-1) + v*j/(ny-1). Pixels that lie
+	// outside the image are zero. The slice has the pixel type of the image.
+	bool GetSlice(CImage& im, const vec3d& r0, const vec3d& u, const vec3d& v, int nx, int ny);
+
+	// axis-aligned slices at the relative offset f. These have the same layout
+	// as the slices of C3DImage::GetSampledSliceX/Y/Z.
+	bool GetSliceX(CImage& im, double f);
+	bool GetSliceY(CImage& im, double f);
+	bool GetSliceZ(CImage& im, double f);
+
+private:
+	template <class pType, class Real, int channels>
+	void Sample(CImage& im, const vec3d& r0, const vec3d& du, const vec3d& dv);
+
+private:
+	C3DImage*	m_im;
+};
@@ -29,6 +29,7 @@ SOFTWARE.*/
 #include <ImageLib/3DImage.h>
 #include <FSCore/FSDir.h>
 #include <filesystem>
+#include <stdexcept>
 
 using namespace Post;
 namespace fs = std::filesystem;
@@ -95,6 +96,69 @@ void CImageSource::AssignImage(C3DImage* im)
     m_img = im;
 }
 
+bool CImageSource::ReadSlices(C3DImage* im, std::function<bool(int n, uint8_t* dest)> readSlice)
+{
+    const int nz = im->Depth();
+    const size_t sliceSize = (size_t)im->Width() * (size_t)im->Height() * (size_t)im->BPS();
+    uint8_t* buf = im->GetBytes();
+
+    int ndone = 0;
+    bool bok = true;
+    std::string err;
+
+    setProgress(0.0);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int n = 0; n < nz; ++n)
+    {
+        if (!bok || IsCanceled()) continue;
+
+        bool b = false;
+        std::string msg;
+        try {
+            b = readSlice(n, buf + n * sliceSize);
+        }
+        catch (std::exception& e)
+        {
+            msg = e.what();
+        }
+        catch (...)
+        {
+        }
+
+        #pragma omp critical
+        {
+            if (b)
+            {
+                ndone++;
+                setProgress((100.0 * ndone) / nz);
+            }
+            else if (bok)
+            {
+                bok = false;
+                err = (msg.empty() ? "Failed reading slice " + std::to_string(n + 1) + "." : msg);
+            }
+        }
+    }
+
+    if (bok && IsCanceled()) { bok = false; err = "Reading the image was canceled."; }
+
+    // the image only replaces the current one when all slices were read
+    if (bok == false)
+    {
+        delete im;
+        error(err);
+        return false;
+    }
+
+    // the slices were written into the buffer directly
+    im->Modified();
+    AssignImage(im);
+
+    setProgress(100.0);
+    return true;
+}
+
 //========================================================================
 
 CRawImageSource::CRawImageSource(CImageModel* imgModel, const std::string& filename, int imgType, int nx, int ny, int nz, BOX box, bool byteSwap)
@@ -28,6 +28,7 @@ SOFTWARE.*/
 
 #include <vector>
 #include <string>
+#include <functional>
 #include <FSCore/FSObjectList.h>
 #include <FSCore/box.h>
 #include <FSCore/FSThreadedTask.h>
@@ -72,6 +73,13 @@ public:
 protected:
     void AssignImage(C3DImage* im);
 
+    // Reads the slices of im concurrently. readSlice(n, dest) must decode slice n into
+    // dest, which points to slice n of the image buffer. It returns false, or throws, 
+    // when it fails. Takes ownership of im: it is assigned when all slices were read. 
+    // If reading fails or is canceled, im is deleted, the current image is kept 
+    // and false is returned.
+    bool ReadSlices(C3DImage* im, std::function<bool(int n, uint8_t* dest)> readSlice);
+
 protected:
     int m_type;
 
@@ -0,0 +1,262 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "ImageStatistics.h"
+#include "3DImage.h"
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <assert.h>
+
+// The image is processed in blocks of BLOCK_SIZE values. Sums are accumulated per
+// block and added in block order, so the results do not depend on the number of threads.
+static const size_t BLOCK_SIZE = 1 << 18;
+
+static int blockCount(size_t N) { return (int)((N + BLOCK_SIZE - 1) / BLOCK_SIZE); }
+
+CImageStatistics::CImageStatistics()
+{
+	count = 0;
+	min = max = 0;
+	mean = stddev = 0;
+	histogram.assign(BINS, 0);
+
+	m_fine0 = 0;
+	m_fineWidth = 0;
+	m_exact = true;
+}
+
+void CImageStatistics::Calculate(C3DImage& im)
+{
+	*this = CImageStatistics();
+
+	size_t N = (size_t)im.Width() * im.Height() * im.Depth();
+	if (im.IsRGB()) N *= 3;
+
+	const uint8_t* pb = im.GetBytes();
+	if ((pb == nullptr) || (N == 0)) return;
+
+	switch (im.PixelType())
+	{
+	case CImage::UINT_8    : CalculateInteger<uint8_t >((const uint8_t* )pb, N); break;
+	case CImage::INT_8     : CalculateInteger<int8_t  >((const int8_t*  )pb, N); break;
+	case CImage::UINT_16   : CalculateInteger<uint16_t>((const uint16_t*)pb, N); break;
+	case CImage::INT_16    : CalculateInteger<int16_t >((const int16_t* )pb, N); break;
+	case CImage::UINT_RGB8 : CalculateInteger<uint8_t >((const uint8_t* )pb, N); break;
+	case CImage::INT_RGB8  : CalculateInteger<int8_t  >((const int8_t*  )pb, N); break;
+	case CImage::UINT_RGB16: CalculateInteger<uint16_t>((const uint16_t*)pb, N); break;
+	case CImage::INT_RGB16 : CalculateInteger<int16_t >((const int16_t* )pb, N); break;
+	case CImage::UINT_32   : CalculateReal<uint32_t>((const uint32_t*)pb, N); break;
+	case CImage::INT_32    : CalculateReal<int32_t >((const int32_t* )pb, N); break;
+	case CImage::REAL_32   : CalculateReal<float   >((const float*   )pb, N); break;
+	case CImage::REAL_64   : CalculateReal<double  >((const double*  )pb, N); break;
+	default:
+		assert(false);
+	}
+}
+
+// Counts every value in a single pass. All other statistics follow from these counts.
+template <class pType> void CImageStatistics::CalculateInteger(const pType* data, size_t N)
+{
+	const int lo = (int)std::numeric_limits<pType>::lowest();
+	const int nvals = (int)std::numeric_limits<pType>::max() - lo + 1;
+
+	m_fine.assign(nvals, 0);
+	m_fine0 = lo;
+	m_fineWidth = 1;
+	m_exact = true;
+
+	const int nblocks = blockCount(N);
+	#pragma omp parallel
+	{
+		std::vector<size_t> hist(nvals, 0);
+
+		#pragma omp for schedule(dynamic)
+		for (int b = 0; b < nblocks; ++b)
+		{
+			size_t i0 = (size_t)b * BLOCK_SIZE;
+			size_t i1 = std::min(i0 + BLOCK_SIZE, N);
+			for (size_t i = i0; i < i1; ++i) hist[(int)data[i] - lo]++;
+		}
+
+		#pragma omp critical
+		for (int i = 0; i < nvals; ++i) m_fine[i] += hist[i];
+	}
+
+	int imin = 0;
+	while (m_fine[imin] == 0) imin++;
+	int imax = nvals - 1;
+	while (m_fine[imax] == 0) imax--;
+
+	count = N;
+	min = lo + imin;
+	max = lo + imax;
+
+	double sum = 0;
+	for (int i = imin; i <= imax; ++i) sum += (double)m_fine[i] * (lo + i);
+	mean = sum / count;
+
+	double sum2 = 0;
+	for (int i = imin; i <= imax; ++i)
+	{
+		if (m_fine[i] == 0) continue;
+		double d = (lo + i) - mean;
+		sum2 += m_fine[i] * d * d;
+		histogram[Bin(lo + i)] += m_fine[i];
+	}
+	stddev = sqrt(sum2 / count);
+}
+
+// The first pass finds the range and the mean, and the second pass fills the 
+// histogram and accumulates the squared deviations from the mean.
+template <class pType> void CImageStatistics::CalculateReal(const pType* data, size_t N)
+{
+	const int nblocks = blockCount(N);
+	std::vector<double> bmin(nblocks), bmax(nblocks), bsum(nblocks);
+	std::vector<size_t> bcount(nblocks);
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int b = 0; b < nblocks; ++b)
+	{
+		size_t i0 = (size_t)b * BLOCK_SIZE;
+		size_t i1 = std::min(i0 + BLOCK_SIZE, N);
+		double vmin = std::numeric_limits<double>::max();
+		double vmax = std::numeric_limits<double>::lowest();
+		double sum = 0;
+		size_t n = 0;
+		for (size_t i = i0; i < i1; ++i)
+		{
+			double v = (double)data[i];
+			if (v != v) continue;
+			if (v < vmin) vmin = v;
+			if (v > vmax) vmax = v;
+			sum += v;
+			n++;
+		}
+		bmin[b] = vmin;
+		bmax[b] = vmax;
+		bsum[b] = sum;
+		bcount[b] = n;
+	}
+
+	double sum = 0;
+	min = std::numeric_limits<double>::max();
+	max = std::numeric_limits<double>::lowest();
+	for (int b = 0; b < nblocks; ++b)
+	{
+		if (bcount[b] == 0) continue;
+		if (bmin[b] < min) min = bmin[b];
+		if (bmax[b] > max) max = bmax[b];
+		sum += bsum[b];
+		count += bcount[b];
+	}
+	if (count == 0)
+	{
+		min = max = 0;
+		return;
+	}
+	mean = sum / count;
+
+	m_fine.assign(FINE_BINS, 0);
+	m_fine0 = min;
+	m_fineWidth = (max - min) / FINE_BINS;
+	m_exact = false;
+
+	const double scale = (max > min ? FINE_BINS / (max - min) : 0.0);
+	const double vmin = min;
+	const double vmean = mean;
+	std::vector<double> bsum2(nblocks);
+	#pragma omp parallel
+	{
+		std::vector<size_t> hist(FINE_BINS, 0);
+
+		#pragma omp for schedule(dynamic)
+		for (int b = 0; b < nblocks; ++b)
+		{
+			size_t i0 = (size_t)b * BLOCK_SIZE;
+			size_t i1 = std::min(i0 + BLOCK_SIZE, N);
+			double sum2 = 0;
+			for (size_t i = i0; i < i1; ++i)
+			{
+				double v = (double)data[i];
+				if (v != v) continue;
+				double d = v - vmean;
+				sum2 += d * d;
+				int n = (int)((v - vmin) * scale);
+				if (n >= FINE_BINS) n = FINE_BINS - 1;
+				hist[n]++;
+			}
+			bsum2[b] = sum2;
+		}
+
+		#pragma omp critical
+		for (int i = 0; i < FINE_BINS; ++i) m_fine[i] += hist[i];
+	}
+
+	double sum2 = 0;
+	for (int b = 0; b < nblocks; ++b) sum2 += bsum2[b];
+	stddev = sqrt(sum2 / count);
+
+	const int m = FINE_BINS / BINS;
+	for (int i = 0; i < FINE_BINS; ++i) histogram[i / m] += m_fine[i];
+}
+
+double CImageStatistics::Percentile(double p) const
+{
+	if (count == 0) return 0;
+	if (p <= 0) return min;
+	if (p >= 100) return max;
+
+	// rank of the requested value
+	double r = p * count / 100.0;
+	if (r < 1) r = 1;
+
+	double cum = 0;
+	for (size_t i = 0; i < m_fine.size(); ++i)
+	{
+		double c = (double)m_fine[i];
+		if ((c > 0) && (cum + c >= r))
+		{
+			if (m_exact) return m_fine0 + i;
+
+			double v = m_fine0 + (i + (r - cum) / c) * m_fineWidth;
+			return std::min(std::max(v, min), max);
+		}
+		cum += c;
+	}
+	return max;
+}
+
+int CImageStatistics::Bin(double v) const
+{
+	if (max <= min) return 0;
+	int n = (int)((v - min) * BINS / (max - min));
+	if (n < 0) n = 0;
+	if (n >= BINS) n = BINS - 1;
+	return n;
+}
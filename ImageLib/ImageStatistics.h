@@ -0,0 +1,85 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include <vector>
+#include <stddef.h>
+
+class C3DImage;
+
+//-----------------------------------------------------------------------------
+// Statistics of the values of a 3D image. For RGB images all channels are
+// combined. 8- and 16-bit images are processed in a single pass that counts
+// every possible value, so all statistics, including the percentiles, are exact.
+// Other pixel types need a second pass for the histogram and the variance, and
+// their percentiles are interpolated in a histogram of FINE_BINS bins.
+// NaN values are skipped.
+class CImageStatistics
+{
+public:
+	enum { BINS = 256 };		// bins of the histogram
+	enum { FINE_BINS = 4096 };	// bins used for percentiles of 32-bit and real images
+
+public:
+	CImageStatistics();
+
+	// calculate the statistics of the image (runs in parallel)
+	void Calculate(C3DImage& im);
+
+	// the value at percentile p (0 - 100)
+	double Percentile(double p) const;
+
+	// the histogram bin that value v falls into
+	int Bin(double v) const;
+
+	// For 8- and 16-bit images the count of every value is kept, so that histograms
+	// with other bins can be made without reading the image again. Entry i is the 
+	// count of value LowestValue() + i.
+	bool HasValueCounts() const { return m_exact && !m_fine.empty(); }
+	int LowestValue() const { return (int)m_fine0; }
+	const std::vector<size_t>& ValueCounts() const { return m_fine; }
+
+public:
+	size_t	count;		// number of values
+	double	min, max;
+	double	mean;
+	double	stddev;
+
+	std::vector<size_t>	histogram;	// BINS bins evenly spaced over [min, max]
+
+private:
+	template <class pType> void CalculateInteger(const pType* data, size_t N);
+	template <class pType> void CalculateReal(const pType* data, size_t N);
+
+private:
+	// histogram used for the percentiles. For 8- and 16-bit images each 
+	// value has its own bin.
+	std::vector<size_t>	m_fine;
+	double	m_fine0;	// value at the start of the first bin
+	double	m_fineWidth;	// bin width
+	bool	m_exact;	// one bin per value
+};
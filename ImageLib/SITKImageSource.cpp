@@ -30,6 +30,7 @@ SOFTWARE.*/
 #include "SITKTools.h"
 #include <FSCore/FSDir.h>
 #include <cstring>
+#include <cmath>
 #include <filesystem>
 
 using namespace Post;
@@ -51,162 +52,204 @@ CITKImageSource::CITKImageSource(CImageModel* imgModel)
 
 }
 
-bool CITKImageSource::Load()
+// Parses a DICOM multi-valued string (values separated by backslashes) into v. At most v.size() values are read.
+static void ParseDICOMValues(const string& val, std::vector<double>& v)
 {
-    C3DImage* im = new C3DImage;
+    int pos = 0;
+    for(int i = 0; i < v.size(); i++)
+    {
+        int oldPos = pos;
 
-    sitk::Image sitkImage;
+        pos = val.find('\\', pos);
 
-    if(m_fileType == CITKImageSource::DICOM)
-    {
-        sitk::ImageSeriesReader reader;
+        if(pos >= 0) pos++;
 
-        string absolutePath = FSDir::fileDir(m_filename);
-        const std::vector<std::string> dicom_names = sitk::ImageSeriesReader::GetGDCMSeriesFileNames(absolutePath);
-        reader.SetFileNames( dicom_names );
+        v[i] = atof(val.substr(oldPos, pos - oldPos).c_str());
         
-        
-        try {
-			// this can throw exceptions. 
-			// If this is called while loading the fs2 file, this could cause problems.
-			// Therefore, we catch the exception and just retrn false.
-			sitkImage = reader.Execute();
-
-            // Sometimes the origin and spacing info is stored in the DICOM headers
-            sitk::ImageFileReader headerReader;
-            headerReader.SetFileName(dicom_names[0]);
-            headerReader.LoadPrivateTagsOn();
-            headerReader.ReadImageInformation();
-
-            ////// origin
-            // "Image Position (Patient)" tag
-            string imgPosTag = "0020|0032";
-            if(headerReader.HasMetaDataKey(imgPosTag))
-            {
-                string val = headerReader.GetMetaData(imgPosTag);
+        if(pos == -1)
+        {
+            break;
+        }
+    }
+}
 
-                std::vector<double> origin = sitkImage.GetOrigin();
-                
-                int pos = 0;
-                for(int i = 0; i < origin.size(); i++)
-                {
-                    int oldPos = pos;
+bool CITKImageSource::Load()
+{
+    if(m_fileType == CITKImageSource::DICOM)
+    {
+        return LoadDICOMSeries();
+    }
 
-                    pos = val.find('\\', pos);
+    C3DImage* im = new C3DImage;
 
-                    if(pos >= 0) pos++;
+    sitk::Image sitkImage;
 
-                    origin[i] = atof(val.substr(oldPos, pos - oldPos).c_str());
-                    
-                    if(pos == -1)
-                    {
-                        break;
-                    }
-                }
+    sitk::ImageFileReader reader;
+    reader.SetFileName(m_filename);
 
-                sitkImage.SetOrigin(origin);
-            }
+    try {
+        // this can throw exceptions. 
+        // If this is called while loading the fs2 file, this could cause problems.
+        // Therefore, we catch the exception and just return false.
+        sitkImage = reader.Execute();
+    }
+    catch (...)
+    {
+        delete im;
+        return false;
+    }
 
-            ////// Direction
-            // "Image Orientation (Patient)" tag
-            string imgOrientTag = "0020|0037";
-            if(headerReader.HasMetaDataKey(imgOrientTag))
-            {
-                string val = headerReader.GetMetaData(imgOrientTag);
+    if(supportedTypes.count(sitkImage.GetPixelID()) == 0)
+    {
+        delete im;
 
-                std::vector<double> dicomOr(6,0);
-                
-                int pos = 0;
-                for(int i = 0; i < 6; i++)
-                {
-                    int oldPos = pos;
+        throw std::runtime_error("FEBio Studio does not yet support " + sitkImage.GetPixelIDTypeAsString() + " images.");
+    }
 
-                    pos = val.find('\\', pos);
+    // Copy to 3DImage
+    CopyTo3DImage(im, sitkImage);
 
-                    if(pos >= 0) pos++;
+	AssignImage(im);
 
-                    dicomOr[i] = atof(val.substr(oldPos, pos - oldPos).c_str());
-                    
-                    if(pos == -1)
-                    {
-                        break;
-                    }
-                }
+	return true;
+}
 
-                vec3d a(dicomOr[0], dicomOr[1], dicomOr[2]);
-                vec3d b(dicomOr[3], dicomOr[4], dicomOr[5]);
+bool CITKImageSource::LoadDICOMSeries()
+{
+    string absolutePath = FSDir::fileDir(m_filename);
 
-                vec3d c = a^b;
+    std::vector<std::string> dicom_names;
+    sitk::ImageFileReader headerReader;
+    std::vector<double> lastOrigin;
+    try {
+        // this can throw exceptions. 
+        // If this is called while loading the fs2 file, this could cause problems.
+        // Therefore, we catch the exception and just return false.
 
-                std::vector<double> orientation {a.x, b.x, c.x, a.y, b.y, c.y, a.z, b.z, c.z};
+        // the file names are sorted along the slice direction
+        dicom_names = sitk::ImageSeriesReader::GetGDCMSeriesFileNames(absolutePath);
+        if(dicom_names.empty()) return false;
 
-                sitkImage.SetDirection(orientation);
-            }
+        headerReader.SetFileName(dicom_names[0]);
+        headerReader.LoadPrivateTagsOn();
+        headerReader.ReadImageInformation();
 
-            ////// spacing
-            // "Pixel Spacing" tag
-            string spacingTag = "0028|0030";
-            if(headerReader.HasMetaDataKey(spacingTag))
-            {
-                string val = headerReader.GetMetaData(spacingTag);
+        // the position of the last slice determines the slice spacing
+        sitk::ImageFileReader lastReader;
+        lastReader.SetFileName(dicom_names.back());
+        lastReader.ReadImageInformation();
+        lastOrigin = lastReader.GetOrigin();
+    }
+    catch (...)
+    {
+        return false;
+    }
 
-                std::vector<double> spacing = sitkImage.GetSpacing();
-                
-                int pos = 0;
-                for(int i = 0; i < spacing.size(); i++)
-                {
-                    int oldPos = pos;
+    sitk::PixelIDValueEnum pixelID = (sitk::PixelIDValueEnum)headerReader.GetPixelID();
+    if(supportedTypes.count(pixelID) == 0)
+    {
+        throw std::runtime_error("FEBio Studio does not yet support " + sitk::GetPixelIDValueAsString(pixelID) + " images.");
+    }
 
-                    pos = val.find('\\', pos);
+    auto size = headerReader.GetSize();
+    unsigned int nx = size[0];
+    unsigned int ny = size[1];
+    unsigned int nz = dicom_names.size();
+
+    std::vector<double> origin = headerReader.GetOrigin();
+    std::vector<double> spacing = headerReader.GetSpacing();
+    std::vector<double> orientation = headerReader.GetDirection();
+    origin.resize(3, 0.0);
+    spacing.resize(3, 1.0);
+
+    ////// origin
+    // "Image Position (Patient)" tag
+    string imgPosTag = "0020|0032";
+    if(headerReader.HasMetaDataKey(imgPosTag))
+    {
+        ParseDICOMValues(headerReader.GetMetaData(imgPosTag), origin);
+    }
 
-                    if(pos >= 0) pos++;
+    ////// Direction
+    // "Image Orientation (Patient)" tag
+    vec3d c(0, 0, 1);
+    string imgOrientTag = "0020|0037";
+    if(headerReader.HasMetaDataKey(imgOrientTag))
+    {
+        std::vector<double> dicomOr(6,0);
+        ParseDICOMValues(headerReader.GetMetaData(imgOrientTag), dicomOr);
 
-                    spacing[i] = atof(val.substr(oldPos, pos - oldPos).c_str());
-                    
-                    if(pos == -1)
-                    {
-                        break;
-                    }
-                }
+        vec3d a(dicomOr[0], dicomOr[1], dicomOr[2]);
+        vec3d b(dicomOr[3], dicomOr[4], dicomOr[5]);
 
-                sitkImage.SetSpacing(spacing);
-            }
-		}
-		catch (...)
-		{
-			return false;
-		}
+        c = a^b;
+
+        orientation = {a.x, b.x, c.x, a.y, b.y, c.y, a.z, b.z, c.z};
     }
-    else
+    else if(orientation.size() == 9)
     {
-        sitk::ImageFileReader reader;
-        reader.SetFileName(m_filename);
+        c = vec3d(orientation[2], orientation[5], orientation[8]);
+    }
 
-		try {
-			// this can throw exceptions. 
-			// If this is called while loading the fs2 file, this could cause problems.
-			// Therefore, we catch the exception and just return false.
-            sitkImage = reader.Execute();
-		}
-		catch (...)
-		{
-			return false;
-		}
+    ////// spacing
+    // "Pixel Spacing" tag
+    string spacingTag = "0028|0030";
+    if(headerReader.HasMetaDataKey(spacingTag))
+    {
+        ParseDICOMValues(headerReader.GetMetaData(spacingTag), spacing);
     }
 
-    if(supportedTypes.count(sitkImage.GetPixelID()) == 0)
+    // slice spacing: distance between the first and last slice along the slice normal
+    if((nz > 1) && (lastOrigin.size() >= 3))
+    {
+        vec3d r0(origin[0], origin[1], origin[2]);
+        vec3d r1(lastOrigin[0], lastOrigin[1], lastOrigin[2]);
+        double dz = fabs((r1 - r0)*c) / (nz - 1);
+        if(dz > 0) spacing[2] = dz;
+    }
+
+    C3DImage* im = new C3DImage;
+    if (im->Create(nx, ny, nz, nullptr, typeMap.at(pixelID)) == false)
     {
         delete im;
+        return false;
+    }
+    uint64_t sliceSize = (uint64_t)nx*(uint64_t)ny*(uint64_t)im->BPS();
 
-        throw std::runtime_error("FEBio Studio does not yet support " + sitkImage.GetPixelIDTypeAsString() + " images.");
+    // set physical dimensions and orientation
+    BOX box(origin[0],origin[1],origin[2],spacing[0]*nx+origin[0],spacing[1]*ny+origin[1],spacing[2]*nz+origin[2]);
+    im->SetBoundingBox(box);
+
+    if(orientation.size() == 9)
+    {
+        mat3d Q(orientation[0], orientation[1], orientation[2], orientation[3], orientation[4], 
+            orientation[5], orientation[6], orientation[7], orientation[8]);
+        im->SetOrientation(Q);
     }
 
-    // Copy to 3DImage
-    CopyTo3DImage(im, sitkImage);
+    // The slices are read concurrently, each one straight into the image buffer.
+    setCurrentTask("Reading DICOM slices ...");
+    return ReadSlices(im, [&](int index, uint8_t* dest) {
 
-	AssignImage(im);
+        sitk::ImageFileReader reader;
+        reader.SetFileName(dicom_names[index]);
 
-	return true;
+        // (exceptions are caught by ReadSlices)
+        sitk::Image slice = reader.Execute();
+
+        if(slice.GetPixelID() != pixelID)
+        {
+            throw std::runtime_error("All images in the series must have the same pixel type.");
+        }
+
+        if(slice.GetWidth() != nx || slice.GetHeight() != ny || slice.GetDepth() > 1)
+        {
+            throw std::runtime_error("All images in the series must have the same pixel dimensions");
+        }
+
+        std::memcpy(dest, slice.GetBufferAsVoid(), sliceSize);
+        return true;
+    });
 }
 
 void CITKImageSource::Save(OArchive& ar)
@@ -352,60 +395,42 @@ bool CITKSeriesImageSource::Load()
         throw std::runtime_error("FEBio Studio does not yet support " + slice.GetPixelIDTypeAsString() + " images.");
     }
 
-    im->Create(nx, ny, nz, nullptr, typeMap.at(slice.GetPixelID()));
-    uint8_t* imgBuff = im->GetBytes();
-    uint64_t sliceSize = (uint64_t)nx*(uint64_t)ny*(uint64_t)im->BPS();
-
-    try
+    sitk::PixelIDValueEnum pixelID = slice.GetPixelID();
+    if (im->Create(nx, ny, nz, nullptr, typeMap.at(pixelID)) == false)
     {
-        sitk::ImageFileReader reader;
-
-        for(int index = 0; index < m_filenames.size(); index++)
-        {
-            reader.SetFileName(m_filenames[index]);
-            sitk::Image slice;
-
-            try {
-                // this can throw exceptions. 
-                // If this is called while loading the fs2 file, this could cause problems.
-                // Therefore, we catch the exception and just return false.
-                slice = reader.Execute();
-            }
-            catch (...)
-            {
-                return false;
-            }
+        delete im;
+        return false;
+    }
+    uint64_t sliceSize = (uint64_t)nx*(uint64_t)ny*(uint64_t)im->BPS();
 
-            if(slice.GetDimension() != 2)
-            {
-                throw std::runtime_error("All images in the stack must have be 2 dimensional.");
-            }
+    // The slices are read concurrently, each one straight into the image buffer.
+    setCurrentTask("Reading image slices ...");
+    return ReadSlices(im, [&](int index, uint8_t* dest) {
 
-            if(slice.GetPixelID() != slice.GetPixelID())
-            {
-                throw std::runtime_error("All images in the stack must have the same pixel type.");
-            }
+        sitk::ImageFileReader reader;
+        reader.SetFileName(m_filenames[index]);
 
-            if(slice.GetWidth() != nx || slice.GetHeight() != ny)
-            {
-                throw std::runtime_error("All images in the stack must have the same pixel dimensions");
-            }
-            
-            uint8_t* sliceBuff = (uint8_t*)slice.GetBufferAsVoid();
+        // (exceptions are caught by ReadSlices)
+        sitk::Image slice = reader.Execute();
 
-            std::memcpy(imgBuff + sliceSize*index, sliceBuff, sliceSize);
+        if(slice.GetDimension() != 2)
+        {
+            throw std::runtime_error("All images in the stack must have be 2 dimensional.");
         }
 
-    }
-    catch(const std::exception& e)
-    {
-        delete im;
-        throw e;
-    }
+        if(slice.GetPixelID() != pixelID)
+        {
+            throw std::runtime_error("All images in the stack must have the same pixel type.");
+        }
 
-	AssignImage(im);
+        if(slice.GetWidth() != nx || slice.GetHeight() != ny)
+        {
+            throw std::runtime_error("All images in the stack must have the same pixel dimensions");
+        }
 
-	return true;
+        std::memcpy(dest, slice.GetBufferAsVoid(), sliceSize);
+        return true;
+    });
 }
 
 void CITKSeriesImageSource::Save(OArchive& ar)
@@ -51,6 +51,9 @@ public:
 
     int GetFileType() const { return m_fileType; }
 
+private:
+    bool LoadDICOMSeries();
+
 private:
     std::string m_filename;
 
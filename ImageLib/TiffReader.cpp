@@ -27,10 +27,18 @@ SOFTWARE.*/
 #include <ImageLib/3DImage.h>
 #include "ImageModel.h"
 #include <XML/XMLReader.h>
+#include <FSCore/MemoryMappedFile.h>
 #include <stdexcept>
 #include <sstream>
 #include <iostream>
 #include <filesystem>
+#include <set>
+#include <atomic>
+#include <algorithm>
+#include <string.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 namespace fs = std::filesystem;
 
@@ -39,11 +47,6 @@ namespace fs = std::filesystem;
 #define DWORD	uint32_t
 #endif // ! WORD
 
-#ifdef WIN32
-	int __declspec(dllimport) _fseeki64(FILE*, __int64, int);
-	#define fseek _fseeki64
-#endif
-
 enum TifCompression {
 	TIF_COMPRESSION_NONE = 1,
 	TIF_COMPRESSION_CCITTRLE = 2,
@@ -86,6 +89,32 @@ enum TifPhotometric {
 	PHOTOMETRIC_LOGLUV = 32845
 };
 
+enum TifPredictor {
+	TIF_PREDICTOR_NONE = 1,
+	TIF_PREDICTOR_HORIZONTAL = 2,
+	TIF_PREDICTOR_FLOATINGPOINT = 3
+};
+
+// data types of tag values
+enum TifDataType {
+	TIF_TYPE_BYTE = 1,
+	TIF_TYPE_ASCII = 2,
+	TIF_TYPE_SHORT = 3,
+	TIF_TYPE_LONG = 4,
+	TIF_TYPE_RATIONAL = 5,
+	TIF_TYPE_SBYTE = 6,
+	TIF_TYPE_UNDEFINED = 7,
+	TIF_TYPE_SSHORT = 8,
+	TIF_TYPE_SLONG = 9,
+	TIF_TYPE_SRATIONAL = 10,
+	TIF_TYPE_FLOAT = 11,
+	TIF_TYPE_DOUBLE = 12,
+	TIF_TYPE_IFD = 13,
+	TIF_TYPE_LONG8 = 16,
+	TIF_TYPE_SLONG8 = 17,
+	TIF_TYPE_IFD8 = 18
+};
+
 namespace ome {
 	enum DimensionOrder {
 		Unknown,
@@ -94,35 +123,30 @@ namespace ome {
 	};
 }
 
-typedef struct _TiffHeader
-{
-	WORD  Identifier;  /* byte-order Identifier */
-	WORD  Version;     /* TIFF version number (always 2Ah) */
-	DWORD IFDOffset;   /* Offset of the first Image File Directory*/
-} TIFHEAD;
-
 typedef struct _TifTag
 {
-	WORD   TagId;       /* The tag identifier  */
-	WORD   DataType;    /* The scalar type of the data items  */
-	DWORD  DataCount;   /* The number of items in the tag data  */
-	DWORD  DataOffset;  /* The byte offset to the data items  */
+	WORD		TagId;		/* The tag identifier  */
+	WORD		DataType;	/* The scalar type of the data items  */
+	uint64_t	DataCount;	/* The number of items in the tag data  */
+	uint64_t	DataPos;	/* File position of the data items (either in the tag itself, or where its offset points to) */
 } TIFTAG;
 
 typedef struct _TifIfd
 {
-	WORD    NumDirEntries;    /* Number of Tags in IFD  */
-	TIFTAG* TagList;			/* Array of Tags  */
-	DWORD   NextIFDOffset;    /* Offset to next IFD  */
+	std::vector<TIFTAG>	TagList;	/* Array of Tags  */
 } TIFIFD;
 
 typedef struct _TifStrip
 {
-	DWORD	offset;
-	DWORD	byteCount;
+	uint64_t	offset;
+	uint64_t	byteCount;
 } TIFSTRIP;
 
-size_t lzw_decompress(uint8_t* dst, uint8_t* src, size_t max_dst_size);
+size_t lzw_decompress(uint8_t* dst, const uint8_t* src, size_t src_size, size_t max_dst_size);
+size_t packbits_decompress(uint8_t* dst, const uint8_t* src, size_t src_size, size_t max_dst_size);
+#ifdef HAVE_ZLIB
+size_t deflate_decompress(uint8_t* dst, const uint8_t* src, size_t src_size, size_t max_dst_size);
+#endif
 
 typedef struct _TiffImage
 {
@@ -130,52 +154,90 @@ typedef struct _TiffImage
 	DWORD	ny;
 	WORD	photometric;
 	WORD	bps;
+	WORD	compression;
+	WORD	predictor;
+	DWORD	rowsPerStrip;
 	float	xres;
 	float	yres;
-	uint8_t* description;
-	uint8_t* pd;
+	std::string	description;
+	std::vector<TIFSTRIP>	strips;
 } TIFIMAGE;
 
+// size of the data types of tag values
+static int tifTypeSize(int dataType)
+{
+	switch (dataType)
+	{
+	case TIF_TYPE_BYTE:
+	case TIF_TYPE_ASCII:
+	case TIF_TYPE_SBYTE:
+	case TIF_TYPE_UNDEFINED: return 1;
+	case TIF_TYPE_SHORT:
+	case TIF_TYPE_SSHORT: return 2;
+	case TIF_TYPE_LONG:
+	case TIF_TYPE_SLONG:
+	case TIF_TYPE_FLOAT:
+	case TIF_TYPE_IFD: return 4;
+	case TIF_TYPE_RATIONAL:
+	case TIF_TYPE_SRATIONAL:
+	case TIF_TYPE_DOUBLE:
+	case TIF_TYPE_LONG8:
+	case TIF_TYPE_SLONG8:
+	case TIF_TYPE_IFD8: return 8;
+	}
+	return 1;
+}
+
+// The file is mapped into memory, so that the strips of all the pages can
+// be decoded concurrently, straight into the buffer of the 3D image.
 class CTiffImageSource::Impl
 {
 public:
-	Impl() { m_fp = nullptr; }
+	Impl() {}
 	~Impl() { clear(); }
 
 	void clear()
 	{
-		if (m_fp) {
-			fclose(m_fp); m_fp = nullptr;
-		}
-		if (m_img.empty() == false)
-		{
-			for (int i = 0; i < m_img.size(); ++i)
-			{
-				_TiffImage& im = m_img[i];
-				if (im.description) delete[] im.description;
-				delete[] im.pd;
-			}
-			m_img.clear();
-		}
-
-		for (int i = 0; i < m_ifd.size(); ++i)
-		{
-			// cleanup
-			_TifIfd& ifd = m_ifd[i];
-			delete[] ifd.TagList;
-		}
+		m_file.Close();
+		m_img.clear();
 		m_ifd.clear();
 	}
 
 	bool Open();
 	bool ReadIFDs();
-	bool readIFD();
-	bool readImage(_TifIfd& ifd);
+	bool readIFD(uint64_t& offset);
+	void readImage(_TifIfd& ifd);
+
+	// decode all the images into the 3D image
+	bool decodeImages(C3DImage* im, int nc, int dimOrder, FSThreadedTask* task);
+
+private:
+	// decode strip n of image im into dst (which is the size of the strip's rows).
+	bool decodeStrip(const _TiffImage& im, int n, uint8_t* dst, size_t dstSize);
+
+	// convert decoded rows to the native byte order, undo the predictor, etc.
+	void postProcess(const _TiffImage& im, uint8_t* buf, size_t rows);
+
+	// check that the range [pos, pos + size) is inside the file
+	bool inFile(uint64_t pos, uint64_t size) const { return (pos <= m_file.Size()) && (size <= m_file.Size() - pos); }
+
+	const uint8_t* data(uint64_t pos) const { return (const uint8_t*)m_file.Data() + pos; }
+
+	// read values from the file (in the file's byte order)
+	WORD read16(uint64_t pos) const;
+	DWORD read32(uint64_t pos) const;
+	uint64_t read64(uint64_t pos) const;
+
+	// get the i-th value of a tag
+	uint64_t tagValue(const TIFTAG& t, uint64_t i = 0) const;
+	float rationalValue(const TIFTAG& t) const;
 
 public:
 	std::string filename;
 	bool	m_bigE = false;
-	FILE* m_fp = nullptr;
+	bool	m_bigTiff = false;
+	MemoryMappedFile	m_file;
+	uint64_t	m_firstIFD = 0;
 	std::vector<_TiffImage>	m_img;
 	std::vector<_TifIfd>	m_ifd;
 };
@@ -209,52 +271,61 @@ void byteswap(DWORD& v)
 	b[1] ^= b[2]; b[2] ^= b[1]; b[1] ^= b[2];
 }
 
+void byteswap(uint64_t& v)
+{
+	unsigned char* b = (unsigned char*)(&v);
+	for (int i = 0; i < 4; ++i)
+	{
+		unsigned char t = b[i]; b[i] = b[7 - i]; b[7 - i] = t;
+	}
+}
+
 bool CTiffImageSource::Load()
 {
-	if (m->Open() == false) return error("failed opending file.");
+	if (m->Open() == false) { m->clear(); return error("failed opending file."); }
 
 	// read all IFDs
 	setCurrentTask("Reading IFDs ...");
-	if (m->ReadIFDs() == false) return error("failed to read IFDs");
+	if (m->ReadIFDs() == false) { m->clear(); return error("failed to read IFDs"); }
 
-	// read the images
+	// process the tags of all images
 	try {
-		char buf[256] = { 0 };
 		int n = (int)m->m_ifd.size();
-		for (int i = 0; i < n; ++i)
-		{
-			sprintf(buf, "reading image [%d/%d]", i + 1, n);
-			setCurrentTask(buf);
-			setProgress((100.0 * i) / n);
-			if (m->readImage(m->m_ifd[i]) == false) break;
-
-			if (IsCanceled()) return false;
-		}
-		setCurrentTask("finishing...");
+		for (int i = 0; i < n; ++i) m->readImage(m->m_ifd[i]);
 	}
-	catch (std::exception e)
+	catch (std::exception& e)
 	{
+		m->clear();
 		return error(e.what());
 	}
 	catch (...)
 	{
+		m->clear();
 		return error("unknown exception");
 	}
-	setProgress(100.0);
-	fclose(m->m_fp);
-	m->m_fp = nullptr;
 
 	// see if we read any image data
-	if (m->m_img.size() == 0) return error("no image data read.");
+	if (m->m_img.size() == 0) { m->clear(); return error("no image data read."); }
 	int nc = 1;	// nr of channels
 	int nx = m->m_img[0].nx;
 	int ny = m->m_img[0].ny;
 	int nbps = m->m_img[0].bps;
 	int dimOrder = ome::DimensionOrder::Unknown;
 
+	// all images are decoded into the same 3D image
+	for (size_t i = 1; i < m->m_img.size(); ++i)
+	{
+		_TiffImage& tif = m->m_img[i];
+		if ((tif.nx != nx) || (tif.ny != ny) || (tif.bps != nbps))
+		{
+			m->clear();
+			return error("All images in the stack must have the same size.");
+		}
+	}
+
 	float zspacing = 1.f;
 
-	char* szdescription = (char*)m->m_img[0].description;
+	const char* szdescription = (m->m_img[0].description.empty() ? nullptr : m->m_img[0].description.c_str());
 	if (szdescription && GetImageModel())
 	{
 		CImageModel* mdl = GetImageModel();
@@ -329,127 +400,43 @@ bool CTiffImageSource::Load()
 
 	// figure out number of z-slices (= images / channels)
 	int images = m->m_img.size();
+	if (nc <= 0) nc = 1;
 	int nz = images / nc; assert((images % nc) == 0);
 
 	// build the 3D image
 	C3DImage* im = new C3DImage;
+	bool bok = true;
 	if (nc == 1)
 	{
-		if (nbps == 8)
-		{
-			im->Create(nx, ny, nz);
-			uint8_t* buf = im->GetBytes();
-			DWORD imSize = nx * ny;
-			for (int i = 0; i < nz; ++i)
-			{
-				_TiffImage& im = m->m_img[i];
-				memcpy(buf, im.pd, imSize);
-
-				if (im.photometric == PHOTOMETRIC_MINISWHITE)
-				{
-					for (int n = 0; n < imSize; ++n)
-					{
-						uint8_t b = buf[n];
-						buf[n] = 255 - b;
-					}
-				}
-				buf += imSize;
-			}
-		}
-		else if (nbps == 16)
-		{
-			im->Create(nx, ny, nz, nullptr, CImage::UINT_16);
-			WORD* buf = (WORD*)im->GetBytes();
-			DWORD imSize = nx * ny;
-			for (int i = 0; i < nz; ++i)
-			{
-				_TiffImage& im = m->m_img[i];
-				WORD* b = (WORD*)im.pd;
-				if (m->m_bigE)
-				{
-					for (int j = 0; j < imSize; ++j)
-					{
-						buf[j] = *b++;
-						byteswap(buf[j]);
-					}
-				}
-				else
-				{
-					for (int j = 0; j < imSize; ++j) buf[j] = *b++;
-				}
-				buf += imSize;
-			}
-		}
+		if      (nbps ==  8) bok = im->Create(nx, ny, nz);
+		else if (nbps == 16) bok = im->Create(nx, ny, nz, nullptr, CImage::UINT_16);
 	}
 	else if (nc == 3)
 	{
-		if (nbps == 8)
-		{
-			// This will be mapped to a RGB image
-			im->Create(nx, ny, nz, nullptr, CImage::UINT_RGB8);
-			DWORD imSize = nx * ny;
-			for (int k = 0; k < images; ++k)
-			{
-				_TiffImage& tif = m->m_img[k];
-				int slice = k / 3;
-				int channel = k % 3;
-				uint8_t* buf = im->GetBytes() + slice * imSize * 3;
-				if (tif.bps == 8)
-				{
-					for (int i = 0; i < imSize; ++i)
-					{
-						buf[3 * i + channel] = tif.pd[i];
-					}
-				}
-			}
-		}
-		else if (nbps == 16)
-		{
-			// This will be mapped to a RGB image
-			im->Create(nx, ny, nz, nullptr, CImage::UINT_RGB16);
-			DWORD imSize = nx * ny;
-			assert(dimOrder != ome::DimensionOrder::Unknown);
-			if (dimOrder == ome::DimensionOrder::XYCZT)
-			{
-				for (int k = 0; k < images; ++k)
-				{
-					_TiffImage& tif = m->m_img[k];
-					int slice = k / 3;
-					int channel = k % 3;
-					WORD* buf = (WORD*)im->GetBytes() + slice * imSize * 3;
-					if (tif.bps == 16)
-					{
-						WORD* b = (WORD*)tif.pd;
-						for (int i = 0; i < imSize; ++i)
-						{
-							buf[3 * i + channel] = b[i];
-							if (m->m_bigE) byteswap(buf[3 * i + channel]);
-						}
-					}
-				}
-			}
-			else if (dimOrder == ome::DimensionOrder::XYZTC)
-			{
-				for (int k = 0; k < images; ++k)
-				{
-					_TiffImage& tif = m->m_img[k];
-					int slice = k % nz;
-					int channel = k / nz;
-					WORD* buf = (WORD*)im->GetBytes() + slice * imSize * 3;
-					if (tif.bps == 16)
-					{
-						WORD* b = (WORD*)tif.pd;
-						for (int i = 0; i < imSize; ++i)
-						{
-							buf[3 * i + channel] = b[i];
-							if (m->m_bigE) byteswap(buf[3 * i + channel]);
-						}
-					}
-				}
-			}
-		}
+		// This will be mapped to a RGB image
+		if      (nbps ==  8) bok = im->Create(nx, ny, nz, nullptr, CImage::UINT_RGB8);
+		else if (nbps == 16) bok = im->Create(nx, ny, nz, nullptr, CImage::UINT_RGB16);
+	}
+	if (bok == false)
+	{
+		delete im;
+		m->clear();
+		return error("Failed allocating image.");
 	}
 
+	// decode the image data
+	setCurrentTask("Decoding images ...");
+	setProgress(0.0);
+	if (m->decodeImages(im, nc, dimOrder, this) == false)
+	{
+		delete im;
+		m->clear();
+		if (IsCanceled()) return false;
+		return error("Failed decoding image data.");
+	}
+	setCurrentTask("finishing...");
+	setProgress(100.0);
+
 	float fx = (float) nx / m->m_img[0].xres;
 	float fy = (float) ny / m->m_img[0].yres;
 	float fz = (zspacing != 0 ? nz * zspacing : nz);
@@ -464,28 +451,79 @@ bool CTiffImageSource::Load()
 	return true;
 }
 
+WORD CTiffImageSource::Impl::read16(uint64_t pos) const
+{
+	WORD v; memcpy(&v, data(pos), sizeof(WORD));
+	if (m_bigE) byteswap(v);
+	return v;
+}
+
+DWORD CTiffImageSource::Impl::read32(uint64_t pos) const
+{
+	DWORD v; memcpy(&v, data(pos), sizeof(DWORD));
+	if (m_bigE) byteswap(v);
+	return v;
+}
+
+uint64_t CTiffImageSource::Impl::read64(uint64_t pos) const
+{
+	uint64_t v; memcpy(&v, data(pos), sizeof(uint64_t));
+	if (m_bigE) byteswap(v);
+	return v;
+}
+
+uint64_t CTiffImageSource::Impl::tagValue(const TIFTAG& t, uint64_t i) const
+{
+	int size = tifTypeSize(t.DataType);
+	uint64_t pos = t.DataPos + i * size;
+	if ((i >= t.DataCount) || !inFile(pos, size)) throw std::domain_error("Invalid tag value.");
+	switch (size)
+	{
+	case 1: return *data(pos);
+	case 2: return read16(pos);
+	case 4: return read32(pos);
+	case 8: return read64(pos);
+	}
+	return 0;
+}
+
+float CTiffImageSource::Impl::rationalValue(const TIFTAG& t) const
+{
+	if ((t.DataType != TIF_TYPE_RATIONAL) || !inFile(t.DataPos, 8)) return 1.f;
+	DWORD nom = read32(t.DataPos);
+	DWORD den = read32(t.DataPos + 4);
+	return (float)nom / (float)den;
+}
+
 bool CTiffImageSource::Impl::Open()
 {
 	if (filename.empty()) return false;
 	const char* szfile = filename.c_str();
-	m_fp = fopen(szfile, "rb");
-	if (m_fp == 0) return false;
-
-	// read the header
-	TIFHEAD hdr;
-	fread(&hdr, sizeof(TIFHEAD), 1, m_fp);
+	if (m_file.Open(szfile) == false) return false;
+	if (m_file.Size() < 8) return false;
 
 	// see if this is a tiff (and determine endianess)
+	WORD id; memcpy(&id, data(0), sizeof(WORD));
 	m_bigE = false;
-	if (hdr.Identifier == 0x4D4D) m_bigE = true;
-	else if (hdr.Identifier == 0x4949) m_bigE = false;
-
-	if (m_bigE) byteswap(hdr.Version);
-	if (hdr.Version != 0x2A) return false;
-
-	// jump to the first IFD
-	if (m_bigE) byteswap(hdr.IFDOffset);
-	fseek(m_fp, hdr.IFDOffset, SEEK_SET);
+	if (id == 0x4D4D) m_bigE = true;
+	else if (id == 0x4949) m_bigE = false;
+	else return false;
+
+	// Version 0x2A is a classic tiff, with 32-bit offsets.
+	// Version 0x2B is a BigTIFF, with 64-bit offsets.
+	WORD version = read16(2);
+	if (version == 0x2A)
+	{
+		m_bigTiff = false;
+		m_firstIFD = read32(4);
+	}
+	else if (version == 0x2B)
+	{
+		m_bigTiff = true;
+		if ((m_file.Size() < 16) || (read16(4) != 8)) return false;
+		m_firstIFD = read64(8);
+	}
+	else return false;
 
 	return true;
 }
@@ -494,8 +532,14 @@ bool CTiffImageSource::Impl::ReadIFDs()
 {
 	// read the IFDs
 	try {
-		bool bdone = false;
-		while (bdone == false) bdone = readIFD();
+		std::set<uint64_t> visited;
+		uint64_t offset = m_firstIFD;
+		while (offset != 0)
+		{
+			// protect against IFD chains that loop
+			if (visited.insert(offset).second == false) break;
+			if (readIFD(offset) == false) return false;
+		}
 	}
 	catch (...)
 	{
@@ -508,94 +552,80 @@ bool CTiffImageSource::Impl::ReadIFDs()
 	return true;
 }
 
-bool CTiffImageSource::Impl::readIFD()
+// Reads the IFD at offset and returns the offset of the next IFD in offset
+bool CTiffImageSource::Impl::readIFD(uint64_t& offset)
 {
-	// read the IFD
-	TIFIFD ifd;
-	fread(&ifd.NumDirEntries, sizeof(WORD), 1, m_fp);
-	if (m_bigE) byteswap(ifd.NumDirEntries);
-	if ((ifd.NumDirEntries <= 0) || (ifd.NumDirEntries >= 65536))
+	// sizes of the IFD fields
+	const uint64_t countSize = (m_bigTiff ? 8 : 2);
+	const uint64_t entrySize = (m_bigTiff ? 20 : 12);
+	const uint64_t valueSize = (m_bigTiff ? 8 : 4);
+
+	// read the number of entries
+	if (!inFile(offset, countSize)) throw std::domain_error("Invalid IFD offset.");
+	uint64_t entries = (m_bigTiff ? read64(offset) : read16(offset));
+	if ((entries <= 0) || (entries >= 65536))
 	{
 		throw std::domain_error("Invalid number of entries in IFD.");
 	}
 
-	// read the tags
-	ifd.TagList = new _TifTag[ifd.NumDirEntries];
-	int nread = fread(ifd.TagList, sizeof(_TifTag), ifd.NumDirEntries, m_fp);
-	if (nread != ifd.NumDirEntries)  throw std::domain_error("Fatal error reading IFD.");
+	uint64_t pos = offset + countSize;
+	if (!inFile(pos, entries * entrySize + valueSize)) throw std::domain_error("Fatal error reading IFD.");
 
-	// swap if necessary
-	if (m_bigE)
+	// read the tags
+	TIFIFD ifd;
+	ifd.TagList.resize(entries);
+	for (uint64_t i = 0; i < entries; ++i, pos += entrySize)
 	{
-		for (int i = 0; i < ifd.NumDirEntries; ++i)
-		{
-			TIFTAG& t = ifd.TagList[i];
-			byteswap(t.TagId);
-			byteswap(t.DataType);
-			byteswap(t.DataCount);
-
-			if (t.DataType == 3)
-			{
-				WORD tmp = t.DataOffset;
-				byteswap(tmp);
-				t.DataOffset = tmp;
-			}
-			else if (t.DataType == 1) byteswap(t.DataOffset);
-			else if (t.DataType == 2) byteswap(t.DataOffset);
-			else if (t.DataType == 4) byteswap(t.DataOffset);
-			else if (t.DataType == 5) byteswap(t.DataOffset);
-		}
+		TIFTAG& t = ifd.TagList[i];
+		t.TagId = read16(pos);
+		t.DataType = read16(pos + 2);
+		t.DataCount = (m_bigTiff ? read64(pos + 4) : read32(pos + 4));
+
+		// the value is stored in the tag if it fits, otherwise the tag stores its offset
+		uint64_t valuePos = pos + (m_bigTiff ? 12 : 8);
+		uint64_t dataSize = t.DataCount * tifTypeSize(t.DataType);
+		if (dataSize <= valueSize) t.DataPos = valuePos;
+		else t.DataPos = (m_bigTiff ? read64(valuePos) : read32(valuePos));
 	}
 
 	// store the IFD
 	m_ifd.push_back(ifd);
 
 	// read the next IDF offset
-	DWORD nextIFD = 0;
-	fread(&nextIFD, sizeof(DWORD), 1, m_fp);
-	if (m_bigE) byteswap(nextIFD);
-
-	// jump to the next IFD
-	if (nextIFD != 0)
-	{
-		if (nextIFD > 0x7FFFFFFF)
-		{
-			fseek(m_fp, 0x7FFFFFFF, SEEK_SET);
-			DWORD offset = nextIFD - 0x7FFFFFFF;
-			fseek(m_fp, offset, SEEK_CUR);
-		}
-		else fseek(m_fp, nextIFD, SEEK_SET);
-	}
-	else return true;
+	offset = (m_bigTiff ? read64(pos) : read32(pos));
 
-	return false;
+	return true;
 }
 
-bool CTiffImageSource::Impl::readImage(_TifIfd& ifd)
+void CTiffImageSource::Impl::readImage(_TifIfd& ifd)
 {
 	// process tags
 	DWORD imWidth = 0, imLength = 0;
-	DWORD rowsPerStrip = 0, stripOffsets = 0, stripByteCounts = 0, bitsPerSample = 0, compression = TIF_COMPRESSION_NONE;
-	int numberOfStrips = 1;
+	DWORD rowsPerStrip = 0, bitsPerSample = 0, compression = TIF_COMPRESSION_NONE;
+	DWORD predictor = TIF_PREDICTOR_NONE;
 	int photometric = PHOTOMETRIC_MINISBLACK;
-	int descrCount = 0, descrOffset = 0;
-	int xres_off = -1, yres_off = -1;
-	for (int i = 0; i < ifd.NumDirEntries; ++i)
+	const TIFTAG* stripOffsets = nullptr;
+	const TIFTAG* stripByteCounts = nullptr;
+	const TIFTAG* description = nullptr;
+	const TIFTAG* xresTag = nullptr;
+	const TIFTAG* yresTag = nullptr;
+	for (size_t i = 0; i < ifd.TagList.size(); ++i)
 	{
 		TIFTAG& t = ifd.TagList[i];
 		switch (t.TagId)
 		{
-		case 256: imWidth = t.DataOffset; break;
-		case 257: imLength = t.DataOffset; break;
-		case 258: bitsPerSample = t.DataOffset; break;
-		case 259: compression = t.DataOffset; break;
-		case 262: photometric = t.DataOffset; break;
-		case 270: { descrCount = t.DataCount; descrOffset = t.DataOffset; } break;
-		case 278: rowsPerStrip = t.DataOffset; break;
-		case 273: { stripOffsets = t.DataOffset; numberOfStrips = t.DataCount; break; }
-		case 279: stripByteCounts = t.DataOffset; break;
-		case 282: xres_off = t.DataOffset; break;
-		case 283: yres_off = t.DataOffset; break;
+		case 256: imWidth = (DWORD)tagValue(t); break;
+		case 257: imLength = (DWORD)tagValue(t); break;
+		case 258: bitsPerSample = (DWORD)tagValue(t); break;
+		case 259: compression = (DWORD)tagValue(t); break;
+		case 262: photometric = (int)tagValue(t); break;
+		case 270: description = &t; break;
+		case 273: stripOffsets = &t; break;
+		case 278: rowsPerStrip = (DWORD)tagValue(t); break;
+		case 279: stripByteCounts = &t; break;
+		case 282: xresTag = &t; break;
+		case 283: yresTag = &t; break;
+		case 317: predictor = (DWORD)tagValue(t); break;
 		}
 	}
 
@@ -604,125 +634,261 @@ bool CTiffImageSource::Impl::readImage(_TifIfd& ifd)
 		throw std::domain_error("Only 8 and 16 bit tif supported.");
 	}
 
-	if ((compression != TIF_COMPRESSION_NONE) && (compression != TIF_COMPRESSION_LZW))
+	switch (compression)
 	{
-		throw std::domain_error("Only uncompressed and LZW compressed tiff are supported.");
+	case TIF_COMPRESSION_NONE:
+	case TIF_COMPRESSION_LZW:
+	case TIF_COMPRESSION_PACKBITS:
+		break;
+	case TIF_COMPRESSION_DEFLATE:
+	case TIF_COMPRESSION_ADOBE_DEFLATE:
+#ifdef HAVE_ZLIB
+		break;
+#else
+		throw std::domain_error("Reading Deflate compressed tiff requires zlib.");
+#endif
+	default:
+		throw std::domain_error("Only uncompressed, LZW, PackBits and Deflate compressed tiff are supported.");
 	}
 
-	if (stripByteCounts == 0)
+	if ((predictor != TIF_PREDICTOR_NONE) && (predictor != TIF_PREDICTOR_HORIZONTAL))
 	{
-		if (compression == TIF_COMPRESSION_NONE) stripByteCounts = imWidth * imLength * (bitsPerSample == 16 ? 2 : 1);
-		else throw std::domain_error("Invalid stripbyte count.");
+		throw std::domain_error("Unsupported tiff predictor.");
 	}
 
-	// get the x-resolution
-	float xres = 1.f;
-	if (xres_off != -1)
-	{
-		fseek(m_fp, xres_off, SEEK_SET);
-		unsigned int nom, den;
-		fread(&nom, sizeof(unsigned int), 1, m_fp);
-		fread(&den, sizeof(unsigned int), 1, m_fp);
-		if (m_bigE) { byteswap(nom); byteswap(den); }
+	if ((imWidth == 0) || (imLength == 0)) throw std::domain_error("Invalid image size.");
 
-		xres = (float)nom / (float)den;
-	}
+	// find the strips
+	if ((stripOffsets == nullptr) || (stripOffsets->DataCount == 0)) throw std::invalid_argument("no strips");
+	if ((rowsPerStrip == 0) || (rowsPerStrip > imLength)) rowsPerStrip = imLength;
 
-	// get the x-resolution
-	float yres = 1.f;
-	if (yres_off != -1)
+	size_t rowSize = (size_t)imWidth * (bitsPerSample / 8);
+	int numberOfStrips = (int)stripOffsets->DataCount;
+	std::vector<TIFSTRIP> strips(numberOfStrips);
+	for (int i = 0; i < numberOfStrips; ++i)
 	{
-		fseek(m_fp, yres_off, SEEK_SET);
-		unsigned int nom, den;
-		fread(&nom, sizeof(unsigned int), 1, m_fp);
-		fread(&den, sizeof(unsigned int), 1, m_fp);
-		if (m_bigE) { byteswap(nom); byteswap(den); }
+		TIFSTRIP& strip = strips[i];
+		strip.offset = tagValue(*stripOffsets, i);
+		if (stripByteCounts && ((uint64_t)i < stripByteCounts->DataCount)) strip.byteCount = tagValue(*stripByteCounts, i);
+		else if (compression == TIF_COMPRESSION_NONE)
+		{
+			// assume the strips are not padded
+			DWORD row0 = i * rowsPerStrip;
+			DWORD rows = (row0 < imLength ? std::min(rowsPerStrip, imLength - row0) : 0);
+			strip.byteCount = rows * rowSize;
+		}
+		else throw std::domain_error("Invalid stripbyte count.");
 
-		yres = (float)nom / (float)den;
+		if (!inFile(strip.offset, strip.byteCount)) throw std::domain_error("Strip data is outside of file.");
 	}
 
+	_TiffImage im;
+	im.nx = imWidth;
+	im.ny = imLength;
+	im.bps = bitsPerSample;
+	im.compression = compression;
+	im.predictor = predictor;
+	im.rowsPerStrip = rowsPerStrip;
+	im.photometric = photometric;
+	im.strips = strips;
+
+	// get the resolution
+	float xres = (xresTag ? rationalValue(*xresTag) : 1.f);
+	float yres = (yresTag ? rationalValue(*yresTag) : 1.f);
+	im.xres = ((xres != 0.f) && (xres == xres) ? xres : 1.f);
+	im.yres = ((yres != 0.f) && (yres == yres) ? yres : 1.f);
+
 	// read the description if present
-	uint8_t* description = nullptr;
-	if ((descrCount > 0) && (descrOffset > 0))
+	if (description && (description->DataCount > 0) && inFile(description->DataPos, description->DataCount))
 	{
-		description = new uint8_t[descrCount + 1];
-		fseek(m_fp, descrOffset, SEEK_SET);
-		int nread = fread(description, 1, descrCount, m_fp); assert(nread == descrCount);
-		description[nread] = 0; // don't think this is necessary, but let's just to be safe
+		const char* sz = (const char*)data(description->DataPos);
+		size_t l = strnlen(sz, description->DataCount);
+		im.description.assign(sz, l);
 	}
 
-	// find the strips
-	if (numberOfStrips == 0) throw std::invalid_argument("no strips");
-	std::vector<TIFSTRIP> strips(numberOfStrips);
-	if (numberOfStrips == 1)
+	m_img.push_back(im);
+}
+
+bool CTiffImageSource::Impl::decodeStrip(const _TiffImage& im, int n, uint8_t* dst, size_t dstSize)
+{
+	size_t bytesRead = 0;
+	if (n < (int)im.strips.size())
 	{
-		strips[0].offset = stripOffsets;
-		strips[0].byteCount = stripByteCounts;
+		const TIFSTRIP& strip = im.strips[n];
+		const uint8_t* src = data(strip.offset);
+		size_t srcSize = (size_t)strip.byteCount;
+		switch (im.compression)
+		{
+		case TIF_COMPRESSION_NONE:
+			bytesRead = std::min(srcSize, dstSize);
+			memcpy(dst, src, bytesRead);
+			break;
+		case TIF_COMPRESSION_LZW:
+			bytesRead = lzw_decompress(dst, src, srcSize, dstSize);
+			break;
+		case TIF_COMPRESSION_PACKBITS:
+			bytesRead = packbits_decompress(dst, src, srcSize, dstSize);
+			break;
+#ifdef HAVE_ZLIB
+		case TIF_COMPRESSION_DEFLATE:
+		case TIF_COMPRESSION_ADOBE_DEFLATE:
+			bytesRead = deflate_decompress(dst, src, srcSize, dstSize);
+			break;
+#endif
+		default:
+			return false;
+		}
 	}
-	else
+
+	// missing data is set to zero
+	if (bytesRead < dstSize) memset(dst + bytesRead, 0, dstSize - bytesRead);
+
+	return true;
+}
+
+void CTiffImageSource::Impl::postProcess(const _TiffImage& im, uint8_t* buf, size_t rows)
+{
+	size_t nx = im.nx;
+	if (im.bps == 16)
 	{
-		fseek(m_fp, stripOffsets, SEEK_SET);
-		DWORD* tmp = new DWORD[numberOfStrips];
-		fread(tmp, sizeof(DWORD), numberOfStrips, m_fp);
-		for (int i = 0; i < numberOfStrips; ++i)
+		WORD* b = (WORD*)buf;
+		if (m_bigE)
 		{
-			if (m_bigE) byteswap(tmp[i]);
-			strips[i].offset = tmp[i];
+			for (size_t i = 0; i < nx * rows; ++i) byteswap(b[i]);
 		}
 
-		fseek(m_fp, stripByteCounts, SEEK_SET);
-		fread(tmp, sizeof(DWORD), numberOfStrips, m_fp);
-		for (int i = 0; i < numberOfStrips; ++i)
+		if (im.predictor == TIF_PREDICTOR_HORIZONTAL)
 		{
-			if (m_bigE) byteswap(tmp[i]);
-			strips[i].byteCount = tmp[i];
+			for (size_t j = 0; j < rows; ++j)
+			{
+				WORD* row = b + j * nx;
+				for (size_t i = 1; i < nx; ++i) row[i] += row[i - 1];
+			}
 		}
-		delete[] tmp;
 	}
+	else
+	{
+		if (im.predictor == TIF_PREDICTOR_HORIZONTAL)
+		{
+			for (size_t j = 0; j < rows; ++j)
+			{
+				uint8_t* row = buf + j * nx;
+				for (size_t i = 1; i < nx; ++i) row[i] += row[i - 1];
+			}
+		}
 
-	// allocate buffer for image
-	DWORD imSize = imWidth * imLength * (bitsPerSample == 16 ? 2 : 1);
-	uint8_t* buf = new uint8_t[imSize];
-	uint8_t* tmp = buf;
-	_TiffImage im;
-	im.nx = imWidth;
-	im.ny = imLength;
-	im.bps = bitsPerSample;
-	im.pd = buf;
-	im.photometric = photometric;
-	im.description = description;
-	im.xres = (xres != 0.f ? xres : 1.f);
-	im.yres = (yres != 0.f ? yres : 1.f);
-	m_img.push_back(im);
+		if (im.photometric == PHOTOMETRIC_MINISWHITE)
+		{
+			for (size_t i = 0; i < nx * rows; ++i) buf[i] = 255 - buf[i];
+		}
+	}
+}
 
-	// This assumes only one strip per image!!
-	DWORD bytesRead = 0;
-	int nstrip = 0;
-	while (bytesRead < imSize)
+bool CTiffImageSource::Impl::decodeImages(C3DImage* im, int nc, int dimOrder, FSThreadedTask* task)
+{
+	int images = (int)m_img.size();
+	int nz = images / nc;
+	size_t nx = m_img[0].nx;
+	size_t ny = m_img[0].ny;
+	size_t bpp = m_img[0].bps / 8;
+	size_t rowSize = nx * bpp;
+	size_t pageSize = rowSize * ny;
+	uint8_t* pb = im->GetBytes();
+
+	// cleared by any thread that fails to decode a strip
+	std::atomic<bool> bok(true);
+	int ndone = 0;
+	if (nc == 1)
 	{
-		TIFSTRIP& strip = strips[nstrip++];
-		fseek(m_fp, strip.offset, SEEK_SET);
+		// The strips of all the pages are decoded concurrently, straight into the image buffer.
+		std::vector<std::pair<int, int> > items;
+		for (int k = 0; k < images; ++k)
+		{
+			_TiffImage& tif = m_img[k];
+			int strips = (int)((ny + tif.rowsPerStrip - 1) / tif.rowsPerStrip);
+			for (int i = 0; i < strips; ++i) items.push_back(std::pair<int, int>(k, i));
+		}
 
-		if (compression == TIF_COMPRESSION_NONE)
+		int N = (int)items.size();
+		#pragma omp parallel for schedule(dynamic)
+		for (int n = 0; n < N; ++n)
 		{
-			fread(tmp, strip.byteCount, 1, m_fp);
-			bytesRead += strip.byteCount;
-			tmp += strip.byteCount;
+			if (!bok || task->IsCanceled()) continue;
+
+			const _TiffImage& tif = m_img[items[n].first];
+			int nstrip = items[n].second;
+			size_t row0 = (size_t)nstrip * tif.rowsPerStrip;
+			size_t rows = std::min((size_t)tif.rowsPerStrip, ny - row0);
+			uint8_t* dst = pb + items[n].first * pageSize + row0 * rowSize;
+
+			if (decodeStrip(tif, nstrip, dst, rows * rowSize)) postProcess(tif, dst, rows);
+			else bok.store(false);
+
+			#pragma omp critical
+			{
+				ndone++;
+				task->setProgress((100.0 * ndone) / N);
+			}
 		}
-		else if (compression == TIF_COMPRESSION_LZW)
+	}
+	else if (nc == 3)
+	{
+		// The pages are decoded concurrently. Each page is decoded into a buffer
+		// and then copied to its channel in the image buffer.
+		#pragma omp parallel
 		{
-			// read the compressed stream
-			uint8_t* stream = new uint8_t[strip.byteCount];
-			fread(stream, strip.byteCount, 1, m_fp);
-
-			// decompress the zream
-			int decompressedSize = lzw_decompress(tmp, stream, imSize);
-			bytesRead += decompressedSize;
-			tmp += decompressedSize;
+			std::vector<uint8_t> page(pageSize);
+
+			#pragma omp for schedule(dynamic)
+			for (int k = 0; k < images; ++k)
+			{
+				if (!bok || task->IsCanceled()) continue;
+
+				const _TiffImage& tif = m_img[k];
+				int strips = (int)((ny + tif.rowsPerStrip - 1) / tif.rowsPerStrip);
+				for (int i = 0; i < strips; ++i)
+				{
+					size_t row0 = (size_t)i * tif.rowsPerStrip;
+					size_t rows = std::min((size_t)tif.rowsPerStrip, ny - row0);
+					uint8_t* dst = page.data() + row0 * rowSize;
+					if (decodeStrip(tif, i, dst, rows * rowSize)) postProcess(tif, dst, rows);
+					else bok.store(false);
+				}
+
+				// figure out the slice and channel
+				int slice = k / 3;
+				int channel = k % 3;
+				if ((tif.bps == 16) && (dimOrder == ome::DimensionOrder::XYZTC))
+				{
+					slice = k % nz;
+					channel = k / nz;
+				}
+
+				size_t imSize = nx * ny;
+				if (tif.bps == 8)
+				{
+					uint8_t* buf = pb + slice * imSize * 3;
+					for (size_t i = 0; i < imSize; ++i) buf[3 * i + channel] = page[i];
+				}
+				else
+				{
+					WORD* buf = (WORD*)pb + slice * imSize * 3;
+					WORD* b = (WORD*)page.data();
+					for (size_t i = 0; i < imSize; ++i) buf[3 * i + channel] = b[i];
+				}
+
+				#pragma omp critical
+				{
+					ndone++;
+					task->setProgress((100.0 * ndone) / images);
+				}
+			}
 		}
 	}
 
-	return true;
+	if (task->IsCanceled()) return false;
+
+	return bok.load();
 }
 
 void CTiffImageSource::Save(OArchive& ar)
@@ -829,7 +995,7 @@ class LZWDecompress
 	typedef std::pair<uint8_t*, int>	Entry;
 
 public:
-	LZWDecompress(uint8_t* src) : m_src(src) 
+	LZWDecompress(const uint8_t* src, size_t src_size) : m_src(src), m_end(src + src_size)
 	{
 		m_max_size = 0;
 		m_s = m_src; m_startBit = 0; m_bps = 9; 
@@ -846,8 +1012,8 @@ public:
 	{
 		uint8_t* b = entry.first;
 		int size = entry.second;
+		if (size > m_max_size - m_dsize) size = (int)(m_max_size - m_dsize);
 		for (int i = 0; i < size; ++i) { (*m_d++) = *b++; m_dsize++; }
-		int a = 0;
 	}
 
 	size_t decompress(uint8_t* dst, size_t max_buf_size)
@@ -856,13 +1022,14 @@ public:
 		m_dsize = 0;
 		m_max_size = max_buf_size;
 		DWORD code = 0, oldcode = 0;
-		while ((code = nextCode()) != EOI_CODE)
+		initDictionary();
+		while (((code = nextCode()) != EOI_CODE) && (m_dsize < m_max_size))
 		{
 			if (code == CLEAR_CODE)
 			{
 				initDictionary();
 				code = nextCode();
-				if (code == EOI_CODE) break;
+				if ((code == EOI_CODE) || (code >= m_dic.size())) break;
 				writeString(m_dic[code]);
 				oldcode = code;
 			}
@@ -875,13 +1042,14 @@ public:
 					addToDictionary(sc);
 					oldcode = code;
 				}
-				else
+				else if (code == m_dic.size())
 				{
 					Entry OutString = appendEntry(m_dic[oldcode], m_dic[oldcode].first[0]);
 					writeString(OutString);
 					addToDictionary(OutString);
 					oldcode = code;
 				}
+				else break;
 			}
 			assert(m_dsize <= max_buf_size);
 		}
@@ -899,16 +1067,17 @@ public:
 	{
 		DWORD code = 0;
 		int bitsread = 0;
-		WORD buf = m_s[0];
 		while (bitsread < m_bps)
 		{
+			// a stream that is not terminated properly ends at the end of the strip
+			if (m_s >= m_end) return EOI_CODE;
+			WORD buf = m_s[0];
 			code |= ((buf >> (7 - m_startBit)) & 0x01) << (m_bps - bitsread - 1);
 			bitsread++;
 			m_startBit++;
 			if (m_startBit == 8)
 			{
 				m_s++;
-				buf = m_s[0];
 				m_startBit = 0;
 			}
 		}
@@ -926,6 +1095,7 @@ public:
 
 	void addToDictionary(const Entry& s)
 	{
+		if (m_dic.size() >= 4096) return;
 		m_dic.push_back(s);
 		if (m_dsize == m_max_size) return;
 
@@ -996,11 +1166,12 @@ private:
 	enum { DEFAULT_PAGE_SIZE = 16384 }; // 16K
 
 private:
-	uint8_t* m_src;
-	uint8_t* m_s;
+	const uint8_t* m_src;
+	const uint8_t* m_end;
+	const uint8_t* m_s;
 	uint8_t* m_d;
 	size_t	m_dsize;
-	DWORD m_max_size;
+	size_t m_max_size;
 	int	  m_startBit;
 	int	  m_bps;
 	DWORD	m_mask;
@@ -1014,9 +1185,59 @@ private:
 
 // this function decompresses a LZW compressed strip
 // the src is the compressed data, and dst is used to store the decoded strip
-size_t lzw_decompress(uint8_t* dst, uint8_t* src, size_t max_dst_size)
+size_t lzw_decompress(uint8_t* dst, const uint8_t* src, size_t src_size, size_t max_dst_size)
 {
-	LZWDecompress lzw(src);
+	LZWDecompress lzw(src, src_size);
 	size_t n = lzw.decompress(dst, max_dst_size);
 	return n;
 }
+
+// this function decompresses a PackBits compressed strip
+size_t packbits_decompress(uint8_t* dst, const uint8_t* src, size_t src_size, size_t max_dst_size)
+{
+	size_t n = 0, i = 0;
+	while ((i < src_size) && (n < max_dst_size))
+	{
+		int h = (int8_t)src[i++];
+		if (h >= 0)
+		{
+			// copy the next h+1 bytes literally
+			size_t count = h + 1;
+			if (count > src_size - i) count = src_size - i;
+			if (count > max_dst_size - n) count = max_dst_size - n;
+			memcpy(dst + n, src + i, count);
+			i += h + 1;
+			n += count;
+		}
+		else if (h != -128)
+		{
+			// repeat the next byte 1-h times
+			if (i >= src_size) break;
+			size_t count = 1 - h;
+			if (count > max_dst_size - n) count = max_dst_size - n;
+			memset(dst + n, src[i++], count);
+			n += count;
+		}
+	}
+	return n;
+}
+
+#ifdef HAVE_ZLIB
+// this function decompresses a Deflate (zlib) compressed strip
+size_t deflate_decompress(uint8_t* dst, const uint8_t* src, size_t src_size, size_t max_dst_size)
+{
+	z_stream strm;
+	memset(&strm, 0, sizeof(z_stream));
+	if (inflateInit(&strm) != Z_OK) return 0;
+
+	strm.next_in = (Bytef*)src;
+	strm.avail_in = (uInt)src_size;
+	strm.next_out = (Bytef*)dst;
+	strm.avail_out = (uInt)max_dst_size;
+	inflate(&strm, Z_FINISH);
+
+	size_t n = max_dst_size - strm.avail_out;
+	inflateEnd(&strm);
+	return n;
+}
+#endif
@@ -24,42 +24,93 @@ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.*/
 
+
 #include "STLimport.h"
 #include <GeomLib/GSurfaceMeshObject.h>
 #include <GeomLib/GModel.h>
+#include <FSCore/MemoryMappedFile.h>
+#include <algorithm>
+#include <stdint.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 //-----------------------------------------------------------------------------
-STLimport::STLimport(FSProject& prj) : FSFileImport(prj)
+// helper functions for parsing the ASCII STL format from a memory buffer
+static inline const char* skip_space(const char* sz, const char* szend)
 {
+	while ((sz < szend) && isspace((unsigned char)*sz)) ++sz;
+	return sz;
 }
 
-//-----------------------------------------------------------------------------
-STLimport::~STLimport(void)
+// move to the start of the next line
+static inline const char* skip_line(const char* sz, const char* szend)
 {
+	while ((sz < szend) && (*sz != '\n')) ++sz;
+	return (sz < szend ? sz + 1 : sz);
 }
 
-//-----------------------------------------------------------------------------
-// read a line from the input file
-bool STLimport::read_line(char* szline, const char* sz)
+static inline bool match(const char* sz, const char* szend, const char* key)
 {
-	m_nline++;
+	size_t l = strlen(key);
+	return (((size_t)(szend - sz) >= l) && (strncmp(sz, key, l) == 0));
+}
 
-	int l = (int)strlen(sz);
-	if (fgets(szline, 255, m_fp) == 0) return false;
+// read a floating point value that is on the current line
+static inline const char* read_float(const char* sz, const char* szend, float& f, bool& ok)
+{
+	while ((sz < szend) && ((*sz == ' ') || (*sz == '\t'))) ++sz;
 
-	// remove leading white space
+	// copy the token, since the buffer is not null-terminated
+	char buf[64];
 	int n = 0;
-	while (isspace(szline[n])) ++n;
-	if (n != 0)
+	while ((sz < szend) && (n < 63) && !isspace((unsigned char)*sz)) buf[n++] = *sz++;
+	buf[n] = 0;
+
+	char* end = nullptr;
+	f = (float)strtod(buf, &end);
+	ok = ((n > 0) && (end == buf + n));
+	return sz;
+}
+
+// find the start of the first line at or after sz that starts a facet (or ends the solid)
+static const char* find_facet_start(const char* sz, const char* szbegin, const char* szend)
+{
+	if ((sz > szbegin) && (sz[-1] != '\n')) sz = skip_line(sz, szend);
+	while (sz < szend)
 	{
-		char* ch = szline + n;
-		n = 0;
-		while (*ch) szline[n++] = *ch++;
+		const char* s = sz;
+		while ((s < szend) && ((*s == ' ') || (*s == '\t') || (*s == '\r'))) ++s;
+		if (match(s, szend, "facet") || match(s, szend, "endsolid")) return sz;
+		sz = skip_line(sz, szend);
 	}
-	
-	if (strncmp(szline, sz, l) != 0) return false;
+	return szend;
+}
 
-	return true;
+// return the (one-based) line number of the character pointed to by sz
+static int line_number(const char* szbegin, const char* sz)
+{
+	return (int)std::count(szbegin, sz, '\n') + 1;
+}
+
+// A binary STL file's size is fully determined by its triangle count. We check this
+// first, since the 80-byte header of a binary file is allowed to start with "solid".
+static bool is_binary_stl(const MemoryMappedFile& file)
+{
+	if (file.Size() < 84) return false;
+	unsigned int numtri = 0;
+	memcpy(&numtri, file.Data() + 80, sizeof(numtri));
+	return ((numtri > 0) && (file.Size() == 84 + 50 * (size_t)numtri));
+}
+
+//-----------------------------------------------------------------------------
+STLimport::STLimport(FSProject& prj) : FSFileImport(prj)
+{
+}
+
+//-----------------------------------------------------------------------------
+STLimport::~STLimport(void)
+{
 }
 
 //-----------------------------------------------------------------------------
@@ -69,15 +120,28 @@ bool STLimport::Load(const char* szfile)
 	FSModel& fem = m_prj.GetFSModel();
 	m_pfem = &fem;
 
-	// try to read ascii STL
-	if (read_ascii(szfile) == false)
+	Reset();
+
+	MemoryMappedFile file;
+	if (file.Open(szfile) == false) return errf("Failed opening file %s.", szfile);
+	SetFileName(szfile);
+
+	if (is_binary_stl(file))
+	{
+		if (read_binary(file) == false) return false;
+	}
+	else if (read_ascii(file) == false)
 	{
 		// try to read binary STL
-		if (read_binary(szfile) == false)
+		ClearErrors();
+		if (read_binary(file) == false)
 		{
 			return false;
 		}
 	}
+	file.Close();
+
+	if (m_Vert.empty()) return errf("No facets found in file %s.", szfile);
 
 	// build the nodes
 	GObject* po = build_mesh();
@@ -102,166 +166,269 @@ bool STLimport::Load(const char* szfile)
 }
 
 //-----------------------------------------------------------------------------
-bool STLimport::read_ascii(const char* szfile)
+bool STLimport::read_ascii(const MemoryMappedFile& file)
 {
-	m_nline = 0;
-
-	// try to open the file
-	if (Open(szfile, "rt") == false) return errf("Failed opening file %s.", szfile);
+	const char* szbegin = file.Data();
+	const char* szend = szbegin + file.Size();
 
 	// read the first line
-	char szline[256] = { 0 };
-	if (read_line(szline, "solid") == false) return errf("First line must be solid definition.");
+	const char* sz = skip_space(szbegin, szend);
+	if (match(sz, szend, "solid") == false) return errf("First line must be solid definition.");
+	sz = skip_line(sz, szend);
+
+	// split the facet data in chunks that are parsed concurrently
+	int nchunks = 1;
+	size_t nbytes = szend - sz;
+#ifdef _OPENMP
+	if (nbytes > (1 << 20)) nchunks = omp_get_max_threads();
+#endif
+	std::vector<const char*> start(nchunks + 1);
+	start[0] = sz;
+	start[nchunks] = szend;
+	for (int i = 1; i < nchunks; ++i)
+	{
+		const char* si = std::max(start[i - 1], sz + (nbytes / nchunks) * i);
+		start[i] = find_facet_start(si, szbegin, szend);
+	}
 
-	// clear the list
-	m_Face.clear();
+	std::vector< std::vector<float> > vert(nchunks);
+	std::vector<const char*> stop(nchunks);
+	std::vector<char> endsolid(nchunks, 0), error(nchunks, 0);
+#pragma omp parallel for schedule(static, 1)
+	for (int i = 0; i < nchunks; ++i)
+	{
+		bool es = false, err = false;
+		stop[i] = parse_facets(start[i], start[i + 1], vert[i], es, err);
+		endsolid[i] = (es ? 1 : 0);
+		error[i] = (err ? 1 : 0);
+	}
+
+	// everything after the endsolid tag is ignored
+	int last = -1;
+	size_t nsize = 0;
+	for (int i = 0; i < nchunks; ++i)
+	{
+		if (error[i]) return errf("Error encountered at line %d", line_number(szbegin, stop[i]));
+		nsize += vert[i].size();
+		if (endsolid[i]) { last = i; break; }
+	}
+	if (last == -1) return errf("Error encountered at line %d", line_number(szbegin, szend));
 
-	// read all the triangles
-	int nc = 0;
-	FACET face;
-	do
+	m_Vert.clear();
+	m_Vert.reserve(nsize);
+	for (int i = 0; i <= last; ++i)
 	{
+		m_Vert.insert(m_Vert.end(), vert[i].begin(), vert[i].end());
+		std::vector<float>().swap(vert[i]);
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+const char* STLimport::parse_facets(const char* sz, const char* szend, std::vector<float>& vert, bool& endsolid, bool& error)
+{
+	endsolid = false;
+	error = false;
+	float v[9];
+	bool ok = true;
+	while (true)
+	{
+		sz = skip_space(sz, szend);
+		if (sz >= szend) return sz;
+
+		// check for the endsolid tag
+		if (match(sz, szend, "endsolid")) { endsolid = true; return sz; }
+
 		// read the facet line
-		if (read_line(szline, "facet normal") == false)
-		{
-			// check for the endsolid tag
-			if (strncmp(szline, "endsolid", 8) == 0) break;
-			else return errf("Error encountered at line %d", m_nline);
-		}
+		if (match(sz, szend, "facet normal") == false) { error = true; return sz; }
+		sz = skip_line(sz, szend);
 
 		// read the outer loop line
-		if (read_line(szline, "outer loop") == false) return errf("Error encountered at line %d", m_nline);
+		sz = skip_space(sz, szend);
+		if (match(sz, szend, "outer loop") == false) { error = true; return sz; }
+		sz = skip_line(sz, szend);
 
 		// read the vertex data
-		float x, y, z;
-		if (read_line(szline, "vertex ") == false) return errf("Error encountered at line %d", m_nline);
-		sscanf(szline, "vertex %g%g%g", &x, &y, &z);
-		face.v1[0] = x;	face.v1[1] = y; face.v1[2] = z;
-
-		if (read_line(szline, "vertex ") == false) return errf("Error encountered at line %d", m_nline);
-		sscanf(szline, "vertex %g%g%g", &x, &y, &z);
-		face.v2[0] = x;	face.v2[1] = y; face.v2[2] = z;
-
-		if (read_line(szline, "vertex ") == false) return errf("Error encountered at line %d", m_nline);
-		sscanf(szline, "vertex %g%g%g", &x, &y, &z);
-		face.v3[0] = x;	face.v3[1] = y; face.v3[2] = z;
+		for (int i = 0; i < 3; ++i)
+		{
+			sz = skip_space(sz, szend);
+			if (match(sz, szend, "vertex") == false) { error = true; return sz; }
+			const char* szline = sz;
+			sz += 6;
+			for (int j = 0; j < 3; ++j)
+			{
+				sz = read_float(sz, szend, v[3 * i + j], ok);
+				if (ok == false) { error = true; return szline; }
+			}
+			sz = skip_line(sz, szend);
+		}
 
 		// read the endloop tag
-		if (read_line(szline, "endloop") == false) return errf("Error encountered at line %d", m_nline);
+		sz = skip_space(sz, szend);
+		if (match(sz, szend, "endloop") == false) { error = true; return sz; }
+		sz = skip_line(sz, szend);
 
 		// read the endfacet tag
-		if (read_line(szline, "endfacet") == false) return errf("Error encountered at line %d", m_nline);
+		sz = skip_space(sz, szend);
+		if (match(sz, szend, "endfacet") == false) { error = true; return sz; }
+		sz = skip_line(sz, szend);
 
 		// add the facet to the list
-		m_Face.push_back(face);
-	} while (1);
-
-	// close the file
-	Close();
-
-	return true;
+		vert.insert(vert.end(), v, v + 9);
+	}
 }
 
 //-----------------------------------------------------------------------------
-// read a line from the input file
-bool STLimport::read_facet(STLimport::FACET& f)
+// Load a binary STL model
+bool STLimport::read_binary(const MemoryMappedFile& file)
 {
-	unsigned short att;
-	if (fread(f.norm, sizeof(float), 3, m_fp) != 3) return false;
-	if (fread(f.v1, sizeof(float), 3, m_fp) != 3) return false;
-	if (fread(f.v2, sizeof(float), 3, m_fp) != 3) return false;
-	if (fread(f.v3, sizeof(float), 3, m_fp) != 3) return false;
-	if (fread(&att, sizeof(att), 1, m_fp) != 1) return false;
+	// read the header
+	if (file.Size() < 84) return errf("Failed reading header.");
+	const char* data = file.Data();
+
+	// read the number of triangles
+	int numtri = 0;
+	memcpy(&numtri, data + 80, sizeof(int));
+	if (numtri <= 0) return errf("Invalid number of triangles.");
+
+	// each triangle is stored as normal (3 floats), 3 vertices (9 floats) and a 2-byte attribute
+	if (file.Size() < 84 + 50 * (size_t)numtri) return errf("Error encountered reading triangle data.");
+
+	// read all the triangles (the normal and attribute are skipped)
+	m_Vert.resize(9 * (size_t)numtri);
+	float* pv = m_Vert.data();
+#pragma omp parallel for
+	for (int i = 0; i < numtri; ++i)
+	{
+		memcpy(pv + 9 * (size_t)i, data + 84 + 50 * (size_t)i + 12, 9 * sizeof(float));
+	}
+
 	return true;
 }
 
 //-----------------------------------------------------------------------------
-// Load an STL model
-bool STLimport::read_binary(const char* szfile)
+// Hash table used for merging coincident vertices. The coordinates are quantised
+// on a grid and the table maps each occupied grid cell to a linked list of
+// the nodes that lie in that cell.
+class VertexWelder
 {
-	FSModel& fem = m_prj.GetFSModel();
-	m_pfem = &fem;
+public:
+	VertexWelder(const BOX& box, size_t reserveNodes, double eps) : m_eps(eps)
+	{
+		const double NQ = (double)((1 << 21) - 1);
+		m_r0 = vec3d(box.x0, box.y0, box.z0);
+		double wx = box.x1 - box.x0; if (wx <= 0) wx = 1.0;
+		double wy = box.y1 - box.y0; if (wy <= 0) wy = 1.0;
+		double wz = box.z1 - box.z0; if (wz <= 0) wz = 1.0;
+		m_s = vec3d(NQ / wx, NQ / wy, NQ / wz);
+
+		m_node.reserve(reserveNodes);
+		m_next.reserve(reserveNodes);
+		rehash(1024);
+	}
 
-	// try to open the file
-	if (Open(szfile, "rb") == false) return errf("Failed opening file %s.", szfile);
+	// find the node at position r, or add a new one
+	int find_node(const vec3d& r)
+	{
+		uint64_t key = quantise(r);
+		size_t slot = find_slot(key);
+		if (m_head[slot] >= 0)
+		{
+			// see if this node is already in this cell
+			for (int n = m_head[slot]; n >= 0; n = m_next[n])
+			{
+				const vec3d& rn = m_node[n];
+				if ((rn - r) * (rn - r) < m_eps) return n;
+			}
+		}
+		else
+		{
+			m_key[slot] = key;
+			m_used++;
+		}
 
-	// read the header
-	char szbuf[80] = { 0 };
-	if (fread(szbuf, 80, 1, m_fp) != 1) return errf("Failed reading header.");
+		int n = (int)m_node.size();
+		m_node.push_back(r);
+		m_next.push_back(m_head[slot]);
+		m_head[slot] = n;
 
-	// clear the list
-	m_Face.clear();
+		// keep the load factor below 1/2
+		if (2 * m_used > m_key.size()) rehash(2 * m_key.size());
 
-	// read the number of triangles
-	int numtri = 0;
-	fread(&numtri, sizeof(int), 1, m_fp);
-	if (numtri <= 0) return errf("Invalid number of triangles.");
+		return n;
+	}
 
-	// read all the triangles
-	FACET face;
-	for (int i = 0; i < numtri; ++i)
+	std::vector<vec3d>& Nodes() { return m_node; }
+
+private:
+	uint64_t quantise(const vec3d& r) const
 	{
-		// read the facet line
-		if (read_facet(face) == false) return errf("Error encountered reading triangle data.");
+		uint64_t i = (uint64_t)std::max(0.0, (r.x - m_r0.x) * m_s.x);
+		uint64_t j = (uint64_t)std::max(0.0, (r.y - m_r0.y) * m_s.y);
+		uint64_t k = (uint64_t)std::max(0.0, (r.z - m_r0.z) * m_s.z);
+		return (i << 42) | (j << 21) | k;
+	}
 
-		// add the facet to the list
-		m_Face.push_back(face);
+	size_t find_slot(uint64_t key) const
+	{
+		size_t mask = m_key.size() - 1;
+		size_t slot = (size_t)((key * 0x9E3779B97F4A7C15ull) >> 20) & mask;
+		while ((m_head[slot] >= 0) && (m_key[slot] != key)) slot = (slot + 1) & mask;
+		return slot;
+	}
+
+	void rehash(size_t newSize)
+	{
+		std::vector<uint64_t> oldKey; oldKey.swap(m_key);
+		std::vector<int> oldHead; oldHead.swap(m_head);
+		m_key.assign(newSize, 0);
+		m_head.assign(newSize, -1);
+		for (size_t i = 0; i < oldKey.size(); ++i)
+		{
+			if (oldHead[i] >= 0)
+			{
+				size_t slot = find_slot(oldKey[i]);
+				m_key[slot] = oldKey[i];
+				m_head[slot] = oldHead[i];
+			}
+		}
 	}
 
-	// close the file
-	Close();
+private:
+	vec3d	m_r0, m_s;	// quantisation origin and scale
+	double	m_eps;		// squared distance tolerance
 
-	return true;
-}
+	std::vector<uint64_t>	m_key;	// cell key of each slot
+	std::vector<int>		m_head;	// first node in each slot (-1 if empty)
+	size_t					m_used = 0;
+
+	std::vector<vec3d>	m_node;	// node coordinates
+	std::vector<int>	m_next;	// next node in the same cell
+};
 
 //-----------------------------------------------------------------------------
 // Build the FE model
 GObject* STLimport::build_mesh()
 {
-	int i;
-
 	// number of facets
-	int NF = (int)m_Face.size();
+	int NF = (int)(m_Vert.size() / 9);
 
 	// find the bounding box of the model
 	BOX& b = m_box = BoundingBox();
 	double h = 0.01*b.GetMaxExtent();
 	b.Inflate(h,h,h);
-	vec3d r0(b.x0, b.y0, b.z0);
-	vec3d r1(b.x1, b.y1, b.z1);
 
-	// create the box partition
-	int NB = m_NB = (int) pow((double) (NF*3), 0.17) + 1;
-	m_BL.resize(NB*NB*NB);
-	int n = 0;
-	for (i=0; i<NB; ++i)
-		for (int j=0; j<NB; ++j)
-			for (int k=0; k<NB; ++k)
-			{
-				OBOX& bn = m_BL[n++];
-				bn.r0.x = r0.x + i*(r1.x - r0.x)/NB;
-				bn.r0.y = r0.x + j*(r1.x - r0.x)/NB;
-				bn.r0.z = r0.x + k*(r1.x - r0.x)/NB;
-
-				bn.r1.x = r0.x + (i+1)*(r1.x - r0.x)/NB;
-				bn.r1.y = r0.x + (j+1)*(r1.x - r0.x)/NB;
-				bn.r1.z = r0.x + (k+1)*(r1.x - r0.x)/NB;
-			}
-
-	// reserve space for nodes
-	m_Node.reserve(NF*3);
-	
-	// create the nodes
-	list<FACET>::iterator pf = m_Face.begin();
-	int nid = 0;
-	for (i=0; i<NF; ++i, ++pf)
+	// merge the vertices into nodes
+	VertexWelder welder(b, (size_t)NF / 2 + 3, 1e-14);
+	m_Face.resize(3 * (size_t)NF);
+	for (size_t i = 0; i < 3 * (size_t)NF; ++i)
 	{
-		FACET& f = *pf;
-        vec3d v1 = vec3d(f.v1[0], f.v1[1], f.v1[2]); f.n[0] = find_node(v1);
-        vec3d v2 = vec3d(f.v2[0], f.v2[1], f.v2[2]); f.n[1] = find_node(v2);
-        vec3d v3 = vec3d(f.v3[0], f.v3[1], f.v3[2]); f.n[2] = find_node(v3);
-		f.nid = nid++;
+		const float* v = &m_Vert[3 * i];
+		m_Face[i] = welder.find_node(vec3d(v[0], v[1], v[2]));
 	}
+	std::vector<float>().swap(m_Vert);
+	m_Node.swap(welder.Nodes());
 	int NN = (int)m_Node.size();
 
 	// create the mesh
@@ -269,29 +436,26 @@ GObject* STLimport::build_mesh()
 	pm->Create(NN, 0, NF);
 
 	// create nodes
-	for (i=0; i<NN; ++i)
+#pragma omp parallel for
+	for (int i=0; i<NN; ++i)
 	{
-		vec3d& ri = m_Node[i].r;
 		FSNode& node = pm->Node(i);
-		node.pos(ri);
+		node.pos(m_Node[i]);
 	}
 
 	// create elements
-	list<FACET>::iterator is = m_Face.begin();
-	for (i=0; i<NF; ++i, ++is)
+#pragma omp parallel for
+	for (int i=0; i<NF; ++i)
 	{
-		FACET& f = *is;
-		int n = f.nid;
-		if (n >= 0)
-		{
-			FSFace& face = pm->Face(n);
-			face.SetType(FE_FACE_TRI3);
-			face.m_gid = 0;
-			face.n[0] = f.n[0];
-			face.n[1] = f.n[1];
-			face.n[2] = f.n[2];
-		}
+		FSFace& face = pm->Face(i);
+		face.SetType(FE_FACE_TRI3);
+		face.m_gid = 0;
+		face.n[0] = m_Face[3 * i    ];
+		face.n[1] = m_Face[3 * i + 1];
+		face.n[2] = m_Face[3 * i + 2];
 	}
+	std::vector<vec3d>().swap(m_Node);
+	std::vector<int>().swap(m_Face);
 
 	// update the mesh
 	pm->RebuildMesh();
@@ -300,53 +464,17 @@ GObject* STLimport::build_mesh()
 	return po;
 }
 
-//-----------------------------------------------------------------------------
-int STLimport::FindBox(const vec3d& r)
-{
-	BOX& b = m_box;
-	int i = (int)(m_NB*(r.x - b.x0)/(b.x1 - b.x0));
-	int j = (int)(m_NB*(r.y - b.y0)/(b.y1 - b.y0));
-	int k = (int)(m_NB*(r.z - b.z0)/(b.z1 - b.z0));
-	return k + j*(m_NB + i*m_NB);
-}
-
-//-----------------------------------------------------------------------------
-int STLimport::find_node(const vec3d& r, const double eps)
-{
-	// get the box in which this node lies
-	int nb = FindBox(r);
-	assert((nb >= 0)&&(nb<(int)m_BL.size()));
-	OBOX& b = m_BL[nb];
-
-	// see if this node is already in this box
-	int N = (int)b.NL.size();
-	for (int i=0; i<N; ++i)
-	{
-		NODE& ni = m_Node[b.NL[i]];
-		vec3d& ri = ni.r;
-		if ((ri - r)*(ri - r) < eps) return ni.n;
-	}
-
-	N = (int)m_Node.size();
-	NODE nd;
-	nd.r = r;
-	nd.n = N;
-	m_Node.push_back(nd);
-	b.NL.push_back(nd.n);
-	return nd.n;
-}
-
 //-----------------------------------------------------------------------------
 BOX STLimport::BoundingBox()
 {
-	list<FACET>::iterator pf = m_Face.begin();
-	vec3d r = vec3d(pf->v1[0], pf->v1[1], pf->v1[2]);
+	size_t NV = m_Vert.size() / 3;
+	const float* v = m_Vert.data();
+	vec3d r = vec3d(v[0], v[1], v[2]);
 	BOX b(r, r);
-	for (pf = m_Face.begin(); pf != m_Face.end(); ++pf)
+	for (size_t i = 1; i < NV; ++i)
 	{
-		b += vec3d(pf->v1[0], pf->v1[1], pf->v1[2]);
-		b += vec3d(pf->v2[0], pf->v2[1], pf->v2[2]);
-		b += vec3d(pf->v3[0], pf->v3[1], pf->v3[2]);
+		v = &m_Vert[3 * i];
+		b += vec3d(v[0], v[1], v[2]);
 	}
 	return b;
 }
@@ -30,41 +30,11 @@ SOFTWARE.*/
 #include <FEMLib/FSProject.h>
 
 #include <vector>
-#include <list>
+
+class MemoryMappedFile;
 
 class STLimport : public FSFileImport
 {
-	struct FACET
-	{
-		float	norm[3];
-		float	v1[3];
-		float	v2[3];
-		float	v3[3];
-		int		n[3];
-		int		nid;
-	};
-
-	struct NODE
-	{
-		vec3d	r;
-		int		n;
-	};
-
-	class OBOX
-	{
-	public:
-		vec3d		r0, r1;		// points defining box
-		std::vector<int>	NL;			// list of nodes inside this box
-
-	public:
-		OBOX(){}
-		OBOX(const OBOX& b) 
-		{
-			r0 = b.r0; r1 = b.r1;
-			NL = b.NL; 
-		}
-	};
-
 public:
 	STLimport(FSProject& prj);
 	virtual ~STLimport(void);
@@ -72,29 +42,23 @@ public:
 	bool Load(const char* szfile);
 
 protected:
-	bool read_line(char* szline, const char* sz);
-
 	GObject* build_mesh();
-	int find_node(const vec3d& r, const double eps = 1e-14);
-	int FindBox(const vec3d& r);
 
 	::BOX BoundingBox();
 
 private:
-	bool read_ascii(const char* szfile);
-	bool read_binary(const char* szfile);
+	bool read_ascii(const MemoryMappedFile& file);
+	bool read_binary(const MemoryMappedFile& file);
 
-private:
-	bool read_facet(FACET& f);
+	// parse the facets in the text range [sz, szend). Returns a pointer to where parsing stopped.
+	// Sets the endsolid flag when the endsolid tag was read and the error flag on failure.
+	const char* parse_facets(const char* sz, const char* szend, std::vector<float>& vert, bool& endsolid, bool& error);
 
 protected:
 	FSModel*			m_pfem;
-	std::list<FACET>	m_Face;
-	std::vector<NODE>	m_Node;
-	int					m_nline;	// line counter
-
-	int					m_NB;
-	std::vector<OBOX>	m_BL;		// box lists
+	std::vector<float>	m_Vert;		// facet vertex coordinates (9 floats per facet)
+	std::vector<vec3d>	m_Node;		// merged node coordinates
+	std::vector<int>	m_Face;		// facet node indices (3 per facet)
 
 	BOX				m_box;		// bounding box
 };
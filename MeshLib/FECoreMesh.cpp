@@ -182,44 +182,73 @@ double FSCoreMesh::ElementVolume(const FEElement_& el)
 }
 
 //-----------------------------------------------------------------------------
-double hex8_volume(vec3d* r, bool bJ)
+// Shape functions and their derivatives at the integration points of a solid
+// element. The volume routines below keep one instance per element type as a
+// function-local static, so the tables are computed once.
+template <int NELN, int NINT> struct SolidGaussTables
 {
-	const int NELN = 8;
-	const int NINT = 8;
-    
-    static double gr[NINT] = { 0 };
-    static double gs[NINT] = { 0 };
-    static double gt[NINT] = { 0 };
-    static double gw[NINT] = { 0 };
-
-	static double H[NINT][NELN] = { 0 };
-	static double Gr[NINT][NELN] = { 0 };
-	static double Gs[NINT][NELN] = { 0 };
-	static double Gt[NINT][NELN] = { 0 };
-	static bool bfirst = true;
-
-	if (bfirst)
+	double gr[NINT], gs[NINT], gt[NINT], gw[NINT];
+	double H[NINT][NELN];
+	double Gr[NINT][NELN], Gs[NINT][NELN], Gt[NINT][NELN];
+
+	SolidGaussTables(
+		void (*gauss_data)(double*, double*, double*, double*),
+		void (*shape)(double*, double, double, double),
+		void (*shape_deriv)(double*, double*, double*, double, double, double))
 	{
-        HEX8::gauss_data(gr, gs, gt, gw);
-		for (int n = 0; n<NINT; ++n)
+		gauss_data(gr, gs, gt, gw);
+		for (int n = 0; n < NINT; ++n)
 		{
 			// calculate shape function values at gauss points
-			HEX8::shape(H[n], gr[n], gs[n], gt[n]);
+			shape(H[n], gr[n], gs[n], gt[n]);
 
 			// calculate local derivatives of shape functions at gauss points
-			HEX8::shape_deriv(Gr[n], Gs[n], Gt[n], gr[n], gs[n], gt[n]);
+			shape_deriv(Gr[n], Gs[n], Gt[n], gr[n], gs[n], gt[n]);
 		}
+	}
+};
+
+//-----------------------------------------------------------------------------
+// Same as above, for shell elements. The shape functions only depend on (r,s).
+template <int NELN, int NINT> struct ShellGaussTables
+{
+	double gr[NINT], gs[NINT], gt[NINT], gw[NINT];
+	double H[NINT][NELN];
+	double Gr[NINT][NELN], Gs[NINT][NELN];
+
+	ShellGaussTables(
+		void (*gauss_data)(double*, double*, double*, double*),
+		void (*shape)(double*, double, double),
+		void (*shape_deriv)(double*, double*, double, double))
+	{
+		gauss_data(gr, gs, gt, gw);
+		for (int n = 0; n < NINT; ++n)
+		{
+			// calculate shape function values at gauss points
+			shape(H[n], gr[n], gs[n]);
 
-		bfirst = false;
+			// calculate local derivatives of shape functions at gauss points
+			shape_deriv(Gr[n], Gs[n], gr[n], gs[n]);
+		}
 	}
+};
+
+//-----------------------------------------------------------------------------
+double hex8_volume(vec3d* r, bool bJ)
+{
+	const int NELN = 8;
+	const int NINT = 8;
+    
+    // integration point tables (initialized once on first use, which is thread-safe)
+    static const SolidGaussTables<NELN, NINT> tab(HEX8::gauss_data, HEX8::shape, HEX8::shape_deriv);
 
 	double J[3][3];
 	double vol = 0;
 	for (int n = 0; n<NINT; ++n)
 	{
-		double* Grn = Gr[n];
-		double* Gsn = Gs[n];
-		double* Gtn = Gt[n];
+		const double* Grn = tab.Gr[n];
+		const double* Gsn = tab.Gs[n];
+		const double* Gtn = tab.Gt[n];
 
 		J[0][0] = J[0][1] = J[0][2] = 0.0;
 		J[1][0] = J[1][1] = J[1][2] = 0.0;
@@ -248,7 +277,7 @@ double hex8_volume(vec3d* r, bool bJ)
         if (bJ) {
             if ((detJ < vol) || (n == 0)) vol = detJ;
         }
-        else vol += detJ*gw[n];
+        else vol += detJ*tab.gw[n];
 	}
 
 	return vol;
@@ -260,39 +289,16 @@ double hex20_volume(vec3d* r, bool bJ)
     const int NELN = 20;
     const int NINT = 8;
 
-    static double gr[NINT] = { 0 };
-    static double gs[NINT] = { 0 };
-    static double gt[NINT] = { 0 };
-    static double gw[NINT] = { 0 };
-    
-    static double H[NINT][NELN] = { 0 };
-    static double Gr[NINT][NELN] = { 0 };
-    static double Gs[NINT][NELN] = { 0 };
-    static double Gt[NINT][NELN] = { 0 };
-    static bool bfirst = true;
-    
-    if (bfirst)
-    {
-        HEX20::gauss_data(gr, gs, gt, gw);
-        for (int n = 0; n<NINT; ++n)
-        {
-            // calculate shape function values at gauss points
-            HEX20::shape(H[n], gr[n], gs[n], gt[n]);
-            
-            // calculate local derivatives of shape functions at gauss points
-            HEX20::shape_deriv(Gr[n], Gs[n], Gt[n], gr[n], gs[n], gt[n]);
-        }
-        
-        bfirst = false;
-    }
+    // integration point tables (initialized once on first use, which is thread-safe)
+    static const SolidGaussTables<NELN, NINT> tab(HEX20::gauss_data, HEX20::shape, HEX20::shape_deriv);
     
     double J[3][3];
     double vol = 0;
     for (int n = 0; n<NINT; ++n)
     {
-        double* Grn = Gr[n];
-        double* Gsn = Gs[n];
-        double* Gtn = Gt[n];
+        const double* Grn = tab.Gr[n];
+        const double* Gsn = tab.Gs[n];
+        const double* Gtn = tab.Gt[n];
         
         J[0][0] = J[0][1] = J[0][2] = 0.0;
         J[1][0] = J[1][1] = J[1][2] = 0.0;
@@ -321,7 +327,7 @@ double hex20_volume(vec3d* r, bool bJ)
         if (bJ) {
             if ((detJ < vol) || (n == 0)) vol = detJ;
         }
-        else vol += detJ*gw[n];
+        else vol += detJ*tab.gw[n];
     }
     
     return vol;
@@ -334,39 +340,16 @@ double hex27_volume(vec3d* r, bool bJ)
     const int NELN = 27;
     const int NINT = 27;
     
-    static double gr[NINT] = { 0 };
-    static double gs[NINT] = { 0 };
-    static double gt[NINT] = { 0 };
-    static double gw[NINT] = { 0 };
-
-    static double H[NINT][NELN] = { 0 };
-    static double Gr[NINT][NELN] = { 0 };
-    static double Gs[NINT][NELN] = { 0 };
-    static double Gt[NINT][NELN] = { 0 };
-    static bool bfirst = true;
-    
-    if (bfirst)
-    {
-        HEX27::gauss_data(gr, gs, gt, gw);
-        for (int n = 0; n<NINT; ++n)
-        {
-            // calculate shape function values at gauss points
-            HEX27::shape(H[n], gr[n], gs[n], gt[n]);
-            
-            // calculate local derivatives of shape functions at gauss points
-            HEX27::shape_deriv(Gr[n], Gs[n], Gt[n], gr[n], gs[n], gt[n]);
-        }
-        
-        bfirst = false;
-    }
+    // integration point tables (initialized once on first use, which is thread-safe)
+    static const SolidGaussTables<NELN, NINT> tab(HEX27::gauss_data, HEX27::shape, HEX27::shape_deriv);
     
     double J[3][3];
     double vol = 0;
     for (int n = 0; n<NINT; ++n)
     {
-        double* Grn = Gr[n];
-        double* Gsn = Gs[n];
-        double* Gtn = Gt[n];
+        const double* Grn = tab.Gr[n];
+        const double* Gsn = tab.Gs[n];
+        const double* Gtn = tab.Gt[n];
         
         J[0][0] = J[0][1] = J[0][2] = 0.0;
         J[1][0] = J[1][1] = J[1][2] = 0.0;
@@ -395,7 +378,7 @@ double hex27_volume(vec3d* r, bool bJ)
         if (bJ) {
             if ((detJ < vol) || (n == 0)) vol = detJ;
         }
-        else vol += detJ*gw[n];
+        else vol += detJ*tab.gw[n];
     }
     
     return vol;
@@ -433,39 +416,16 @@ double penta6_volume(vec3d* r, bool bJ)
     const int NELN = 6;
     const int NINT = 6;
     
-    static double gr[NINT] = { 0 };
-    static double gs[NINT] = { 0 };
-    static double gt[NINT] = { 0 };
-    static double gw[NINT] = { 0 };
-
-    static double H[NINT][NELN] = { 0 };
-    static double Gr[NINT][NELN] = { 0 };
-    static double Gs[NINT][NELN] = { 0 };
-    static double Gt[NINT][NELN] = { 0 };
-    static bool bfirst = true;
-    
-    if (bfirst)
-    {
-        PENTA6::gauss_data(gr, gs, gt, gw);
-        for (int n = 0; n<NINT; ++n)
-        {
-            // calculate shape function values at gauss points
-            PENTA6::shape(H[n], gr[n], gs[n], gt[n]);
-            
-            // calculate local derivatives of shape functions at gauss points
-            PENTA6::shape_deriv(Gr[n], Gs[n], Gt[n], gr[n], gs[n], gt[n]);
-        }
-        
-        bfirst = false;
-    }
+    // integration point tables (initialized once on first use, which is thread-safe)
+    static const SolidGaussTables<NELN, NINT> tab(PENTA6::gauss_data, PENTA6::shape, PENTA6::shape_deriv);
     
     double J[3][3];
     double vol = 0;
     for (int n = 0; n<NINT; ++n)
     {
-        double* Grn = Gr[n];
-        double* Gsn = Gs[n];
-        double* Gtn = Gt[n];
+        const double* Grn = tab.Gr[n];
+        const double* Gsn = tab.Gs[n];
+        const double* Gtn = tab.Gt[n];
         
         J[0][0] = J[0][1] = J[0][2] = 0.0;
         J[1][0] = J[1][1] = J[1][2] = 0.0;
@@ -494,7 +454,7 @@ double penta6_volume(vec3d* r, bool bJ)
         if (bJ) {
             if ((detJ < vol) || (n == 0)) vol = detJ;
         }
-        else vol += detJ*gw[n];
+        else vol += detJ*tab.gw[n];
     }
     
     return vol;
@@ -506,39 +466,16 @@ double penta15_volume(vec3d* r, bool bJ)
     const int NELN = 15;
     const int NINT = 8;
     
-    static double gr[NINT] = { 0 };
-    static double gs[NINT] = { 0 };
-    static double gt[NINT] = { 0 };
-    static double gw[NINT] = { 0 };
-
-    static double H[NINT][NELN] = { 0 };
-    static double Gr[NINT][NELN] = { 0 };
-    static double Gs[NINT][NELN] = { 0 };
-    static double Gt[NINT][NELN] = { 0 };
-    static bool bfirst = true;
-    
-    if (bfirst)
-    {
-        PENTA15::gauss_data(gr, gs, gt, gw);
-        for (int n = 0; n<NINT; ++n)
-        {
-            // calculate shape function values at gauss points
-            PENTA15::shape(H[n], gr[n], gs[n], gt[n]);
-            
-            // calculate local derivatives of shape functions at gauss points
-            PENTA15::shape_deriv(Gr[n], Gs[n], Gt[n], gr[n], gs[n], gt[n]);
-        }
-        
-        bfirst = false;
-    }
+    // integration point tables (initialized once on first use, which is thread-safe)
+    static const SolidGaussTables<NELN, NINT> tab(PENTA15::gauss_data, PENTA15::shape, PENTA15::shape_deriv);
     
     double J[3][3];
     double vol = 0;
     for (int n = 0; n<NINT; ++n)
     {
-        double* Grn = Gr[n];
-        double* Gsn = Gs[n];
-        double* Gtn = Gt[n];
+        const double* Grn = tab.Gr[n];
+        const double* Gsn = tab.Gs[n];
+        const double* Gtn = tab.Gt[n];
         
         J[0][0] = J[0][1] = J[0][2] = 0.0;
         J[1][0] = J[1][1] = J[1][2] = 0.0;
@@ -567,7 +504,7 @@ double penta15_volume(vec3d* r, bool bJ)
         if (bJ) {
             if ((detJ < vol) || (n == 0)) vol = detJ;
         }
-        else vol += detJ*gw[n];
+        else vol += detJ*tab.gw[n];
     }
     
     return vol;
@@ -599,39 +536,16 @@ double pyra5_volume(vec3d* r, bool bJ)
     const int NELN = 5;
     const int NINT = 8;
     
-    static double gr[NINT] = {0};
-    static double gs[NINT] = {0};
-    static double gt[NINT] = {0};
-    static double gw[NINT] = {0};
-    
-    static double H[NINT][NELN] = { 0 };
-    static double Gr[NINT][NELN] = { 0 };
-    static double Gs[NINT][NELN] = { 0 };
-    static double Gt[NINT][NELN] = { 0 };
-    static bool bfirst = true;
-    
-    if (bfirst)
-    {
-        PYRA5::gauss_data(gr, gs, gt, gw);
-        for (int n = 0; n<NINT; ++n)
-        {
-            // calculate shape function values at gauss points
-            PYRA5::shape(H[n], gr[n], gs[n], gt[n]);
-            
-            // calculate local derivatives of shape functions at gauss points
-            PYRA5::shape_deriv(Gr[n], Gs[n], Gt[n], gr[n], gs[n], gt[n]);
-        }
-        
-        bfirst = false;
-    }
+    // integration point tables (initialized once on first use, which is thread-safe)
+    static const SolidGaussTables<NELN, NINT> tab(PYRA5::gauss_data, PYRA5::shape, PYRA5::shape_deriv);
     
     double J[3][3];
     double vol = 0;
     for (int n = 0; n<NINT; ++n)
     {
-        double* Grn = Gr[n];
-        double* Gsn = Gs[n];
-        double* Gtn = Gt[n];
+        const double* Grn = tab.Gr[n];
+        const double* Gsn = tab.Gs[n];
+        const double* Gtn = tab.Gt[n];
         
         J[0][0] = J[0][1] = J[0][2] = 0.0;
         J[1][0] = J[1][1] = J[1][2] = 0.0;
@@ -660,7 +574,7 @@ double pyra5_volume(vec3d* r, bool bJ)
         if (bJ) {
             if ((detJ < vol) || (n == 0)) vol = detJ;
         }
-        else vol += detJ*gw[n];
+        else vol += detJ*tab.gw[n];
     }
     
     return vol;
@@ -672,39 +586,16 @@ double pyra13_volume(vec3d* r, bool bJ)
     const int NELN = 13;
     const int NINT = 8;
     
-    static double gr[NINT] = {0};
-    static double gs[NINT] = {0};
-    static double gt[NINT] = {0};
-    static double gw[NINT] = {0};
-
-    static double H[NINT][NELN] = { 0 };
-    static double Gr[NINT][NELN] = { 0 };
-    static double Gs[NINT][NELN] = { 0 };
-    static double Gt[NINT][NELN] = { 0 };
-    static bool bfirst = true;
-    
-    if (bfirst)
-    {
-        PYRA13::gauss_data(gr, gs, gt, gw);
-        for (int n = 0; n<NINT; ++n)
-        {
-            // calculate shape function values at gauss points
-            PYRA13::shape(H[n], gr[n], gs[n], gt[n]);
-            
-            // calculate local derivatives of shape functions at gauss points
-            PYRA13::shape_deriv(Gr[n], Gs[n], Gt[n], gr[n], gs[n], gt[n]);
-        }
-        
-        bfirst = false;
-    }
+    // integration point tables (initialized once on first use, which is thread-safe)
+    static const SolidGaussTables<NELN, NINT> tab(PYRA13::gauss_data, PYRA13::shape, PYRA13::shape_deriv);
     
     double J[3][3];
     double vol = 0;
     for (int n = 0; n<NINT; ++n)
     {
-        double* Grn = Gr[n];
-        double* Gsn = Gs[n];
-        double* Gtn = Gt[n];
+        const double* Grn = tab.Gr[n];
+        const double* Gsn = tab.Gs[n];
+        const double* Gtn = tab.Gt[n];
         
         J[0][0] = J[0][1] = J[0][2] = 0.0;
         J[1][0] = J[1][1] = J[1][2] = 0.0;
@@ -733,7 +624,7 @@ double pyra13_volume(vec3d* r, bool bJ)
         if (bJ) {
             if ((detJ < vol) || (n == 0)) vol = detJ;
         }
-        else vol += detJ*gw[n];
+        else vol += detJ*tab.gw[n];
     }
     
     return vol;
@@ -766,41 +657,19 @@ double tri3_volume(vec3d* r, vec3d* D, bool bJ)
     const int NELN = 3;
     const int NINT = 6;
 
-    static double gr[NINT] = { 0 };
-    static double gs[NINT] = { 0 };
-    static double gt[NINT] = { 0 };
-    static double gw[NINT] = { 0 };
-
-    static double H[NINT][NELN] = { 0 };
-    static double Gr[NINT][NELN] = { 0 };
-    static double Gs[NINT][NELN] = { 0 };
-    static bool bfirst = true;
-
-    if (bfirst)
-    {
-        TRI3::gauss_data(gr, gs, gt, gw);
-        for (int n = 0; n < NINT; ++n)
-        {
-            // calculate shape function values at gauss points
-            TRI3::shape(H[n], gr[n], gs[n]);
-
-            // calculate local derivatives of shape functions at gauss points
-            TRI3::shape_deriv(Gr[n], Gs[n], gr[n], gs[n]);
-        }
-
-        bfirst = false;
-    }
+    // integration point tables (initialized once on first use, which is thread-safe)
+    static const ShellGaussTables<NELN, NINT> tab(TRI3::gauss_data, TRI3::shape, TRI3::shape_deriv);
 
     double V = 0;
     vec3d g[3];
     for (int n = 0; n < NINT; ++n)
     {
         // jacobian matrix
-        double eta = gt[n];
+        double eta = tab.gt[n];
 
-        double* Mr = Gr[n];
-        double* Ms = Gs[n];
-        double* M = H[n];
+        const double* Mr = tab.Gr[n];
+        const double* Ms = tab.Gs[n];
+        const double* M = tab.H[n];
 
         // evaluate covariant basis vectors
         g[0] = g[1] = g[2] = vec3d(0, 0, 0);
@@ -822,7 +691,7 @@ double tri3_volume(vec3d* r, vec3d* D, bool bJ)
         if (bJ) {
             if ((detJ < V) || (n == 0)) V = detJ;
         }
-        else V += detJ * gw[n];
+        else V += detJ * tab.gw[n];
     }
 
     return V;
@@ -834,41 +703,19 @@ double quad4_volume(vec3d* r, vec3d* D, bool bJ)
     const int NELN = 4;
     const int NINT = 8;
 
-    static double gr[NINT] = { 0 };
-    static double gs[NINT] = { 0 };
-    static double gt[NINT] = { 0 };
-    static double gw[NINT] = { 0 };
-
-    static double H[NINT][NELN] = { 0 };
-    static double Gr[NINT][NELN] = { 0 };
-    static double Gs[NINT][NELN] = { 0 };
-    static bool bfirst = true;
-
-    if (bfirst)
-    {
-        QUAD4::gauss_data(gr, gs, gt, gw);
-        for (int n = 0; n < NINT; ++n)
-        {
-            // calculate shape function values at gauss points
-            QUAD4::shape(H[n], gr[n], gs[n]);
-
-            // calculate local derivatives of shape functions at gauss points
-            QUAD4::shape_deriv(Gr[n], Gs[n], gr[n], gs[n]);
-        }
-
-        bfirst = false;
-    }
+    // integration point tables (initialized once on first use, which is thread-safe)
+    static const ShellGaussTables<NELN, NINT> tab(QUAD4::gauss_data, QUAD4::shape, QUAD4::shape_deriv);
 
     double V = 0;
     vec3d g[3];
     for (int n = 0; n < NINT; ++n)
     {
         // jacobian matrix
-        double eta = gt[n];
+        double eta = tab.gt[n];
 
-        double* Mr = Gr[n];
-        double* Ms = Gs[n];
-        double* M = H[n];
+        const double* Mr = tab.Gr[n];
+        const double* Ms = tab.Gs[n];
+        const double* M = tab.H[n];
 
         // evaluate covariant basis vectors
         g[0] = g[1] = g[2] = vec3d(0, 0, 0);
@@ -890,7 +737,7 @@ double quad4_volume(vec3d* r, vec3d* D, bool bJ)
         if (bJ) {
             if ((detJ < V) || (n == 0)) V = detJ;
         }
-        else V += detJ * gw[n];
+        else V += detJ * tab.gw[n];
     }
 
     return V;
@@ -926,39 +773,16 @@ double tet4_volume(vec3d* r, bool bJ)
 	const int NELN = 4;
 	const int NINT = 4;
 
-    static double gr[NINT] = {0};
-    static double gs[NINT] = {0};
-    static double gt[NINT] = {0};
-    static double gw[NINT] = {0};
-
-	static double H[NINT][NELN] = { 0 };
-	static double Gr[NINT][NELN] = { 0 };
-	static double Gs[NINT][NELN] = { 0 };
-	static double Gt[NINT][NELN] = { 0 };
-	static bool bfirst = true;
-
-	if (bfirst)
-	{
-        TET4::gauss_data(gr, gs, gt, gw);
-		for (int n = 0; n<NINT; ++n)
-		{
-			// calculate shape function values at gauss points
-			TET4::shape(H[n], gr[n], gs[n], gt[n]);
-
-			// calculate local derivatives of shape functions at gauss points
-			TET4::shape_deriv(Gr[n], Gs[n], Gt[n], gr[n], gs[n], gt[n]);
-		}
-
-		bfirst = false;
-	}
+    // integration point tables (initialized once on first use, which is thread-safe)
+    static const SolidGaussTables<NELN, NINT> tab(TET4::gauss_data, TET4::shape, TET4::shape_deriv);
 
 	double J[3][3];
 	double vol = 0;
 	for (int n = 0; n<NINT; ++n)
 	{
-		double* Grn = Gr[n];
-		double* Gsn = Gs[n];
-		double* Gtn = Gt[n];
+		const double* Grn = tab.Gr[n];
+		const double* Gsn = tab.Gs[n];
+		const double* Gtn = tab.Gt[n];
 
 		J[0][0] = J[0][1] = J[0][2] = 0.0;
 		J[1][0] = J[1][1] = J[1][2] = 0.0;
@@ -987,7 +811,7 @@ double tet4_volume(vec3d* r, bool bJ)
         if (bJ) {
             if ((detJ < vol) || (n == 0)) vol = detJ;
         }
-        else vol += detJ*gw[n];
+        else vol += detJ*tab.gw[n];
 	}
 
 	return vol;
@@ -999,39 +823,16 @@ double tet5_volume(vec3d* r, bool bJ)
     const int NELN = 5;
     const int NINT = 4;
     
-    static double gr[NINT] = {0};
-    static double gs[NINT] = {0};
-    static double gt[NINT] = {0};
-    static double gw[NINT] = {0};
-    
-    static double H[NINT][NELN] = { 0 };
-    static double Gr[NINT][NELN] = { 0 };
-    static double Gs[NINT][NELN] = { 0 };
-    static double Gt[NINT][NELN] = { 0 };
-    static bool bfirst = true;
-    
-    if (bfirst)
-    {
-        TET5::gauss_data(gr, gs, gt, gw);
-        for (int n = 0; n<NINT; ++n)
-        {
-            // calculate shape function values at gauss points
-            TET5::shape(H[n], gr[n], gs[n], gt[n]);
-            
-            // calculate local derivatives of shape functions at gauss points
-            TET5::shape_deriv(Gr[n], Gs[n], Gt[n], gr[n], gs[n], gt[n]);
-        }
-        
-        bfirst = false;
-    }
+    // integration point tables (initialized once on first use, which is thread-safe)
+    static const SolidGaussTables<NELN, NINT> tab(TET5::gauss_data, TET5::shape, TET5::shape_deriv);
     
     double J[3][3];
     double vol = 0;
     for (int n = 0; n<NINT; ++n)
     {
-        double* Grn = Gr[n];
-        double* Gsn = Gs[n];
-        double* Gtn = Gt[n];
+        const double* Grn = tab.Gr[n];
+        const double* Gsn = tab.Gs[n];
+        const double* Gtn = tab.Gt[n];
         
         J[0][0] = J[0][1] = J[0][2] = 0.0;
         J[1][0] = J[1][1] = J[1][2] = 0.0;
@@ -1060,7 +861,7 @@ double tet5_volume(vec3d* r, bool bJ)
         if (bJ) {
             if ((detJ < vol) || (n == 0)) vol = detJ;
         }
-        else vol += detJ*gw[n];
+        else vol += detJ*tab.gw[n];
     }
     
     return vol;
@@ -1072,39 +873,16 @@ double tet10_volume(vec3d* r, bool bJ)
 	const int NELN = 10;
 	const int NINT = 8;
 
-	static double gr[NINT] = { 0 };
-	static double gs[NINT] = { 0 };
-	static double gt[NINT] = { 0 };
-	static double gw[NINT] = { 0 };
-
-	static double H[NINT][NELN] = { 0 };
-	static double Gr[NINT][NELN] = { 0 };
-	static double Gs[NINT][NELN] = { 0 };
-	static double Gt[NINT][NELN] = { 0 };
-	static bool bfirst = true;
-
-	if (bfirst)
-	{
-        TET10::gauss_data(gr, gs, gt, gw);
-		for (int n = 0; n<NINT; ++n)
-		{
-			// calculate shape function values at gauss points
-			TET10::shape(H[n], gr[n], gs[n], gt[n]);
-
-			// calculate local derivatives of shape functions at gauss points
-			TET10::shape_deriv(Gr[n], Gs[n], Gt[n], gr[n], gs[n], gt[n]);
-		}
-
-		bfirst = false;
-	}
+	// integration point tables (initialized once on first use, which is thread-safe)
+	static const SolidGaussTables<NELN, NINT> tab(TET10::gauss_data, TET10::shape, TET10::shape_deriv);
 
 	double J[3][3];
 	double vol = 0;
 	for (int n = 0; n<NINT; ++n)
 	{
-		double* Grn = Gr[n];
-		double* Gsn = Gs[n];
-		double* Gtn = Gt[n];
+		const double* Grn = tab.Gr[n];
+		const double* Gsn = tab.Gs[n];
+		const double* Gtn = tab.Gt[n];
 
 		J[0][0] = J[0][1] = J[0][2] = 0.0;
 		J[1][0] = J[1][1] = J[1][2] = 0.0;
@@ -1133,7 +911,7 @@ double tet10_volume(vec3d* r, bool bJ)
         if (bJ) {
             if ((detJ < vol) || (n == 0)) vol = detJ;
         }
-        else vol += detJ*gw[n];
+        else vol += detJ*tab.gw[n];
 	}
 
 	return vol;
@@ -1145,39 +923,16 @@ double tet15_volume(vec3d* r, bool bJ)
     const int NELN = 15;
     const int NINT = 8;
     
-    static double gr[NINT] = { 0 };
-    static double gs[NINT] = { 0 };
-    static double gt[NINT] = { 0 };
-    static double gw[NINT] = { 0 };
-    
-    static double H[NINT][NELN] = { 0 };
-    static double Gr[NINT][NELN] = { 0 };
-    static double Gs[NINT][NELN] = { 0 };
-    static double Gt[NINT][NELN] = { 0 };
-    static bool bfirst = true;
-    
-    if (bfirst)
-    {
-        TET15::gauss_data(gr, gs, gt, gw);
-        for (int n = 0; n<NINT; ++n)
-        {
-            // calculate shape function values at gauss points
-            TET15::shape(H[n], gr[n], gs[n], gt[n]);
-            
-            // calculate local derivatives of shape functions at gauss points
-            TET15::shape_deriv(Gr[n], Gs[n], Gt[n], gr[n], gs[n], gt[n]);
-        }
-        
-        bfirst = false;
-    }
+    // integration point tables (initialized once on first use, which is thread-safe)
+    static const SolidGaussTables<NELN, NINT> tab(TET15::gauss_data, TET15::shape, TET15::shape_deriv);
     
     double J[3][3];
     double vol = 0;
     for (int n = 0; n<NINT; ++n)
     {
-        double* Grn = Gr[n];
-        double* Gsn = Gs[n];
-        double* Gtn = Gt[n];
+        const double* Grn = tab.Gr[n];
+        const double* Gsn = tab.Gs[n];
+        const double* Gtn = tab.Gt[n];
         
         J[0][0] = J[0][1] = J[0][2] = 0.0;
         J[1][0] = J[1][1] = J[1][2] = 0.0;
@@ -1206,7 +961,7 @@ double tet15_volume(vec3d* r, bool bJ)
         if (bJ) {
             if ((detJ < vol) || (n == 0)) vol = detJ;
         }
-        else vol += detJ*gw[n];
+        else vol += detJ*tab.gw[n];
     }
     
     return vol;
@@ -1218,39 +973,16 @@ double tet20_volume(vec3d* r, bool bJ)
     const int NELN = 20;
     const int NINT = 15;
     
-    static double gr[NINT] = { 0 };
-    static double gs[NINT] = { 0 };
-    static double gt[NINT] = { 0 };
-    static double gw[NINT] = { 0 };
-    
-    static double H[NINT][NELN] = { 0 };
-    static double Gr[NINT][NELN] = { 0 };
-    static double Gs[NINT][NELN] = { 0 };
-    static double Gt[NINT][NELN] = { 0 };
-    static bool bfirst = true;
-    
-    if (bfirst)
-    {
-        TET20::gauss_data(gr, gs, gt, gw);
-        for (int n = 0; n<NINT; ++n)
-        {
-            // calculate shape function values at gauss points
-            TET20::shape(H[n], gr[n], gs[n], gt[n]);
-            
-            // calculate local derivatives of shape functions at gauss points
-            TET20::shape_deriv(Gr[n], Gs[n], Gt[n], gr[n], gs[n], gt[n]);
-        }
-        
-        bfirst = false;
-    }
+    // integration point tables (initialized once on first use, which is thread-safe)
+    static const SolidGaussTables<NELN, NINT> tab(TET20::gauss_data, TET20::shape, TET20::shape_deriv);
     
     double J[3][3];
     double vol = 0;
     for (int n = 0; n<NINT; ++n)
     {
-        double* Grn = Gr[n];
-        double* Gsn = Gs[n];
-        double* Gtn = Gt[n];
+        const double* Grn = tab.Gr[n];
+        const double* Gsn = tab.Gs[n];
+        const double* Gtn = tab.Gt[n];
         
         J[0][0] = J[0][1] = J[0][2] = 0.0;
         J[1][0] = J[1][1] = J[1][2] = 0.0;
@@ -1279,7 +1011,7 @@ double tet20_volume(vec3d* r, bool bJ)
         if (bJ) {
             if ((detJ < vol) || (n == 0)) vol = detJ;
         }
-        else vol += detJ*gw[n];
+        else vol += detJ*tab.gw[n];
     }
     
     return vol;
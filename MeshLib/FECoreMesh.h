@@ -28,6 +28,7 @@ SOFTWARE.*/
 #include "FENode.h"
 #include "FEElement.h"
 #include "FEMeshBase.h"
+#include "FEElementAttributes.h"
 #include <vector>
 #include <functional>
 
@@ -72,6 +73,30 @@ public: // interface for accessing elements
 	// select a list of elements
 	void SelectElements(const std::vector<int>& elem);
 
+public: // element attributes (see FSElementAttributes)
+
+	//! the attribute table. Derived classes must keep it in sync with their element list.
+	FSElementAttributes& ElementAttributes() { return m_elemAtt; }
+	const FSElementAttributes& ElementAttributes() const { return m_elemAtt; }
+
+	// fiber orientation of element i
+	const vec3d& ElementFiber(int i) const { return m_elemAtt.Fiber(i); }
+	void SetElementFiber(int i, const vec3d& a) { m_elemAtt.SetFiber(i, a); }
+
+	// local material axes of element i. The axes are only used when they are active.
+	const mat3d& ElementMaterialAxes(int i) const { return m_elemAtt.MaterialAxes(i); }
+	void SetElementMaterialAxes(int i, const mat3d& Q) { m_elemAtt.SetMaterialAxes(i, Q); }
+	void SetElementMaterialAxes(int i, const vec3d& a, const vec3d& d) { m_elemAtt.SetMaterialAxes(i, a, d); }
+	bool IsElementMaterialAxesActive(int i) const { return m_elemAtt.IsMaterialAxesActive(i); }
+	void SetElementMaterialAxesActive(int i, bool b) { m_elemAtt.SetMaterialAxesActive(i, b); }
+
+	// cross-sectional area of element i (only used by truss elements)
+	double ElementCrossSectionArea(int i) const { return m_elemAtt.CrossSectionArea(i); }
+	void SetElementCrossSectionArea(int i, double a0) { m_elemAtt.SetCrossSectionArea(i, a0); }
+
+	// copy the attributes of element j of mesh src to element i of this mesh
+	void CopyElementAttributes(int i, const FSCoreMesh& src, int j) { m_elemAtt.Copy(i, src.m_elemAtt, j); }
+
 public:
 	void ShowElements(std::vector<int>& elem, bool show = true);
 	void UpdateItemVisibility();
@@ -124,6 +149,9 @@ public:
 	int CountFacePartitions() const;
 	int CountElementPartitions() const;
 	int CountSmoothingGroups() const;
+
+protected:
+	FSElementAttributes	m_elemAtt;	// element attributes (indexed by element)
 };
 
 inline FEElement_* FSCoreMesh::ElementPtr(int n) { return ((n >= 0) && (n<Elements()) ? &ElementRef(n) : 0); }
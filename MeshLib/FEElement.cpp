@@ -50,9 +50,35 @@ FEElement_::FEElement_()
 	m_lid = 0;
 	m_MatID = 0;
 	m_tex = 0.0f;
+}
+
+//-----------------------------------------------------------------------------
+// Note that the storage pointers are not copied. Derived classes must point
+// them to their own storage.
+FEElement_::FEElement_(const FEElement_& el) : MeshItem(el)
+{
+	m_traits = el.m_traits;
+
+	m_node = 0;
+	m_nbr = 0;
+	m_face = 0;
+	m_h = 0;
+
+	m_lid = el.m_lid;
+	m_MatID = el.m_MatID;
+	m_tex = el.m_tex;
+}
 
-	m_Q.unit(); m_Qactive = false;
-	m_a0 = 0;
+//-----------------------------------------------------------------------------
+FEElement_& FEElement_::operator = (const FEElement_& el)
+{
+	if (this == &el) return *this;
+	MeshItem::operator = (el);
+	m_traits = el.m_traits;
+	m_lid = el.m_lid;
+	m_MatID = el.m_MatID;
+	m_tex = el.m_tex;
+	return *this;
 }
 
 //-----------------------------------------------------------------------------
@@ -741,10 +767,6 @@ void FEElement_::copy(const FEElement_& el)
 	m_ntag = el.m_ntag;
 	m_MatID = el.m_MatID;
 
-	m_fiber = el.m_fiber;
-	m_Q = el.m_Q;
-	m_Qactive = el.m_Qactive;
-	m_a0 = el.m_a0;
 //	m_edata = el.m_edata;
 
 	for (int i=0; i<Nodes(); ++i) m_node[i] = el.m_node[i];
@@ -899,18 +921,6 @@ void FEElement_::iso_coord_2d(int n, double q[2])
 	}
 }
 
-void FEElement_::setAxes(const vec3d& a, const vec3d& d)
-{
-	vec3d e1(a); e1.Normalize();
-	vec3d e3 = e1 ^ d; e3.Normalize();
-	vec3d e2 = e3 ^ e1; e2.Normalize();
-	m_Q = mat3d(
-		e1.x, e2.x, e3.x,
-		e1.y, e2.y, e3.y,
-		e1.z, e2.z, e3.z);
-	m_Qactive = true;
-}
-
 //=============================================================================
 // FSElement
 //-----------------------------------------------------------------------------
@@ -994,12 +1004,18 @@ FELinearElement::FELinearElement(const FELinearElement& e) : FEElement_(e)
 	m_nbr  = _nbr;
 	m_face = _face;
 	m_h    = _h;
-	for (int i = 0; i<MAX_NODES; ++i) m_node[i] = e.m_node[i];
+	copyData(e);
 }
 
 void FELinearElement::operator = (const FELinearElement& e)
 {
-	m_traits = e.m_traits;
 	FEElement_::operator = (e);
+	copyData(e);
+}
+
+void FELinearElement::copyData(const FELinearElement& e)
+{
 	for (int i = 0; i<MAX_NODES; ++i) m_node[i] = e.m_node[i];
+	for (int i = 0; i<6; ++i) { m_nbr[i] = e.m_nbr[i]; m_face[i] = e.m_face[i]; }
+	for (int i = 0; i<9; ++i) m_h[i] = e.m_h[i];
 }
@@ -107,6 +107,12 @@ public:
 	//! constructor
 	FEElement_();
 
+	//! copy constructor (derived classes must set the node, neighbor, face and thickness pointers)
+	FEElement_(const FEElement_& el);
+
+	//! assignment operator (copies the element data, but not the storage pointers)
+	FEElement_& operator = (const FEElement_& el);
+
 public:
 	//! Set the element type
 	void SetType(int ntype);
@@ -183,9 +189,6 @@ public:
 	// get iso-param coordinates of the nodes
 	void iso_coord_2d(int n, double q[2]);
 
-	// set the material axis
-	void setAxes(const vec3d& a, const vec3d& d);
-
 public:
 	// evaluate shape function at iso-parameteric point (r,s) (for 2D elements only!)
 	void shape_2d(double* H, double r, double s);
@@ -208,12 +211,6 @@ public:
 	int			m_MatID;	// material id
 	float		m_tex;		// element texture coordinate
 
-public:
-	vec3d	m_fiber;	//!< fiber orientation \todo maybe I can add an element attribute section
-	mat3d	m_Q;		//!< local material orientation
-	bool	m_Qactive;	//!< active local material orientation
-	double	m_a0;		//!< cross-sectional area (only used by truss elements)
-	
 protected:
 	const FSElemTraits* m_traits;	// element traits
 };
@@ -287,14 +284,24 @@ public:
 	FEElementBase(const FEElementBase& el) : FEElement_(el)
 	{
 		m_node = _node;
-		for (int i = 0; i<T::Nodes; ++i) m_node[i] = el.m_node[i];
 		m_nbr = _nbr;
+		m_face = _face;
+		m_h = _h;
+		copyData(el);
 	}
 
 	void operator = (const FEElementBase& el)
 	{
 		FEElement_::operator = (el);
+		copyData(el);
+	}
+
+private:
+	void copyData(const FEElementBase& el)
+	{
 		for (int i = 0; i<T::Nodes; ++i) m_node[i] = el.m_node[i];
+		for (int i = 0; i<6; ++i) { m_nbr[i] = el.m_nbr[i]; m_face[i] = el.m_face[i]; }
+		for (int i = 0; i<9; ++i) m_h[i] = el.m_h[i];
 	}
 
 public:
@@ -336,6 +343,9 @@ public:
 	FELinearElement(const FELinearElement& e);
 	void operator = (const FELinearElement& e);
 
+private:
+	void copyData(const FELinearElement& e);
+
 public:
 	int		_node[MAX_NODES];	// array of nodes ID
 	int		_nbr[6];
@@ -0,0 +1,172 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "FEElementAttributes.h"
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// default values, returned for elements whose array was not allocated
+static const vec3d	defaultFiber(0, 0, 0);
+static const mat3d	defaultAxes(1, 0, 0, 0, 1, 0, 0, 0, 1);
+
+//-----------------------------------------------------------------------------
+FSElementAttributes::FSElementAttributes()
+{
+	m_elems = 0;
+}
+
+//-----------------------------------------------------------------------------
+void FSElementAttributes::Clear()
+{
+	m_elems = 0;
+	m_fiber = std::vector<vec3d>();
+	m_Q = std::vector<mat3d>();
+	m_Qactive = std::vector<unsigned char>();
+	m_a0 = std::vector<double>();
+}
+
+//-----------------------------------------------------------------------------
+void FSElementAttributes::Resize(int elems)
+{
+	m_elems = elems;
+	if (!m_fiber.empty()) m_fiber.resize(elems, defaultFiber);
+	if (!m_Q.empty())
+	{
+		m_Q.resize(elems, defaultAxes);
+		m_Qactive.resize(elems, 0);
+	}
+	if (!m_a0.empty()) m_a0.resize(elems, 0.0);
+}
+
+//-----------------------------------------------------------------------------
+void FSElementAttributes::Copy(int i, const FSElementAttributes& src, int j)
+{
+	// The setters do not allocate for default values, so copying an element 
+	// without attributes into a mesh without attributes costs nothing.
+	// (The values are copied first, since src can be this table.)
+	vec3d a = src.Fiber(j);
+	SetFiber(i, a);
+	if (src.HasMaterialAxes() || HasMaterialAxes())
+	{
+		mat3d Q = src.MaterialAxes(j);
+		bool active = src.IsMaterialAxesActive(j);
+		SetMaterialAxes(i, Q);
+		SetMaterialAxesActive(i, active);
+	}
+	SetCrossSectionArea(i, src.CrossSectionArea(j));
+}
+
+//-----------------------------------------------------------------------------
+const vec3d& FSElementAttributes::Fiber(int i) const
+{
+	return ((i >= 0) && (i < (int)m_fiber.size()) ? m_fiber[i] : defaultFiber);
+}
+
+void FSElementAttributes::SetFiber(int i, const vec3d& a)
+{
+	if (m_fiber.empty())
+	{
+		// a zero fiber is the default, so no need to allocate the array for it
+		if ((a.x == 0.0) && (a.y == 0.0) && (a.z == 0.0)) return;
+		m_fiber.assign(std::max(m_elems, i + 1), defaultFiber);
+	}
+	else if (i >= (int)m_fiber.size()) m_fiber.resize(i + 1, defaultFiber);
+	m_fiber[i] = a;
+}
+
+//-----------------------------------------------------------------------------
+const mat3d& FSElementAttributes::MaterialAxes(int i) const
+{
+	return ((i >= 0) && (i < (int)m_Q.size()) ? m_Q[i] : defaultAxes);
+}
+
+void FSElementAttributes::SetMaterialAxes(int i, const mat3d& Q)
+{
+	if (m_Q.empty())
+	{
+		int n = std::max(m_elems, i + 1);
+		m_Q.assign(n, defaultAxes);
+		m_Qactive.assign(n, 0);
+	}
+	else if (i >= (int)m_Q.size())
+	{
+		m_Q.resize(i + 1, defaultAxes);
+		m_Qactive.resize(i + 1, 0);
+	}
+	m_Q[i] = Q;
+}
+
+bool FSElementAttributes::IsMaterialAxesActive(int i) const
+{
+	return ((i >= 0) && (i < (int)m_Qactive.size()) ? (m_Qactive[i] != 0) : false);
+}
+
+void FSElementAttributes::SetMaterialAxesActive(int i, bool b)
+{
+	// inactive is the default
+	if (m_Q.empty() && (b == false)) return;
+	if (i >= (int)m_Q.size()) SetMaterialAxes(i, defaultAxes);
+	m_Qactive[i] = (b ? 1 : 0);
+}
+
+void FSElementAttributes::SetMaterialAxes(int i, const vec3d& a, const vec3d& d)
+{
+	vec3d e1(a); e1.Normalize();
+	vec3d e3 = e1 ^ d; e3.Normalize();
+	vec3d e2 = e3 ^ e1; e2.Normalize();
+	SetMaterialAxes(i, mat3d(
+		e1.x, e2.x, e3.x,
+		e1.y, e2.y, e3.y,
+		e1.z, e2.z, e3.z));
+	SetMaterialAxesActive(i, true);
+}
+
+//-----------------------------------------------------------------------------
+double FSElementAttributes::CrossSectionArea(int i) const
+{
+	return ((i >= 0) && (i < (int)m_a0.size()) ? m_a0[i] : 0.0);
+}
+
+void FSElementAttributes::SetCrossSectionArea(int i, double a0)
+{
+	if (m_a0.empty())
+	{
+		if (a0 == 0.0) return;
+		m_a0.assign(std::max(m_elems, i + 1), 0.0);
+	}
+	else if (i >= (int)m_a0.size()) m_a0.resize(i + 1, 0.0);
+	m_a0[i] = a0;
+}
+
+//-----------------------------------------------------------------------------
+size_t FSElementAttributes::MemorySize() const
+{
+	return m_fiber.capacity() * sizeof(vec3d)
+		+ m_Q.capacity() * sizeof(mat3d)
+		+ m_Qactive.capacity() * sizeof(unsigned char)
+		+ m_a0.capacity() * sizeof(double);
+}
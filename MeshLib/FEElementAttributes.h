@@ -0,0 +1,87 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include <FSCore/math3d.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Element attributes that only some meshes use: the fiber orientation, the local
+// material axes, and the cross-sectional area of truss elements. 
+// Each attribute is stored in a dense array that is indexed by the element's index
+// in the mesh. An array is only allocated when an element is assigned a value that 
+// differs from the default, so meshes that do not use an attribute pay nothing for it.
+// Elements of unallocated arrays return the defaults (zero fiber, inactive unit axes, zero area).
+class FSElementAttributes
+{
+public:
+	FSElementAttributes();
+
+	// remove all attributes
+	void Clear();
+
+	// set the number of elements. Allocated arrays are resized and new elements get the default values.
+	void Resize(int elems);
+
+	// copy the attributes of element j of src to element i
+	void Copy(int i, const FSElementAttributes& src, int j);
+
+public:
+	// fiber orientation
+	const vec3d& Fiber(int i) const;
+	void SetFiber(int i, const vec3d& a);
+
+	// local material axes. The axes are only used when they are active.
+	const mat3d& MaterialAxes(int i) const;
+	void SetMaterialAxes(int i, const mat3d& Q);
+	bool IsMaterialAxesActive(int i) const;
+	void SetMaterialAxesActive(int i, bool b);
+
+	// set (and activate) the material axes from a primary direction a and a secondary direction d
+	void SetMaterialAxes(int i, const vec3d& a, const vec3d& d);
+
+	// cross-sectional area (only used by truss elements)
+	double CrossSectionArea(int i) const;
+	void SetCrossSectionArea(int i, double a0);
+
+public:
+	// returns true if the corresponding array was allocated
+	bool HasFibers() const { return !m_fiber.empty(); }
+	bool HasMaterialAxes() const { return !m_Q.empty(); }
+	bool HasCrossSectionAreas() const { return !m_a0.empty(); }
+
+	// memory used by the arrays (in bytes)
+	size_t MemorySize() const;
+
+private:
+	int	m_elems;	// number of elements
+
+	std::vector<vec3d>			m_fiber;	// fiber orientation
+	std::vector<mat3d>			m_Q;		// local material axes
+	std::vector<unsigned char>	m_Qactive;	// active flag of local material axes (allocated with m_Q)
+	std::vector<double>			m_a0;		// cross-sectional area
+};
@@ -27,168 +27,62 @@ SOFTWARE.*/
 #include "FEFindElement.h"
 #include "FECoreMesh.h"
 #include "MeshTools.h"
+#include <algorithm>
 
-FEFindElement::OCTREE_BOX::OCTREE_BOX()
-{
-	m_elem = -1;
-	m_level = -1;
-}
+// max number of elements in a leaf of the BVH
+const int MAX_LEAF_SIZE = 4;
 
-FEFindElement::OCTREE_BOX::~OCTREE_BOX()
+// spread the lower 10 bits of v so that there are two zeros between each bit
+static unsigned int expandBits(unsigned int v)
 {
-	for (size_t i = 0; i<m_child.size(); ++i) delete m_child[i];
-	m_child.clear();
+	v = (v * 0x00010001u) & 0xFF0000FFu;
+	v = (v * 0x00000101u) & 0x0F00F00Fu;
+	v = (v * 0x00000011u) & 0xC30C30C3u;
+	v = (v * 0x00000005u) & 0x49249249u;
+	return v;
 }
 
-void FEFindElement::OCTREE_BOX::split(int levels)
+// map a value in [0,1] to a 10-bit integer
+static unsigned int quantize(double f)
 {
-	m_level = levels;
-	if (m_level == 0) return;
-
-	double x0 = m_box.x0, x1 = m_box.x1;
-	double y0 = m_box.y0, y1 = m_box.y1;
-	double z0 = m_box.z0, z1 = m_box.z1;
-
-	double dx = x1 - x0;
-	double dy = y1 - y0;
-	double dz = z1 - z0;
-
-	m_child.clear();
-	for (int i = 0; i<2; i++)
-		for (int j = 0; j<2; j++)
-			for (int k = 0; k <2; k++)
-			{
-				double xa = x0 + i*dx*0.5, xb = x0 + (i + 1)*dx*0.5;
-				double ya = y0 + j*dy*0.5, yb = y0 + (j + 1)*dy*0.5;
-				double za = z0 + k*dz*0.5, zb = z0 + (k + 1)*dz*0.5;
-
-				BOX b(xa, ya, za, xb, yb, zb);
-				double R = b.GetMaxExtent();
-				b.Inflate(R*0.0001);
-
-				OCTREE_BOX* box = new OCTREE_BOX;
-				box->m_box = b;
-
-				m_child.push_back(box);
-			}
-
-	for (int i = 0; i<(int)m_child.size(); ++i)
-	{
-		m_child[i]->split(levels - 1);
-	}
+	int n = (int)(f * 1024.0);
+	if (n < 0) n = 0;
+	if (n > 1023) n = 1023;
+	return (unsigned int)n;
 }
 
-void FEFindElement::OCTREE_BOX::Add(BOX& b, int nelem)
+static inline bool insideBox(const float* b, const vec3f& x)
 {
-	if (m_level == 0)
-	{
-		if (m_box.Intersects(b))
-		{
-			OCTREE_BOX* box = new OCTREE_BOX;
-			box->m_box = b;
-			box->m_elem = nelem;
-			box->m_level = -1;
-			m_child.push_back(box);
-			return;
-		}
-	}
-	else
-	{
-		for (size_t i = 0; i<m_child.size(); ++i)
-		{
-			m_child[i]->Add(b, nelem);
-		}
-	}
+	return ((x.x >= b[0]) && (x.x <= b[3]) &&
+		    (x.y >= b[1]) && (x.y <= b[4]) &&
+		    (x.z >= b[2]) && (x.z <= b[5]));
 }
 
-
-FEFindElement::OCTREE_BOX* FEFindElement::OCTREE_BOX::Find(const vec3f& r)
-{
-	if (m_level == 0)
-	{
-		bool inside = m_box.IsInside(to_vec3d(r));
-		return (inside ? this : 0);
-	}
-
-	// try to find the child
-	for (size_t i = 0; i<m_child.size(); ++i)
-	{
-		OCTREE_BOX* c = m_child[i];
-		OCTREE_BOX* ret = c->Find(r);
-		if (ret) return ret;
-	}
-
-	return 0;
-}
-
-
-FEFindElement::OCTREE_BOX* FEFindElement::FindBox(const vec3f& r)
+FEFindElement::FEFindElement(FSCoreMesh& mesh) : m_mesh(mesh)
 {
-	// make sure it's in the master box
-	if (m_bound.IsInside(r) == false) return 0;
-
-	// try to find the child
-	OCTREE_BOX* b = &m_bound;
-	do
-	{
-		if (b->m_level == 0)
-		{
-			bool inside = b->IsInside(r);
-			return (inside ? b : 0);
-		}
-
-		bool bfound = false;
-		for (size_t i = 0; i<b->m_child.size(); ++i)
-		{
-			OCTREE_BOX* c = b->m_child[i];
-			if (c->IsInside(r))
-			{
-				b = c;
-				bfound = true;
-				break;
-			}
-		}
-
-		assert(bfound);
-		if (bfound == false) break;
-	} while (1);
-
-	return 0;
+	m_nframe = -1;
 }
 
-FEFindElement::FEFindElement(FSCoreMesh& mesh) : m_mesh(mesh)
+void FEFindElement::Init(int nframe)
 {
-	m_nframe = -1;
+	std::vector<bool> dummy;
+	Init(dummy, nframe);
 }
 
-void FEFindElement::InitReferenceFrame(std::vector<bool>& flags)
+void FEFindElement::Init(std::vector<bool>& flags, int nframe)
 {
-	assert(m_nframe == 0);
+	m_nframe = nframe;
+	m_flags = flags;
+	m_node.clear();
+	m_item.clear();
+	m_itemBox.clear();
 
-	// calculate bounding box for the entire mesh
 	int NN = m_mesh.Nodes();
 	int NE = m_mesh.Elements();
+	m_active.assign(NE, false);
 	if ((NN == 0) || (NE == 0)) return;
 
-	vec3d r = m_mesh.Node(0).r;
-	BOX box(r, r);
-	for (int i = 1; i<m_mesh.Nodes(); ++i)
-	{
-		r = m_mesh.Node(i).r;
-		box += r;
-	}
-	double R = box.GetMaxExtent();
-	box.Inflate(R*0.001);
-
-	// split this box recursively
-	m_bound.m_box = box;
-
-	int l = (int)(log(NE) / log(8.0));
-	if (l < 0) l = 0;
-	if (l > 3) l = 3;
-	m_bound.split(l);
-
-	// calculate bounding boxes for all elements
+	// find the elements that we need to add
 	int cflags = (int)flags.size();
 	for (int i = 0; i<NE; ++i)
 	{
@@ -203,167 +97,292 @@ void FEFindElement::InitReferenceFrame(std::vector<bool>& flags)
 
 		if (badd)
 		{
-			int ne = e.Nodes();
-
-			// do a quick bounding box test
-			vec3d r0 = m_mesh.Node(e.m_node[0]).r;
-			vec3d r1 = r0;
-			BOX box(r0, r1);
-			for (int j = 1; j<ne; ++j)
-			{
-				vec3d rj = m_mesh.Node(e.m_node[j]).r;
-				box += rj;
-			}
-			double R = box.GetMaxExtent();
-			box.Inflate(R*0.001);
-
-			// add it to the octree
-			m_bound.Add(box, i);
+			m_active[i] = true;
+			m_item.push_back(i);
 		}
 	}
+
+	// calculate bounding boxes for all elements
+	UpdateItemBoxes();
+
+	// build the tree
+	Build();
 }
 
-void FEFindElement::InitCurrentFrame(std::vector<bool>& flags)
+void FEFindElement::Refit()
 {
-	assert(m_nframe == 1);
+	// if the mesh changed, we need to start over (with the same material selection)
+	if ((int)m_active.size() != m_mesh.Elements())
+	{
+		Init(m_flags, m_nframe);
+		return;
+	}
 
-	// calculate bounding box for the entire mesh
+	if (m_node.empty()) return;
+
+	UpdateItemBoxes();
+	UpdateNodeBoxes();
+}
+
+// This calculates the bounding box of the mesh and the bounding boxes of the items.
+void FEFindElement::UpdateItemBoxes()
+{
 	int NN = m_mesh.Nodes();
-	int NE = m_mesh.Elements();
-	if ((NN == 0) || (NE == 0)) return;
+	if (NN == 0) return;
 
 	vec3d r = m_mesh.Node(0).r;
 	BOX box(r, r);
-	for (int i = 1; i<m_mesh.Nodes(); ++i)
+	for (int i = 1; i<NN; ++i)
 	{
 		r = m_mesh.Node(i).r;
 		box += r;
 	}
 	double R = box.GetMaxExtent();
 	box.Inflate(R*0.001);
+	m_box = box;
 
-	// split this box recursively
-	m_bound.m_box = box;
-
-	int l = (int)(log(NE) / log(8.0));
-	if (l < 0) l = 0;
-	if (l > 3) l = 3;
-	m_bound.split(l);
-
-	// calculate bounding boxes for all elements
-	int cflags = (int)flags.size();
-	for (int i = 0; i<NE; ++i)
+	int NI = (int)m_item.size();
+	m_itemBox.resize(6 * NI);
+#pragma omp parallel for
+	for (int i = 0; i<NI; ++i)
 	{
-		FEElement_& e = m_mesh.ElementRef(i);
+		FEElement_& e = m_mesh.ElementRef(m_item[i]);
+		int ne = e.Nodes();
 
-		bool badd = true;
-		if (flags.empty() == false)
+		vec3d r0 = m_mesh.Node(e.m_node[0]).r;
+		BOX b(r0, r0);
+		for (int j = 1; j<ne; ++j)
 		{
-			int mid = e.m_MatID;
-			if ((mid >= 0) && (mid < cflags)) badd = flags[mid];
+			vec3d rj = m_mesh.Node(e.m_node[j]).r;
+			b += rj;
 		}
+		double R = b.GetMaxExtent();
+		b.Inflate(R*0.001);
 
-		if (badd)
-		{
-			int ne = e.Nodes();
+		float* f = &m_itemBox[6 * i];
+		f[0] = (float)b.x0; f[1] = (float)b.y0; f[2] = (float)b.z0;
+		f[3] = (float)b.x1; f[4] = (float)b.y1; f[5] = (float)b.z1;
+	}
+}
 
-			// do a quick bounding box test
-			vec3d r0 = m_mesh.Node(e.m_node[0]).r;
-			vec3d r1 = r0;
-			BOX box(r0, r1);
-			for (int j = 1; j<ne; ++j)
-			{
-				vec3d rj = m_mesh.Node(e.m_node[j]).r;
-				box += rj;
-			}
-			double R = box.GetMaxExtent();
-			box.Inflate(R*0.001);
+void FEFindElement::Build()
+{
+	int NI = (int)m_item.size();
+	if (NI == 0) return;
+
+	// calculate the Morton codes of the element centers
+	double dx = m_box.Width (); if (dx == 0.0) dx = 1.0;
+	double dy = m_box.Height(); if (dy == 0.0) dy = 1.0;
+	double dz = m_box.Depth (); if (dz == 0.0) dz = 1.0;
+	std::vector< std::pair<unsigned int, int> > code(NI);
+#pragma omp parallel for
+	for (int i = 0; i<NI; ++i)
+	{
+		const float* b = &m_itemBox[6 * i];
+		unsigned int ix = quantize((0.5*(b[0] + b[3]) - m_box.x0) / dx);
+		unsigned int iy = quantize((0.5*(b[1] + b[4]) - m_box.y0) / dy);
+		unsigned int iz = quantize((0.5*(b[2] + b[5]) - m_box.z0) / dz);
+		code[i].first = (expandBits(ix) << 2) | (expandBits(iy) << 1) | expandBits(iz);
+		code[i].second = i;
+	}
+	std::sort(code.begin(), code.end());
 
-			// add it to the octree
-			m_bound.Add(box, i);
-		}
+	// sort the items along the Morton curve, so that neighboring items are close in space
+	std::vector<int> item(NI);
+	std::vector<float> itemBox(6 * NI);
+	for (int i = 0; i<NI; ++i)
+	{
+		int k = code[i].second;
+		item[i] = m_item[k];
+		for (int j = 0; j<6; ++j) itemBox[6 * i + j] = m_itemBox[6 * k + j];
 	}
+	m_item.swap(item);
+	m_itemBox.swap(itemBox);
+
+	// build the tree
+	m_node.reserve(2 * (NI / MAX_LEAF_SIZE + 1));
+	BuildNode(0, NI);
+
+	// calculate the boxes of the nodes
+	UpdateNodeBoxes();
 }
 
-void FEFindElement::Init(int nframe)
+// Build the node for the items [n0, n1). Since the items are sorted along the Morton
+// curve, we can just split the range in half to get a balanced tree.
+int FEFindElement::BuildNode(int n0, int n1)
 {
-	std::vector<bool> dummy;
-	m_nframe = nframe;
-	if (m_nframe == 0) InitReferenceFrame(dummy);
-	else InitCurrentFrame(dummy);
+	int n = (int)m_node.size();
+	m_node.push_back(BVH_NODE());
+	if (n1 - n0 <= MAX_LEAF_SIZE)
+	{
+		m_node[n].first = n0;
+		m_node[n].count = n1 - n0;
+	}
+	else
+	{
+		int nm = (n0 + n1) / 2;
+		BuildNode(n0, nm);
+		int nright = BuildNode(nm, n1);
+		m_node[n].first = nright;
+		m_node[n].count = 0;
+	}
+	return n;
 }
 
-void FEFindElement::Init(std::vector<bool>& flags, int nframe)
+// Since children always come after their parents, we can update the boxes
+// bottom-up by looping over the nodes in reverse order.
+void FEFindElement::UpdateNodeBoxes()
 {
-	m_nframe = nframe;
-	if (m_nframe == 0) InitReferenceFrame(flags);
-	else InitCurrentFrame(flags);
+	for (int n = (int)m_node.size() - 1; n >= 0; --n)
+	{
+		BVH_NODE& node = m_node[n];
+		float* b = node.box;
+		if (node.count > 0)
+		{
+			const float* bi = &m_itemBox[6 * node.first];
+			for (int j = 0; j<6; ++j) b[j] = bi[j];
+			for (int i = 1; i<node.count; ++i)
+			{
+				bi = &m_itemBox[6 * (node.first + i)];
+				for (int j = 0; j<3; ++j) { if (bi[j] < b[j]) b[j] = bi[j]; }
+				for (int j = 3; j<6; ++j) { if (bi[j] > b[j]) b[j] = bi[j]; }
+			}
+		}
+		else
+		{
+			const float* bl = m_node[n + 1].box;
+			const float* br = m_node[node.first].box;
+			for (int j = 0; j<3; ++j) b[j] = (bl[j] < br[j] ? bl[j] : br[j]);
+			for (int j = 3; j<6; ++j) b[j] = (bl[j] > br[j] ? bl[j] : br[j]);
+		}
+	}
 }
 
-bool FEFindElement::FindInReferenceFrame(const vec3f& x, int& nelem, double r[3])
+bool FEFindElement::ProjectInside(int nelem, const vec3f& x, double r[3])
 {
-	assert(m_nframe == 0);
+	FEElement_& e = m_mesh.ElementRef(nelem);
+	if (m_nframe == 0)
+		return ProjectInsideReferenceElement(m_mesh, e, x, r);
+	else
+		return ProjectInsideElement(m_mesh, e, x, r);
+}
 
-	vec3f y[FSElement::MAX_NODES];
-	OCTREE_BOX* b = FindBox(x);
-	if (b == 0) return false;
-	assert(b->m_level == 0);
+bool FEFindElement::FindElement(const vec3f& x, int& nelem, double r[3])
+{
+	nelem = -1;
+	if (m_node.empty()) return false;
 
-	int NE = (int)b->m_child.size();
-	for (int i = 0; i<NE; ++i)
-	{
-		OCTREE_BOX* c = b->m_child[i];
-		assert(c->m_level == -1);
+	// make sure it's in the mesh's box
+	if (m_box.IsInside(to_vec3d(x)) == false) return false;
 
-		int nid = c->m_elem; assert(nid >= 0);
+	// The depth of the tree is about log2(N), so this is plenty
+	int stack[64];
+	int ns = 0;
+	stack[ns++] = 0;
+	while (ns > 0)
+	{
+		int n = stack[--ns];
+		const BVH_NODE& node = m_node[n];
+		if (insideBox(node.box, x) == false) continue;
 
-		FEElement_& e = m_mesh.ElementRef(nid);
-		nelem = nid;
+		if (node.count > 0)
+		{
+			for (int i = 0; i<node.count; ++i)
+			{
+				int k = node.first + i;
 
-		// do a quick bounding box test
-		if (c->m_box.IsInside(to_vec3d(x)))
+				// do a quick bounding box test before the more complete search
+				if (insideBox(&m_itemBox[6 * k], x) && ProjectInside(m_item[k], x, r))
+				{
+					nelem = m_item[k];
+					return true;
+				}
+			}
+		}
+		else
 		{
-			// do a more complete search
-			if (ProjectInsideReferenceElement(m_mesh, e, x, r)) return true;
+			stack[ns++] = node.first;
+			stack[ns++] = n + 1;
 		}
 	}
 
-	nelem = -1;
 	return false;
 }
 
-bool FEFindElement::FindInCurrentFrame(const vec3f& x, int& nelem, double r[3])
+bool FEFindElement::FindElement(const vec3f& x, int& nelem, double r[3], int nhint)
 {
-	assert(m_nframe == 1);
+	if (WalkToElement(x, nelem, r, nhint)) return true;
+	return FindElement(x, nelem, r);
+}
 
-	vec3f y[FSElement::MAX_NODES];
-	OCTREE_BOX* b = FindBox(x);
-	if (b == 0) return false;
-	assert(b->m_level == 0);
+bool FEFindElement::WalkToElement(const vec3f& x, int& nelem, double r[3], int nhint)
+{
+	nelem = -1;
 
-	int NE = (int)b->m_child.size();
-	for (int i = 0; i<NE; ++i)
+	// max number of elements we visit before we give up and search the tree
+	const int MAX_WALK = 8;
+
+	int NE = (int)m_active.size();
+	int ncurr = nhint;
+	int nprev = -1;
+	for (int n = 0; n < MAX_WALK; ++n)
 	{
-		OCTREE_BOX* c = b->m_child[i];
-		assert(c->m_level == -1);
+		if ((ncurr < 0) || (ncurr >= NE) || (m_active[ncurr] == false)) break;
 
-		int nid = c->m_elem; assert(nid >= 0);
+		if (ProjectInside(ncurr, x, r))
+		{
+			nelem = ncurr;
+			return true;
+		}
 
-		FEElement_& e = m_mesh.ElementRef(nid);
-		nelem = nid;
+		// move to the face neighbor whose center is closest to x
+		// (but don't go back to where we came from)
+		FEElement_& e = m_mesh.ElementRef(ncurr);
+		if (e.IsSolid() == false) break;
 
-		// do a quick bounding box test
-		if (c->m_box.IsInside(to_vec3d(x)))
+		vec3d p = to_vec3d(x);
+		double dmin = 0.0;
+		int nnext = -1;
+		for (int i = 0; i < e.Faces(); ++i)
 		{
-			// do a more complete search
-			if (ProjectInsideElement(m_mesh, e, x, r)) return true;
+			int nj = e.m_nbr[i];
+			if ((nj >= 0) && (nj < NE) && (nj != nprev) && m_active[nj])
+			{
+				double d = (m_mesh.ElementCenter(m_mesh.ElementRef(nj)) - p).SqrLength();
+				if ((nnext == -1) || (d < dmin))
+				{
+					dmin = d;
+					nnext = nj;
+				}
+			}
 		}
+		nprev = ncurr;
+		ncurr = nnext;
 	}
 
-	nelem = -1;
 	return false;
 }
 
+int FEFindElement::FindElements(const std::vector<vec3f>& x, std::vector<int>& elem, std::vector<vec3d>& r)
+{
+	int N = (int)x.size();
+	if ((int)elem.size() != N) elem.assign(N, -1);
+	r.resize(N);
+
+	int nfound = 0;
+#pragma omp parallel for schedule(dynamic, 256) reduction(+:nfound)
+	for (int i = 0; i<N; ++i)
+	{
+		int nelem = -1;
+		double q[3] = { 0.0, 0.0, 0.0 };
+		if (FindElement(x[i], nelem, q, elem[i])) nfound++;
+		elem[i] = nelem;
+		r[i] = vec3d(q[0], q[1], q[2]);
+	}
+
+	return nfound;
+}
+
 //================================================================================================
 bool FindElement2D(const vec2d& r, int& elem, double q[2], FSMesh* mesh)
 {
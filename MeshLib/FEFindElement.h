@@ -30,60 +30,78 @@ SOFTWARE.*/
 
 class FSCoreMesh;
 
+//-----------------------------------------------------------------------------
+// Finds the element that contains a point. The elements are stored in a bounding 
+// volume hierarchy (BVH) that is built over the elements' Morton codes and kept 
+// in flat arrays. When only the node positions change (e.g. for a deforming mesh),
+// Refit updates the bounding boxes without rebuilding the tree.
+// The queries do not modify the object, so they can be called concurrently.
 class FEFindElement
 {
 public:
-	class OCTREE_BOX
-	{
-	public:
-		BOX					m_box;
-		std::vector<OCTREE_BOX*>	m_child;
-		int					m_elem;
-		int					m_level;
+	FEFindElement(FSCoreMesh& mesh);
 
-	public:
-		OCTREE_BOX();
-		~OCTREE_BOX();
+	void Init(int nframe = 0);
+	void Init(std::vector<bool>& flags, int nframe = 0);
 
-		void split(int levels);
+	// Update the bounding boxes after the nodes of the mesh moved. This is much 
+	// faster than Init, but queries slow down when the mesh deforms a lot.
+	// If the number of elements changed, the tree is rebuilt with the material 
+	// flags of the last Init.
+	void Refit();
 
-		OCTREE_BOX* Find(const vec3f& r);
+	bool FindElement(const vec3f& x, int& nelem, double r[3]);
 
-		bool IsInside(const vec3f& r) const { return m_box.IsInside(to_vec3d(r)); }
+	// Find the element that contains x, starting at element nhint. The search first walks
+	// from nhint through face neighbors toward x and only uses the tree when that fails.
+	// This is much faster when consecutive points are close (e.g. along stream lines).
+	bool FindElement(const vec3f& x, int& nelem, double r[3], int nhint);
 
-		void Add(BOX& b, int nelem);
-	};
+	// Only the walk of the previous function: returns false when the walk from nhint 
+	// does not reach the element that contains x, without searching the tree.
+	bool WalkToElement(const vec3f& x, int& nelem, double r[3], int nhint);
 
-public:
-	FEFindElement(FSCoreMesh& mesh);
+	// Find the elements of many points at once (in parallel). If elem has the same size
+	// as x, its values are used as search hints. On return, elem[i] is the element that 
+	// contains x[i] (or -1) and r[i] its iso-parametric coordinates in that element.
+	// Returns the number of points that were found.
+	int FindElements(const std::vector<vec3f>& x, std::vector<int>& elem, std::vector<vec3d>& r);
 
-	void Init(int nframe = 0);
-	void Init(std::vector<bool>& flags, int nframe = 0);
+	BOX BoundingBox() const { return m_box; }
 
-	bool FindElement(const vec3f& x, int& nelem, double r[3]);
-
-	BOX BoundingBox() const { return m_bound.m_box; }
+	// frame that was used for Init (0 = reference, 1 = current, -1 = not initialized)
+	int Frame() const { return m_nframe; }
 
 private:
-	void InitReferenceFrame(std::vector<bool>& flags);
-	void InitCurrentFrame(std::vector<bool>& flags);
+	// node of the BVH. The left child of an internal node is the next node in the 
+	// array and the right child is stored in first. This means that children always
+	// come after their parent.
+	struct BVH_NODE
+	{
+		float	box[6];	// x0, y0, z0, x1, y1, z1
+		int		first;	// leaf: first item in m_item, internal node: right child
+		int		count;	// leaf: number of items, internal node: 0
+	};
 
-	bool FindInReferenceFrame(const vec3f& x, int& nelem, double r[3]);
-	bool FindInCurrentFrame(const vec3f& x, int& nelem, double r[3]);
+	void Build();
+	int BuildNode(int n0, int n1);
 
-private:
-	OCTREE_BOX* FindBox(const vec3f& r);
+	void UpdateItemBoxes();
+	void UpdateNodeBoxes();
+
+	bool ProjectInside(int nelem, const vec3f& x, double r[3]);
 
 private:
-	OCTREE_BOX	m_bound;
 	FSCoreMesh&	m_mesh;
 	int			m_nframe;	// = 0 reference, 1 = current
-};
+	BOX			m_box;		// bounding box of mesh
 
-inline bool FEFindElement::FindElement(const vec3f& x, int& nelem, double r[3])
-{
-	return (m_nframe == 0 ? FindInReferenceFrame(x, nelem, r) : FindInCurrentFrame(x, nelem, r));
-}
+	std::vector<BVH_NODE>	m_node;		// BVH nodes (m_node[0] is the root)
+	std::vector<int>		m_item;		// elements, sorted by Morton code
+	std::vector<float>		m_itemBox;	// bounding boxes of items (6 per item)
+	std::vector<bool>		m_active;	// elements that were added to the tree
+	std::vector<bool>		m_flags;	// material flags that were passed to Init
+};
 
 class FSMesh;
 
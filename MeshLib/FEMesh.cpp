@@ -76,6 +76,7 @@ FSMesh::FSMesh(FSMesh& m)
 	// create the elements
 	m_Elem.resize(m.Elements());
 	for (int i = 0; i<Elements(); ++i) m_Elem[i] = m.m_Elem[i];
+	m_elemAtt = m.m_elemAtt;
 
 	// create the faces
 	m_Face.resize(m.Faces());
@@ -158,6 +159,7 @@ void FSMesh::Clear()
 	m_Edge.clear();
 	m_Face.clear();
 	m_Elem.clear();
+	m_elemAtt.Clear();
 	m_Node.clear();
 	ClearNLT();
 	ClearMeshData();
@@ -218,6 +220,7 @@ void FSMesh::ResizeFaces(int newSize)
 void FSMesh::ResizeElems(int newSize)
 {
 	m_Elem.resize(newSize);
+	m_elemAtt.Resize(newSize);
 	ClearELT();
 	m_NEL.Clear();
 }
@@ -448,6 +451,7 @@ void FSMesh::RemoveElements(int ntag)
 			if (i != n)
 			{
 				e2 = e1;
+				m_elemAtt.Copy(n, m_elemAtt, i);
 				if (bdata) m_data[n] = m_data[i];
 			}
 			n++;
@@ -455,6 +459,7 @@ void FSMesh::RemoveElements(int ntag)
 	}
 
 	m_Elem.resize(n);
+	m_elemAtt.Resize(n);
 	m_data.Clear();
 }
 
@@ -1503,11 +1508,14 @@ void FSMesh::Save(OArchive &ar)
 					ar.WriteChunk(CID_MESH_ELEMENT_TYPE, ntype);
 					ar.WriteChunk(CID_MESH_ELEMENT_GID, pe->m_gid);
 					ar.WriteChunk(CID_MESH_ELEMENT_NODES, pe->m_node, pe->Nodes());
-					ar.WriteChunk(CID_MESH_ELEMENT_FIBER, pe->m_fiber);
-					if (pe->m_Qactive)
+					vec3d fiber = ElementFiber(i);
+					ar.WriteChunk(CID_MESH_ELEMENT_FIBER, fiber);
+					if (IsElementMaterialAxesActive(i))
 					{
-						ar.WriteChunk(CID_MESH_ELEMENT_Q_ACTIVE, pe->m_Qactive);
-						ar.WriteChunk(CID_MESH_ELEMENT_Q, pe->m_Q);
+						bool Qactive = true;
+						mat3d Q = ElementMaterialAxes(i);
+						ar.WriteChunk(CID_MESH_ELEMENT_Q_ACTIVE, Qactive);
+						ar.WriteChunk(CID_MESH_ELEMENT_Q, Q);
 					}
 					if (pe->IsShell())
 						ar.WriteChunk(CID_MESH_SHELL_THICKNESS, pe->m_h, pe->Nodes());
@@ -1601,9 +1609,9 @@ void FSMesh::Save(OArchive &ar)
 				type[i] = pe->Type();
 				gid[i] = pe->m_gid;
 				eid[i] = pe->m_nid;
-				fiber[i] = pe->m_fiber;
-				Qactive[i] = (int)(pe->m_Qactive);
-				if (pe->m_Qactive) qactive++;
+				fiber[i] = ElementFiber(i);
+				Qactive[i] = (int)(IsElementMaterialAxesActive(i));
+				if (IsElementMaterialAxesActive(i)) qactive++;
 
 				if (pe->IsShell()) hcount += pe->Nodes();
 
@@ -1622,8 +1630,7 @@ void FSMesh::Save(OArchive &ar)
 				vector<mat3d> Q(qactive);
 				for (int i = 0, n = 0; i < elems; ++i)
 				{
-					FEElement_* pe = ElementPtr(i);
-					if (pe->m_Qactive) Q[n++] = pe->m_Q;
+					if (IsElementMaterialAxesActive(i)) Q[n++] = ElementMaterialAxes(i);
 				}
 				ar.WriteChunk(CID_MESH_ELEMENT_Q, Q);
 			}
@@ -1976,9 +1983,9 @@ void FSMesh::Load(IArchive& ar)
 								else ar.read(pe->m_node, pe->Nodes());
 							}
 							break;
-							case CID_MESH_ELEMENT_FIBER: ar.read(pe->m_fiber); break;
-							case CID_MESH_ELEMENT_Q_ACTIVE: ar.read(pe->m_Qactive); break;
-							case CID_MESH_ELEMENT_Q:  ar.read(pe->m_Q); break;
+							case CID_MESH_ELEMENT_FIBER: { vec3d a; ar.read(a); SetElementFiber(n, a); } break;
+							case CID_MESH_ELEMENT_Q_ACTIVE: { bool b; ar.read(b); SetElementMaterialAxesActive(n, b); } break;
+							case CID_MESH_ELEMENT_Q: { mat3d Q; ar.read(Q); SetElementMaterialAxes(n, Q); } break;
 
 							case CID_MESH_SHELL_THICKNESS:
 							{
@@ -2201,10 +2208,10 @@ void FSMesh::Load(IArchive& ar)
 						for (int i = 0; i < elems; ++i)
 							if (Qactive[i] != 0)
 							{
-								ElementPtr(i)->m_Qactive = true;
+								SetElementMaterialAxesActive(i, true);
 								qactive++;
 							}
-							else ElementPtr(i)->m_Qactive = false;
+							else SetElementMaterialAxesActive(i, false);
 					}
 					break;
 					case CID_MESH_ELEMENT_Q:
@@ -2214,8 +2221,7 @@ void FSMesh::Load(IArchive& ar)
 						ar.read(Q);
 						for (int i = 0, n = 0; i < elems; ++i)
 						{
-							FEElement_* pe = ElementPtr(i);
-							if (pe->m_Qactive) pe->m_Q = Q[n++];
+							if (IsElementMaterialAxesActive(i)) SetElementMaterialAxes(i, Q[n++]);
 						}
 					}
 					break;
@@ -2245,7 +2251,7 @@ void FSMesh::Load(IArchive& ar)
 							FEElement_* pe = ElementPtr(i);
 							pe->m_gid = gid[i];
 							pe->m_nid = eid[i];
-							pe->m_fiber = fiber[i];
+							SetElementFiber(i, fiber[i]);
 							for (int j = 0; j < pe->Nodes(); ++j) pe->m_node[j] = eln[n++];
 						}
 					}
@@ -2505,6 +2511,7 @@ void FSMesh::ShallowCopy(FSMesh* pm)
 	m_Edge = pm->m_Edge;
 	m_Face = pm->m_Face;
 	m_Elem = pm->m_Elem;
+	m_elemAtt = pm->m_elemAtt;
 
 	m_data = pm->m_data;
 
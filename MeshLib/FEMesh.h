@@ -236,7 +236,7 @@ public: // --- M E S H   Q U E R I E S ---
 
 	FSNodeElementList& NodeElementList();
 
-	const std::vector<NodeElemRef>& NodeElemList(int nodeIndex) const { return m_NEL.ElementList(nodeIndex); }
+	NodeElemRefList NodeElemList(int nodeIndex) const { return m_NEL.ElementList(nodeIndex); }
 
 	int FindFaceIndex(FSFace& face);
 
@@ -96,7 +96,7 @@ bool FSMeshBase::IsCreaseEdge(int n0, int n1)
 }
 
 //-----------------------------------------------------------------------------
-const vector<NodeFaceRef>& FSMeshBase::NodeFaceList(int n) const 
+NodeFaceRefList FSMeshBase::NodeFaceList(int n) const 
 { 
 	return m_NFL.FaceList(n); 
 }
@@ -662,42 +662,29 @@ void FSMeshBase::GetNodeNeighbors(int inode, int levels, std::set<int>& nl1)
 	nl1.insert(inode);
 
 	// loop over all levels
+	// (Faces are not tagged, so that this can be called from several threads.)
 	vector<int> nl2; nl2.reserve(64);
+	std::set<int> faces;
 	for (int k = 0; k <= levels; ++k)
 	{
-		// reset face marks
-		std::set<int>::iterator it;
-		for (it = nl1.begin(); it != nl1.end(); ++it)
-		{
-			// get the node-face list
-			const vector<NodeFaceRef>& nfl = NodeFaceList(*it);
-			int NF = nfl.size();
-
-			// add the other nodes
-			for (int i = 0; i < NF; ++i)
-			{
-				FSFace& f = Face(nfl[i].fid);
-				f.m_ntag = 0;
-			}
-		}
-
 		// loop over all nodes
 		nl2.clear();
+		faces.clear();
+		std::set<int>::iterator it;
 		for (it = nl1.begin(); it != nl1.end(); ++it)
 		{
 			// get the node-face list
-			const vector<NodeFaceRef>& nfl = NodeFaceList(*it);
+			NodeFaceRefList nfl = NodeFaceList(*it);
 			int NF = nfl.size();
 
 			// add the other nodes
 			for (int i = 0; i < NF; ++i)
 			{
-				FSFace& f = Face(nfl[i].fid);
-				if (f.m_ntag == 0)
+				if (faces.insert(nfl[i].fid).second)
 				{
+					const FSFace& f = Face(nfl[i].fid);
 					int ne = f.Nodes();
 					for (int j = 0; j < ne; ++j) if (f.n[j] != *it) nl2.push_back(f.n[j]);
-					f.m_ntag = 1;
 				}
 			}
 		}
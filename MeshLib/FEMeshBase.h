@@ -106,7 +106,7 @@ public:
 
 	bool IsCreaseEdge(int n0, int n1);
 
-	const std::vector<NodeFaceRef>& NodeFaceList(int n) const;
+	NodeFaceRefList NodeFaceList(int n) const;
 
 protected:
 	void RemoveEdges(int ntag);
@@ -66,6 +66,7 @@ void FEMeshBuilder::AddTriangle(int n0, int n1, int n2)
 	elem.m_node[1] = n1;
 	elem.m_node[2] = n2;
 	m_mesh.m_Elem.push_back(elem);
+	m_mesh.ElementAttributes().Resize(m_mesh.Elements());
 	RebuildMesh();
 }
 
@@ -81,6 +82,7 @@ void FEMeshBuilder::AddTriangles(const std::vector<int>& nodes)
 		elem.m_node[2] = nodes[i+2];
 		m_mesh.m_Elem.push_back(elem);
 	}
+	m_mesh.ElementAttributes().Resize(m_mesh.Elements());
 	RebuildMesh();
 }
 
@@ -663,6 +665,7 @@ void FEMeshBuilder::Attach(FSMesh& fem)
 		++ng;
 
 		m_mesh.m_Elem.resize(elems);
+		m_mesh.ElementAttributes().Resize(elems);
 		m_mesh.m_data.Clear();
 		for (i = 0; i<ne1; ++i)
 		{
@@ -670,6 +673,7 @@ void FEMeshBuilder::Attach(FSMesh& fem)
 			FSElement& e1 = fem.m_Elem[i];
 			e0 = e1;
 			e0.m_gid = e1.m_gid + ng;
+			m_mesh.CopyElementAttributes(ne0 + i, fem, i);
 
 			for (j = 0; j<6; ++j)
 			{
@@ -973,11 +977,13 @@ FSMesh* FEMeshBuilder::DetachSelectedMesh()
 		if (!e0.IsSelected())
 		{
 			e1 = e0;
+			m_mesh.CopyElementAttributes(n, m_mesh, i);
 			ELT[i] = n;
 			++n;
 		}
 	}
 	m_mesh.m_Elem.resize(n);
+	m_mesh.ElementAttributes().Resize(n);
 	m_mesh.m_data.Clear();
 
 	// tag nodes which will be kept
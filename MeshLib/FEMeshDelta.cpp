@@ -0,0 +1,245 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "FEMeshDelta.h"
+#include "FEMesh.h"
+#include <assert.h>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+static inline bool sameVec(const vec3d& a, const vec3d& b)
+{
+	return ((a.x == b.x) && (a.y == b.y) && (a.z == b.z));
+}
+
+//-----------------------------------------------------------------------------
+static bool sameItem(const MeshItem& a, const MeshItem& b)
+{
+	return ((a.m_gid == b.m_gid) && (a.m_nid == b.m_nid) && (a.m_ntag == b.m_ntag));
+}
+
+//-----------------------------------------------------------------------------
+static bool sameElement(const FEElement_& a, const FEElement_& b)
+{
+	if (a.Type() != b.Type()) return false;
+	if (sameItem(a, b) == false) return false;
+	if (a.m_MatID != b.m_MatID) return false;
+	int n = a.Nodes();
+	for (int i = 0; i < n; ++i) if (a.m_node[i] != b.m_node[i]) return false;
+	if (a.IsShell())
+	{
+		for (int i = 0; i < n; ++i) if (a.m_h[i] != b.m_h[i]) return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// compare the attributes of element i of both meshes
+static bool sameElementAttributes(const FSMesh& a, const FSMesh& b, int i)
+{
+	if (!sameVec(a.ElementFiber(i), b.ElementFiber(i))) return false;
+	if (a.IsElementMaterialAxesActive(i) != b.IsElementMaterialAxesActive(i)) return false;
+	if (a.IsElementMaterialAxesActive(i))
+	{
+		const mat3d& Qa = a.ElementMaterialAxes(i);
+		const mat3d& Qb = b.ElementMaterialAxes(i);
+		for (int k = 0; k < 3; ++k)
+			for (int l = 0; l < 3; ++l)
+				if (Qa(k, l) != Qb(k, l)) return false;
+	}
+	if (a.ElementCrossSectionArea(i) != b.ElementCrossSectionArea(i)) return false;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+static bool sameFace(const FSFace& a, const FSFace& b)
+{
+	if (a.Type() != b.Type()) return false;
+	if (sameItem(a, b) == false) return false;
+	if (a.m_sid != b.m_sid) return false;
+	int n = a.Nodes();
+	for (int i = 0; i < n; ++i) if (a.n[i] != b.n[i]) return false;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+static bool sameEdge(const FSEdge& a, const FSEdge& b)
+{
+	if (a.Type() != b.Type()) return false;
+	if (sameItem(a, b) == false) return false;
+	int n = a.Nodes();
+	for (int i = 0; i < n; ++i) if (a.n[i] != b.n[i]) return false;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// compare the name and items of two groups
+static bool sameGroup(FEItemListBuilder* a, FEItemListBuilder* b)
+{
+	if ((a == nullptr) || (b == nullptr)) return (a == b);
+	if (a->Type() != b->Type()) return false;
+	if (a->GetName() != b->GetName()) return false;
+	if (a->size() != b->size()) return false;
+	return std::equal(a->begin(), a->end(), b->begin());
+}
+
+//-----------------------------------------------------------------------------
+static bool sameMeshData(FEMeshData* a, FEMeshData* b)
+{
+	if (a->GetName() != b->GetName()) return false;
+	if (a->GetDataClass() != b->GetDataClass()) return false;
+	if (a->GetDataType() != b->GetDataType()) return false;
+	if (a->GetDataFormat() != b->GetDataFormat()) return false;
+	if (a->GetData() != b->GetData()) return false;
+	return sameGroup(a->GetItemList(), b->GetItemList());
+}
+
+//-----------------------------------------------------------------------------
+bool SameMeshTopology(FSMesh& a, FSMesh& b)
+{
+	if (a.Nodes() != b.Nodes()) return false;
+	if (a.Elements() != b.Elements()) return false;
+	if (a.Faces() != b.Faces()) return false;
+	if (a.Edges() != b.Edges()) return false;
+
+	if (a.FEPartSets() != b.FEPartSets()) return false;
+	if (a.FEElemSets() != b.FEElemSets()) return false;
+	if (a.FESurfaces() != b.FESurfaces()) return false;
+	if (a.FEEdgeSets() != b.FEEdgeSets()) return false;
+	if (a.FENodeSets() != b.FENodeSets()) return false;
+	if (a.MeshDataFields() != b.MeshDataFields()) return false;
+
+	for (int i = 0; i < a.Nodes(); ++i)
+		if (sameItem(a.Node(i), b.Node(i)) == false) return false;
+
+	for (int i = 0; i < a.Elements(); ++i)
+		if ((sameElement(a.ElementRef(i), b.ElementRef(i)) == false) ||
+			(sameElementAttributes(a, b, i) == false)) return false;
+
+	for (int i = 0; i < a.Faces(); ++i)
+		if (sameFace(a.Face(i), b.Face(i)) == false) return false;
+
+	for (int i = 0; i < a.Edges(); ++i)
+		if (sameEdge(a.Edge(i), b.Edge(i)) == false) return false;
+
+	for (int i = 0; i < a.FEPartSets(); ++i)
+		if (sameGroup(a.GetFEPartSet(i), b.GetFEPartSet(i)) == false) return false;
+
+	for (int i = 0; i < a.FEElemSets(); ++i)
+		if (sameGroup(a.GetFEElemSet(i), b.GetFEElemSet(i)) == false) return false;
+
+	for (int i = 0; i < a.FESurfaces(); ++i)
+		if (sameGroup(a.GetFESurface(i), b.GetFESurface(i)) == false) return false;
+
+	for (int i = 0; i < a.FEEdgeSets(); ++i)
+		if (sameGroup(a.GetFEEdgeSet(i), b.GetFEEdgeSet(i)) == false) return false;
+
+	for (int i = 0; i < a.FENodeSets(); ++i)
+		if (sameGroup(a.GetFENodeSet(i), b.GetFENodeSet(i)) == false) return false;
+
+	for (int i = 0; i < a.MeshDataFields(); ++i)
+		if (sameMeshData(a.GetMeshDataField(i), b.GetMeshDataField(i)) == false) return false;
+
+	// The element data used for visualization is not compared item by item.
+	// If either mesh has any, we keep a full copy to be safe.
+	if (a.GetMeshData().IsValid() || b.GetMeshData().IsValid()) return false;
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+size_t MeshMemorySize(const FSMesh& mesh)
+{
+	size_t size = sizeof(FSMesh);
+	size += (size_t)mesh.Nodes() * sizeof(FSNode);
+	size += (size_t)mesh.Elements() * sizeof(FSElement);
+	size += (size_t)mesh.Faces() * sizeof(FSFace);
+	size += (size_t)mesh.Edges() * sizeof(FSEdge);
+	return size;
+}
+
+//=============================================================================
+FSNodePositionDelta::FSNodePositionDelta()
+{
+}
+
+//-----------------------------------------------------------------------------
+void FSNodePositionDelta::Clear()
+{
+	m_range.clear();
+	m_rold.clear();
+	m_rnew.clear();
+}
+
+//-----------------------------------------------------------------------------
+bool FSNodePositionDelta::Build(FSMesh& oldMesh, FSMesh& newMesh)
+{
+	Clear();
+	if (SameMeshTopology(oldMesh, newMesh) == false) return false;
+
+	// collect the ranges of nodes that moved
+	int NN = oldMesh.Nodes();
+	for (int i = 0; i < NN;)
+	{
+		if (sameVec(oldMesh.Node(i).r, newMesh.Node(i).r)) { i++; continue; }
+
+		RANGE rng;
+		rng.n0 = i;
+		while ((i < NN) && !sameVec(oldMesh.Node(i).r, newMesh.Node(i).r))
+		{
+			m_rold.push_back(oldMesh.Node(i).r);
+			m_rnew.push_back(newMesh.Node(i).r);
+			i++;
+		}
+		rng.count = i - rng.n0;
+		m_range.push_back(rng);
+	}
+
+	m_range.shrink_to_fit();
+	m_rold.shrink_to_fit();
+	m_rnew.shrink_to_fit();
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void FSNodePositionDelta::Apply(FSMesh& mesh, bool undo) const
+{
+	const std::vector<vec3d>& r = (undo ? m_rold : m_rnew);
+	size_t m = 0;
+	for (const RANGE& rng : m_range)
+	{
+		assert(rng.n0 + rng.count <= mesh.Nodes());
+		for (int i = 0; i < rng.count; ++i) mesh.Node(rng.n0 + i).r = r[m++];
+	}
+}
+
+//-----------------------------------------------------------------------------
+size_t FSNodePositionDelta::MemorySize() const
+{
+	return sizeof(FSNodePositionDelta) + m_range.capacity() * sizeof(RANGE) + (m_rold.capacity() + m_rnew.capacity()) * sizeof(vec3d);
+}
@@ -0,0 +1,76 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include <FSCore/math3d.h>
+#include <vector>
+
+class FSMesh;
+
+//-----------------------------------------------------------------------------
+// Stores the difference between two meshes that only differ in their nodal
+// positions (e.g. after smoothing). Only the ranges of nodes that moved are
+// stored, which is much smaller than keeping a copy of the whole mesh.
+class FSNodePositionDelta
+{
+	struct RANGE
+	{
+		int	n0;		// first node of range
+		int	count;	// number of nodes in range
+	};
+
+public:
+	FSNodePositionDelta();
+
+	// Build the delta from oldMesh to newMesh. Returns false if the meshes differ
+	// in anything other than node positions, in which case the delta is empty.
+	bool Build(FSMesh& oldMesh, FSMesh& newMesh);
+
+	// set the node positions of the mesh to the old (undo = true) or new positions
+	void Apply(FSMesh& mesh, bool undo) const;
+
+	// number of nodes that changed
+	int ChangedNodes() const { return (int)m_rold.size(); }
+
+	// clear the delta
+	void Clear();
+
+	// approximate memory used by this delta (in bytes)
+	size_t MemorySize() const;
+
+private:
+	std::vector<RANGE>	m_range;	// ranges of changed nodes
+	std::vector<vec3d>	m_rold;		// old positions of changed nodes
+	std::vector<vec3d>	m_rnew;		// new positions of changed nodes
+};
+
+// returns true if the two meshes have the same topology, item attributes,
+// groups and data fields, i.e. they only (possibly) differ in their nodal positions.
+bool SameMeshTopology(FSMesh& a, FSMesh& b);
+
+// approximate memory used by a mesh (in bytes)
+size_t MeshMemorySize(const FSMesh& mesh);
@@ -0,0 +1,140 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+
+//-----------------------------------------------------------------------------
+// A read-only view of the items that are attached to a node in a FSNodeAdjacency list.
+template <typename T> class FSAdjacencyRange
+{
+public:
+	FSAdjacencyRange(const T* beg, const T* end) : m_beg(beg), m_end(end) {}
+
+	size_t size() const { return (size_t)(m_end - m_beg); }
+	bool empty() const { return (m_beg == m_end); }
+
+	const T& operator [] (size_t i) const { return m_beg[i]; }
+
+	const T* begin() const { return m_beg; }
+	const T* end() const { return m_end; }
+
+private:
+	const T*	m_beg;
+	const T*	m_end;
+};
+
+//-----------------------------------------------------------------------------
+// Stores for each node a list of items (elements, faces, edges, ...) in compressed
+// sparse row format. The references of node n are stored in m_ref[m_off[n]] to
+// m_ref[m_off[n+1]-1].
+template <typename T> class FSNodeAdjacency
+{
+public:
+	FSNodeAdjacency() {}
+
+	void Clear()
+	{
+		m_off.clear(); m_off.shrink_to_fit();
+		m_ref.clear(); m_ref.shrink_to_fit();
+	}
+
+	bool IsEmpty() const { return m_off.empty(); }
+
+	int Nodes() const { return (m_off.empty() ? 0 : (int)m_off.size() - 1); }
+
+	int Valence(int n) const { return m_off[n + 1] - m_off[n]; }
+
+	T& Ref(int n, int i) { return m_ref[m_off[n] + i]; }
+	const T& Ref(int n, int i) const { return m_ref[m_off[n] + i]; }
+
+	FSAdjacencyRange<T> List(int n) const
+	{
+		const T* p = m_ref.data();
+		return FSAdjacencyRange<T>(p + m_off[n], p + m_off[n + 1]);
+	}
+
+	// Build the list for nodes nodes from items items. The function itemRefs(i, add)
+	// must call add(node, ref) for every node reference of item i, and the references
+	// must be ordered by the items they belong to (i.e. T must define an operator <
+	// that sorts by item). References to invalid nodes are ignored. The items are 
+	// processed in parallel: the references are counted and placed with an atomic 
+	// counter per node, so that the only temporary storage is one counter per node. 
+	// Since the threads place the references in any order, the references of each 
+	// node are sorted afterwards, which keeps the result independent of the number 
+	// of threads.
+	template <class ItemRefs>
+	void Build(int nodes, int items, ItemRefs itemRefs)
+	{
+		Clear();
+		if (nodes <= 0) return;
+
+		// count the references of each node
+		std::vector<std::atomic<int> > cnt(nodes);
+		for (int n = 0; n < nodes; ++n) cnt[n].store(0, std::memory_order_relaxed);
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < items; ++i)
+		{
+			itemRefs(i, [&](int n, const T&) {
+				if ((n >= 0) && (n < nodes)) cnt[n].fetch_add(1, std::memory_order_relaxed);
+			});
+		}
+
+		// setup the offsets, and let the counters point to the node's first slot
+		m_off.assign(nodes + 1, 0);
+		for (int n = 0; n < nodes; ++n)
+		{
+			m_off[n + 1] = m_off[n] + cnt[n].load(std::memory_order_relaxed);
+			cnt[n].store(m_off[n], std::memory_order_relaxed);
+		}
+		m_ref.resize(m_off[nodes]);
+
+		// fill the reference array
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < items; ++i)
+		{
+			itemRefs(i, [&](int n, const T& ref) {
+				if ((n >= 0) && (n < nodes)) m_ref[cnt[n].fetch_add(1, std::memory_order_relaxed)] = ref;
+			});
+		}
+
+		// sort the references of each node in item order
+#pragma omp parallel for schedule(static)
+		for (int n = 0; n < nodes; ++n)
+		{
+			T* p = m_ref.data();
+			std::sort(p + m_off[n], p + m_off[n + 1]);
+		}
+	}
+
+private:
+	std::vector<int>	m_off;	// offset into reference array (size = nodes + 1)
+	std::vector<T>		m_ref;	// reference array
+};
@@ -36,12 +36,12 @@ FSNodeEdgeList::FSNodeEdgeList(FSLineMesh* mesh) : m_mesh(mesh)
 
 void FSNodeEdgeList::Clear()
 {
-	m_edge.clear();
+	m_edge.Clear();
 }
 
 bool FSNodeEdgeList::IsEmpty() const
 {
-	return m_edge.empty();
+	return m_edge.IsEmpty();
 }
 
 void FSNodeEdgeList::Build(FSLineMesh* pmesh, bool segsOnly)
@@ -50,42 +50,34 @@ void FSNodeEdgeList::Build(FSLineMesh* pmesh, bool segsOnly)
 	assert(pmesh);
 	FSLineMesh& mesh = *m_mesh;
 
-	// allocate valence array
+	m_edge.Clear();
 	int N = mesh.Nodes();
 	if (N == 0) return;
-	m_edge.resize(N);
 
 	// fill edge array
 	int NE = mesh.Edges();
-	for (int i=0; i<NE; ++i)
-	{
-		const FSEdge& edge = mesh.Edge(i);
-		if ((segsOnly == false) || (edge.IsExterior()))
-		{
-			int n0 = edge.n[0];
-			int n1 = edge.n[1];
-
-			vector<int>& l0 = m_edge[n0];
-			vector<int>& l1 = m_edge[n1];
-
-			l0.push_back(i);
-			l1.push_back(i);
-		}
-	}
+	m_edge.Build(N, NE, [&](int i, auto add) {
+			const FSEdge& edge = mesh.Edge(i);
+			if ((segsOnly == false) || (edge.IsExterior()))
+			{
+				add(edge.n[0], i);
+				add(edge.n[1], i);
+			}
+		});
 }
 
 // Return the edge for a given node
 const FSEdge* FSNodeEdgeList::Edge(int node, int edge) const
 {
-	return m_mesh->EdgePtr(m_edge[node][edge]);
+	return m_mesh->EdgePtr(m_edge.Ref(node, edge));
 }
 
 int FSNodeEdgeList::EdgeIndex(int node, int edge) const 
 { 
-	return m_edge[node][edge]; 
+	return m_edge.Ref(node, edge); 
 }
 
-const std::vector<int>& FSNodeEdgeList::EdgeIndexList(int node) const
+FSAdjacencyRange<int> FSNodeEdgeList::EdgeIndexList(int node) const
 {
-	return m_edge[node];
+	return m_edge.List(node);
 }
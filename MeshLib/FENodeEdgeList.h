@@ -26,6 +26,7 @@ SOFTWARE.*/
 
 #pragma once
 #include <vector>
+#include "FENodeAdjacency.h"
 
 class FSLineMesh;
 class FSEdge;
@@ -42,7 +43,7 @@ public:
 	bool IsEmpty() const;
 
 	// Return the number of edges for a given node
-	int Edges(int node) const { return (int) m_edge[node].size(); }
+	int Edges(int node) const { return m_edge.Valence(node); }
 
 	// Return the edge for a given node
 	const FSEdge* Edge(int node, int edge) const;
@@ -50,9 +51,9 @@ public:
 	// return the edge index
 	int EdgeIndex(int node, int edge) const;
 
-	const std::vector<int>& EdgeIndexList(int node) const;
+	FSAdjacencyRange<int> EdgeIndexList(int node) const;
 
 private:
 	FSLineMesh*			m_mesh;
-	std::vector< std::vector<int> >	m_edge;		// edge list
+	FSNodeAdjacency<int>	m_edge;		// edge list
 };
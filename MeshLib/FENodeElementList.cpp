@@ -39,42 +39,29 @@ void FSNodeElementList::Build(FSCoreMesh* pm)
 {
 	m_pm = pm;
 	assert(m_pm);
-	m_elem.clear();
+	m_elem.Clear();
 
 	int NN = m_pm->Nodes();
 	int NE = m_pm->Elements();
 	if ((NE == 0) || (NN == 0)) return;
 
-	m_elem.resize(NN);
-	for (int i=0; i<NE; ++i)
-	{
-		FEElement_& el = m_pm->ElementRef(i);
-		int ne = el.Nodes();
-		for (int j=0; j<ne; ++j) 
-		{
-			int n = el.m_node[j];
-
-			std::vector<NodeElemRef>& lj = m_elem[n];
-
-			NodeElemRef ref;
-			ref.eid = i;
-			ref.nid = j;
-			ref.pe = &el;
-
-			lj.push_back(ref);
-		}
-	}
+	FSCoreMesh& mesh = *m_pm;
+	m_elem.Build(NN, NE, [&](int i, auto add) {
+			const FEElement_& el = mesh.ElementRef(i);
+			int ne = el.Nodes();
+			for (int j = 0; j < ne; ++j) add(el.m_node[j], NodeElemRef{ i, j });
+		});
 }
 
 void FSNodeElementList::Clear()
 {
 	m_pm = nullptr;
-	m_elem.clear();
+	m_elem.Clear();
 }
 
 bool FSNodeElementList::IsEmpty() const
 {
-	return m_elem.empty();
+	return m_elem.IsEmpty();
 }
 
 bool FSNodeElementList::HasElement(int node, int iel) const
@@ -89,6 +76,7 @@ bool FSNodeElementList::HasElement(int node, int iel) const
 std::vector<int> FSNodeElementList::ElementIndexList(int n) const
 {
 	std::vector<int> l;
+	l.reserve(Valence(n));
 	int nval = Valence(n);
 	for (int i=0; i<nval; ++i)
 	{
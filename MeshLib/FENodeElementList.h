@@ -26,6 +26,7 @@ SOFTWARE.*/
 #pragma once
 #include <vector>
 #include "FECoreMesh.h"
+#include "FENodeAdjacency.h"
 
 //-----------------------------------------------------------------------------
 // the first index is the element number
@@ -33,9 +34,16 @@ SOFTWARE.*/
 struct NodeElemRef {
 	int		eid;	// element index in mesh
 	int		nid;	// local node index of the element
-	FEElement_*	pe;	// pointer to element
 };
 
+// sorts the references in the order of the items
+inline bool operator < (const NodeElemRef& a, const NodeElemRef& b)
+{
+	return (a.eid < b.eid) || ((a.eid == b.eid) && (a.nid < b.nid));
+}
+
+typedef FSAdjacencyRange<NodeElemRef> NodeElemRefList;
+
 class FSNodeElementList
 {
 public:
@@ -48,16 +56,16 @@ public:
 
 	bool IsEmpty() const;
 
-	int Valence(int n) const { return (int)m_elem[n].size(); }
-	FEElement_* Element(int n, int j) { return m_elem[n][j].pe; }
-	int ElementIndex(int n, int j) const { return m_elem[n][j].eid; }
+	int Valence(int n) const { return m_elem.Valence(n); }
+	FEElement_* Element(int n, int j) { return &m_pm->ElementRef(m_elem.Ref(n, j).eid); }
+	int ElementIndex(int n, int j) const { return m_elem.Ref(n, j).eid; }
 
 	bool HasElement(int node, int iel) const;
 
 	std::vector<int> ElementIndexList(int n) const;
-	const std::vector<NodeElemRef>& ElementList(int n) const { return m_elem[n]; }
+	NodeElemRefList ElementList(int n) const { return m_elem.List(n); }
 
 protected:
 	FSCoreMesh*	m_pm;
-	std::vector< std::vector<NodeElemRef> >	m_elem;
+	FSNodeAdjacency<NodeElemRef>	m_elem;
 };
@@ -44,13 +44,13 @@ FSNodeFaceList::~FSNodeFaceList(void)
 //-----------------------------------------------------------------------------
 void FSNodeFaceList::Clear()
 {
-	m_face.clear();
+	m_face.Clear();
 }
 
 //-----------------------------------------------------------------------------
 bool FSNodeFaceList::IsEmpty() const
 {
-	return m_face.empty();
+	return m_face.IsEmpty();
 }
 
 //-----------------------------------------------------------------------------
@@ -80,24 +80,17 @@ void FSNodeFaceList::Build(FSMeshBase* pm)
 	int NN = m.Nodes();
 	int NF = m.Faces();
 
-	m_face.resize(NN);
-	for (int i=0; i<NF; ++i)
-	{
-		FSFace& f = m.Face(i);
-		int nf = f.Nodes();
-		for (int j = 0; j<nf; ++j)
-		{
-			int n = f.n[j];
-			vector<NodeFaceRef>& li = m_face[n];
-
-			NodeFaceRef ref;
-			ref.fid = i;
-			ref.nid = j;
-			ref.pf = &f;
+	m_face.Build(NN, NF, [&](int i, auto add) {
+			const FSFace& f = m.Face(i);
+			int nf = f.Nodes();
+			for (int j = 0; j < nf; ++j) add(f.n[j], NodeFaceRef{ i, j });
+		});
+}
 
-			li.push_back(ref);
-		}
-	}
+//-----------------------------------------------------------------------------
+FSFace* FSNodeFaceList::Face(int n, int i)
+{
+	return &m_pm->Face(m_face.Ref(n, i).fid);
 }
 
 //-----------------------------------------------------------------------------
@@ -125,12 +118,14 @@ int FSNodeFaceList::FindFace(const FSFace& f)
 bool FSNodeFaceList::Sort(int node)
 {
 	int nval = Valence(node);
+	if (nval == 0) return true;
 	vector<NodeFaceRef> fl; fl.reserve(nval);
 
 	for (int i=0; i<nval; ++i) Face(node, i)->m_ntag = 0;
 
-	NodeFaceRef ref = m_face[node][0];
-	ref.pf->m_ntag = 1;
+	NodeFaceRef ref = m_face.Ref(node, 0);
+	FSFace* pf = &m_pm->Face(ref.fid);
+	pf->m_ntag = 1;
 	fl.push_back(ref);
 	bool bdone = false;
 	do
@@ -138,11 +133,11 @@ bool FSNodeFaceList::Sort(int node)
 		bdone = true;
 
 		int m = -1;
-		if      (ref.pf->n[0] == node) m = 0;
-		else if (ref.pf->n[1] == node) m = 1;
-		else if (ref.pf->n[2] == node) m = 2;
+		if      (pf->n[0] == node) m = 0;
+		else if (pf->n[1] == node) m = 1;
+		else if (pf->n[2] == node) m = 2;
 
-		int nj = ref.pf->m_nbr[(m+2)%3];
+		int nj = pf->m_nbr[(m+2)%3];
 		if (nj >= 0)
 		{
 			FSFace* pf2 = &m_pm->Face(nj);
@@ -161,8 +156,9 @@ bool FSNodeFaceList::Sort(int node)
 				}
 				assert(k < nval);
 
-				fl.push_back(m_face[node][k]);
-				ref = m_face[node][k];
+				ref = m_face.Ref(node, k);
+				pf = pf2;
+				fl.push_back(ref);
 				bdone = false;
 			}
 		}
@@ -172,14 +168,14 @@ bool FSNodeFaceList::Sort(int node)
 	// for non-manifold topologies this algorithm
 	// can fail. In that case, we return false
 	if ((int)fl.size() != nval) return false;
-	m_face[node] = fl;
+	for (int i = 0; i < nval; ++i) m_face.Ref(node, i) = fl[i];
 
 	return true;
 }
 
-const vector<NodeFaceRef>& FSNodeFaceList::FaceList(int n) const
+NodeFaceRefList FSNodeFaceList::FaceList(int n) const
 { 
-	return m_face[n]; 
+	return m_face.List(n); 
 }
 
 //-----------------------------------------------------------------------------
@@ -204,7 +200,7 @@ int FSNodeFaceList::FindFace(int inode, int n[10], int m)
 		assert(false);
 	};
 
-	vector<NodeFaceRef>& ni = m_face[inode];
+	NodeFaceRefList ni = m_face.List(inode);
 	int nf = (int)ni.size();
 	for (int i = 0; i<nf; ++i)
 	{
@@ -25,6 +25,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.*/
 #pragma once
 #include <vector>
+#include "FENodeAdjacency.h"
 
 class FSFace;
 class FSMeshBase;
@@ -32,9 +33,16 @@ class FSMeshBase;
 struct NodeFaceRef {
 	int		fid;	// face index (into mesh' Face array)
 	int		nid;	// local node index
-	FSFace*	pf;		// face pointer
 };
 
+// sorts the references in the order of the items
+inline bool operator < (const NodeFaceRef& a, const NodeFaceRef& b)
+{
+	return (a.fid < b.fid) || ((a.fid == b.fid) && (a.nid < b.nid));
+}
+
+typedef FSAdjacencyRange<NodeFaceRef> NodeFaceRefList;
+
 class FSNodeFaceList
 {
 public:
@@ -48,9 +56,9 @@ public:
 
 	bool IsEmpty() const;
 
-	int Valence(int i) const { return (int) m_face[i].size(); }
-	FSFace* Face(int n, int i) { return m_face[n][i].pf; }
-	int FaceIndex(int n, int i) { return m_face[n][i].fid; }
+	int Valence(int i) const { return m_face.Valence(i); }
+	FSFace* Face(int n, int i);
+	int FaceIndex(int n, int i) { return m_face.Ref(n, i).fid; }
 
 	bool HasFace(int n, FSFace* pf);
 
@@ -58,12 +66,12 @@ public:
 
 	int FindFace(int inode, int n[10], int m);
 
-	const std::vector<NodeFaceRef>& FaceList(int n) const;
+	NodeFaceRefList FaceList(int n) const;
 
 protected:
 	bool Sort(int node);
 
 protected:
 	FSMeshBase*	m_pm;
-	std::vector< std::vector<NodeFaceRef> >	m_face;
+	FSNodeAdjacency<NodeFaceRef>	m_face;
 };
@@ -118,33 +118,44 @@ void Mesh_Data::SetElementValue(int elem, double v)
 //-----------------------------------------------------------------------------
 void Mesh_Data::UpdateValueRange()
 {
-	m_min = m_max = 0;
+	double vmin = 1e99, vmax = -1e99;
+	bool bset = false;
 
-	// find the first active value
+	// update range
 	int N = (int)m_data.size();
-	int i = 0;
-	for (i = 0; i < N; ++i)
+#pragma omp parallel
 	{
-		if (m_data[i].tag != 0)
+		double tmin = 1e99, tmax = -1e99;
+		bool tset = false;
+#pragma omp for nowait
+		for (int i = 0; i < N; ++i)
 		{
-			m_min = m_max = m_data[i].val[0];
-			break;
+			const DATA& di = m_data[i];
+			if (di.tag != 0)
+			{
+				for (int j = 0; j < di.nval; ++j)
+				{
+					if (di.val[j] > tmax) tmax = di.val[j];
+					if (di.val[j] < tmin) tmin = di.val[j];
+				}
+				tset = true;
+			}
 		}
-	}
 
-	// update range
-	for (i = 0; i < N; ++i)
-	{
-		DATA& di = m_data[i];
-		if (di.tag != 0)
+#pragma omp critical
 		{
-			for (int j = 0; j < di.nval; ++j)
+			if (tset)
 			{
-				if (di.val[j] > m_max) m_max = di.val[j];
-				if (di.val[j] < m_min) m_min = di.val[j];
+				if (tmin < vmin) vmin = tmin;
+				if (tmax > vmax) vmax = tmax;
+				bset = true;
 			}
 		}
 	}
+
+	// if there is no active value, the range is zero
+	if (bset) { m_min = vmin; m_max = vmax; }
+	else m_min = m_max = 0;
 }
 
 //-----------------------------------------------------------------------------
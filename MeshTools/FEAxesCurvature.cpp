@@ -383,14 +383,14 @@ void FEAxesCurvature::ApplyCurvature(FSMesh* pm)
         vec3d b = vec3d(eigenVectors(0,1),eigenVectors(1,1), eigenVectors(2,1));
         vec3d c = vec3d(eigenVectors(0,2),eigenVectors(1,2), eigenVectors(2,2));
         
-        FSElement& el = pm->Element(fel[i]);
-        mat3d& m = el.m_Q;
+        mat3d m;
         m.zero();
         m[0][0] = a.x; m[0][1] = b.x; m[0][2] = c.x;
         m[1][0] = a.y; m[1][1] = b.y; m[1][2] = c.y;
         m[2][0] = a.z; m[2][1] = b.z; m[2][2] = c.z;
     
-        el.m_Qactive = true;
+        pm->SetElementMaterialAxes(fel[i], m);
+        pm->SetElementMaterialAxesActive(fel[i], true);
     }
 }
 
@@ -464,8 +464,8 @@ void FEAxesCurvature::ApplyCurvaturePart(FSMesh* pm)
         }
         
         //assign same material axes
-        pm->Element(pel[i]).m_Q = pm->Element(fel[closestFace]).m_Q;
-        pm->Element(pel[i]).m_Qactive = true;
+        pm->SetElementMaterialAxes(pel[i], pm->ElementMaterialAxes(fel[closestFace]));
+        pm->SetElementMaterialAxesActive(pel[i], true);
     }
     
 }
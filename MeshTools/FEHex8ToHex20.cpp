@@ -193,6 +193,7 @@ FSMesh* FEHex8ToHex20::Apply(FSMesh* pm)
 		FSElement& e0 = pm->Element(i);
 		FSElement& e1 = pnew->Element(i);
 		e1 = e0;
+		pnew->CopyElementAttributes(i, *pm, i);
 
 		e1.m_gid = e0.m_gid;
 
@@ -572,6 +573,7 @@ FSMesh* FEHex20ToHex8::Apply(FSMesh* pm)
 		FSElement& e0 = pm->Element(i);
 		FSElement& e1 = pnew->Element(i);
 		e1 = e0;
+		pnew->CopyElementAttributes(i, *pm, i);
 
 		e1.m_gid = e0.m_gid;
 
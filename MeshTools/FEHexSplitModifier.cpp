@@ -453,6 +453,7 @@ FSMesh* FEHexSplitModifier::RefineSelection(FSMesh* pm)
 			FSElement& el = pmnew->Element(n++);
 			el.SetType(FE_HEX8);
 			el = el0;
+			pmnew->CopyElementAttributes(n - 1, *pm, i);
 		}
 		else
 		{
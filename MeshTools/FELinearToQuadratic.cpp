@@ -415,6 +415,7 @@ FSMesh* FELinearToQuadratic::Apply(FSMesh* pm)
         FSElement& e0 = pm->Element(i);
         FSElement& e1 = pnew->Element(i);
         e1 = e0;
+        pnew->CopyElementAttributes(i, *pm, i);
         
         e1.m_gid = e0.m_gid;
         
@@ -923,6 +924,7 @@ FSMesh* FEQuadraticToLinear::Apply(FSMesh* pm)
         FSElement& e0 = pm->Element(i);
         FSElement& e1 = pnew->Element(i);
         e1 = e0;
+        pnew->CopyElementAttributes(i, *pm, i);
         
         e1.m_gid = e0.m_gid;
         
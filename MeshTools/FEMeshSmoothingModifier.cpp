@@ -42,6 +42,9 @@ FEMeshSmoothingModifier::FEMeshSmoothingModifier() : FEModifier("Mesh Smoothing"
 	m_iteration = 0;
 	m_noise = 1.0;
 	m_method = 1;
+
+	// stop iterating when no node moves more than this (0 = run all iterations)
+	AddDoubleParam(0.0, "tolerance");
 }
 
 
@@ -93,44 +96,89 @@ FSMesh* FEMeshSmoothingModifier::Apply(FSMesh* pm)
 	return pnew;
 }
 
-void FEMeshSmoothingModifier::Laplacian_Smoothing(FSMesh* pnew,vector<int> hashmap)
+//-----------------------------------------------------------------------------
+// Assign the new node positions and return the largest displacement.
+// Nodes that are not smoothed (i.e. hashmap[i] != 0) must have rnew[i] = r[i].
+static double updateNodePositions(FSMesh* pnew, const vector<vec3d>& rnew)
+{
+	int NN = pnew->Nodes();
+	double dmax = 0;
+#pragma omp parallel
+	{
+		double tmax = 0;
+#pragma omp for nowait
+		for (int i = 0; i < NN; i++)
+		{
+			FSNode& ni = pnew->Node(i);
+			double d = (rnew[i] - ni.r).SqrLength();
+			if (d > tmax) tmax = d;
+			ni.r = rnew[i];
+		}
+
+#pragma omp critical
+		{
+			if (tmax > dmax) dmax = tmax;
+		}
+	}
+	return sqrt(dmax);
+}
+
+//-----------------------------------------------------------------------------
+// The smoothing kernels below are Jacobi-style: each iteration computes all new
+// positions from the positions of the previous iteration, so the nodes can be 
+// processed in parallel. If the tolerance parameter is positive, the iterations
+// stop early when no node moves more than the tolerance.
+void FEMeshSmoothingModifier::Laplacian_Smoothing(FSMesh* pnew, const vector<int>& hashmap)
 {
 	//Creating a node node list
 	FSNodeNodeList NNL(pnew);
 
+	double tol = GetFloatValue(0);
+	int NN = pnew->Nodes();
+	vector<vec3d> rnew(NN);
 	for(int j =0 ;j<m_iteration;j++)
 	{
-		for(int i = 0; i < pnew->Nodes() ; i++)
+#pragma omp parallel for schedule(static)
+		for(int i = 0; i < NN ; i++)
 		{
-			if(hashmap[i] == 0)
+			FSNode& ni = pnew->Node(i);
+			rnew[i] = ni.r;
+			int nval = NNL.Valence(i);
+			if((hashmap[i] == 0) && (nval > 0))
 			{
-				FSNode& ni = pnew->Node(i);
 				vec3d r_new; 
-				for (int k = 0; k<NNL.Valence(i);k++)
+				for (int k = 0; k<nval;k++)
 				{
 					vec3d x = pnew->Node(NNL.Node(i, k)).r;
 					r_new = r_new + x;
 				}
-				r_new = r_new/NNL.Valence(i);
-				r_new =(r_new * m_threshold1) + (ni.r * (1-m_threshold1));
-				ni.r = r_new;
+				r_new = r_new/nval;
+				rnew[i] =(r_new * m_threshold1) + (ni.r * (1-m_threshold1));
 			}
 		}
+
+		double dmax = updateNodePositions(pnew, rnew);
+		if ((tol > 0) && (dmax < tol)) break;
 	}
 }
 
-void FEMeshSmoothingModifier::Laplacian_Smoothing2(FSMesh* pnew,vector<int> hashmap)
+void FEMeshSmoothingModifier::Laplacian_Smoothing2(FSMesh* pnew, const vector<int>& hashmap)
 {
 	//Creating a node node list
 	FSNodeNodeList NNL(pnew);
 
+	double tol = GetFloatValue(0);
+	int NN = pnew->Nodes();
+	vector<vec3d> rnew(NN);
 	for(int j =0 ;j<m_iteration;j++)
 	{
-		for(int i = 0; i < pnew->Nodes() ; i++)
+#pragma omp parallel for schedule(static)
+		for(int i = 0; i < NN ; i++)
 		{
+			FSNode& ni = pnew->Node(i);
+			rnew[i] = ni.r;
 			if(hashmap[i] == 0)
 			{
-				FSNode& ni = pnew->Node(i);
 				vec3d r_new; 
 				double sum_dist=0;
 				for (int k = 0; k<NNL.Valence(i);k++)
@@ -140,24 +188,32 @@ void FEMeshSmoothingModifier::Laplacian_Smoothing2(FSMesh* pnew,vector<int> hash
 					r_new = r_new + (x * dist);
 					sum_dist += dist;
 				}
-				r_new = r_new/sum_dist;
-				r_new =(r_new * m_threshold1) + (ni.r * (1-m_threshold1));
-				ni.r = r_new;
+				if (sum_dist > 0)
+				{
+					r_new = r_new/sum_dist;
+					rnew[i] =(r_new * m_threshold1) + (ni.r * (1-m_threshold1));
+				}
 			}
 		}
+
+		double dmax = updateNodePositions(pnew, rnew);
+		if ((tol > 0) && (dmax < tol)) break;
 	}
 }
 
-void FEMeshSmoothingModifier::Taubin_Smoothing(FSMesh* pnew,vector<int> hashmap)
+void FEMeshSmoothingModifier::Taubin_Smoothing(FSMesh* pnew, const vector<int>& hashmap)
 {
 	//Creating a node node list
 	FSNodeNodeList NNL(pnew);
 	
-	vector<vec3d>phi_node;
-	phi_node.reserve(pnew->Nodes());
+	double tol = GetFloatValue(0);
+	int NN = pnew->Nodes();
+	vector<vec3d> phi_node(NN);
+	vector<vec3d> rnew(NN);
 	for(int j =0 ;j<m_iteration;j++)
 	{		
-		for(int i = 0; i < pnew->Nodes() ; i++)
+#pragma omp parallel for schedule(static)
+		for(int i = 0; i < NN ; i++)
 		{
 			FSNode& ni = pnew->Node(i);
 			vec3d r_sum;
@@ -168,13 +224,16 @@ void FEMeshSmoothingModifier::Taubin_Smoothing(FSMesh* pnew,vector<int> hashmap)
 			}
 			r_sum = r_sum/NNL.Valence(i);
 			r_sum -= ni.r;
-			phi_node.push_back(r_sum);
+			phi_node[i] = r_sum;
 		}		
-		for(int i = 0; i < pnew->Nodes() ; i++)
+
+#pragma omp parallel for schedule(static)
+		for(int i = 0; i < NN ; i++)
 		{
+			FSNode& ni = pnew->Node(i);
+			rnew[i] = ni.r;
 			if(hashmap[i] == 0)
 			{
-				FSNode& ni = pnew->Node(i);
 				vec3d phi_old = phi_node[i];
 
 				vec3d r_sq_sum,phi_sq_old; 
@@ -186,87 +245,92 @@ void FEMeshSmoothingModifier::Taubin_Smoothing(FSMesh* pnew,vector<int> hashmap)
 				phi_sq_old = r_sq_sum/NNL.Valence(i);
 				phi_sq_old -= phi_old;
 
-				ni.r = ni.r - (phi_old * (m_threshold2 - m_threshold1)) - (phi_sq_old *(m_threshold1*m_threshold2));
+				rnew[i] = ni.r - (phi_old * (m_threshold2 - m_threshold1)) - (phi_sq_old *(m_threshold1*m_threshold2));
 			}
 		}
-		phi_node.clear();
+
+		double dmax = updateNodePositions(pnew, rnew);
+		if ((tol > 0) && (dmax < tol)) break;
 	}
 }
 
-void FEMeshSmoothingModifier::Crease_Enhancing_Diffusion(FSMesh* pnew,vector<int> hashmap)
+void FEMeshSmoothingModifier::Crease_Enhancing_Diffusion(FSMesh* pnew, const vector<int>& hashmap)
 {
 	//creating Node Element list
 	FSNodeFaceList NFL;
 	NFL.Build(pnew);
 
+	int NF = pnew->Faces();
+	double tol = GetFloatValue(0);
+	int NN = pnew->Nodes();
+
 	//calculating m(R) for each face i.e for each triangle	
-	vector<FSFace*> mR ;
-	vector<vec3d>m_R;
-	vector<vec3d>m_R_new;	
-	mR.reserve(pnew->Faces());
-	m_R.reserve(pnew->Faces());
-	m_R_new.reserve(pnew->Faces());
+	vector<vec3d>m_R(NF);
+	vector<vec3d>m_R_new(NF);	
+	vector<vec3d> rnew(NN);
 
 	//for first iteration m_R are normals
-	for(int i =0; i< pnew->Faces();i++)
+	for(int i =0; i< NF;i++)
 	{
 		FSFace& fa = pnew->Face(i);
-		m_R.push_back(to_vec3d(fa.m_fn));
+		m_R[i] = to_vec3d(fa.m_fn);
 	}
 	for (int iter = 0 ; iter< m_iteration;iter++)
 	{				
 		//for each face calculate m_R
-		for(int i =0;i<pnew->Faces();i++)
+#pragma omp parallel
 		{
-			FSFace& fa = pnew->Face(i);				
-			vec3d centroid_R = (pnew->Node(fa.n[0]).r + pnew->Node(fa.n[1]).r + pnew->Node(fa.n[2]).r )/3;
-			//finding the neighbouring faces
-			for(int j =0 ;j<3 ;j++)
+			vector<const FSFace*> mR;
+#pragma omp for schedule(static)
+			for(int i =0;i<NF;i++)
 			{
-				int nodeID = fa.n[j];
-				for (int k = 0; k<NFL.Valence(nodeID);k++)
+				const FSFace& fa = pnew->Face(i);
+				vec3d centroid_R = (pnew->Node(fa.n[0]).r + pnew->Node(fa.n[1]).r + pnew->Node(fa.n[2]).r )/3;
+				//finding the neighbouring faces
+				mR.clear();
+				for(int j =0 ;j<3 ;j++)
 				{
-					FSFace *fa1 = NFL.Face(nodeID,k);
-					if(fa1->m_ntag != 1 && fa1->m_elem[0].eid != i)
+					int nodeID = fa.n[j];
+					for (int k = 0; k<NFL.Valence(nodeID);k++)
 					{
-						fa1->m_ntag = 1;
-						mR.push_back(fa1);
-					}
-				}					
-			}
-			//now we have the neighbouring faces in mR list
-			double weight =0;
-			m_R_new.push_back(vec3d(0,0,0));
-			for(int k =0;k<mR.size();k++)
-			{
-				FSFace *fa1 = mR[k];
-				vec3d r[3]; //three nodes of the face
-				r[0] = pnew->Node(fa1->n[0]).r;
-				r[1] = pnew->Node(fa1->n[1]).r;
-				r[2] = pnew->Node(fa1->n[2]).r;
-				vec3d centroid_S = (r[0]+r[1]+r[2])/3;
-				double dist = (centroid_S - centroid_R).Length();
-				double angle = acos((fa.m_fn * fa1->m_fn)/(fa.m_fn.Length() * fa1->m_fn.Length()));//angle between the normals
-				double weight1 = area_triangle(r) * exp(-m_threshold1 * angle*angle*dist*dist);
-				weight += weight1;
-				m_R_new[i] += m_R[fa1->m_elem[0].eid] * weight1;
-				fa1->m_ntag = 0;
+						const FSFace *fa1 = NFL.Face(nodeID,k);
+						if((fa1->m_elem[0].eid != i) && (std::find(mR.begin(), mR.end(), fa1) == mR.end()))
+						{
+							mR.push_back(fa1);
+						}
+					}					
+				}
+				//now we have the neighbouring faces in mR list
+				double weight =0;
+				vec3d R_new(0,0,0);
+				for(int k =0;k<mR.size();k++)
+				{
+					const FSFace *fa1 = mR[k];
+					vec3d r[3]; //three nodes of the face
+					r[0] = pnew->Node(fa1->n[0]).r;
+					r[1] = pnew->Node(fa1->n[1]).r;
+					r[2] = pnew->Node(fa1->n[2]).r;
+					vec3d centroid_S = (r[0]+r[1]+r[2])/3;
+					double dist = (centroid_S - centroid_R).Length();
+					double angle = acos((fa.m_fn * fa1->m_fn)/(fa.m_fn.Length() * fa1->m_fn.Length()));//angle between the normals
+					double weight1 = area_triangle(r) * exp(-m_threshold1 * angle*angle*dist*dist);
+					weight += weight1;
+					R_new += m_R[fa1->m_elem[0].eid] * weight1;
+				}
+				m_R_new[i] = R_new/weight;	
 			}
-			m_R_new[i] = m_R_new[i]/weight;	
-			mR.clear();
 		}
 		//we have m_R_new for each face.
-		for(int i =0 ;i<m_R_new.size();i++)
-		{
-			m_R[i] = m_R_new[i];
-		}
-		m_R_new.clear();
+		m_R.swap(m_R_new);
+
 		//For each node modify its coodinates
-		for(int i = 0 ;i < pnew->Nodes();i++)
+#pragma omp parallel for schedule(static)
+		for(int i = 0 ;i < NN;i++)
 		{
+			FSNode& ni = pnew->Node(i);
+			rnew[i] = ni.r;
 			if(hashmap[i] == 0) //not the edge node
 			{
-				FSNode& ni = pnew->Node(i);
 				vec3d vR; 
 				double weight=0;
 				for (int k = 0; k<NFL.Valence(i);k++)
@@ -283,9 +347,12 @@ void FEMeshSmoothingModifier::Crease_Enhancing_Diffusion(FSMesh* pnew,vector<int
 					vR += (m_R[fa1->m_elem[0].eid] * temp)*area_triangle(r);
 				}	
 				vR = vR/weight;
-				ni.r = ni.r + vR;
+				rnew[i] = ni.r + vR;
 			}				
 		}
+
+		double dmax = updateNodePositions(pnew, rnew);
+		if ((tol > 0) && (dmax < tol)) break;
 	}//end of one iteration
 }
 
@@ -295,7 +362,7 @@ double frand(double dmin = 0.0, double dmax = 1.0)
 	return (dmin + f*(dmax - dmin));
 }
 
-void FEMeshSmoothingModifier::Add_Noise(FSMesh* pnew, vector<int> hashmap)
+void FEMeshSmoothingModifier::Add_Noise(FSMesh* pnew, const vector<int>& hashmap)
 {
 	for (int j = 0; j<m_iteration; j++)
 	{
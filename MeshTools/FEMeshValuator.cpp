@@ -32,6 +32,7 @@ SOFTWARE.*/
 #include <MeshLib/FENodeData.h>
 #include <MeshLib/FEElementData.h>
 #include <MeshLib/MeshTools.h>
+#include <math.h>
 
 //-----------------------------------------------------------------------------
 // constructor
@@ -100,6 +101,7 @@ void FEMeshValuator::Evaluate(int nfield)
 			{
 				int NN = m_mesh.Nodes();
 				vector<double> nodeData(NN, 0.0);
+#pragma omp parallel for schedule(dynamic, 256)
 				for (int i = 0; i < NN; ++i)
 				{
 					try {
@@ -130,6 +132,9 @@ void FEMeshValuator::Evaluate(int nfield)
 		}
 		else
 		{
+			// Each element only writes its own data, so we can evaluate them in parallel.
+			// The dynamic schedule balances the cost of mixed element types.
+#pragma omp parallel for schedule(dynamic, 1024)
 			for (int i = 0; i < NE; ++i)
 			{
 				FSElement& el = m_mesh.Element(i);
@@ -243,6 +248,90 @@ void FEMeshValuator::Evaluate(int nfield)
 	data.UpdateValueRange();
 }
 
+//-----------------------------------------------------------------------------
+// Calculate the value range, average, and histogram of the mesh data values of all
+// elements with a nonzero data tag. The number of bins follows Sturges' rule, but
+// is limited to maxBins. Both passes over the data run in parallel.
+FEMeshDataStats FEMeshValuator::GetDataStats(const Mesh_Data& data, int maxBins)
+{
+	FEMeshDataStats stats;
+	int NE = (int)data.m_data.size();
+
+	// first pass: range and average
+	double vmin = 1e99, vmax = -1e99, vsum = 0.0;
+	size_t count = 0;
+#pragma omp parallel
+	{
+		double tmin = 1e99, tmax = -1e99, tsum = 0.0;
+		size_t tcount = 0;
+#pragma omp for nowait
+		for (int i = 0; i < NE; ++i)
+		{
+			const Mesh_Data::DATA& di = data.m_data[i];
+			if (di.tag != 0)
+			{
+				for (int j = 0; j < di.nval; ++j)
+				{
+					double v = di.val[j];
+					if (v < tmin) tmin = v;
+					if (v > tmax) tmax = v;
+					tsum += v;
+				}
+				tcount += di.nval;
+			}
+		}
+
+#pragma omp critical
+		{
+			if (tmin < vmin) vmin = tmin;
+			if (tmax > vmax) vmax = tmax;
+			vsum += tsum;
+			count += tcount;
+		}
+	}
+
+	stats.count = count;
+	if (count == 0) return stats;
+	stats.vmin = vmin;
+	stats.vmax = vmax;
+	stats.vavg = vsum / (double)count;
+
+	// determine number of bins (Sturges' rule)
+	int M = (int)ceil(log2((double)count) + 1);
+	if (M > maxBins) M = maxBins;
+	if (M < 1) M = 1;
+
+	// second pass: histogram
+	if (fabs(vmax - vmin) < 1e-5) vmax++;
+	stats.bins.assign(M, 0.0);
+#pragma omp parallel
+	{
+		vector<double> bins(M, 0.0);
+#pragma omp for nowait
+		for (int i = 0; i < NE; ++i)
+		{
+			const Mesh_Data::DATA& di = data.m_data[i];
+			if (di.tag != 0)
+			{
+				for (int j = 0; j < di.nval; ++j)
+				{
+					int n = (int)(M * (di.val[j] - vmin) / (vmax - vmin));
+					if (n < 0) n = 0;
+					if (n >= M) n = M - 1;
+					bins[n] += 1;
+				}
+			}
+		}
+
+#pragma omp critical
+		{
+			for (int i = 0; i < M; ++i) stats.bins[i] += bins[i];
+		}
+	}
+
+	return stats;
+}
+
 //-----------------------------------------------------------------------------
 // Evaluate element data
 double FEMeshValuator::EvaluateElement(int n, int nfield, int* err)
@@ -28,6 +28,17 @@ SOFTWARE.*/
 #include <MeshLib/FEMesh.h>
 #include <MeshLib/FESurfaceMesh.h>
 
+//-----------------------------------------------------------------------------
+// statistics of the evaluated mesh data
+struct FEMeshDataStats
+{
+	double	vmin = 0.0;
+	double	vmax = 0.0;
+	double	vavg = 0.0;
+	size_t	count = 0;				// number of values
+	std::vector<double>	bins;		// histogram (number of values per bin)
+};
+
 class FEMeshValuator
 {
 public:
@@ -66,6 +77,9 @@ public:
 	// get the list of all datafield names
 	static std::vector< std::string > GetDataFieldNames();
 
+	// calculate range, average, and histogram of the tagged values of the mesh data
+	static FEMeshDataStats GetDataStats(const Mesh_Data& data, int maxBins);
+
 public:
 	void SetCurvatureLevels(int levels);
 	void SetCurvatureMaxIters(int maxIters);
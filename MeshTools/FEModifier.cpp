@@ -532,7 +532,7 @@ void FESetFiberOrientation::SetFiberVector(FSMesh *pm)
 	{
 		FSElement& el = pm->Element(i);
 		if (el.IsSelected() || (nsel==0))
-			el.m_fiber = r;
+			pm->SetElementFiber(i, r);
 	}
 }
 
@@ -554,7 +554,7 @@ void FESetFiberOrientation::SetFiberNodes(FSMesh *pm)
 			r2 = pm->Node(el.m_node[ node1 ]).r;
 			n = r2 - r1;
 			n.Normalize();
-			el.m_fiber = n;
+			pm->SetElementFiber(i, n);
 		}
 	}
 }
@@ -684,12 +684,13 @@ bool FESetAxesOrientation::SetAxesVectors(FSMesh *pm)
 		FSElement& el = pm->Element(i);
 		if (el.m_ntag == 1)
 		{
-			mat3d& m = el.m_Q;
+			mat3d m;
 			m.zero();
 			m[0][0] = a.x; m[0][1] = b.x; m[0][2] = c.x;
 			m[1][0] = a.y; m[1][1] = b.y; m[1][2] = c.y;
 			m[2][0] = a.z; m[2][1] = b.z; m[2][2] = c.z;
-			el.m_Qactive = true;
+			pm->SetElementMaterialAxes(i, m);
+			pm->SetElementMaterialAxesActive(i, true);
 		}
 	}
 
@@ -724,12 +725,13 @@ bool FESetAxesOrientation::SetAxesNodes(FSMesh *pm)
 			a.Normalize();
 			b.Normalize();
 			c.Normalize();
-			mat3d& m = el.m_Q;
+			mat3d m;
 			m.zero();
 			m[0][0] = a.x; m[0][1] = b.x; m[0][2] = c.x;
 			m[1][0] = a.y; m[1][1] = b.y; m[1][2] = c.y;
 			m[2][0] = a.z; m[2][1] = b.z; m[2][2] = c.z;
-			el.m_Qactive = true;
+			pm->SetElementMaterialAxes(i, m);
+			pm->SetElementMaterialAxesActive(i, true);
 		}
 	}
 
@@ -746,12 +748,13 @@ bool FESetAxesOrientation::SetAxesAngles(FSMesh *pm)
         FSElement& el = pm->Element(i);
         if (el.m_ntag == 1)
         {
-            mat3d& m = el.m_Q;
+            mat3d m;
             m.zero();
             m[0][0] = sin(phi)*cos(theta); m[0][1] = -sin(theta); m[0][2] = -cos(phi)*cos(theta);
             m[1][0] = sin(phi)*sin(theta); m[1][1] = cos(theta);  m[1][2] = -cos(phi)*sin(theta);
             m[2][0] = cos(phi);            m[2][1] = 0;           m[2][2] = sin(phi);
-            el.m_Qactive = true;
+            pm->SetElementMaterialAxes(i, m);
+            pm->SetElementMaterialAxesActive(i, true);
         }
     }
 
@@ -797,12 +800,13 @@ bool FESetAxesOrientation::SetAxesCylindrical(FSMesh* pm)
 			vec3d e2 = e3 ^ e1;
 
 			// setup rotation matrix
-			mat3d& Q = el.m_Q;
+			mat3d Q;
 			Q[0][0] = e1.x; Q[0][1] = e2.x; Q[0][2] = e3.x;
 			Q[1][0] = e1.y; Q[1][1] = e2.y; Q[1][2] = e3.y;
 			Q[2][0] = e1.z; Q[2][1] = e2.z; Q[2][2] = e3.z;
 
-			el.m_Qactive = true;
+			pm->SetElementMaterialAxes(i, Q);
+			pm->SetElementMaterialAxesActive(i, true);
 		}
 	}
 
@@ -816,7 +820,7 @@ bool FESetAxesOrientation::ClearAxes(FSMesh* pm)
 		FSElement& el = pm->Element(i);
 		if (el.m_ntag == 1)
 		{
-			el.m_Qactive = false;
+			pm->SetElementMaterialAxesActive(i, false);
 		}
 	}
 
@@ -857,9 +861,8 @@ bool FESetAxesOrientation::SetAxesCopy(FSMesh *pm)
 		c /= n;
 		n = q.Find(c);
 		
-		FSElement& els = m_pms->Element(n);
-		el.m_Q = els.m_Q;
-		el.m_Qactive = els.m_Qactive;
+		pm->SetElementMaterialAxes(i, m_pms->ElementMaterialAxes(n));
+		pm->SetElementMaterialAxesActive(i, m_pms->IsElementMaterialAxesActive(n));
 		
 		// if the element is a shell, we project the fiber on the shell
 		if (el.IsShell())
@@ -881,7 +884,7 @@ bool FESetAxesOrientation::SetAxesCopy(FSMesh *pm)
 			vec3d f = e1^e2;
 			f.Normalize();
 			
-			el.m_fiber -= f*(f*el.m_fiber);
+			pm->SetElementFiber(i, pm->ElementFiber(i) - f*(f*pm->ElementFiber(i)));
 		}
 	}
 */
@@ -1022,6 +1025,8 @@ FSMesh* FEQuad2Tri::Apply(FSMesh *pm)
 
 			e1 = e0;
 			e2 = e0;
+			pnew->CopyElementAttributes(NE1 - 2, *pm, i);
+			pnew->CopyElementAttributes(NE1 - 1, *pm, i);
 
 			e1.SetType(FE_TRI3);
 			e2.SetType(FE_TRI3);
@@ -1043,6 +1048,7 @@ FSMesh* FEQuad2Tri::Apply(FSMesh *pm)
 		{
 			FSElement& e1 = pnew->Element(NE1++);
 			e1 = e0;
+			pnew->CopyElementAttributes(NE1 - 1, *pm, i);
 		}
 	}
 
@@ -1757,6 +1763,7 @@ FSMesh* FEDetachElements::Apply(FSMesh* pm)
 		FSElement& si = pm->Element(i);
 		FSElement& di = newMesh->Element(i);
 		di = si;
+		newMesh->CopyElementAttributes(i, *pm, i);
 
 		if (si.IsSelected())
 		{
@@ -26,22 +26,16 @@ SOFTWARE.*/
 
 #pragma once
 #include <FSCore/math3d.h>
+#include "FSKDTree.h"
 #include <vector>
 
 //-----------------------------------------------------------------------------
-//! This class is a helper class to locate the neirest neighbour on a surface
+//! This class is a helper class to locate the neirest neighbour on a surface.
+//! The searches are done with a kd-tree. Once Init is called, the queries can 
+//! be called concurrently from multiple threads.
 
 class FSNNQuery  
 {
-public:
-	struct NODE
-	{
-		int		i;	// index of node
-		vec3d	r;	// position of node
-		double	d1;	// distance to pivot 1
-		double	d2;	// distance to pivot 2
-	};
-
 public:
 	FSNNQuery(std::vector<vec3d>* ps = 0);
 	virtual ~FSNNQuery();
@@ -52,18 +46,19 @@ public:
 	//! attach to a surface
 	void Attach(std::vector<vec3d>* ps) { m_ps = ps; }
 
-	//! find the neirest neighbour of r
-	int Find(vec3d x);	
+	//! find the neirest neighbour of x
+	int Find(const vec3d& x) const;
 
-protected:
-	int FindRadius(double r);
+	//! find the neirest neighbours of all the points in x
+	void Find(const std::vector<vec3d>& x, std::vector<int>& items) const;
 
-protected:
-	std::vector<vec3d>*	m_ps;	//!< the node array to search
-	std::vector<NODE>	m_bk;	// BK tree
+	//! find the k neirest neighbours of x, sorted by distance
+	void FindNearest(const vec3d& x, int k, std::vector<int>& items) const;
 
-	vec3d	m_q1;	// pivot 1
-	vec3d	m_q2;	// pivot 2
+	//! find all points within a distance R of x
+	void FindRadius(const vec3d& x, double R, std::vector<int>& items) const;
 
-	int		m_imin;	// last found index
+protected:
+	std::vector<vec3d>*	m_ps;	//!< the node array to search
+	FSKDTree			m_tree;	//!< search tree
 };
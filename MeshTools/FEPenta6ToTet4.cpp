@@ -221,6 +221,7 @@ FSMesh* FEPenta6ToTet4::Apply(FSMesh* pm)
             assert(tag[i] == -1);
             FSElement& eld = mesh->Element(ec++);
             eld = els;
+            mesh->CopyElementAttributes(ec - 1, *pm, i);
         }
         else
         {
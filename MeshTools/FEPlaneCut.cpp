@@ -239,6 +239,7 @@ FSMesh* FEPlaneCut::Apply(FSMesh* pm)
 			if (lj[0]==-1) break;
 			FSElement& ed = pnew->Element(ne++);
 			ed = es;
+			pnew->CopyElementAttributes(ne - 1, *pm, i);
 			ed.m_node[0] = n[lj[0]]; assert(ed.m_node[0] != -1);
 			ed.m_node[1] = n[lj[1]]; assert(ed.m_node[1] != -1);
 			ed.m_node[2] = n[lj[2]]; assert(ed.m_node[2] != -1);
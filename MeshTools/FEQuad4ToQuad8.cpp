@@ -194,6 +194,7 @@ FSMesh* FEQuad4ToQuad8::Apply(FSMesh* pm)
         FSElement& e0 = pm->Element(i);
         FSElement& e1 = pnew->Element(i);
         e1 = e0;
+        pnew->CopyElementAttributes(i, *pm, i);
         
         e1.m_gid = e0.m_gid;
         
@@ -547,6 +548,7 @@ FSMesh* FEQuad8ToQuad4::Apply(FSMesh* pm)
         FSElement& e0 = pm->Element(i);
         FSElement& e1 = pnew->Element(i);
         e1 = e0;
+        pnew->CopyElementAttributes(i, *pm, i);
         
         e1.m_gid = e0.m_gid;
         
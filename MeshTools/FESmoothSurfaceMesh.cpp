@@ -28,6 +28,7 @@ SOFTWARE.*/
 #include "FESmoothSurfaceMesh.h"
 #include <MeshLib/FEMesh.h>
 #include <MeshLib/FENodeNodeList.h>
+#include <MeshLib/FENodeFaceList.h>
 #include <MeshLib/FESurfaceMesh.h>
 #include <MeshLib/MeshTools.h>
 
@@ -37,6 +38,7 @@ FESmoothSurfaceMesh::FESmoothSurfaceMesh() : FESurfaceModifier("Smooth")
 	AddDoubleParam(0.0, "lambda");
 	AddBoolParam(false, "preserve shape");
 	AddBoolParam(false, "preserve edges");
+	AddDoubleParam(0.0, "tolerance");
 }
 
 FSSurfaceMesh* FESmoothSurfaceMesh::Apply(FSSurfaceMesh* pm)
@@ -57,10 +59,16 @@ void FESmoothSurfaceMesh::ShapeSmoothMesh(FSSurfaceMesh& mesh, const FSSurfaceMe
 {
 	int niter = GetIntValue(0);
 	double w = GetFloatValue(1);
+	double tol = GetFloatValue(4);
 	int N = mesh.Nodes();
 
 	std::vector<int> faceIDs(N, -1);
 
+	// The new positions are gathered per node from the node's faces, so that
+	// the nodes can be processed in parallel.
+	FSNodeFaceList NFL;
+	NFL.Build(&mesh);
+
 	// smooth node positions
 	for (int n = 0; n<niter; ++n)
 	{
@@ -151,26 +159,23 @@ void FESmoothSurfaceMesh::ShapeSmoothMesh(FSSurfaceMesh& mesh, const FSSurfaceMe
 		}
 
 		// process face nodes
-		for (int i = 0; i<mesh.Faces(); ++i)
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i<N; ++i)
 		{
-			FSFace& face = mesh.Face(i);
-			int nf = face.Nodes();
-			for (int j = 0; j<nf; ++j)
+			if (tag[i].first != -1)
 			{
-				vec3d& rj = mesh.Node(face.n[j]).r;
-				for (int k = 0; k<nf; ++k)
+				int nval = NFL.Valence(i);
+				for (int k = 0; k<nval; ++k)
 				{
-					int nk = face.n[k];
-					if (tag[nk].first != -1)
-					{
-						newPos[nk] += rj;
-						tag[nk].first++;
-
-						tag[nk].second = face.m_gid;
-					}
+					const FSFace& face = mesh.Face(NFL.FaceIndex(i, k));
+					int nf = face.Nodes();
+					for (int j = 0; j<nf; ++j) newPos[i] += mesh.Node(face.n[j]).r;
+					tag[i].first += nf;
+					tag[i].second = face.m_gid;
 				}
 			}
 		}
+#pragma omp parallel for schedule(dynamic, 256)
 		for (int i = 0; i<N; ++i)
 		{
 			if (tag[i].first > 0)
@@ -195,14 +200,30 @@ void FESmoothSurfaceMesh::ShapeSmoothMesh(FSSurfaceMesh& mesh, const FSSurfaceMe
 		}
 
 		// assign new node positions
-		for (int i = 0; i<N; ++i)
+		double dmax = 0.0;
+#pragma omp parallel
 		{
-			FSNode& ni = mesh.Node(i);
-			if (tag[i].first == -1)
+			double tmax = 0.0;
+#pragma omp for schedule(static) nowait
+			for (int i = 0; i<N; ++i)
 			{
-				vec3d& vi = newPos[i];
-				ni.r = ni.r*w + vi*(1.0 - w);
+				FSNode& ni = mesh.Node(i);
+				if (tag[i].first == -1)
+				{
+					vec3d& vi = newPos[i];
+					vec3d r = ni.r*w + vi*(1.0 - w);
+					double d = (r - ni.r).SqrLength();
+					if (d > tmax) tmax = d;
+					ni.r = r;
+				}
+			}
+#pragma omp critical
+			{
+				if (tmax > dmax) dmax = tmax;
 			}
 		}
+
+		// stop when the nodes no longer move
+		if ((tol > 0) && (sqrt(dmax) < tol)) break;
 	}
 }
@@ -373,7 +373,7 @@ FSMesh* FEQuadSplitModifier::Apply(FSMesh* pm)
 		FSElement& en = pnew->Element(ne);
 		FSElement& eo = pm->Element(i);
 		if (eo.m_ntag < 0) { 
-			en = eo; ne++; }
+			en = eo; pnew->CopyElementAttributes(ne, *pm, i); ne++; }
 	}
 
 	// split the elements
@@ -80,6 +80,7 @@ FSMesh* FETet15ToTet4::Apply(FSMesh* pm)
 		FSElement& e0 = pm->Element(i);
 		FSElement& e1 = pnew->Element(i);
 		e1 = e0;
+		pnew->CopyElementAttributes(i, *pm, i);
 
 		e1.m_gid = e0.m_gid;
 
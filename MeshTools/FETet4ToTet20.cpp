@@ -115,6 +115,7 @@ FSMesh* FETet4ToTet20::Apply(FSMesh* pm)
 		FSElement& e0 = pm->Element(i);
 		FSElement& e1 = pnew->Element(i);
 		e1 = e0;
+		pnew->CopyElementAttributes(i, *pm, i);
 
 		e1.SetType(FE_TET20);
 		e1.m_gid = e0.m_gid;
@@ -83,6 +83,7 @@ FSMesh* FETet4ToTet5::Apply(FSMesh* pm)
 		FSElement& e0 = pm->Element(i);
 		FSElement& e1 = pnew->Element(i);
 		e1 = e0;
+		pnew->CopyElementAttributes(i, *pm, i);
 
 		e1.m_gid = e0.m_gid;
 
@@ -164,6 +165,7 @@ FSMesh* FETet5ToTet4::Apply(FSMesh* pm)
 		FSElement& e0 = pm->Element(i);
 		FSElement& e1 = pnew->Element(i);
 		e1 = e0;
+		pnew->CopyElementAttributes(i, *pm, i);
 
 		e1.m_gid = e0.m_gid;
 
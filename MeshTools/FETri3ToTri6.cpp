@@ -195,6 +195,7 @@ FSMesh* FETri3ToTri6::Apply(FSMesh* pm)
         FSElement& e0 = pm->Element(i);
         FSElement& e1 = pnew->Element(i);
         e1 = e0;
+        pnew->CopyElementAttributes(i, *pm, i);
         
         e1.m_gid = e0.m_gid;
         
@@ -541,6 +542,7 @@ FSMesh* FETri6ToTri3::Apply(FSMesh* pm)
         FSElement& e0 = pm->Element(i);
         FSElement& e1 = pnew->Element(i);
         e1 = e0;
+        pnew->CopyElementAttributes(i, *pm, i);
         
         e1.m_gid = e0.m_gid;
         
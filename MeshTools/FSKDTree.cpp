@@ -0,0 +1,296 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#include "stdafx.h"
+#include "FSKDTree.h"
+#include <algorithm>
+#include <assert.h>
+
+// size of the traversal stacks. Since the tree is balanced, this is plenty.
+const int MAX_STACK = 128;
+
+static inline double coord(const vec3d& r, int axis)
+{
+	return (axis == 0 ? r.x : (axis == 1 ? r.y : r.z));
+}
+
+// Item of the traversal stacks. The offsets are the distances from the query point to
+// the node's cell along each axis, and the bound (the sum of their squares) is a lower 
+// bound of the squared distance to the node's points.
+struct STACK_ITEM
+{
+	int		node;
+	double	off[3];
+	double	bound;
+};
+
+// push the far child of an interior node. w is the distance of the query point to 
+// the split plane.
+static inline void pushFar(STACK_ITEM* stack, int& ns, const STACK_ITEM& s, int nfar, int axis, double w)
+{
+	assert(ns + 1 <= MAX_STACK);
+	STACK_ITEM& f = stack[ns++];
+	f = s;
+	f.node = nfar;
+	f.bound = s.bound - s.off[axis]*s.off[axis] + w*w;
+	f.off[axis] = w;
+}
+
+FSKDTree::FSKDTree()
+{
+}
+
+//-----------------------------------------------------------------------------
+void FSKDTree::Clear()
+{
+	m_node.clear();
+	m_pt.clear();
+	m_idx.clear();
+}
+
+//-----------------------------------------------------------------------------
+void FSKDTree::Build(const std::vector<vec3d>& points)
+{
+	Clear();
+
+	int N = (int) points.size();
+	if (N == 0) return;
+
+	// the tree is built by reordering the point indices
+	m_idx.resize(N);
+	for (int i = 0; i < N; ++i) m_idx[i] = i;
+
+	m_node.reserve(4 * (N / MAX_LEAF_SIZE) + 1);
+	BuildNode(points, 0, N);
+
+	// store the points in tree order, so that leaves are contiguous in memory
+	m_pt.resize(N);
+	for (int i = 0; i < N; ++i) m_pt[i] = points[m_idx[i]];
+}
+
+//-----------------------------------------------------------------------------
+void FSKDTree::BuildNode(const std::vector<vec3d>& points, int first, int count)
+{
+	int n = (int) m_node.size();
+	NODE node;
+	node.split = 0.0;
+	node.axis = -1;
+	node.right = -1;
+	node.first = first;
+	node.count = count;
+	m_node.push_back(node);
+
+	if (count <= MAX_LEAF_SIZE) return;
+
+	// find the largest dimension of the bounding box
+	vec3d r0 = points[m_idx[first]], r1 = r0;
+	for (int i = first + 1; i < first + count; ++i)
+	{
+		const vec3d& r = points[m_idx[i]];
+		if (r.x < r0.x) r0.x = r.x;
+		if (r.x > r1.x) r1.x = r.x;
+		if (r.y < r0.y) r0.y = r.y;
+		if (r.y > r1.y) r1.y = r.y;
+		if (r.z < r0.z) r0.z = r.z;
+		if (r.z > r1.z) r1.z = r.z;
+	}
+	vec3d d = r1 - r0;
+	int axis = 0;
+	if (d.y > coord(d, axis)) axis = 1;
+	if (d.z > coord(d, axis)) axis = 2;
+
+	// if all points coincide, they all stay in this leaf
+	if (coord(d, axis) == 0.0) return;
+
+	// split at the median
+	int mid = count / 2;
+	std::vector<int>::iterator it = m_idx.begin() + first;
+	std::nth_element(it, it + mid, it + count, [&](int a, int b) {
+		return (coord(points[a], axis) < coord(points[b], axis));
+	});
+
+	m_node[n].split = coord(points[m_idx[first + mid]], axis);
+	m_node[n].axis = axis;
+	m_node[n].count = 0;
+
+	BuildNode(points, first, mid);
+	m_node[n].right = (int) m_node.size();
+	BuildNode(points, first + mid, count - mid);
+}
+
+//-----------------------------------------------------------------------------
+int FSKDTree::FindNearest(const vec3d& x, double* d2) const
+{
+	if (m_node.empty()) return -1;
+
+	int imin = -1;
+	double dmin = 0.0;
+
+	STACK_ITEM stack[MAX_STACK];
+	int ns = 0;
+	stack[ns++] = { 0, { 0.0, 0.0, 0.0 }, 0.0 };
+	while (ns > 0)
+	{
+		STACK_ITEM s = stack[--ns];
+		double b = s.bound;
+
+		// points at the same distance are still visited, since they may have a lower index
+		if ((imin >= 0) && (b > dmin)) continue;
+
+		// walk down to a leaf, the far sides are visited later
+		while (m_node[s.node].axis != -1)
+		{
+			const NODE& node = m_node[s.node];
+			double w = coord(x, node.axis) - node.split;
+			int nnear = (w < 0 ? s.node + 1 : node.right);
+			int nfar  = (w < 0 ? node.right : s.node + 1);
+			pushFar(stack, ns, s, nfar, node.axis, w);
+			s.node = nnear;
+		}
+
+		const NODE& node = m_node[s.node];
+		for (int i = node.first; i < node.first + node.count; ++i)
+		{
+			vec3d dr = m_pt[i] - x;
+			double d = dr*dr;
+			if ((imin == -1) || (d < dmin) || ((d == dmin) && (m_idx[i] < imin)))
+			{
+				dmin = d;
+				imin = m_idx[i];
+			}
+		}
+	}
+
+	if (d2) *d2 = dmin;
+	return imin;
+}
+
+//-----------------------------------------------------------------------------
+void FSKDTree::FindNearest(const vec3d& x, int k, std::vector<int>& items) const
+{
+	items.clear();
+	if (m_node.empty() || (k <= 0)) return;
+
+	// max-heap of the k nearest points found so far, ordered by distance and index
+	typedef std::pair<double, int> ITEM;
+	std::vector<ITEM> heap;
+	heap.reserve(k + 1);
+
+	STACK_ITEM stack[MAX_STACK];
+	int ns = 0;
+	stack[ns++] = { 0, { 0.0, 0.0, 0.0 }, 0.0 };
+	while (ns > 0)
+	{
+		STACK_ITEM s = stack[--ns];
+		double b = s.bound;
+		if (((int)heap.size() == k) && (b > heap.front().first)) continue;
+
+		// walk down to a leaf, the far sides are visited later
+		while (m_node[s.node].axis != -1)
+		{
+			const NODE& node = m_node[s.node];
+			double w = coord(x, node.axis) - node.split;
+			int nnear = (w < 0 ? s.node + 1 : node.right);
+			int nfar  = (w < 0 ? node.right : s.node + 1);
+			pushFar(stack, ns, s, nfar, node.axis, w);
+			s.node = nnear;
+		}
+
+		const NODE& node = m_node[s.node];
+		for (int i = node.first; i < node.first + node.count; ++i)
+		{
+			vec3d dr = m_pt[i] - x;
+			ITEM item(dr*dr, m_idx[i]);
+			if ((int)heap.size() < k)
+			{
+				heap.push_back(item);
+				std::push_heap(heap.begin(), heap.end());
+			}
+			else if (item < heap.front())
+			{
+				std::pop_heap(heap.begin(), heap.end());
+				heap.back() = item;
+				std::push_heap(heap.begin(), heap.end());
+			}
+		}
+	}
+
+	std::sort_heap(heap.begin(), heap.end());
+	items.resize(heap.size());
+	for (size_t i = 0; i < heap.size(); ++i) items[i] = heap[i].second;
+}
+
+//-----------------------------------------------------------------------------
+void FSKDTree::FindRadius(const vec3d& x, double R, std::vector<int>& items) const
+{
+	items.clear();
+	if (m_node.empty() || (R < 0)) return;
+
+	double R2 = R*R;
+
+	STACK_ITEM stack[MAX_STACK];
+	int ns = 0;
+	stack[ns++] = { 0, { 0.0, 0.0, 0.0 }, 0.0 };
+	while (ns > 0)
+	{
+		STACK_ITEM s = stack[--ns];
+		double b = s.bound;
+		if (b > R2) continue;
+
+		// walk down to a leaf, the far sides are visited later
+		while (m_node[s.node].axis != -1)
+		{
+			const NODE& node = m_node[s.node];
+			double w = coord(x, node.axis) - node.split;
+			int nnear = (w < 0 ? s.node + 1 : node.right);
+			int nfar  = (w < 0 ? node.right : s.node + 1);
+			pushFar(stack, ns, s, nfar, node.axis, w);
+			s.node = nnear;
+		}
+
+		const NODE& node = m_node[s.node];
+		for (int i = node.first; i < node.first + node.count; ++i)
+		{
+			vec3d dr = m_pt[i] - x;
+			if (dr*dr <= R2) items.push_back(m_idx[i]);
+		}
+	}
+
+	std::sort(items.begin(), items.end());
+}
+
+//-----------------------------------------------------------------------------
+void FSKDTree::FindNearest(const std::vector<vec3d>& x, std::vector<int>& items) const
+{
+	int N = (int) x.size();
+	items.resize(N);
+
+	#pragma omp parallel for schedule(dynamic, 1024)
+	for (int i = 0; i < N; ++i)
+	{
+		items[i] = FindNearest(x[i]);
+	}
+}
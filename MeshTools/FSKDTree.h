@@ -0,0 +1,83 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+#pragma once
+#include <FSCore/math3d.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// A kd-tree for nearest neighbour searches in a point cloud. The tree is built
+// by splitting the points at the median of the largest dimension, so it stays
+// balanced for clustered point sets. All queries are const and can be called 
+// concurrently from multiple threads once the tree is built.
+// When several points are at the same distance, the point with the lowest index
+// is returned, so that results do not depend on the tree layout.
+class FSKDTree
+{
+	enum { MAX_LEAF_SIZE = 8 };
+
+	struct NODE
+	{
+		double	split;	// split position (interior nodes)
+		int		axis;	// split axis (0,1,2), or -1 for leaves
+		int		right;	// index of right child (the left child follows its parent)
+		int		first;	// first point of leaf
+		int		count;	// number of points in leaf
+	};
+
+public:
+	FSKDTree();
+
+	// build the tree for the points
+	void Build(const std::vector<vec3d>& points);
+
+	// clear the tree
+	void Clear();
+
+	// number of points in tree
+	int Points() const { return (int) m_pt.size(); }
+
+	// find the nearest point to x. Returns -1 if the tree is empty.
+	// If d2 is not null, it returns the squared distance to the point.
+	int FindNearest(const vec3d& x, double* d2 = nullptr) const;
+
+	// find the k nearest points to x, sorted by distance
+	void FindNearest(const vec3d& x, int k, std::vector<int>& items) const;
+
+	// find all the points within a distance R of x, sorted by index
+	void FindRadius(const vec3d& x, double R, std::vector<int>& items) const;
+
+	// find the nearest point of each of the points in x (in parallel)
+	void FindNearest(const std::vector<vec3d>& x, std::vector<int>& items) const;
+
+private:
+	void BuildNode(const std::vector<vec3d>& points, int first, int count);
+
+private:
+	std::vector<NODE>	m_node;	// tree nodes (depth-first)
+	std::vector<vec3d>	m_pt;	// points, in tree order
+	std::vector<int>	m_idx;	// original index of points
+};
@@ -259,6 +259,7 @@ FSMesh* FEHex2Tet::Apply(FSMesh* pm)
 			assert(tag[i] == -1);
 			FSElement& eld = mesh->Element(ec++);
 			eld = els;
+			mesh->CopyElementAttributes(ec - 1, *pm, i);
 		}
 		else
 		{
@@ -29,6 +29,9 @@ SOFTWARE.*/
 #include "GLModel.h"
 #include "GLWLib/GLWidgetManager.h"
 #include "PostLib/constants.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 using namespace Post;
 
 //-----------------------------------------------------------------------------
@@ -56,6 +59,9 @@ CGLColorMap::CGLColorMap(CGLModel *po) : CGLDataMap(po)
 	m_range.mintype = m_range.maxtype = m_defaultRngType;
 	m_rmin = m_rmax = vec3d(0, 0, 0);
 
+	m_rangeField = -1;
+	m_rangeNodeVals = false;
+
 	m_nfield = 0;
 	m_breset = true;
 	m_bDispNodeVals = true;
@@ -183,9 +189,24 @@ void CGLColorMap::Update(int ntime, float dt, bool breset)
 	int n1 = (ntime + 1 >= N ? ntime : ntime + 1);
 	if (dt == 0.f) n1 = n0;
 
+	if ((int)m_stateRange.size() != N)
+	{
+		STATE_RANGE rng;
+		rng.bvalid = false;
+		m_stateRange.assign(N, rng);
+	}
+
 	UpdateState(n0, breset);
 	if (n0 != n1) UpdateState(n1, breset);
 
+	// the cached ranges are only valid for the current field
+	if ((m_rangeField != m_nfield) || (m_rangeNodeVals != m_bDispNodeVals))
+	{
+		for (STATE_RANGE& rng : m_stateRange) rng.bvalid = false;
+		m_rangeField = m_nfield;
+		m_rangeNodeVals = m_bDispNodeVals;
+	}
+
 	// get the state
 	FEState& s0 = *pfem->GetState(n0);
 	FEState& s1 = *pfem->GetState(n1);
@@ -195,80 +216,54 @@ void CGLColorMap::Update(int ntime, float dt, bool breset)
 
 	float w = dt / df;
 
+	// update the range
+	// Only the range of a single state is cached, since interpolated ranges depend on w. 
+	STATE_RANGE rng;
+	if (n0 == n1)
+	{
+		if (m_stateRange[n0].bvalid == false) EvalRange(pm, s0, s1, w, m_stateRange[n0]);
+		rng = m_stateRange[n0];
+	}
+	else EvalRange(pm, s0, s1, w, rng);
+
+	float fmin = rng.fmin, fmax = rng.fmax;
+
 	m_rmin = m_rmax = vec3d(0, 0, 0);
+	if (rng.belem)
+	{
+		if (rng.nmin >= 0) m_rmin = pm->ElementCenter(pm->ElementRef(rng.nmin));
+		if (rng.nmax >= 0) m_rmax = pm->ElementCenter(pm->ElementRef(rng.nmax));
+	}
+	else
+	{
+		if (rng.nmin >= 0) m_rmin = pm->Node(rng.nmin).r;
+		if (rng.nmax >= 0) m_rmax = pm->Node(rng.nmax).r;
+	}
 
-	// update the range
-	float fmin = 1e29f, fmax = -1e29f;
 	ValArray& faceData0 = s0.m_FaceData;
 	ValArray& faceData1 = s1.m_FaceData;
 	if (IS_ELEM_FIELD(m_nfield) && (m_bDispNodeVals == false))
 	{
-		int ndata = FIELD_CODE(m_nfield);
-		if (s0.m_Data[ndata].GetFormat() == DATA_ITEM)
-		{
-			int NE = pm->Elements();
-			for (int i = 0; i < NE; ++i)
-			{
-				FEElement_& el = pm->ElementRef(i);
-				ELEMDATA& d0 = s0.m_ELEM[i];
-				ELEMDATA& d1 = s1.m_ELEM[i];
-				if ((d0.m_state & StatusFlags::ACTIVE) && (d1.m_state & StatusFlags::ACTIVE))
-				{
-					vec3d r = pm->ElementCenter(el);
-					float f0 = d0.m_val;
-					float f1 = d1.m_val;
-					float f = f0 + (f1 - f0)*w;
-					if (f > fmax) { fmax = f; m_rmax = r; }
-					if (f < fmin) { fmin = f; m_rmin = r; }
-				}
-			}
-		}
-		else
-		{
-			ValArray& elemData0 = s0.m_ElemData;
-			ValArray& elemData1 = s1.m_ElemData;
-			int NE = pm->Elements();
-			for (int i = 0; i < NE; ++i)
-			{
-				FEElement_& el = pm->ElementRef(i);
-				ELEMDATA& d0 = s0.m_ELEM[i];
-				ELEMDATA& d1 = s1.m_ELEM[i];
-				if ((d0.m_state & StatusFlags::ACTIVE) && (d1.m_state & StatusFlags::ACTIVE))
-				{
-					for (int j = 0; j < el.Nodes(); ++j)
-					{
-						float f0 = elemData0.value(i, j);
-						float f1 = elemData1.value(i, j);
-						float f = f0 + (f1 - f0)*w;
-						if (f > fmax) { fmax = f; m_rmax = pm->Node(el.m_node[j]).r; }
-						if (f < fmin) { fmin = f; m_rmin = pm->Node(el.m_node[j]).r; }
-					}
-				}
-			}
-		}
+		// nothing to do here, the element textures are updated below
 	}
 	else
 	{
-		// evaluate all nodes to find range
-		for (int i = 0; i<pm->Nodes(); ++i)
+		// tag the nodes that have a value
+		int NN = pm->Nodes();
+		#pragma omp parallel for schedule(static)
+		for (int i = 0; i<NN; ++i)
 		{
 			FSNode& node = pm->Node(i);
 			NODEDATA& d0 = s0.m_NODE[i];
 			NODEDATA& d1 = s1.m_NODE[i];
-			if ((node.IsEnabled()) && (d0.m_ntag > 0) && (d1.m_ntag > 0))
-			{
-				float f0 = d0.m_val;
-				float f1 = d1.m_val;
-				float f = f0 + (f1 - f0)*w;
-				node.m_ntag = 1;
-				if (f > fmax) { fmax = f; m_rmax = pm->Node(i).r; }
-				if (f < fmin) { fmin = f; m_rmin = pm->Node(i).r; }
-			}
+			if ((node.IsEnabled()) && (d0.m_ntag > 0) && (d1.m_ntag > 0)) node.m_ntag = 1;
 			else node.m_ntag = 0;
 		}
 
 		// evaluate face values for texture generation
-		for (int i = 0; i < pm->Faces(); ++i)
+		int NF = pm->Faces();
+		#pragma omp parallel for schedule(static)
+		for (int i = 0; i < NF; ++i)
 		{
 			FSFace& face = pm->Face(i);
 			if (face.IsEnabled())
@@ -314,11 +309,11 @@ void CGLColorMap::Update(int ntime, float dt, bool breset)
 	if (m_bDispNodeVals == false)
 	{
 		int NF = pm->Faces();
+		#pragma omp parallel for schedule(static)
 		for (int i = 0; i<NF; ++i)
 		{
 			FSFace& face = pm->Face(i);
 			FACEDATA& fd0 = s0.m_FACE[i];
-			FACEDATA& fd1 = s1.m_FACE[i];
 			if (face.IsEnabled() && (fd0.m_ntag > 0))
 			{
 				face.m_ntag = 1;
@@ -329,12 +324,6 @@ void CGLColorMap::Update(int ntime, float dt, bool breset)
 					float f1 = (n0 == n1 ? f0 : faceData1.value(i, j));
 					float f = f0 + (f1 - f0)*w;
 					face.m_tex[j] = f;
-
-					if (IS_ELEM_FIELD(m_nfield) == false)
-					{
-						if (f > fmax) fmax = f;
-						if (f < fmin) fmin = f;
-					}
 				}
 			}
 		}
@@ -422,7 +411,9 @@ void CGLColorMap::Update(int ntime, float dt, bool breset)
 	if (min == max) max++;
 
 	float dti = 1.f / (max - min);
-	for (int i = 0; i<pm->Faces(); ++i)
+	int NF = pm->Faces();
+	#pragma omp parallel for schedule(static)
+	for (int i = 0; i<NF; ++i)
 	{
 		FSFace& face = pm->Face(i);
 		FACEDATA& fd = s0.m_FACE[i];
@@ -440,7 +431,9 @@ void CGLColorMap::Update(int ntime, float dt, bool breset)
 	}
 
 	// update element textures
-	for (int i = 0; i<pm->Elements(); ++i)
+	int NE = pm->Elements();
+	#pragma omp parallel for schedule(static)
+	for (int i = 0; i<NE; ++i)
 	{
 		FEElement_& el = pm->ElementRef(i);
 		ELEMDATA& d0 = s0.m_ELEM[i];
@@ -475,6 +468,7 @@ void CGLColorMap::Update(int ntime, float dt, bool breset)
 	{
 		GLSurface& surf = po->InteralSurface(i);
 		int NF = surf.Faces();
+		#pragma omp parallel for schedule(static)
 		for (int j=0; j<NF; ++j)
 		{
 			FSFace& face = surf.Face(j);
@@ -522,6 +516,149 @@ void CGLColorMap::Update(int ntime, float dt, bool breset)
 	}
 }
 
+//-----------------------------------------------------------------------------
+// running min/max of values and the items where they are found
+struct MinMax
+{
+	float	fmin, fmax;
+	int		nmin, nmax;
+
+	MinMax() : fmin(1e29f), fmax(-1e29f), nmin(-1), nmax(-1) {}
+
+	void Add(float f, int n)
+	{
+		if (f > fmax) { fmax = f; nmax = n; }
+		if (f < fmin) { fmin = f; nmin = n; }
+	}
+
+	void Add(const MinMax& m)
+	{
+		if (m.fmax > fmax) { fmax = m.fmax; nmax = m.nmax; }
+		if (m.fmin < fmin) { fmin = m.fmin; nmin = m.nmin; }
+	}
+};
+
+//-----------------------------------------------------------------------------
+// Find the min/max over N items in parallel. The function f(i, m) adds the value(s) 
+// of item i to m. With a static schedule each thread processes a contiguous block of 
+// items, and merging the partial results in thread order gives the same min/max items
+// as a serial loop would.
+template <class F> static MinMax ParallelMinMax(int N, F f)
+{
+	int nthreads = 1;
+#ifdef _OPENMP
+	nthreads = omp_get_max_threads();
+#endif
+	std::vector<MinMax> part(nthreads);
+
+	#pragma omp parallel for schedule(static)
+	for (int i = 0; i < N; ++i)
+	{
+#ifdef _OPENMP
+		f(i, part[omp_get_thread_num()]);
+#else
+		f(i, part[0]);
+#endif
+	}
+
+	MinMax m;
+	for (int i = 0; i < nthreads; ++i) m.Add(part[i]);
+	return m;
+}
+
+//-----------------------------------------------------------------------------
+// Evaluate the range of the data. Only the index of the min/max item is stored,
+// so that the (more expensive) position is only evaluated for these two items.
+void CGLColorMap::EvalRange(FEPostMesh* pm, FEState& s0, FEState& s1, float w, STATE_RANGE& rng)
+{
+	MinMax m;
+	rng.belem = false;
+	if (IS_ELEM_FIELD(m_nfield) && (m_bDispNodeVals == false))
+	{
+		int ndata = FIELD_CODE(m_nfield);
+		int NE = pm->Elements();
+		if (s0.m_Data[ndata].GetFormat() == DATA_ITEM)
+		{
+			rng.belem = true;
+			m = ParallelMinMax(NE, [&](int i, MinMax& r) {
+				ELEMDATA& d0 = s0.m_ELEM[i];
+				ELEMDATA& d1 = s1.m_ELEM[i];
+				if ((d0.m_state & StatusFlags::ACTIVE) && (d1.m_state & StatusFlags::ACTIVE))
+				{
+					float f0 = d0.m_val;
+					float f1 = d1.m_val;
+					r.Add(f0 + (f1 - f0)*w, i);
+				}
+			});
+		}
+		else
+		{
+			ValArray& elemData0 = s0.m_ElemData;
+			ValArray& elemData1 = s1.m_ElemData;
+			m = ParallelMinMax(NE, [&](int i, MinMax& r) {
+				FEElement_& el = pm->ElementRef(i);
+				ELEMDATA& d0 = s0.m_ELEM[i];
+				ELEMDATA& d1 = s1.m_ELEM[i];
+				if ((d0.m_state & StatusFlags::ACTIVE) && (d1.m_state & StatusFlags::ACTIVE))
+				{
+					for (int j = 0; j < el.Nodes(); ++j)
+					{
+						float f0 = elemData0.value(i, j);
+						float f1 = elemData1.value(i, j);
+						r.Add(f0 + (f1 - f0)*w, el.m_node[j]);
+					}
+				}
+			});
+		}
+	}
+	else
+	{
+		// evaluate all nodes to find range
+		m = ParallelMinMax(pm->Nodes(), [&](int i, MinMax& r) {
+			FSNode& node = pm->Node(i);
+			NODEDATA& d0 = s0.m_NODE[i];
+			NODEDATA& d1 = s1.m_NODE[i];
+			if ((node.IsEnabled()) && (d0.m_ntag > 0) && (d1.m_ntag > 0))
+			{
+				float f0 = d0.m_val;
+				float f1 = d1.m_val;
+				r.Add(f0 + (f1 - f0)*w, i);
+			}
+		});
+
+		// the face values also contribute to the range (but not to the min/max location)
+		if (m_bDispNodeVals == false)
+		{
+			bool bsame = (&s0 == &s1);
+			ValArray& faceData0 = s0.m_FaceData;
+			ValArray& faceData1 = s1.m_FaceData;
+			MinMax mf = ParallelMinMax(pm->Faces(), [&](int i, MinMax& r) {
+				FSFace& face = pm->Face(i);
+				FACEDATA& fd0 = s0.m_FACE[i];
+				if (face.IsEnabled() && (fd0.m_ntag > 0))
+				{
+					int nf = face.Nodes();
+					for (int j = 0; j < nf; ++j)
+					{
+						float f0 = faceData0.value(i, j);
+						float f1 = (bsame ? f0 : faceData1.value(i, j));
+						r.Add(f0 + (f1 - f0)*w, -1);
+					}
+				}
+			});
+			if (mf.fmax > m.fmax) m.fmax = mf.fmax;
+			if (mf.fmin < m.fmin) m.fmin = mf.fmin;
+		}
+	}
+
+	rng.fmin = m.fmin;
+	rng.fmax = m.fmax;
+	rng.nmin = m.nmin;
+	rng.nmax = m.nmax;
+	rng.bvalid = true;
+}
+
+//-----------------------------------------------------------------------------
 void CGLColorMap::UpdateState(int ntime, bool breset)
 {
 	// get the model
@@ -537,6 +674,13 @@ void CGLColorMap::UpdateState(int ntime, bool breset)
 		breset = true;
 	}
 
+	// if the state's data will be re-evaluated, its cached range is no longer valid
+	FEState& state = *pfem->GetState(ntime);
+	if (breset || (state.m_nField != m_nfield))
+	{
+		if (ntime < (int)m_stateRange.size()) m_stateRange[ntime].bvalid = false;
+	}
+
 	// evaluate the mesh
 	pfem->Evaluate(m_nfield, ntime, breset);
 }
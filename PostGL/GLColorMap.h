@@ -29,10 +29,13 @@ SOFTWARE.*/
 #include <GLWLib/GLWidget.h>
 #include <GLLib/GLTexture1D.h>
 #include <PostLib/ColorMap.h>
+#include <vector>
 
 namespace Post {
 
 class CGLModel;
+class FEState;
+class FEPostMesh;
 
 //-----------------------------------------------------------------------------
 
@@ -79,8 +82,19 @@ public:
 	void Activate(bool b) override { CGLObject::Activate(b); ShowLegend(b); }
 
 private:
+	// data range of a state, or of two states that are interpolated
+	struct STATE_RANGE
+	{
+		bool	bvalid;		// range was evaluated
+		float	fmin, fmax;	// min, max values
+		int		nmin, nmax;	// index of item where min, max is found (or -1)
+		bool	belem;		// items are elements (true) or nodes (false)
+	};
+
 	void UpdateState(int ntime, bool breset);
 
+	void EvalRange(FEPostMesh* pm, FEState& s0, FEState& s1, float w, STATE_RANGE& rng);
+
 	bool UpdateData(bool bsave = true) override;
 
 	void Update() override;
@@ -91,6 +105,11 @@ protected:
 	DATA_RANGE	m_range;	// range for legend
 	vec3d	m_rmin, m_rmax;	// global indicators of min, max
 
+	// cached ranges of each state for the current field
+	std::vector<STATE_RANGE>	m_stateRange;
+	int		m_rangeField;		// field of the cached ranges
+	bool	m_rangeNodeVals;	// value of m_bDispNodeVals for the cached ranges
+
 public:
 	bool	m_bDispNodeVals;	// render nodal values
 
@@ -59,6 +59,7 @@ CGLModel::CGLModel(FEPostModel* ps)
 	SetName("Model");
 
 	m_lastMesh = nullptr;
+	m_meshRev = 0;
 
 	m_stol = 60.0;
 
@@ -213,6 +214,8 @@ void CGLModel::SetTimeValue(float ftime)
 // Update the model data
 bool CGLModel::Update(bool breset)
 {
+	MeshChanged();
+
 	if (m_ps == nullptr) return true;
 
 	FEPostModel& fem = *m_ps;
@@ -257,6 +260,8 @@ bool CGLModel::Update(bool breset)
 //-----------------------------------------------------------------------------
 void CGLModel::UpdateDisplacements(int nstate, bool breset)
 {
+	MeshChanged();
+
 	if (m_pdis && m_pdis->IsActive()) m_pdis->Update(nstate, 0.f, breset);
 }
 
@@ -1094,32 +1099,11 @@ void CGLModel::RenderTransparentMaterial(CGLContext& rc, FEPostModel* ps, int m)
 
 	if (m_doZSorting)
 	{
-		int NF = dom.Faces();
-		std::map< double, int> zmap;
-		// first, build a list of faces
-		for (int i = 0; i < NF; ++i)
-		{
-			FSFace& face = dom.Face(i);
-			FEElement_& el = pm->ElementRef(face.m_elem[0].eid);
-
-			if (((mode != SELECT_FE_ELEMS) || !el.IsSelected()) && face.IsVisible())
-			{
-				// get the face center
-				vec3d r = pm->FaceCenter(face);
-
-				// convert to eye coordinates
-				vec3d q = rc.m_cam->WorldToCam(r);
-
-				// add it to the z-list
-				zmap[q.z] = i;
-			}
-		}
-
 		// build the sorted face list
-		const vector<int>& faceList = dom.FaceList();
-		vector<int> sortedFaceList(zmap.size());
-		auto it = zmap.begin();
-		for (size_t i = 0; i < zmap.size(); ++i, ++it) sortedFaceList[i] = faceList[it->second];
+		const vector<int>& sortedFaceList = ZSortDomainFaces(rc, dom, [&](const FSFace& face) {
+			const FEElement_& el = pm->ElementRef(face.m_elem[0].eid);
+			return (((mode != SELECT_FE_ELEMS) || !el.IsSelected()) && face.IsVisible());
+			});
 
 		// render the list
 		glDisable(GL_CULL_FACE);
@@ -1311,32 +1295,9 @@ void CGLModel::RenderSolidDomain(CGLContext& rc, MeshDomain& dom, bool btex, boo
 	// render active faces
 	if (zsort)
 	{
-		int NF = dom.Faces();
-		std::map< double, int> zmap;
-		for (int i = 0; i < NF; ++i)
-		{
-			FSFace& face = dom.Face(i);
-			if (face.m_ntag == 1)
-			{
-				// get the face center
-				vec3d r = pm->FaceCenter(face);
-
-				// convert to eye coordinates
-				vec3d q = rc.m_cam->WorldToCam(r);
-
-				// add it to the z-list
-				zmap[q.z] = i;
-			}
-		}
-
-		// build the sorted face list
-		const vector<int>& faceList = dom.FaceList();
-		vector<int> sortedFaceList(zmap.size());
-		auto it = zmap.begin();
-		for (size_t i = 0; i < zmap.size(); ++i, it++) sortedFaceList[i] = faceList[it->second];
-
-		// render the list
-		m_render.RenderFEFaces(pm, sortedFaceList);
+		m_render.RenderFEFaces(pm, ZSortDomainFaces(rc, dom, [](const FSFace& f) {
+			return (f.m_ntag == 1);
+			}));
 	}
 	else
 	{
@@ -1354,32 +1315,9 @@ void CGLModel::RenderSolidDomain(CGLContext& rc, MeshDomain& dom, bool btex, boo
 
 		if (zsort)
 		{
-			int NF = dom.Faces();
-			std::map< double, int> zmap;
-			for (int i = 0; i < NF; ++i)
-			{
-				FSFace& face = dom.Face(i);
-				if (face.m_ntag == 2)
-				{
-					// get the face center
-					vec3d r = pm->FaceCenter(face);
-
-					// convert to eye coordinates
-					vec3d q = rc.m_cam->WorldToCam(r);
-
-					// add it to the z-list
-					zmap[q.z] = i;
-				}
-			}
-
-			// build the sorted face list
-			const vector<int>& faceList = dom.FaceList();
-			vector<int> sortedFaceList(zmap.size());
-			auto it = zmap.begin();
-			for (size_t i = 0; i < zmap.size(); ++i, ++it) sortedFaceList[i] = faceList[it->second];
-
-			// render the list
-			m_render.RenderFEFaces(pm, sortedFaceList);
+			m_render.RenderFEFaces(pm, ZSortDomainFaces(rc, dom, [](const FSFace& f) {
+				return (f.m_ntag == 2);
+				}));
 		}
 		else
 		{
@@ -1391,6 +1329,42 @@ void CGLModel::RenderSolidDomain(CGLContext& rc, MeshDomain& dom, bool btex, boo
 	}
 }
 
+//-----------------------------------------------------------------------------
+// Sort the faces of a domain for which f returns true from back to front. The face
+// positions change with the state, so the depths are evaluated every time.
+const std::vector<int>& CGLModel::ZSortDomainFaces(CGLContext& rc, MeshDomain& dom, std::function<bool(const FSFace& face)> f)
+{
+	FEPostMesh* pm = GetActiveMesh();
+	const vector<int>& faceList = dom.FaceList();
+
+	// collect the faces
+	m_zfaces.clear();
+	int NF = dom.Faces();
+	for (int i = 0; i < NF; ++i)
+	{
+		if (f(dom.Face(i))) m_zfaces.push_back(faceList[i]);
+	}
+
+	// evaluate the depth of the face centers in eye coordinates
+	int N = (int)m_zfaces.size();
+	m_zsort.Resize(N);
+	const CGLCamera& cam = *rc.m_cam;
+#pragma omp parallel for
+	for (int i = 0; i < N; ++i)
+	{
+		vec3d r = pm->FaceCenter(pm->Face(m_zfaces[i]));
+		vec3d q = cam.WorldToCam(r);
+		m_zsort.SetDepth(i, (float)q.z);
+	}
+
+	// build the sorted face list
+	const std::vector<unsigned int>& order = m_zsort.Sort();
+	m_zsortedFaces.resize(N);
+	for (int i = 0; i < N; ++i) m_zsortedFaces[i] = m_zfaces[order[i]];
+
+	return m_zsortedFaces;
+}
+
 //-----------------------------------------------------------------------------
 void CGLModel::RenderSolidPart(FEPostModel* ps, CGLContext& rc, int mat)
 {
@@ -2434,6 +2408,8 @@ void CGLModel::SetSelection(FESelection* sel)
 //! unhide all items
 void CGLModel::UnhideAll()
 {
+	MeshChanged();
+
 	Post::FEPostMesh& mesh = *GetActiveMesh();
 	for (int i = 0; i<mesh.Elements(); ++i) mesh.ElementRef(i).Unhide();
 	for (int i = 0; i<mesh.Faces(); ++i) mesh.Face(i).Unhide();
@@ -2446,6 +2422,8 @@ void CGLModel::UnhideAll()
 // Hide elements with a particular material ID
 void CGLModel::HideMaterial(int nmat)
 {
+	MeshChanged();
+
 	Post::FEPostMesh& mesh = *GetActiveMesh();
 
 	// Hide the elements with the material ID
@@ -2506,6 +2484,8 @@ void CGLModel::HideMaterial(int nmat)
 // Show elements with a certain material ID
 void CGLModel::ShowMaterial(int nmat)
 {
+	MeshChanged();
+
 	Post::FEPostMesh& mesh = *GetActiveMesh();
 
 	// unhide the elements with mat ID nmat
@@ -2561,6 +2541,8 @@ void CGLModel::ShowMaterial(int nmat)
 // Show elements with a certain material ID
 void CGLModel::UpdateMeshVisibility()
 {
+	MeshChanged();
+
 	Post::FEPostMesh& mesh = *GetActiveMesh();
 	Post::FEPostModel& fem = *GetFSModel();
 
@@ -2629,6 +2611,8 @@ void CGLModel::UpdateMeshVisibility()
 // Enable elements with a certain mat ID
 void CGLModel::UpdateMeshState()
 {
+	MeshChanged();
+
 	FEPostModel& fem = *GetFSModel();
 	for (int i = 0; i < fem.Meshes(); ++i)
 	{
@@ -2742,6 +2726,8 @@ void CGLModel::SelectFacesInRange(float fmin, float fmax, bool bsel)
 // Hide selected elements
 void CGLModel::HideSelectedElements()
 {
+	MeshChanged();
+
 	Post::FEPostMesh& mesh = *GetActiveMesh();
 
 	// hide selected elements
@@ -2789,6 +2775,8 @@ void CGLModel::HideSelectedElements()
 // Hide selected elements
 void CGLModel::HideUnselectedElements()
 {
+	MeshChanged();
+
 	Post::FEPostMesh& mesh = *GetActiveMesh();
 
 	// hide unselected elements
@@ -2836,6 +2824,8 @@ void CGLModel::HideUnselectedElements()
 // Hide selected faces
 void CGLModel::HideSelectedFaces()
 {
+	MeshChanged();
+
 	Post::FEPostMesh& mesh = *GetActiveMesh();
 	// hide the faces and the elements that they are attached to
 	int NF = mesh.Faces();
@@ -2885,6 +2875,8 @@ void CGLModel::HideSelectedFaces()
 // hide selected edges
 void CGLModel::HideSelectedEdges()
 {
+	MeshChanged();
+
 	Post::FEPostMesh& mesh = *GetActiveMesh();
 
 	int NN = mesh.Nodes();
@@ -2962,6 +2954,8 @@ void CGLModel::HideSelectedEdges()
 // hide selected nodes
 void CGLModel::HideSelectedNodes()
 {
+	MeshChanged();
+
 	Post::FEPostMesh& mesh = *GetActiveMesh();
 
 	// hide nodes and all elements they attach to
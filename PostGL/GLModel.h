@@ -33,6 +33,7 @@ SOFTWARE.*/
 #include "GLPlotGroup.h"
 #include <FSCore/FSObjectList.h>
 #include <GLLib/GLMeshRender.h>
+#include <GLLib/GLZSort.h>
 #include <MeshLib/Intersect.h>
 #include <MeshTools/FESelection.h>
 #include <vector>
@@ -222,6 +223,9 @@ protected:
 	void RenderTransparentMaterial(CGLContext& rc, FEPostModel* ps, int m);
 	void RenderSolidDomain(CGLContext& rc, MeshDomain& dom, bool btex, bool benable, bool zsort, bool activeOnly);
 
+	// sort the domain faces for which f returns true from back to front
+	const std::vector<int>& ZSortDomainFaces(CGLContext& rc, MeshDomain& dom, std::function<bool(const FSFace& face)> f);
+
 	void RenderInnerSurface(int m, bool btex = true);
 	void RenderInnerSurfaceOutline(int m, int ndivs);
 
@@ -274,6 +278,11 @@ public: // Selection
 	//! hide selected nodes
 	void HideSelectedNodes();
 
+	// The mesh revision changes whenever the visibility or the node positions
+	// of the mesh may have changed. Plots use it to check if cached data is still valid.
+	int MeshRevision() const { return m_meshRev; }
+	void MeshChanged() { m_meshRev++; }
+
 	// --- S E L E C T I O N ---
 
 	// get selection mode
@@ -346,7 +355,13 @@ protected:
 
 	GLMeshRender	m_render;
 
+	// buffers for z-sorting transparent faces
+	GLZSorter			m_zsort;
+	std::vector<int>	m_zfaces;
+	std::vector<int>	m_zsortedFaces;
+
 	Post::FEPostMesh*	m_lastMesh;	// mesh of last evaluated state
+	int					m_meshRev;	// mesh revision (see MeshRevision)
 
 	// selected items
 	FESelection* m_selection;
@@ -27,6 +27,7 @@ SOFTWARE.*/
 #include "stdafx.h"
 #include "GLParticleFlowPlot.h"
 #include "GLModel.h"
+#include <PostLib/FEFlowTracer.h>
 #include <FSCore/ClassDescriptor.h>
 using namespace Post;
 
@@ -251,7 +252,10 @@ void CGLParticleFlowPlot::Update(int ntime, float dt, bool breset)
 	{
 		if (m_find == nullptr) m_find = new FEFindElement(*mdl->GetActiveMesh());
 		// choose reference frame or current frame, depending on whether we have a displacement map
-		m_find->Init(bdisp ? 1 : 0);
+		// If only the nodes moved, it's enough to refit the search tree.
+		int nframe = (bdisp ? 1 : 0);
+		if (breset || (m_find->Frame() != nframe)) m_find->Init(nframe);
+		else m_find->Refit();
 	}
 
 	FSMeshBase* pm = mdl->GetActiveMesh();
@@ -380,40 +384,6 @@ void CGLParticleFlowPlot::UpdateParticleColors()
 	}
 }
 
-vec3f CGLParticleFlowPlot::Velocity(const vec3f& r, int ntime, float w, bool& ok)
-{
-	vec3f v(0.f, 0.f, 0.f);
-	vec3f ve0[FSElement::MAX_NODES];
-	vec3f ve1[FSElement::MAX_NODES];
-	FEPostMesh& mesh = *GetModel()->GetActiveMesh();
-
-	vector<vec3f>& val0 = m_map.State(ntime    );
-	vector<vec3f>& val1 = m_map.State(ntime + 1);
-
-	int nelem;
-	double q[3];
-	if (m_find->FindElement(r, nelem, q))
-	{
-		ok = true;
-		FEElement_& el = mesh.ElementRef(nelem);
-
-		int ne = el.Nodes();
-		for (int i = 0; i<ne; ++i)
-		{
-			ve0[i] = val0[el.m_node[i]];
-			ve1[i] = val1[el.m_node[i]];
-		}
-
-		vec3f v0 = el.eval(ve0, q[0], q[1], q[2]);
-		vec3f v1 = el.eval(ve1, q[0], q[1], q[2]);
-
-		v = v0*(1.f - w) + v1*w;
-	}
-	else ok = false;
-
-	return v;
-}
-
 void CGLParticleFlowPlot::AdvanceParticles(int n0, int n1)
 {
 	// get the model
@@ -422,13 +392,13 @@ void CGLParticleFlowPlot::AdvanceParticles(int n0, int n1)
 	FEPostModel& fem = *mdl->GetFSModel();
 
 	// get the mesh
-	FSMeshBase& mesh = *mdl->GetActiveMesh();
+	FEPostMesh& mesh = *mdl->GetActiveMesh();
 
-	BOX box = m_find->BoundingBox();
-	float R = box.GetMaxExtent();
 	float dt = m_dt;
 	if (dt <= 0.f) return;
 
+	FEFlowTracer tracer(mesh, *m_find);
+
 	for (int ntime=n0; ntime<n1; ++ntime)
 	{
 		float t0 = fem.GetState(ntime    )->m_time;
@@ -451,8 +421,11 @@ void CGLParticleFlowPlot::AdvanceParticles(int n0, int n1)
 			if (t > t1) t = t1;
 			float w = (t - t0) / (t1 - t0);
 
+			tracer.SetField(m_map.State(ntime), m_map.State(ntime + 1), w);
+
+			// particles die at different times, so use dynamic scheduling
 			int NP = (int) m_particles.size();
-#pragma omp parallel for shared (NP)
+#pragma omp parallel for shared (NP) schedule(dynamic, 64)
 			for (int i=0; i<NP; ++i)
 			{
 				FlowParticle& p = m_particles[i];
@@ -464,9 +437,9 @@ void CGLParticleFlowPlot::AdvanceParticles(int n0, int n1)
 
 					vec3f r1 = r0 + v0*dt;
 
-					bool ok = true;
-					vec3f v1 = Velocity(r1, ntime, w, ok);
-					if (ok == false)
+					vec3f v1;
+					int nelem = p.m_elem;
+					if (tracer.Velocity(r1, nelem, v1) == false)
 					{
 						p.m_ndeath = ntime + 1;
 					}
@@ -474,6 +447,7 @@ void CGLParticleFlowPlot::AdvanceParticles(int n0, int n1)
 					{
 						p.m_pos[ntime + 1] = r1;
 						p.m_vel[ntime + 1] = v1;
+						p.m_elem = nelem;
 					}
 				}
 			}
@@ -481,11 +455,6 @@ void CGLParticleFlowPlot::AdvanceParticles(int n0, int n1)
 	}
 }
 
-static float frand()
-{
-	return rand() / (float) RAND_MAX;
-}
-
 void CGLParticleFlowPlot::SeedParticles()
 {
 	// clear current particles, if any
@@ -510,8 +479,10 @@ void CGLParticleFlowPlot::SeedParticles()
 	// make sure vtol is positive
 	float vtol = fabs(m_vtol);
 
-	// loop over all the surface facts
+	// find the faces that seed a particle
 	int NF = mesh.Faces();
+	vector<vec3f> faceVel(NF);
+	vector<char> seed(NF, 0);
 #pragma omp parallel for shared (NF)
 	for (int i = 0; i<NF; ++i)
 	{
@@ -522,36 +493,43 @@ void CGLParticleFlowPlot::SeedParticles()
 		vec3f vf(0.f, 0.f, 0.f);
 		for (int j = 0; j<nf; ++j) vf += val[f.n[j]];
 		vf /= nf;
+		faceVel[i] = vf;
 
 		// generate random number
-		float w = frand();
+		float w = FEFlowTracer::Random(0, i);
 
 		// see if this is a valid candidate for a seed
 		vec3f fn = f.m_fn;
-		if ((fn*vf < -vtol) && (w <= m_density))
-		{
-			// calculate the face center, this will be the seed
-			// NOTE: We are using reference coordinates, therefore we assume that the mesh is not deforming!!
-			vec3d cf(0.f, 0.f, 0.f);
-			for (int j = 0; j<nf; ++j) cf += mesh.Node(f.n[j]).r;
-			cf /= nf;
-
-			// create a particle here
-			FlowParticle p;
-			p.m_pos.resize(NS);
-			p.m_vel.resize(NS);
-			p.m_balive = true;
-			p.m_ndeath = NS;	// assume the particle will live the entire time
+		if ((fn*vf < -vtol) && (w <= m_density)) seed[i] = 1;
+	}
 
-			// set initial position and velocity
-			p.m_pos[m_seedTime] = to_vec3f(cf);
-			p.m_vel[m_seedTime] = vf;
+	// create the particles in face order, so that the result does not depend on the threads
+	for (int i = 0; i<NF; ++i)
+	{
+		if (seed[i] == 0) continue;
 
-			// add it to the pile
-#pragma omp critical
-            {
-                m_particles.push_back(p);
-            }
-		}
+		FSFace& f = mesh.Face(i);
+
+		// calculate the face center, this will be the seed
+		// NOTE: We are using reference coordinates, therefore we assume that the mesh is not deforming!!
+		int nf = f.Nodes();
+		vec3d cf(0.f, 0.f, 0.f);
+		for (int j = 0; j<nf; ++j) cf += mesh.Node(f.n[j]).r;
+		cf /= nf;
+
+		// create a particle here
+		FlowParticle p;
+		p.m_pos.resize(NS);
+		p.m_vel.resize(NS);
+		p.m_balive = true;
+		p.m_ndeath = NS;	// assume the particle will live the entire time
+		p.m_elem = f.m_elem[0].eid;
+
+		// set initial position and velocity
+		p.m_pos[m_seedTime] = to_vec3f(cf);
+		p.m_vel[m_seedTime] = faceVel[i];
+
+		// add it to the pile
+		m_particles.push_back(p);
 	}
 }
@@ -38,7 +38,7 @@ class CGLParticleFlowPlot : public CGLPlot
 	class FlowParticle
 	{
 	public:
-		FlowParticle(){}
+		FlowParticle() { m_elem = -1; }
 		FlowParticle(const FlowParticle& p)
 		{
 			m_r = p.m_r;
@@ -46,6 +46,7 @@ class CGLParticleFlowPlot : public CGLPlot
 			m_col = p.m_col;
 			m_balive = p.m_balive;
 			m_ndeath = p.m_ndeath;
+			m_elem = p.m_elem;
 			m_pos = p.m_pos;
 			m_vel = p.m_vel;
 		}
@@ -56,6 +57,7 @@ class CGLParticleFlowPlot : public CGLPlot
 			m_col = p.m_col;
 			m_balive = p.m_balive;
 			m_ndeath = p.m_ndeath;
+			m_elem = p.m_elem;
 			m_pos = p.m_pos;
 			m_vel = p.m_vel;
 		}
@@ -66,6 +68,7 @@ class CGLParticleFlowPlot : public CGLPlot
 		GLColor			m_col;		// particles color
 		bool			m_balive;	// is particle alive at current position?
 		int				m_ndeath;	// time of death
+		int				m_elem;		// element that contains the particle (used as search hint)
 		vector<vec3f>	m_pos;		// particle position at various times
 		vector<vec3f>	m_vel;		// particle velocity at various times
 	};
@@ -107,8 +110,6 @@ protected:
 
 	void AdvanceParticles(int t0, int t1);
 
-	vec3f Velocity(const vec3f& r, int ntime, float dt, bool& ok);
-
 	void UpdateParticleState(int ntime);
 
 public:
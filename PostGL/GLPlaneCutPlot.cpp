@@ -32,6 +32,10 @@ SOFTWARE.*/
 #include <MeshLib/hex.h>
 #include <MeshTools/FESelection.h>
 #include <FSCore/ClassDescriptor.h>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 using namespace Post;
 
 extern int LUT[256][15];
@@ -46,6 +50,63 @@ const int PYR_NT[8] = {0, 1, 2, 3, 4, 4, 4, 4};
 const int QUAD_NT[4] = { 0, 1, 2, 3 };
 const int TRI_NT[4]  = { 0, 1, 2, 2 };
 
+// returns the node lookup table for the (solid) element, or null if the type is not supported
+static const int* ElementNodeTable(const FEElement_& el)
+{
+	switch (el.Type())
+	{
+	case FE_HEX8   : return HEX_NT;
+	case FE_HEX20  : return HEX_NT;
+	case FE_HEX27  : return HEX_NT;
+	case FE_PENTA6 : return PEN_NT;
+	case FE_PENTA15: return PEN_NT;
+	case FE_TET4   : return TET_NT;
+	case FE_TET5   : return TET_NT;
+	case FE_TET10  : return TET_NT;
+	case FE_TET15  : return TET_NT;
+	case FE_TET20  : return TET_NT;
+	case FE_PYRA5  : return PYR_NT;
+	case FE_PYRA13 : return PYR_NT;
+	}
+	return nullptr;
+}
+
+// returns the node lookup table for the face, or null if the type is not supported
+static const int* FaceNodeTable(const FSFace& face)
+{
+	switch (face.Type())
+	{
+	case FE_FACE_TRI3 : return TRI_NT;
+	case FE_FACE_TRI6 : return TRI_NT;
+	case FE_FACE_TRI7 : return TRI_NT;
+	case FE_FACE_TRI10: return TRI_NT;
+	case FE_FACE_QUAD4: return QUAD_NT;
+	case FE_FACE_QUAD8: return QUAD_NT;
+	case FE_FACE_QUAD9: return QUAD_NT;
+	}
+	return nullptr;
+}
+
+// number of threads that may be used by a parallel region
+static int MaxThreads()
+{
+#ifdef _OPENMP
+	return omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+// id of the calling thread
+static int ThreadID()
+{
+#ifdef _OPENMP
+	return omp_get_thread_num();
+#else
+	return 0;
+#endif
+}
+
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
@@ -93,6 +154,9 @@ CGLPlaneCutPlot::CGLPlaneCutPlot()
 
 	m_bupdateSlice = false;
 
+	m_spanMesh = nullptr;
+	m_bupdateSpans = true;
+
 	UpdateData(false);
 }
 
@@ -190,6 +254,9 @@ void CGLPlaneCutPlot::InitClipPlanes()
 void CGLPlaneCutPlot::Update(int ntime, float dt, bool breset)
 {
 	m_bupdateSlice = true;
+
+	// nodal positions may have changed
+	m_bupdateSpans = true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -465,12 +532,12 @@ void CGLPlaneCutPlot::UpdateLineMesh()
 	int matId = -1;
 	Material* pmat = nullptr;
 
-	// repeat over all elements
+	// repeat over all the elements that were cut by the plane
 	vector<vec3d> points; points.reserve(1024);
-	for (int i=0; i<pm->Elements(); ++i)
+	for (int i=0; i<(int)m_cutElems.size(); ++i)
 	{
 		// render only when visible
-		FEElement_& el = pm->ElementRef(i);
+		FEElement_& el = pm->ElementRef(m_cutElems[i]);
 		if (el.m_MatID != matId)
 		{
 			pmat = ps->GetMaterial(el.m_MatID);
@@ -679,14 +746,17 @@ void CGLPlaneCutPlot::UpdateSlice()
 	// set the plane normal
 	vec3d norm((float)a[0], (float)a[1], (float)a[2]);
 
-	double ref = -a[3];
-
 	FEPostModel* ps = mdl->GetFSModel();
 	FEPostMesh* pm = mdl->GetActiveMesh();
 
 	m_slice.Clear();
+	m_cutElems.clear();
 
-	Post::FEState& state = *ps->CurrentState();
+	// the spans only depend on the plane normal, so they can be reused when the offset changes
+	if (m_bupdateSpans || (pm != m_spanMesh) || ((norm == m_spanNormal) == false) || ((int)m_elemSpan.size() != pm->Domains()))
+	{
+		UpdateSpans(pm, norm);
+	}
 
 	// loop over all domains
 	for (int n = 0; n < pm->Domains(); ++n)
@@ -706,15 +776,105 @@ void CGLPlaneCutPlot::UpdateSlice()
 	AddFaces(pm);
 }
 
-void CGLPlaneCutPlot::AddDomain(FEPostMesh* pm, int n)
+//-----------------------------------------------------------------------------
+// Calculate the projections of all the elements and faces onto the plane normal
+void CGLPlaneCutPlot::UpdateSpans(FEPostMesh* pm, const vec3d& norm)
 {
-	float ev[8];
-	vec3d ex[8];
-	int	nf[8];
-	EDGE edge[15];
-	int en[8];
-	int	rf[3];
+	m_elemSpan.resize(pm->Domains());
+	for (int n = 0; n < pm->Domains(); ++n)
+	{
+		MeshDomain& dom = pm->Domain(n);
+		SPAN_LIST& l = m_elemSpan[n];
+		l.span.clear();
+		l.span.reserve(dom.Elements());
+		for (int i = 0; i < dom.Elements(); ++i)
+		{
+			FEElement_& el = dom.Element(i);
+			const int* nt = (el.IsSolid() ? ElementNodeTable(el) : nullptr);
+			if (nt)
+			{
+				SPAN s;
+				s.nid = i;
+				s.pmin = s.pmax = norm * pm->Node(el.m_node[nt[0]]).r;
+				for (int k = 1; k < 8; ++k)
+				{
+					double p = norm * pm->Node(el.m_node[nt[k]]).r;
+					if (p < s.pmin) s.pmin = p;
+					if (p > s.pmax) s.pmax = p;
+				}
+				l.span.push_back(s);
+			}
+		}
+		l.Sort();
+	}
+
+	SPAN_LIST& l = m_faceSpan;
+	l.span.clear();
+	l.span.reserve(pm->Faces());
+	for (int i = 0; i < pm->Faces(); ++i)
+	{
+		FSFace& face = pm->Face(i);
+		const int* nt = FaceNodeTable(face);
+		if (nt)
+		{
+			SPAN s;
+			s.nid = i;
+			s.pmin = s.pmax = norm * pm->Node(face.n[nt[0]]).r;
+			for (int k = 1; k < 4; ++k)
+			{
+				double p = norm * pm->Node(face.n[nt[k]]).r;
+				if (p < s.pmin) s.pmin = p;
+				if (p > s.pmax) s.pmax = p;
+			}
+			l.span.push_back(s);
+		}
+	}
+	l.Sort();
+
+	m_spanNormal = norm;
+	m_spanMesh = pm;
+	m_bupdateSpans = false;
+}
+
+//-----------------------------------------------------------------------------
+void CGLPlaneCutPlot::SPAN_LIST::Sort()
+{
+	std::sort(span.begin(), span.end(), [](const SPAN& a, const SPAN& b) {
+		return (a.pmin < b.pmin);
+	});
+
+	wmax = 0.0;
+	for (const SPAN& s : span)
+	{
+		double w = s.pmax - s.pmin;
+		if (w > wmax) wmax = w;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Find the items that are cut by the plane at offset ref, i.e. the items with
+// at least one node below and one node on or above the plane. Items are returned
+// in their original order.
+void CGLPlaneCutPlot::SPAN_LIST::FindItems(double ref, std::vector<int>& items) const
+{
+	items.clear();
+
+	// an item with pmin < ref - wmax cannot reach the plane (a small margin is added for round-off)
+	double p0 = ref - wmax;
+	p0 -= 1e-12*(fabs(p0) + wmax);
+	auto it0 = std::lower_bound(span.begin(), span.end(), p0, [](const SPAN& s, double p) { return (s.pmin < p); });
+	auto it1 = std::lower_bound(it0, span.end(), ref, [](const SPAN& s, double p) { return (s.pmin < p); });
+	for (auto it = it0; it != it1; ++it)
+	{
+		if (it->pmax >= ref) items.push_back(it->nid);
+	}
 
+	std::sort(items.begin(), items.end());
+}
+
+//-----------------------------------------------------------------------------
+void CGLPlaneCutPlot::AddDomain(FEPostMesh* pm, int n)
+{
 	MeshDomain& dom = pm->Domain(n);
 
 	// get the plane equations
@@ -732,37 +892,36 @@ void CGLPlaneCutPlot::AddDomain(FEPostMesh* pm, int n)
 	FEPostModel* ps = mdl->GetFSModel();
 	Post::FEState& state = *ps->CurrentState();
 
-	// repeat over all elements
-	for (int i = 0; i < dom.Elements(); ++i)
+	// only the elements that straddle the plane need to be processed
+	vector<int> elems;
+	m_elemSpan[n].FindItems(ref, elems);
+	int NC = (int)elems.size();
+
+	// Each thread writes to its own buffer. With a static schedule each thread processes
+	// a contiguous range of elements, so appending the buffers in thread order gives the 
+	// same faces in the same order as a serial loop.
+	vector< vector<GLSlice::FACE> > buf(MaxThreads());
+	vector<int> elemCase(NC, 0);
+
+	#pragma omp parallel for schedule(static)
+	for (int j = 0; j < NC; ++j)
 	{
+		float ev[8];
+		vec3d ex[8];
+
+		vector<GLSlice::FACE>& faces = buf[ThreadID()];
+
 		// render only when visible
-		FEElement_& el = dom.Element(i);
+		FEElement_& el = dom.Element(elems[j]);
 		if ((el.IsVisible() || m_bcut_hidden) && el.IsSolid())
 		{
-			const int *nt = nullptr;
-			switch (el.Type())
-			{
-			case FE_HEX8: nt = HEX_NT; break;
-			case FE_HEX20: nt = HEX_NT; break;
-			case FE_HEX27: nt = HEX_NT; break;
-			case FE_PENTA6: nt = PEN_NT; break;
-			case FE_PENTA15: nt = PEN_NT; break;
-			case FE_TET4: nt = TET_NT; break;
-			case FE_TET5: nt = TET_NT; break;
-			case FE_TET10: nt = TET_NT; break;
-			case FE_TET15: nt = TET_NT; break;
-			case FE_TET20: nt = TET_NT; break;
-			case FE_PYRA5: nt = PYR_NT; break;
-            case FE_PYRA13: nt = PYR_NT; break;
-			}
+			const int *nt = ElementNodeTable(el);
 
 			// get the nodal values
 			for (int k = 0; k < 8; ++k)
 			{
 				FSNode& node = pm->Node(el.m_node[nt[k]]);
-				nf[k] = (node.IsExterior() ? 1 : 0);
 				ex[k] = node.r;
-				en[k] = el.m_node[nt[k]];
 				ev[k] = state.m_NODE[el.m_node[nt[k]]].m_val;
 			}
 
@@ -772,12 +931,12 @@ void CGLPlaneCutPlot::AddDomain(FEPostMesh* pm, int n)
 				if (norm*ex[k] >= ref) ncase |= (1 << k);
 
 			el.m_ntag = ncase;
+			elemCase[j] = ncase;
 
 			if ((ndivs <= 1) || (el.Shape() != ELEM_HEX))
 			{
 				// loop over faces
 				int* pf = LUT[ncase];
-				int ne = 0;
 				for (int l = 0; l < 5; l++)
 				{
 					if (*pf == -1) break;
@@ -802,7 +961,6 @@ void CGLPlaneCutPlot::AddDomain(FEPostMesh* pm, int n)
 
 						r[k] = ex[n1] * (1 - w) + ex[n2] * w;
 						tex[k] = v;
-						rf[k] = ((nf[n1] == 1) && (nf[n2] == 1) ? 1 : 0);
 					}
 
 					GLSlice::FACE face;
@@ -815,7 +973,7 @@ void CGLPlaneCutPlot::AddDomain(FEPostMesh* pm, int n)
 					face.tex[2] = tex[2];
 					face.bactive = el.IsActive();
 
-					m_slice.AddFace(face);
+					faces.push_back(face);
 
 					pf += 3;
 				}
@@ -866,7 +1024,6 @@ void CGLPlaneCutPlot::AddDomain(FEPostMesh* pm, int n)
 
 							// loop over faces
 							int* pf = LUT[ncase];
-							int ne = 0;
 							for (int l = 0; l < 5; l++)
 							{
 								if (*pf == -1) break;
@@ -903,7 +1060,7 @@ void CGLPlaneCutPlot::AddDomain(FEPostMesh* pm, int n)
 								face.tex[2] = tex[2];
 								face.bactive = el.IsActive();
 
-								m_slice.AddFace(face);
+								faces.push_back(face);
 
 								pf += 3;
 							}
@@ -913,17 +1070,26 @@ void CGLPlaneCutPlot::AddDomain(FEPostMesh* pm, int n)
 			}
 		}
 	}
+
+	// collect the faces
+	for (int i = 0; i < (int)buf.size(); ++i)
+	{
+		vector<GLSlice::FACE>& faces = buf[i];
+		for (int j = 0; j < (int)faces.size(); ++j) m_slice.AddFace(faces[j]);
+	}
+
+	// store the elements that were cut, so the mesh lines can be generated
+	for (int j = 0; j < NC; ++j)
+	{
+		if ((elemCase[j] > 0) && (elemCase[j] < 255)) m_cutElems.push_back(dom.ElementIndex(elems[j]));
+	}
 }
 
+//-----------------------------------------------------------------------------
 void CGLPlaneCutPlot::AddFaces(FEPostMesh* pm)
 {
-	float ev[8];
-	vec3d ex[8];
-	EDGE edge[15];
-	int en[8];
 	CGLModel* mdl = GetModel();
 	FEPostModel* ps = mdl->GetFSModel();
-	Post::FEState& state = *ps->CurrentState();
 
 	// get the plane equations
 	GLdouble a[4];
@@ -933,10 +1099,24 @@ void CGLPlaneCutPlot::AddFaces(FEPostMesh* pm)
 	vec3d norm((float)a[0], (float)a[1], (float)a[2]);
 
 	double ref = -a[3];
+
+	// only the faces that straddle the plane need to be processed
+	vector<int> faceList;
+	m_faceSpan.FindItems(ref, faceList);
+	int NC = (int)faceList.size();
+
+	// per-thread buffers (see AddDomain)
+	vector< vector<GLSlice::EDGE> > buf(MaxThreads());
+
 	// loop over faces to determine edges
-	for (int i = 0; i < pm->Faces(); ++i)
+	#pragma omp parallel for schedule(static)
+	for (int i = 0; i < NC; ++i)
 	{
-		FSFace& face = pm->Face(i);
+		vec3d ex[4];
+
+		vector<GLSlice::EDGE>& edges = buf[ThreadID()];
+
+		FSFace& face = pm->Face(faceList[i]);
 
 		int elemId = face.m_elem[0].eid;
 		FSElement& el = pm->Element(elemId);
@@ -950,25 +1130,13 @@ void CGLPlaneCutPlot::AddFaces(FEPostMesh* pm)
 				Material* pmat = ps->GetMaterial(matId);
 				if ((pmat->bvisible || m_bcut_hidden) && pmat->bclip)
 				{
-					const int *nt = nullptr;
-					switch (face.Type())
-					{
-					case FE_FACE_TRI3 : nt = TRI_NT; break;
-					case FE_FACE_TRI6 : nt = TRI_NT; break;
-					case FE_FACE_TRI7 : nt = TRI_NT; break;
-					case FE_FACE_TRI10: nt = TRI_NT; break;
-					case FE_FACE_QUAD4: nt = QUAD_NT; break;
-					case FE_FACE_QUAD8: nt = QUAD_NT; break;
-					case FE_FACE_QUAD9: nt = QUAD_NT; break;
-					}
+					const int *nt = FaceNodeTable(face);
 
 					// get the nodal values
 					for (int k = 0; k<4; ++k)
 					{
 						FSNode& node = pm->Node(face.n[nt[k]]);
 						ex[k] = node.r;
-						en[k] = el.m_node[nt[k]];
-						ev[k] = state.m_NODE[el.m_node[nt[k]]].m_val;
 					}
 
 					// calculate the case of the face
@@ -978,7 +1146,6 @@ void CGLPlaneCutPlot::AddFaces(FEPostMesh* pm)
 
 					// loop over faces
 					int* pf = LUT2D[ncase];
-					int ne = 0;
 					for (int l = 0; l < 2; l++)
 					{
 						if (*pf == -1) break;
@@ -999,8 +1166,6 @@ void CGLPlaneCutPlot::AddFaces(FEPostMesh* pm)
 							else
 								w = 0.f;
 
-							float v = ev[n1] * (1 - w) + ev[n2] * w;
-
 							r[k] = ex[n1] * (1 - w) + ex[n2] * w;
 						}
 
@@ -1008,7 +1173,7 @@ void CGLPlaneCutPlot::AddFaces(FEPostMesh* pm)
 						GLSlice::EDGE e;
 						e.r[0] = r[0];
 						e.r[1] = r[1];
-						m_slice.AddEdge(e);
+						edges.push_back(e);
 
 						pf += 2;
 					}
@@ -1016,6 +1181,13 @@ void CGLPlaneCutPlot::AddFaces(FEPostMesh* pm)
 			}
 		}
 	}
+
+	// collect the edges
+	for (int i = 0; i < (int)buf.size(); ++i)
+	{
+		vector<GLSlice::EDGE>& edges = buf[i];
+		for (int j = 0; j < (int)edges.size(); ++j) m_slice.AddEdge(edges[j]);
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -124,6 +124,8 @@ protected:
 	void AddDomain(FEPostMesh* pm, int n);
 	void AddFaces(FEPostMesh* pm);
 
+	void UpdateSpans(FEPostMesh* pm, const vec3d& norm);
+
 	void UpdateTriMesh();
 	void UpdateLineMesh();
 	void UpdateOutlineMesh();
@@ -169,5 +171,30 @@ protected:
 	GLLineMesh	m_outlineMesh;	// for rendering the outline
 
 	bool	m_bupdateSlice; // update slice before rendering
+
+	// Projection of an element (or face) onto the plane normal. Only the items
+	// whose span contains the plane offset can be cut by the plane.
+	struct SPAN
+	{
+		double	pmin, pmax;	// projection interval
+		int		nid;		// index of item
+	};
+
+	struct SPAN_LIST
+	{
+		std::vector<SPAN>	span;	// spans, sorted by pmin
+		double				wmax;	// largest span width
+
+		void Sort();
+		void FindItems(double ref, std::vector<int>& items) const;
+	};
+
+	std::vector<SPAN_LIST>	m_elemSpan;	// element spans of each domain
+	SPAN_LIST				m_faceSpan;	// face spans
+	vec3d					m_spanNormal;	// plane normal used for the spans
+	FEPostMesh*				m_spanMesh;		// mesh used for the spans
+	bool					m_bupdateSpans;	// spans need to be recalculated
+
+	std::vector<int>	m_cutElems;	// elements that are cut by the plane (m_ntag stores the case)
 };
 }
@@ -28,7 +28,7 @@ SOFTWARE.*/
 #include "GLStreamLinePlot.h"
 #include "GLWLib/GLWidgetManager.h"
 #include "GLModel.h"
-#include <MeshLib/MeshTools.h>
+#include <PostLib/FEFlowTracer.h>
 #include <FSCore/ClassDescriptor.h>
 using namespace Post;
 
@@ -142,11 +142,6 @@ void CGLStreamLinePlot::Render(CGLContext& rc)
 	glPopAttrib();
 }
 
-static float frand()
-{
-	return rand() / (float)RAND_MAX;
-}
-
 void CGLStreamLinePlot::Update(int ntime, float dt, bool breset)
 {
 	m_lastTime = ntime;
@@ -156,7 +151,7 @@ void CGLStreamLinePlot::Update(int ntime, float dt, bool breset)
 	FSMeshBase* pm = mdl->GetActiveMesh();
 	FEPostModel* pfem = mdl->GetFSModel();
 
-	if (breset) { m_map.Clear(); m_rng.clear(); m_val.clear(); m_prob.clear(); }
+	if (breset) { m_map.Clear(); m_rng.clear(); m_val.clear(); }
 
 	// see if we need to revaluate the FEFindElement object
 	// We evaluate it when the plot needs to be reset, or when the model has a displacement map
@@ -165,7 +160,10 @@ void CGLStreamLinePlot::Update(int ntime, float dt, bool breset)
 	{
 		if (m_find == nullptr) m_find = new FEFindElement(*mdl->GetActiveMesh());
 		// choose reference frame or current frame, depending on whether we have a displacement map
-		m_find->Init(bdisp ? 1 : 0);
+		// If only the nodes moved, it's enough to refit the search tree.
+		int nframe = (bdisp ? 1 : 0);
+		if (breset || (m_find->Frame() != nframe)) m_find->Init(nframe);
+		else m_find->Refit();
 	}
 
 	if (m_map.States() == 0)
@@ -178,14 +176,6 @@ void CGLStreamLinePlot::Update(int ntime, float dt, bool breset)
 		m_val.resize(NN);
 	}
 
-	if (m_prob.empty())
-	{
-		FSMeshBase& mesh = *pfem->GetFEMesh(0);
-		int NF = mesh.Faces();
-		m_prob.resize(NF);
-		for (int i=0; i<NF; ++i) m_prob[i] = frand();
-	}
-
 	// check the tag
 	int ntag = m_map.GetTag(ntime);
 
@@ -247,28 +237,6 @@ void CGLStreamLinePlot::Update(int ntime, float dt, bool breset)
 	UpdateMesh();
 }
 
-vec3f CGLStreamLinePlot::Velocity(const vec3f& r, bool& ok)
-{
-	vec3f v(0.f, 0.f, 0.f);
-	vec3f ve[FSElement::MAX_NODES];
-	FEPostMesh& mesh = *GetModel()->GetActiveMesh();
-	int nelem;
-	double q[3];
-	if (m_find->FindElement(r, nelem, q))
-	{
-		ok = true;
-		FEElement_& el = mesh.ElementRef(nelem);
-
-		int ne = el.Nodes();
-		for (int i=0; i<ne; ++i) ve[i] = m_val[el.m_node[i]];
-
-		v = el.eval(ve, q[0], q[1], q[2]);
-	}
-	else ok = false;
-
-	return v;
-}
-
 void CGLStreamLinePlot::UpdateStreamLines()
 {
 	// clear current stream lines
@@ -296,16 +264,16 @@ void CGLStreamLinePlot::UpdateStreamLines()
 	float R = box.GetMaxExtent();
 	float maxStep = m_inc*R;
 
-	// tag all elements
-	mesh.TagAllElements(0);
+	FEFlowTracer tracer(mesh, *m_find);
+	tracer.SetField(m_val);
 
-	// use the same seed
-	srand(0);
+	// Each face traces into its own slot, so the result does not depend on the 
+	// number of threads or the order in which the faces are processed.
+	int NF = mesh.Faces();
+	vector<StreamLine> lines(NF);
 
 	// loop over all the surface facts
-	double q[3];
-	int NF = mesh.Faces();
-#pragma omp parallel for shared (NF)
+#pragma omp parallel for schedule(dynamic, 16)
 	for (int i=0; i<NF; ++i)
 	{
 		FSFace& f = mesh.Face(i);
@@ -317,8 +285,9 @@ void CGLStreamLinePlot::UpdateStreamLines()
 		vf /= nf;
 
 		// see if this is a valid candidate for a seed
+		// (we use the same "random" numbers for each update)
 		vec3f fn = f.m_fn;
-		if ((fn*vf < -vtol) && (m_prob[i] <= m_density))
+		if ((fn*vf < -vtol) && (FEFlowTracer::Random(0, i) <= m_density))
 		{
 			// calculate the face center, this will be the seed
 			// NOTE: We are using reference coordinates, therefore we assume that te mesh is not deforming!!
@@ -326,21 +295,17 @@ void CGLStreamLinePlot::UpdateStreamLines()
 			for (int j = 0; j<nf; ++j) cf += to_vec3f(mesh.Node(f.n[j]).r);
 			cf /= nf;
 
-			// project the seed into the adjacent solid element
+			// the seed starts in the adjacent solid element
 			int nelem = f.m_elem[0].eid;
-			FEElement_* el = &mesh.ElementRef(nelem);
-			el->m_ntag = 1;
-			ProjectInsideReferenceElement(mesh, *el, cf, q);
 
 			double V = vf.Length();
 
 			// now, propagate the seed and form the stream line
-			StreamLine l;
+			StreamLine& l = lines[i];
 			l.Add(cf, V);
 
 			vec3f vc = vf;
 
-			vec3f v[FSElement::MAX_NODES];
 			bool ok;
 			do
 			{
@@ -362,13 +327,19 @@ void CGLStreamLinePlot::UpdateStreamLines()
 				cf += (vc + vp)*(dt*0.5f);
 */
 				// RK4
+				// The substeps start their element search at the element of the current point.
 				vec3f dr(0.f, 0.f, 0.f);
 				do
 				{
+					int ne = nelem;
+					vec3f vb, vc2, vd;
 					vec3f a = vc*dt;
-					vec3f b = Velocity(cf + a*0.5f, ok)*dt; if (ok == false) break;
-					vec3f c = Velocity(cf + b*0.5f, ok)*dt; if (ok == false) break;
-					vec3f d = Velocity(cf + c     , ok)*dt; if (ok == false) break;
+					ok = tracer.Velocity(cf + a*0.5f, ne, vb); if (ok == false) break;
+					vec3f b = vb*dt;
+					ok = tracer.Velocity(cf + b*0.5f, ne, vc2); if (ok == false) break;
+					vec3f c = vc2*dt;
+					ok = tracer.Velocity(cf + c, ne, vd); if (ok == false) break;
+					vec3f d = vd*dt;
 
 					dr = (a + b*2.f + c*2.f + d) / 6.0;
 					float DR = dr.Length();
@@ -386,19 +357,21 @@ void CGLStreamLinePlot::UpdateStreamLines()
 				if (l.Points() > MAX_POINTS) break;
 
 				// get velocity at new point
-				vc = Velocity(cf, ok);
+				ok = tracer.Velocity(cf, nelem, vc);
 				if (ok == false) break;
 			}
 			while (1);
 
-			if (l.Points() > 2)
-#pragma omp critical
-			{
-				m_streamLines.push_back(l);
-			}
+			if (l.Points() <= 2) l.m_pt.clear();
 		}
 	}
 
+	// collect the stream lines
+	for (int i = 0; i < NF; ++i)
+	{
+		if (lines[i].Points() > 2) m_streamLines.push_back(lines[i]);
+	}
+
 	// evaluate the color of stream lines
 	ColorStreamLines();
 }
@@ -111,9 +111,6 @@ public:
 	bool UpdateData(bool bsave = true) override;
 
 protected:
-
-	vec3f Velocity(const vec3f& r, bool& ok);
-
 	void UpdateMesh();
 
 private:
@@ -136,7 +133,6 @@ private:
 	vec2f			m_crng;	// current range
 
 	vector<StreamLine>	m_streamLines;
-	vector<float>		m_prob;
 
 	FEFindElement*	m_find;
 
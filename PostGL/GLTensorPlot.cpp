@@ -31,6 +31,7 @@ SOFTWARE.*/
 #include "GLModel.h"
 #include <stdlib.h>
 #include <GLLib/glx.h>
+#include <GLLib/GLGlyph.h>
 #include <FSCore/ClassDescriptor.h>
 using namespace Post;
 
@@ -96,6 +97,9 @@ GLTensorPlot::GLTensorPlot()
 	m_range.mintype = RANGE_DYNAMIC;
 	m_range.valid = false;
 
+	m_mesh.SetRenderMode(GLMesh::VBOMode);
+	m_lines.SetRenderMode(GLMesh::VBOMode);
+
 	GLLegendBar* bar = new GLLegendBar(&m_Col, 0, 0, 600, 100, GLLegendBar::ORIENT_HORIZONTAL);
 	bar->align(GLW_ALIGN_BOTTOM | GLW_ALIGN_HCENTER);
 	bar->copy_label(szname);
@@ -154,6 +158,8 @@ bool GLTensorPlot::UpdateData(bool bsave)
 		{
 			for (int i = 0; i<m_map.States(); ++i) m_map.SetTag(i, -1);
 		}
+
+		m_glyphs.Invalidate();
 	}
 	else
 	{
@@ -207,6 +213,7 @@ void GLTensorPlot::Update(int ntime, float dt, bool breset)
 
 	m_lastTime = ntime;
 	m_lastDt = dt;
+	m_glyphs.Invalidate();
 
 	CGLModel* mdl = GetModel();
 	FEPostMesh* pm = mdl->GetActiveMesh();
@@ -444,16 +451,7 @@ void GLTensorPlot::Render(CGLContext& rc)
 	// store attributes
 	glPushAttrib(GL_LIGHTING_BIT);
 
-	// create the cylinder object
-	glEnable(GL_LIGHTING);
-	GLUquadricObj* pglyph = gluNewQuadric();
-	gluQuadricNormals(pglyph, GLU_SMOOTH);
-
 	CGLModel* mdl = GetModel();
-	FEPostModel* ps = mdl->GetFSModel();
-
-	srand(m_seed);
-
 	FEPostModel* pfem = mdl->GetFSModel();
 	FEPostMesh* pm = mdl->GetActiveMesh();
 
@@ -465,7 +463,6 @@ void GLTensorPlot::Render(CGLContext& rc)
 		glEnable(GL_LIGHTING);
 		glEnable(GL_COLOR_MATERIAL);
 		glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
-		glColor3ub(m_gcl.r, m_gcl.g, m_gcl.b);
 
 		GLfloat dif[] = { 1.f, 1.f, 1.f, 1.f };
 		GLfloat amb[] = { 0.1f, 0.1f, 0.1f, 1.f };
@@ -474,6 +471,62 @@ void GLTensorPlot::Render(CGLContext& rc)
 		glLightfv(GL_LIGHT0, GL_AMBIENT, amb);
 	}
 
+	int items = (IS_ELEM_FIELD(m_ntensor) ? pm->Elements() : pm->Nodes());
+
+	float auto_scale = 1.f;
+	if (m_bautoscale)
+	{
+		float Lmax = 0.f;
+		for (int i = 0; i < items; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				float L = fabs(m_val[i].l[j]);
+				if (L > Lmax) Lmax = L;
+			}
+		}
+		if (Lmax == 0.f) Lmax = 1.f;
+		auto_scale = 1.f / Lmax;
+	}
+	scale *= auto_scale;
+
+	float fmax = 1.f, fmin = 0.f;
+	if (m_ncol != Glyph_Col_Solid)
+	{
+		fmax = m_range.max;
+		fmin = m_range.min;
+	}
+	GetLegendBar()->SetRange(fmin, fmax);
+
+	// The items that are drawn depend on visibility, which can change without 
+	// this plot being updated. The glyph items are only collected again when the
+	// mesh revision changed.
+	auto collect = [this](vector<int>& items, vector<vec3f>& pos) { CollectGlyphs(items, pos); };
+	if (m_glyphs.Update(pm, mdl->MeshRevision(), scale, collect))
+	{
+		BuildGlyphs(scale);
+	}
+
+	if (m_nglyph == Glyph_Line) m_lines.Render();
+	else m_mesh.Render();
+
+	// restore attributes
+	glPopAttrib();
+
+	glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+}
+
+void GLTensorPlot::CollectGlyphs(vector<int>& items, vector<vec3f>& pos)
+{
+	items.clear();
+	pos.clear();
+
+	CGLModel* mdl = GetModel();
+	FEPostModel* ps = mdl->GetFSModel();
+	FEPostMesh* pm = mdl->GetActiveMesh();
+
+	srand(m_seed);
+
 	if (IS_ELEM_FIELD(m_ntensor))
 	{
 		pm->TagAllElements(0);
@@ -497,53 +550,13 @@ void GLTensorPlot::Render(CGLContext& rc)
 			}
 		}
 
-		float auto_scale = 1.f;
-		if (m_bautoscale)
-		{
-			float Lmax = 0.f;
-			for (int i = 0; i < pm->Elements(); ++i)
-			{
-				for (int j = 0; j < 3; ++j)
-				{
-					float L = fabs(m_val[i].l[j]);
-					if (L > Lmax) Lmax = L;
-				}
-			}
-			if (Lmax == 0.f) Lmax = 1.f;
-			auto_scale = 1.f / Lmax;
-		}
-
-		CColorMap& map = ColorMapManager::GetColorMap(m_Col.GetColorMap());
-		float fmax = 1.f, fmin = 0.f;
-		if (m_ncol != Glyph_Col_Solid)
-		{
-			fmax = m_range.max;
-			fmin = m_range.min;
-		}
-
-		GetLegendBar()->SetRange(fmin, fmax);
-
-		if (fmax == fmin) fmax++;
-
 		for (int i = 0; i < pm->Elements(); ++i)
 		{
 			FEElement_& elem = pm->ElementRef(i);
 			if ((frand() <= m_dens) && elem.m_ntag)
 			{
-				vec3d r = pm->ElementCenter(elem);
-
-				TENSOR& t = m_val[i];
-
-				if (m_ncol != Glyph_Col_Solid)
-				{
-					float w = (t.f - fmin) / (fmax - fmin);
-					GLColor c = map.map(w);
-					glColor3ub(c.r, c.g, c.b);
-				}
-
-				glTranslatef(r.x, r.y, r.z);
-				RenderGlyphs(t, scale*auto_scale, pglyph);
-				glTranslatef(-r.x, -r.y, -r.z);
+				items.push_back(i);
+				pos.push_back(to_vec3f(pm->ElementCenter(elem)));
 			}
 		}
 	}
@@ -571,80 +584,82 @@ void GLTensorPlot::Render(CGLContext& rc)
 			}
 		}
 
-		float auto_scale = 1.f;
-		if (m_bautoscale)
-		{
-			float Lmax = 0.f;
-			for (int i = 0; i < pm->Nodes(); ++i)
-			{
-				for (int j = 0; j < 3; ++j)
-				{
-					float L = fabs(m_val[i].l[j]);
-					if (L > Lmax) Lmax = L;
-				}
-			}
-			if (Lmax == 0.f) Lmax = 1.f;
-			auto_scale = 1.f / Lmax;
-		}
-
-		CColorMap& map = ColorMapManager::GetColorMap(m_Col.GetColorMap());
-		float fmax = 1.f, fmin = 0.f;
-		if (m_ncol != Glyph_Col_Solid)
-		{
-			fmax = m_range.max;
-			fmin = m_range.min;
-		}
-		GetLegendBar()->SetRange(fmin, fmax);
-
-		if (fmax == fmin) fmax++;
-
-		if (m_nglyph == Glyph_Line) glDisable(GL_LIGHTING);
-
-		glx::glcolor(m_gcl);
-
 		for (int i = 0; i < pm->Nodes(); ++i)
 		{
 			FSNode& node = pm->Node(i);
 			if ((frand() <= m_dens) && node.m_ntag)
 			{
-				vec3d r = node.r;
-
-				TENSOR& t = m_val[i];
-
-				if (m_ncol != Glyph_Col_Solid)
-				{
-					float w = (t.f  - fmin)/ (fmax - fmin);
-					GLColor c = map.map(w);
-					glx::glcolor(c);
-				}
-
-				glx::translate(r);
-				RenderGlyphs(t, scale*auto_scale, pglyph);
-				glx::translate(-r);
+				items.push_back(i);
+				pos.push_back(to_vec3f(node.r));
 			}
 		}
 	}
-
-	gluDeleteQuadric(pglyph);
-
-	// restore attributes
-	glPopAttrib();
-
-	glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
 }
 
-void GLTensorPlot::RenderGlyphs(TENSOR& t, float scale, GLUquadricObj* glyph)
+void GLTensorPlot::BuildGlyphs(float scale)
 {
+	// build the glyph template
+	GLGlyph glyph;
+	int glyphsPerItem = 1;
 	switch (m_nglyph)
 	{
-	case Glyph_Arrow : RenderArrows(t, scale, glyph); break;
-	case Glyph_Line  : RenderLines (t, scale, glyph); break;
-	case Glyph_Sphere: RenderSphere(t, scale, glyph); break;
-	case Glyph_Box   : RenderBox   (t, scale, glyph); break;
+	case Glyph_Arrow:
+		glyph.AddCylinder(0.05f, 0.05f, 0.f, 0.9f, 5);
+		glyph.AddCylinder(0.15f, 0.f, 0.81f, 1.01f, 10);
+		glyphsPerItem = 3;
+		break;
+	case Glyph_Sphere: glyph.AddSphere(1.f, 16, 16); break;
+	case Glyph_Box   : glyph.AddBox(0.5f, 0.5f, 0.5f); break;
+	}
+
+	CColorMap& map = ColorMapManager::GetColorMap(m_Col.GetColorMap());
+	float fmax = 1.f, fmin = 0.f;
+	if (m_ncol != Glyph_Col_Solid)
+	{
+		fmax = m_range.max;
+		fmin = m_range.min;
+	}
+	if (fmax == fmin) fmax++;
+
+	int N = (int)m_glyphs.Glyphs();
+	if (m_nglyph == Glyph_Line)
+	{
+		m_lines.Create(3 * N, GLMesh::FLAG_COLOR);
+		m_lines.BeginMesh();
+	}
+	else
+	{
+		m_mesh.Create(N*glyphsPerItem*glyph.Triangles(), GLMesh::FLAG_NORMAL | GLMesh::FLAG_COLOR);
+		m_mesh.BeginMesh();
+	}
+
+	for (int i = 0; i < N; ++i)
+	{
+		const TENSOR& t = m_val[m_glyphs.Item(i)];
+		const vec3f& r = m_glyphs.Position(i);
+
+		GLColor col(m_gcl.r, m_gcl.g, m_gcl.b);
+		if (m_ncol != Glyph_Col_Solid)
+		{
+			float w = (t.f - fmin) / (fmax - fmin);
+			col = map.map(w);
+			col.a = 255;
+		}
+
+		switch (m_nglyph)
+		{
+		case Glyph_Arrow : AddArrows(r, t, scale, glyph); break;
+		case Glyph_Line  : AddLines (r, t, scale); break;
+		case Glyph_Sphere: 
+		case Glyph_Box   : AddScaled(r, t, scale, glyph, col); break;
+		}
 	}
+
+	if (m_nglyph == Glyph_Line) m_lines.EndMesh();
+	else m_mesh.EndMesh();
 }
 
-void GLTensorPlot::RenderArrows(GLTensorPlot::TENSOR& t, float scale, GLUquadricObj* pglyph)
+void GLTensorPlot::AddArrows(const vec3f& r, const GLTensorPlot::TENSOR& t, float scale, const GLGlyph& glyph)
 {
 	GLColor c[3];
 	c[0] = GLColor(255, 0, 0);
@@ -653,35 +668,18 @@ void GLTensorPlot::RenderArrows(GLTensorPlot::TENSOR& t, float scale, GLUquadric
 
 	for (int i = 0; i<3; ++i)
 	{
-		glPushMatrix();
-
 		float L = (m_bnormalize ? scale : scale*t.l[i]);
 		vec3f v = t.r[i];
 		if (L < 0) { v = -v; L = -L; }
 
-		float l0 = L * .9;
-		float l1 = L * .2;
-		float r0 = L * 0.05;
-		float r1 = L * 0.15;
-
-		quatd q = quatd(vec3d(0,0,1), to_vec3d(v));
-		float w = q.GetAngle();
-		if (fabs(w) > 1e-6)
-		{
-			vec3d p = q.GetVector();
-			if (p.Length() > 1e-6) glRotated(w * 180 / PI, p.x, p.y, p.z);
-		}
-
-		glColor3ub(c[i].r, c[i].g, c[i].b);
-		gluCylinder(pglyph, r0, r0, l0, 5, 1);
-		glTranslatef(0.f, 0.f, (float)l0*0.9f);
-		gluCylinder(pglyph, r1, 0, l1, 10, 1);
-
-		glPopMatrix();
+		vec3f R[3];
+		GLGlyph::RotateZTo(v, R);
+		vec3f A[3] = { R[0] * L, R[1] * L, R[2] * L };
+		glyph.AddToMesh(m_mesh, r, A, R, c[i]);
 	}
 }
 
-void GLTensorPlot::RenderLines(GLTensorPlot::TENSOR& t, float scale, GLUquadricObj* pglyph)
+void GLTensorPlot::AddLines(const vec3f& r, const GLTensorPlot::TENSOR& t, float scale)
 {
 	GLColor c[3];
 	c[0] = GLColor(255, 0, 0);
@@ -690,27 +688,18 @@ void GLTensorPlot::RenderLines(GLTensorPlot::TENSOR& t, float scale, GLUquadricO
 
 	for (int i = 0; i<3; ++i)
 	{
-		glPushMatrix();
-
 		float L = (m_bnormalize ? scale : scale*t.l[i]);
 
-		vec3f v = t.r[i];
-		quatd q = quatd(vec3d(0, 0, 1), to_vec3d(v));
-		float w = q.GetAngle();
-		if (fabs(w) > 1e-6)
-		{
-			vec3d p = q.GetVector();
-			if (p.Length() > 1e-6) glRotatef(w * 180 / PI, p.x, p.y, p.z);
-		}
-
-		glx::glcolor(c[i]);
-		glx::drawLine(0, 0, 0, 0, 0, L);
+		vec3f R[3];
+		GLGlyph::RotateZTo(t.r[i], R);
 
-		glPopMatrix();
+		m_lines.AddVertex(r, c[i]);
+		m_lines.AddVertex(r + R[2] * L, c[i]);
 	}
 }
 
-void GLTensorPlot::RenderSphere(TENSOR& t, float scale, GLUquadricObj* glyph)
+// Add a glyph that is scaled along the tensor's principal directions (i.e. sphere and box glyphs)
+void GLTensorPlot::AddScaled(const vec3f& r, const GLTensorPlot::TENSOR& t, float scale, const GLGlyph& glyph, const GLColor& col)
 {
 	if (scale <= 0.f) return;
 
@@ -724,46 +713,12 @@ void GLTensorPlot::RenderSphere(TENSOR& t, float scale, GLUquadricObj* glyph)
 	if (sy < 0.1*smax) sy = 0.1f*smax;
 	if (sz < 0.1*smax) sz = 0.1f*smax;
 
-	glPushMatrix();
-	vec3f* e = t.r;
-	vec3f n = e[0] ^ e[1];
-	if (n*e[2] < 0) e[2] = -e[2];
-	GLfloat m[4][4] = {0};
-	m[3][3] = 1.f;
-	m[0][0] = e[0].x; m[0][1] = e[0].y; m[0][2] = e[0].z;
-	m[1][0] = e[1].x; m[1][1] = e[1].y; m[1][2] = e[1].z;
-	m[2][0] = e[2].x; m[2][1] = e[2].y; m[2][2] = e[2].z;
-	glMultMatrixf(&m[0][0]);
-
-	glScalef(scale*sx, scale*sy, scale*sz);
-	gluSphere(glyph, 1.f, 16, 16);
-	glPopMatrix();
-}
-
-void GLTensorPlot::RenderBox(TENSOR& t, float scale, GLUquadricObj* glyph)
-{
-	if (scale <= 0.f) return;
+	const vec3f* e = t.r;
+	vec3f A[3] = { e[0] * (scale*sx), e[1] * (scale*sy), e[2] * (scale*sz) };
 
-	float smax = 0.f;
-	float sx = fabs(t.l[0]); if (sx > smax) smax = sx;
-	float sy = fabs(t.l[1]); if (sy > smax) smax = sy;
-	float sz = fabs(t.l[2]); if (sz > smax) smax = sz;
-	if (smax < 1e-7f) return;
-
-	if (sx < 0.1*smax) sx = 0.1f*smax;
-	if (sy < 0.1*smax) sy = 0.1f*smax;
-	if (sz < 0.1*smax) sz = 0.1f*smax;
+	// normals transform with the inverse transpose of A (up to a scale factor)
+	vec3f B[3] = { A[1] ^ A[2], A[2] ^ A[0], A[0] ^ A[1] };
+	if (A[0] * B[0] < 0.f) { B[0] = -B[0]; B[1] = -B[1]; B[2] = -B[2]; }
 
-	glPushMatrix();
-	vec3f* e = t.r;
-	GLfloat m[4][4] = { 0 };
-	m[3][3] = 1.f;
-	m[0][0] = e[0].x; m[0][1] = e[0].y; m[0][2] = e[0].z;
-	m[1][0] = e[1].x; m[1][1] = e[1].y; m[1][2] = e[1].z;
-	m[2][0] = e[2].x; m[2][1] = e[2].y; m[2][2] = e[2].z;
-	glMultMatrixf(&m[0][0]);
-
-	glScalef(scale*sx, scale*sy, scale*sz);
-	glx::drawBox(0.5, 0.5, 0.5);
-	glPopMatrix();
+	glyph.AddToMesh(m_mesh, r, A, B, col);
 }
@@ -27,11 +27,8 @@ SOFTWARE.*/
 #pragma once
 #include "GLPlot.h"
 #include <GLWLib/GLWidget.h>
-#ifdef __APPLE__
-    #include <OpenGL/GLU.h>
-#else
-    #include <GL/glu.h>
-#endif
+#include <GLLib/GLMesh.h>
+#include <GLLib/GLGlyph.h>
 
 namespace Post {
 
@@ -84,36 +81,40 @@ public:
 	int GetVectorMethod() const { return m_nmethod; }
 	void SetVectorMethod(int m);
 
-	void SetScaleFactor(float g) { m_scale = g; }
+	void SetScaleFactor(float g) { m_scale = g; m_glyphs.Invalidate(); }
 	double GetScaleFactor() { return m_scale; }
 
-	void SetDensity(float d) { m_dens = d; }
+	void SetDensity(float d) { m_dens = d; m_glyphs.Invalidate(); }
 	double GetDensity() { return m_dens; }
 
 	bool ShowHidden() const { return m_bshowHidden; }
-	void ShowHidden(bool b) { m_bshowHidden = b; }
+	void ShowHidden(bool b) { m_bshowHidden = b; m_glyphs.Invalidate(); }
 
 	int GetGlyphType() { return m_nglyph; }
-	void SetGlyphType(int ntype) { m_nglyph = ntype; }
+	void SetGlyphType(int ntype) { m_nglyph = ntype; m_glyphs.Invalidate(); }
 
 	int GetColorType() { return m_ncol; }
-	void SetColorType(int ntype) { m_ncol = ntype; }
+	void SetColorType(int ntype) { m_ncol = ntype; m_glyphs.Invalidate(); }
 
 	GLColor GetGlyphColor() { return m_gcl; }
-	void SetGlyphColor(GLColor c) { m_gcl = c; }
+	void SetGlyphColor(GLColor c) { m_gcl = c; m_glyphs.Invalidate(); }
 
 	bool GetAutoScale() { return m_bautoscale; }
-	void SetAutoScale(bool b) { m_bautoscale = b; }
+	void SetAutoScale(bool b) { m_bautoscale = b; m_glyphs.Invalidate(); }
 
 	bool GetNormalize() { return m_bnormalize; }
-	void SetNormalize(bool b) { m_bnormalize = b; }
+	void SetNormalize(bool b) { m_bnormalize = b; m_glyphs.Invalidate(); }
 
 protected:
-	void RenderGlyphs(TENSOR& t, float scale, GLUquadricObj* glyph);
-	void RenderArrows(TENSOR& t, float scale, GLUquadricObj* glyph);
-	void RenderLines(TENSOR& t, float scale, GLUquadricObj* glyph);
-	void RenderSphere(TENSOR& t, float scale, GLUquadricObj* glyph);
-	void RenderBox(TENSOR& t, float scale, GLUquadricObj* glyph);
+	// find the items (nodes or elements) that get a glyph and their positions
+	void CollectGlyphs(vector<int>& items, vector<vec3f>& pos);
+
+	// build the glyph mesh for the current glyph items
+	void BuildGlyphs(float scale);
+
+	void AddArrows(const vec3f& r, const TENSOR& t, float scale, const GLGlyph& glyph);
+	void AddLines (const vec3f& r, const TENSOR& t, float scale);
+	void AddScaled(const vec3f& r, const TENSOR& t, float scale, const GLGlyph& glyph, const GLColor& col);
 
 	void Update() override;
 
@@ -144,5 +145,11 @@ protected:
 	int		m_lastTime;
 	float	m_lastDt;
 	int		m_lastCol;
+
+	// All glyphs are batched in a single mesh, which is only rebuilt when the
+	// data, the parameters, or the set of rendered items changes.
+	GLTriMesh		m_mesh;			// glyph mesh
+	GLLineMesh		m_lines;		// glyph mesh for line glyphs
+	GLGlyphCache	m_glyphs;		// items and positions of the glyphs in the mesh
 };
 }
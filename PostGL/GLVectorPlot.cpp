@@ -31,6 +31,7 @@ SOFTWARE.*/
 #include "GLWLib/GLWidgetManager.h"
 #include <PostGL/GLModel.h>
 #include <GLLib/glx.h>
+#include <GLLib/GLGlyph.h>
 #include <FSCore/ClassDescriptor.h>
 using namespace Post;
 
@@ -94,6 +95,9 @@ CGLVectorPlot::CGLVectorPlot()
 	m_usr[0] = 0.0;
 	m_usr[1] = 1.0;
 
+	m_mesh.SetRenderMode(GLMesh::VBOMode);
+	m_lines.SetRenderMode(GLMesh::VBOMode);
+
 	GLLegendBar* bar = new GLLegendBar(&m_Col, 0, 0, 120, 500);
 	bar->align(GLW_ALIGN_BOTTOM | GLW_ALIGN_HCENTER);
 	bar->SetOrientation(GLLegendBar::ORIENT_HORIZONTAL);
@@ -179,18 +183,8 @@ void CGLVectorPlot::Render(CGLContext& rc)
 	// store attributes
 	glPushAttrib(GL_ENABLE_BIT | GL_LIGHTING_BIT);
 
-	// create the cylinder object
-	glEnable(GL_LIGHTING);
-	GLUquadricObj* pglyph = gluNewQuadric();
-	gluQuadricNormals(pglyph, GLU_SMOOTH);
-
 	CGLModel* mdl = GetModel();
-	FEPostModel* ps = mdl->GetFSModel();
-
-	srand(m_seed);
-
 	FEPostModel* pfem = mdl->GetFSModel();
-	FEPostMesh* pm = mdl->GetActiveMesh();
 
 	// calculate scale factor for rendering
 	m_fscale = 0.02f*m_scale*pfem->GetBoundingBox().Radius();
@@ -223,6 +217,35 @@ void CGLVectorPlot::Render(CGLContext& rc)
 		glLightfv(GL_LIGHT0, GL_AMBIENT, dif);
 	}
 
+	// The items that are drawn depend on visibility, which can change without 
+	// this plot being updated. The glyph items are only collected again when the
+	// mesh revision changed.
+	auto collect = [this](vector<int>& items, vector<vec3f>& pos) { CollectGlyphs(items, pos); };
+	if (m_glyphs.Update(mdl->GetActiveMesh(), mdl->MeshRevision(), m_fscale, collect))
+	{
+		BuildGlyphs();
+	}
+
+	if (m_nglyph == GLYPH_LINE) m_lines.Render();
+	else m_mesh.Render();
+
+	// restore attributes
+	glPopAttrib();
+
+	glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+}
+
+void CGLVectorPlot::CollectGlyphs(vector<int>& items, vector<vec3f>& pos)
+{
+	items.clear();
+	pos.clear();
+
+	CGLModel* mdl = GetModel();
+	FEPostModel* ps = mdl->GetFSModel();
+	FEPostMesh* pm = mdl->GetActiveMesh();
+
+	srand(m_seed);
+
 	if (IS_ELEM_FIELD(m_nvec))
 	{
 		pm->TagAllElements(0);
@@ -246,15 +269,14 @@ void CGLVectorPlot::Render(CGLContext& rc)
 			}
 		}
 
-		// render the vectors at the elements' centers
+		// the vectors are drawn at the elements' centers
 		for (int i = 0; i < pm->Elements(); ++i)
 		{
 			FEElement_& elem = pm->ElementRef(i);
 			if ((frand() <= m_dens) && elem.m_ntag)
 			{
-				vec3f r = to_vec3f(pm->ElementCenter(elem));
-				vec3f v = m_val[i];
-				RenderVector(r, v, pglyph);
+				items.push_back(i);
+				pos.push_back(to_vec3f(pm->ElementCenter(elem)));
 			}
 		}
 	}
@@ -285,15 +307,14 @@ void CGLVectorPlot::Render(CGLContext& rc)
 			}
 		}
 
-		// render the vectors at the face's center
+		// the vectors are drawn at the faces' centers
 		for (int i = 0; i < pm->Faces(); ++i)
 		{
 			FSFace& face = pm->Face(i);
 			if ((frand() <= m_dens) && face.m_ntag)
 			{
-				vec3f r = to_vec3f(pm->FaceCenter(face));
-				vec3f v = m_val[i];
-				RenderVector(r, v, pglyph);
+				items.push_back(i);
+				pos.push_back(to_vec3f(pm->FaceCenter(face)));
 			}
 		}
 	}
@@ -326,102 +347,94 @@ void CGLVectorPlot::Render(CGLContext& rc)
 			FSNode& node = pm->Node(i);
 			if ((frand() <= m_dens) && node.m_ntag)
 			{
-				vec3f r = to_vec3f(node.r);
-
-				vec3f v = m_val[i];
-
-				RenderVector(r, v, pglyph);
+				items.push_back(i);
+				pos.push_back(to_vec3f(node.r));
 			}
 		}
 	}
-
-	gluDeleteQuadric(pglyph);
-
-	// restore attributes
-	glPopAttrib();
-
-	glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
 }
 
-void CGLVectorPlot::RenderVector(const vec3f& r, vec3f v, GLUquadric* pglyph)
+void CGLVectorPlot::BuildGlyphs()
 {
-	float L = v.Length();
-	if (L == 0.f) return;
+	// build the glyph template. Glyphs are defined for a vector of unit length along the z-axis.
+	GLGlyph glyph;
+	float ar = m_ar;
+	switch (m_nglyph)
+	{
+	case GLYPH_ARROW:
+		glyph.AddCylinder(0.05f*ar, 0.05f*ar, 0.f, 0.9f, 5);
+		glyph.AddCylinder(0.15f*ar, 0.f, 0.81f, 1.01f, 10);
+		break;
+	case GLYPH_CONE:
+		glyph.AddCylinder(0.15f*ar, 0.f, 0.f, 0.9f, 10);
+		break;
+	case GLYPH_CYLINDER:
+		glyph.AddCylinder(0.15f*ar, 0.15f*ar, 0.f, 0.9f, 10);
+		break;
+	case GLYPH_SPHERE:
+		glyph.AddSphere(0.15f*ar, 10, 5);
+		break;
+	case GLYPH_BOX:
+		glyph.AddBox(0.05f*ar, 0.05f*ar, 0.05f*ar);
+		break;
+	}
 
 	CColorMap& map = ColorMapManager::GetColorMap(m_Col.GetColorMap());
 
 	float fmin = m_crng.x;
 	float fmax = m_crng.y;
 
-	float f = (L - fmin) / (fmax - fmin);
-	GLColor col = map.map(f);
-	v.Normalize();
-
-	switch (m_ncol)
-	{
-	case GLYPH_COL_LENGTH:
-		glColor3ub(col.r, col.g, col.b);
-		break;
-	case GLYPH_COL_ORIENT:
+	int N = (int)m_glyphs.Glyphs();
+	if (m_nglyph == GLYPH_LINE)
 	{
-		GLdouble r = fabs(v.x);
-		GLdouble g = fabs(v.y);
-		GLdouble b = fabs(v.z);
-		glColor3d(r, g, b);
+		m_lines.Create(N, GLMesh::FLAG_COLOR);
+		m_lines.BeginMesh();
 	}
-	break;
-	case GLYPH_COL_SOLID:
-	default:
-		glColor3ub(m_gcl.r, m_gcl.g, m_gcl.b);
+	else
+	{
+		m_mesh.Create(N*glyph.Triangles(), GLMesh::FLAG_NORMAL | GLMesh::FLAG_COLOR);
+		m_mesh.BeginMesh();
 	}
 
-	if (m_bnorm) L = 1;
+	for (int i = 0; i < N; ++i)
+	{
+		vec3f v = m_val[m_glyphs.Item(i)];
+		float L = v.Length();
+		if (L == 0.f) continue;
 
-	L *= m_fscale;
-	float l0 = L*.9;
-	float l1 = L*.2;
-	float r0 = L*0.05*m_ar;
-	float r1 = L*0.15*m_ar;
+		float f = (L - fmin) / (fmax - fmin);
+		v.Normalize();
 
-	glPushMatrix();
+		GLColor col;
+		switch (m_ncol)
+		{
+		case GLYPH_COL_LENGTH: col = map.map(f); col.a = 255; break;
+		case GLYPH_COL_ORIENT: col = GLColor::FromRGBf(fabs(v.x), fabs(v.y), fabs(v.z)); break;
+		case GLYPH_COL_SOLID:
+		default:
+			col = GLColor(m_gcl.r, m_gcl.g, m_gcl.b);
+		}
 
-	glTranslatef(r.x, r.y, r.z);
-	quatd q;
-	vec3d V = to_vec3d(v);
-	if (V * vec3d(0, 0, 1) == -1.0) q = quatd(PI, vec3d(1, 0, 0));
-	else q = quatd(vec3d(0, 0, 1), to_vec3d(v));
-	float w = q.GetAngle();
-	if (fabs(w) > 1e-6)
-	{
-		vec3d p = q.GetVector();
-		if (p.Length() > 1e-6) glRotated(w * 180 / PI, p.x, p.y, p.z);
-		else glRotated(w * 180 / PI, 1, 0, 0);
-	}
+		if (m_bnorm) L = 1;
+		L *= m_fscale;
 
-	switch (m_nglyph)
-	{
-	case GLYPH_ARROW:
-		gluCylinder(pglyph, r0, r0, l0, 5, 1);
-		glTranslatef(0.f, 0.f, (float)l0*0.9f);
-		gluCylinder(pglyph, r1, 0, l1, 10, 1);
-		break;
-	case GLYPH_CONE:
-		gluCylinder(pglyph, r1, 0, l0, 10, 1);
-		break;
-	case GLYPH_CYLINDER:
-		gluCylinder(pglyph, r1, r1, l0, 10, 1);
-		break;
-	case GLYPH_SPHERE:
-		gluSphere(pglyph, r1, 10, 5);
-		break;
-	case GLYPH_BOX:
-		glx::drawBox(r0, r0, r0);
-		break;
-	case GLYPH_LINE:
-		glx::drawLine(0, 0, 0, 0, 0, L);
+		const vec3f& r = m_glyphs.Position(i);
+		if (m_nglyph == GLYPH_LINE)
+		{
+			m_lines.AddVertex(r, col);
+			m_lines.AddVertex(r + v*L, col);
+		}
+		else
+		{
+			vec3f R[3];
+			GLGlyph::RotateZTo(v, R);
+			vec3f A[3] = { R[0] * L, R[1] * L, R[2] * L };
+			glyph.AddToMesh(m_mesh, r, A, R, col);
+		}
 	}
 
-	glPopMatrix();
+	if (m_nglyph == GLYPH_LINE) m_lines.EndMesh();
+	else m_mesh.EndMesh();
 }
 
 void CGLVectorPlot::SetVectorField(int ntype) 
@@ -453,6 +466,7 @@ void CGLVectorPlot::Update(int ntime, float dt, bool breset)
 
 	m_lastTime = ntime;
 	m_lastDt = dt;
+	m_glyphs.Invalidate();
 
 	CGLModel* mdl = GetModel();
 	FEPostMesh* pm = mdl->GetActiveMesh();
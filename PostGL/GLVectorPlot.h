@@ -26,8 +26,8 @@ SOFTWARE.*/
 
 #pragma once
 #include "GLPlot.h"
-
-class GLUquadric;
+#include <GLLib/GLMesh.h>
+#include <GLLib/GLGlyph.h>
 
 namespace Post {
 
@@ -74,32 +74,32 @@ public:
 
 	void Render(CGLContext& rc) override;
 
-	void SetScaleFactor(float g) { m_scale = g; }
+	void SetScaleFactor(float g) { m_scale = g; m_glyphs.Invalidate(); }
 	double GetScaleFactor() { return m_scale; }
 
-	void SetDensity(float d) { m_dens = d; }
+	void SetDensity(float d) { m_dens = d; m_glyphs.Invalidate(); }
 	double GetDensity() { return m_dens; }
 
 	int GetVectorField() { return m_nvec; }
 	void SetVectorField(int ntype);
 
 	int GetGlyphType() { return m_nglyph; }
-	void SetGlyphType(int ntype) { m_nglyph = ntype; }
+	void SetGlyphType(int ntype) { m_nglyph = ntype; m_glyphs.Invalidate(); }
 
 	int GetColorType() { return m_ncol; }
-	void SetColorType(int ntype) { m_ncol = ntype; }
+	void SetColorType(int ntype) { m_ncol = ntype; m_glyphs.Invalidate(); }
 
 	GLColor GetGlyphColor() { return m_gcl; }
-	void SetGlyphColor(GLColor c) { m_gcl = c; }
+	void SetGlyphColor(GLColor c) { m_gcl = c; m_glyphs.Invalidate(); }
 
 	bool NormalizeVectors() { return m_bnorm; }
-	void NormalizeVectors(bool b) { m_bnorm = b; }
+	void NormalizeVectors(bool b) { m_bnorm = b; m_glyphs.Invalidate(); }
 
 	bool GetAutoScale() { return m_bautoscale; }
-	void SetAutoScale(bool b) { m_bautoscale = b; }
+	void SetAutoScale(bool b) { m_bautoscale = b; m_glyphs.Invalidate(); }
 
 	bool ShowHidden() const { return m_bshowHidden; }
-	void ShowHidden(bool b) { m_bshowHidden = b; }
+	void ShowHidden(bool b) { m_bshowHidden = b; m_glyphs.Invalidate(); }
 
 	CColorTexture* GetColorMap() { return &m_Col; }
 
@@ -114,8 +114,11 @@ public:
 	void Activate(bool b) override;
 
 private:
-	// render a vector n at position r
-	void RenderVector(const vec3f& r, vec3f v, GLUquadric* pglyph);
+	// find the items (nodes, faces, or elements) that get a glyph and their positions
+	void CollectGlyphs(vector<int>& items, vector<vec3f>& pos);
+
+	// build the glyph mesh for the current glyph items
+	void BuildGlyphs();
 
 	void UpdateState(int nstate);
 
@@ -152,5 +155,11 @@ protected:
 	vec2f			m_staticRange;
 
 	float			m_fscale;	// total scale factor for rendering
+
+	// All glyphs are batched in a single mesh, which is only rebuilt when the
+	// data, the parameters, or the set of rendered items changes.
+	GLTriMesh		m_mesh;			// glyph mesh
+	GLLineMesh		m_lines;		// glyph mesh for line glyphs
+	GLGlyphCache	m_glyphs;		// items and positions of the glyphs in the mesh
 };
 }
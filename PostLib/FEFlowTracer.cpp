@@ -0,0 +1,96 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "FEFlowTracer.h"
+#include <MeshLib/FECoreMesh.h>
+using namespace Post;
+
+//-----------------------------------------------------------------------------
+FEFlowTracer::FEFlowTracer(FSCoreMesh& mesh, FEFindElement& find) : m_mesh(mesh), m_find(find)
+{
+	m_v0 = nullptr;
+	m_v1 = nullptr;
+	m_w = 0.f;
+}
+
+//-----------------------------------------------------------------------------
+void FEFlowTracer::SetField(const std::vector<vec3f>& v)
+{
+	m_v0 = &v;
+	m_v1 = nullptr;
+	m_w = 0.f;
+}
+
+//-----------------------------------------------------------------------------
+void FEFlowTracer::SetField(const std::vector<vec3f>& v0, const std::vector<vec3f>& v1, float w)
+{
+	m_v0 = &v0;
+	m_v1 = &v1;
+	m_w = w;
+}
+
+//-----------------------------------------------------------------------------
+bool FEFlowTracer::Velocity(const vec3f& x, int& nelem, vec3f& v)
+{
+	assert(m_v0);
+	double q[3];
+	if (m_find.FindElement(x, nelem, q, nelem) == false) return false;
+
+	FEElement_& el = m_mesh.ElementRef(nelem);
+	int ne = el.Nodes();
+
+	const std::vector<vec3f>& v0 = *m_v0;
+	vec3f ve[FSElement::MAX_NODES];
+	for (int i = 0; i < ne; ++i) ve[i] = v0[el.m_node[i]];
+	v = el.eval(ve, q[0], q[1], q[2]);
+
+	if (m_v1)
+	{
+		const std::vector<vec3f>& v1 = *m_v1;
+		for (int i = 0; i < ne; ++i) ve[i] = v1[el.m_node[i]];
+		vec3f w1 = el.eval(ve, q[0], q[1], q[2]);
+		v = v*(1.f - m_w) + w1*m_w;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+float FEFlowTracer::Random(unsigned int seed, unsigned int n)
+{
+	// hash the counter with the finalizer of MurmurHash3
+	unsigned int h = n + seed * 0x9E3779B9u;
+	h ^= h >> 16;
+	h *= 0x85EBCA6Bu;
+	h ^= h >> 13;
+	h *= 0xC2B2AE35u;
+	h ^= h >> 16;
+
+	// use the upper 24 bits, which are exactly representable as a float
+	return (float)(h >> 8) / 16777215.f;
+}
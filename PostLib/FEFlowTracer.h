@@ -0,0 +1,74 @@
+/*This file is part of the FEBio Studio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio-Studio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include <FSCore/math3d.h>
+#include <MeshLib/FEFindElement.h>
+#include <vector>
+
+class FSCoreMesh;
+
+namespace Post {
+
+//-----------------------------------------------------------------------------
+// Evaluates a nodal vector field along paths through a mesh (e.g. stream lines 
+// and particle paths). A path passes the element that contained its previous 
+// point to Velocity, so that the next point is usually found by walking to a 
+// neighboring element instead of searching the octree.
+// Velocity does not modify the tracer, so it can be called concurrently, as long 
+// as each thread traces its own paths.
+class FEFlowTracer
+{
+public:
+	FEFlowTracer(FSCoreMesh& mesh, FEFindElement& find);
+
+	// set the nodal vector field
+	void SetField(const std::vector<vec3f>& v);
+
+	// set a vector field that is interpolated between two nodal fields, i.e. (1-w)*v0 + w*v1
+	void SetField(const std::vector<vec3f>& v0, const std::vector<vec3f>& v1, float w);
+
+	// Evaluate the velocity at x. On input, nelem is the element that contained the
+	// previous point of the path (or -1), on output the element that contains x.
+	// Returns false if x is not inside the mesh.
+	bool Velocity(const vec3f& x, int& nelem, vec3f& v);
+
+public:
+	// Random number in [0,1] that only depends on seed and n. Unlike rand(), this 
+	// gives the same values regardless of the number of threads and the order in
+	// which items are processed.
+	static float Random(unsigned int seed, unsigned int n);
+
+private:
+	FSCoreMesh&		m_mesh;
+	FEFindElement&	m_find;
+
+	const std::vector<vec3f>*	m_v0;
+	const std::vector<vec3f>*	m_v1;
+	float						m_w;
+};
+}
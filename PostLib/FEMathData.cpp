@@ -27,10 +27,211 @@ SOFTWARE.*/
 #include "stdafx.h"
 #include "FEMathData.h"
 #include "FEPostModel.h"
-#include <FECore/MathObject.h>
+#include "FEDataManager.h"
+#include <FSCore/MathKernel.h>
+#include <algorithm>
+#include <cctype>
 
 using namespace Post;
 
+//-----------------------------------------------------------------------------
+// the variable name of a data field
+static std::string variableName(const std::string& fieldName)
+{
+	std::string s = fieldName;
+	for (size_t i = 0; i < s.size(); ++i)
+	{
+		char c = s[i];
+		if ((isalnum((unsigned char)c) == 0) && (c != '_')) s[i] = '_';
+	}
+	return s;
+}
+
+//-----------------------------------------------------------------------------
+// true for the data fields that can be used as variables. Math data fields are 
+// skipped, so that fields cannot depend on each other.
+static bool isVariableField(ModelDataField* pd)
+{
+	return ((pd->Type() == DATA_SCALAR) &&
+		(dynamic_cast<FEMathDataField*>(pd) == nullptr) &&
+		(dynamic_cast<FEMathVec3DataField*>(pd) == nullptr) &&
+		(dynamic_cast<FEMathMat3DataField*>(pd) == nullptr));
+}
+
+FEMathEquations::FEMathEquations(FEPostModel* fem, const std::string* eq, int neq)
+{
+	m_fem = fem;
+
+	// collect the identifiers of all equations
+	std::vector<std::string> ids;
+	for (int i = 0; i < neq; ++i)
+	{
+		std::vector<std::string> idi = MathKernel::Identifiers(eq[i]);
+		ids.insert(ids.end(), idi.begin(), idi.end());
+	}
+
+	// all equations share the same variables
+	std::vector<std::string> vars = { "t", "x", "y", "z" };
+
+	// add the scalar data fields that are used in the equations
+	FEDataManager& dm = *fem->GetDataManager();
+	int nfields = dm.DataFields();
+	FEDataFieldPtr it = dm.FirstDataField();
+	for (int i = 0; i < nfields; ++i, ++it)
+	{
+		ModelDataField* pd = *it;
+		if (isVariableField(pd))
+		{
+			std::string name = variableName(pd->GetName());
+			if ((std::find(ids.begin(), ids.end(), name) != ids.end()) &&
+				(std::find(vars.begin(), vars.end(), name) == vars.end()))
+			{
+				vars.push_back(name);
+				m_field.push_back(pd->GetFieldID());
+			}
+		}
+	}
+
+	for (int i = 0; i < neq; ++i)
+	{
+		MathKernel* math = new MathKernel;
+		for (size_t j = 0; j < vars.size(); ++j) math->AddVariable(vars[j]);
+		math->Create(eq[i]);
+		m_eq.push_back(math);
+	}
+
+	m_nvar = (int)vars.size();
+}
+
+FEMathEquations::~FEMathEquations()
+{
+	for (size_t i = 0; i < m_eq.size(); ++i) delete m_eq[i];
+}
+
+//-----------------------------------------------------------------------------
+void FEMathEquations::NodeVariables(int n, FEState* state, double* v) const
+{
+	int ntime = state->GetID();
+	vec3f r = m_fem->NodePosition(n, ntime);
+	v[0] = (double)state->m_time;
+	v[1] = (double)r.x;
+	v[2] = (double)r.y;
+	v[3] = (double)r.z;
+
+	for (size_t i = 0; i < m_field.size(); ++i)
+	{
+		NODEDATA d;
+		m_fem->EvaluateNode(n, ntime, m_field[i], d);
+		v[4 + i] = (double)d.m_val;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Each thread keeps its own buffer for the variables, so that nodes can be 
+// evaluated concurrently without allocating memory for every node.
+void FEMathEquations::Eval(int n, FEState* state, double* val) const
+{
+	static thread_local std::vector<double> var;
+	var.resize(m_nvar);
+	NodeVariables(n, state, &var[0]);
+	for (size_t i = 0; i < m_eq.size(); ++i) val[i] = m_eq[i]->value(var);
+}
+
+//-----------------------------------------------------------------------------
+void FEMathEquations::EvalItems(const int* items, int count, FEState* state, double* val) const
+{
+	int neq = (int)m_eq.size();
+	std::vector<double> var(m_nvar);
+	for (int n = 0; n < count; ++n)
+	{
+		NodeVariables(items[n], state, &var[0]);
+		for (int i = 0; i < neq; ++i) val[n*neq + i] = m_eq[i]->value(var);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// The variables are collected first, since the other data fields may not support
+// concurrent evaluation. The equations are then evaluated for all nodes in parallel.
+void FEMathEquations::EvalNodes(FEState* state, std::vector<double>& val) const
+{
+	int NN = state->GetFEMesh()->Nodes();
+	int nvar = m_nvar;
+	int neq = (int)m_eq.size();
+	std::vector<double> var(NN*nvar);
+	for (int n = 0; n < NN; ++n) NodeVariables(n, state, &var[n*nvar]);
+
+	if (neq == 1) { m_eq[0]->value(NN, var, val); return; }
+
+	val.assign(NN*neq, 0.0);
+	std::vector<double> vi;
+	for (int i = 0; i < neq; ++i)
+	{
+		m_eq[i]->value(NN, var, vi);
+		for (int n = 0; n < NN; ++n) val[n*neq + i] = vi[n];
+	}
+}
+
+//=============================================================================
+FEMathFieldEquations::FEMathFieldEquations()
+{
+	m_rev = -1;
+}
+
+//-----------------------------------------------------------------------------
+void FEMathFieldEquations::Compile(FEPostModel* fem, const std::string* eq, int neq, int nrev)
+{
+	if (fem == nullptr) return;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Build(fem, eq, neq, nrev);
+}
+
+//-----------------------------------------------------------------------------
+std::shared_ptr<const FEMathEquations> FEMathFieldEquations::Get(FEPostModel* fem, const std::string* eq, int neq, int nrev)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!IsValid(fem, nrev)) Build(fem, eq, neq, nrev);
+	return m_eq;
+}
+
+//-----------------------------------------------------------------------------
+// The equations reference data fields by their names and use them by their field IDs,
+// so both must still be the same.
+bool FEMathFieldEquations::IsValid(FEPostModel* fem, int nrev) const
+{
+	if ((m_eq == nullptr) || (nrev != m_rev)) return false;
+
+	FEDataManager& dm = *fem->GetDataManager();
+	int nfields = dm.DataFields();
+	if (nfields != (int)m_names.size()) return false;
+
+	FEDataFieldPtr it = dm.FirstDataField();
+	for (int i = 0; i < nfields; ++i, ++it)
+	{
+		ModelDataField* pd = *it;
+		if ((pd->GetFieldID() != m_ids[i]) || (pd->GetName() != m_names[i])) return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void FEMathFieldEquations::Build(FEPostModel* fem, const std::string* eq, int neq, int nrev)
+{
+	m_eq = std::make_shared<const FEMathEquations>(fem, eq, neq);
+	m_rev = nrev;
+
+	FEDataManager& dm = *fem->GetDataManager();
+	int nfields = dm.DataFields();
+	m_names.resize(nfields);
+	m_ids.resize(nfields);
+	FEDataFieldPtr it = dm.FirstDataField();
+	for (int i = 0; i < nfields; ++i, ++it)
+	{
+		m_names[i] = (*it)->GetName();
+		m_ids[i] = (*it)->GetFieldID();
+	}
+}
+
+//=============================================================================
 FEMathData::FEMathData(FEState* state, FEMathDataField* pdf) : FENodeData_T<float>(state, pdf)
 {
 	m_pdf = pdf;
@@ -39,21 +240,26 @@ FEMathData::FEMathData(FEState* state, FEMathDataField* pdf) : FENodeData_T<floa
 // evaluate all the nodal data for this state
 void FEMathData::eval(int n, float* pv)
 {
-	double time = m_state->m_time;
-	MSimpleExpression math;
-	math.AddVariable("t", time);
-
-	FEPostModel& fem = *GetFSModel();
-	vec3f r = fem.NodePosition(n, m_state->GetID());
-	math.AddVariable("x", (double)r.x);
-	math.AddVariable("y", (double)r.y);
-	math.AddVariable("z", (double)r.z);
+	double v = 0.0;
+	m_pdf->Equations()->Eval(n, m_state, &v);
+	if (pv) *pv = (float) v;
+}
 
-	const std::string& eq = m_pdf->EquationString();
-	math.Create(eq);
+// evaluate the data for all nodes of this state
+void FEMathData::evalNodes(std::vector<float>& v)
+{
+	std::vector<double> val;
+	m_pdf->Equations()->EvalNodes(m_state, val);
+	v.resize(val.size());
+	for (size_t i = 0; i < val.size(); ++i) v[i] = (float)val[i];
+}
 
-	double v = math.value();
-	if (pv) *pv = (float) v;
+// evaluate the data for a list of nodes of this state
+void FEMathData::evalItems(const int* items, int count, float* v)
+{
+	std::vector<double> val(count);
+	m_pdf->Equations()->EvalItems(items, count, m_state, val.data());
+	for (int i = 0; i < count; ++i) v[i] = (float)val[i];
 }
 
 FEMathVec3Data::FEMathVec3Data(FEState* state, FEMathVec3DataField* pdf) : FENodeData_T<vec3f>(state, pdf)
@@ -64,29 +270,32 @@ FEMathVec3Data::FEMathVec3Data(FEState* state, FEMathVec3DataField* pdf) : FENod
 // evaluate all the nodal data for this state
 void FEMathVec3Data::eval(int n, vec3f* pv)
 {
-	FEState& state = *m_state;
-	int ntime = state.GetID();
-	double time = (double)state.m_time;
-
-	MSimpleExpression math;
-	math.AddVariable("t", time);
-
-	FEPostModel& fem = *GetFSModel();
-	vec3f r = fem.NodePosition(n, ntime);
-	math.AddVariable("x", (double)r.x);
-	math.AddVariable("y", (double)r.y);
-	math.AddVariable("z", (double)r.z);
+	double v[3] = { 0.0 };
+	m_pdf->Equations()->Eval(n, m_state, v);
+	if (pv) *pv = vec3f((float)v[0], (float)v[1], (float)v[2]);
+}
 
-	const std::string& x = m_pdf->EquationString(0);
-	const std::string& y = m_pdf->EquationString(1);
-	const std::string& z = m_pdf->EquationString(2);
+static vec3f toVec3f(const double* v)
+{
+	return vec3f((float)v[0], (float)v[1], (float)v[2]);
+}
 
-	vec3f v;
-	v.x = (float)math.value(x);
-	v.y = (float)math.value(y);
-	v.z = (float)math.value(z);
+// evaluate the data for all nodes of this state
+void FEMathVec3Data::evalNodes(std::vector<vec3f>& v)
+{
+	std::vector<double> val;
+	m_pdf->Equations()->EvalNodes(m_state, val);
+	int NN = (int)val.size() / 3;
+	v.resize(NN);
+	for (int i = 0; i < NN; ++i) v[i] = toVec3f(&val[3*i]);
+}
 
-	if (pv) *pv = v;
+// evaluate the data for a list of nodes of this state
+void FEMathVec3Data::evalItems(const int* items, int count, vec3f* v)
+{
+	std::vector<double> val(3*count);
+	m_pdf->Equations()->EvalItems(items, count, m_state, val.data());
+	for (int i = 0; i < count; ++i) v[i] = toVec3f(&val[3*i]);
 }
 
 FEMathMat3Data::FEMathMat3Data(FEState* state, FEMathMat3DataField* pdf) : FENodeData_T<mat3f>(state, pdf)
@@ -94,29 +303,36 @@ FEMathMat3Data::FEMathMat3Data(FEState* state, FEMathMat3DataField* pdf) : FENod
 	m_pdf = pdf;
 }
 
+static mat3f toMat3f(const double* m)
+{
+	return mat3f((float)m[0], (float)m[1], (float)m[2], (float)m[3], (float)m[4], (float)m[5], (float)m[6], (float)m[7], (float)m[8]);
+}
+
 // evaluate the nodal data for this state
 void FEMathMat3Data::eval(int n, mat3f* pv)
 {
 	if (pv == nullptr) return;
 
-	FEState& state = *m_state;
-	int ntime = state.GetID();
-	double time = (double)state.m_time;
-	MSimpleExpression math;
-	math.AddVariable("t", time);
+	double m[9] = { 0.0 };
+	m_pdf->Equations()->Eval(n, m_state, m);
 
-	FEPostModel& fem = *GetFSModel();
-	vec3f r = fem.NodePosition(n, ntime);
-	math.AddVariable("x", (double)r.x);
-	math.AddVariable("y", (double)r.y);
-	math.AddVariable("z", (double)r.z);
+	*pv = toMat3f(m);
+}
 
-	float m[9] = { 0.f };
-	for (int i = 0; i < 9; ++i)
-	{
-		const std::string& eq = m_pdf->EquationString(i);
-		m[i] = (float) math.value(eq);
-	}
+// evaluate the data for all nodes of this state
+void FEMathMat3Data::evalNodes(std::vector<mat3f>& v)
+{
+	std::vector<double> val;
+	m_pdf->Equations()->EvalNodes(m_state, val);
+	int NN = (int)val.size() / 9;
+	v.resize(NN);
+	for (int i = 0; i < NN; ++i) v[i] = toMat3f(&val[9*i]);
+}
 
-	*pv = mat3f(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8]);
+// evaluate the data for a list of nodes of this state
+void FEMathMat3Data::evalItems(const int* items, int count, mat3f* v)
+{
+	std::vector<double> val(9*count);
+	m_pdf->Equations()->EvalItems(items, count, m_state, val.data());
+	for (int i = 0; i < count; ++i) v[i] = toMat3f(&val[9*i]);
 }
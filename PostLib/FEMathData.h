@@ -26,6 +26,10 @@ SOFTWARE.*/
 
 #pragma once
 #include "FEMeshData_T.h"
+#include <memory>
+#include <mutex>
+
+class MathKernel;
 
 namespace Post {
 
@@ -33,6 +37,73 @@ class FEMathDataField;
 class FEMathVec3DataField;
 class FEMathMat3DataField;
 
+//-----------------------------------------------------------------------------
+// The compiled equations of a math data field. Besides the time (t) and the nodal 
+// coordinates (x, y, z), the equations can use the nodal values of the model's other
+// scalar data fields. The variable name of a data field is its name, with all 
+// characters other than letters, digits and '_' replaced by '_'.
+// Compiled equations are not modified, so they can be evaluated concurrently.
+class FEMathEquations
+{
+public:
+	FEMathEquations(FEPostModel* fem, const std::string* eq, int neq);
+	~FEMathEquations();
+
+	int Equations() const { return (int)m_eq.size(); }
+
+	// evaluate all the equations at node n of a state
+	void Eval(int n, FEState* state, double* val) const;
+
+	// evaluate all the equations at a list of nodes of a state. 
+	// The values of the i-th node are stored at val[i*Equations()].
+	void EvalItems(const int* items, int count, FEState* state, double* val) const;
+
+	// evaluate all the equations at all the nodes of a state. 
+	// The values of node n are stored at val[n*Equations()].
+	void EvalNodes(FEState* state, std::vector<double>& val) const;
+
+private:
+	// set the values of the variables at node n
+	void NodeVariables(int n, FEState* state, double* v) const;
+
+private:
+	FEPostModel*				m_fem;
+	std::vector<MathKernel*>	m_eq;		// the compiled equations
+	std::vector<int>			m_field;	// IDs of the data fields that are used as variables
+	int							m_nvar;		// number of variables
+
+	FEMathEquations(const FEMathEquations&) = delete;
+	void operator = (const FEMathEquations&) = delete;
+};
+
+//-----------------------------------------------------------------------------
+// Keeps the compiled equations of a math data field. The equations are compiled 
+// when they are set and again when the model's data fields were added, deleted or 
+// renamed. Evaluations hold on to the equations they started with, so that a 
+// recompilation does not affect evaluations that are in progress.
+class FEMathFieldEquations
+{
+public:
+	FEMathFieldEquations();
+
+	// compile the equations of revision nrev
+	void Compile(FEPostModel* fem, const std::string* eq, int neq, int nrev);
+
+	// the compiled equations. These are compiled again if the data fields changed.
+	std::shared_ptr<const FEMathEquations> Get(FEPostModel* fem, const std::string* eq, int neq, int nrev);
+
+private:
+	bool IsValid(FEPostModel* fem, int nrev) const;
+	void Build(FEPostModel* fem, const std::string* eq, int neq, int nrev);
+
+private:
+	std::mutex	m_mutex;
+	std::shared_ptr<const FEMathEquations>	m_eq;
+	int							m_rev;		// revision of the equations that were compiled
+	std::vector<std::string>	m_names;	// names of the data fields when the equations were compiled
+	std::vector<int>			m_ids;		// IDs of the data fields when the equations were compiled
+};
+
 class FEMathData : public FENodeData_T<float>
 {
 public:
@@ -41,6 +112,12 @@ public:
 	// evaluate the nodal data for this state
 	void eval(int n, float* pv) override;
 
+	// evaluate the data for all the nodes of this state
+	void evalNodes(std::vector<float>& v);
+
+	// evaluate the data for a list of nodes of this state
+	void evalItems(const int* items, int count, float* v);
+
 private:
 	FEMathDataField*	m_pdf;
 };
@@ -53,6 +130,12 @@ public:
 	// evaluate the nodal data for this state
 	void eval(int n, vec3f* pv) override;
 
+	// evaluate the data for all the nodes of this state
+	void evalNodes(std::vector<vec3f>& v);
+
+	// evaluate the data for a list of nodes of this state
+	void evalItems(const int* items, int count, vec3f* v);
+
 private:
 	FEMathVec3DataField*	m_pdf;
 };
@@ -65,6 +148,12 @@ public:
 	// evaluate the nodal data for this state
 	void eval(int n, mat3f* pv) override;
 
+	// evaluate the data for all the nodes of this state
+	void evalNodes(std::vector<mat3f>& v);
+
+	// evaluate the data for a list of nodes of this state
+	void evalItems(const int* items, int count, mat3f* v);
+
 private:
 	FEMathMat3DataField*	m_pdf;
 };
@@ -75,6 +164,7 @@ public:
 	FEMathDataField(Post::FEPostModel* fem, unsigned int flag = 0) : ModelDataField(fem, DATA_SCALAR, DATA_NODE, NODE_DATA, flag)
 	{
 		m_eq = "";
+		m_rev = 0;
 	}
 
 	//! Create a copy
@@ -91,12 +181,17 @@ public:
 		return new FEMathData(pstate, this);
 	}
 
-	void SetEquationString(const std::string& eq) { m_eq = eq; }
+	void SetEquationString(const std::string& eq) { m_eq = eq; m_rev++; m_math.Compile(m_fem, &m_eq, 1, m_rev); }
 
 	const std::string& EquationString() const { return m_eq; }
 
+	//! the compiled equation
+	std::shared_ptr<const FEMathEquations> Equations() { return m_math.Get(m_fem, &m_eq, 1, m_rev); }
+
 private:
 	std::string	m_eq;		//!< equation string
+	int			m_rev;		//!< revision of equation string
+	FEMathFieldEquations	m_math;	//!< compiled equation
 };
 
 class FEMathVec3DataField : public ModelDataField
@@ -107,6 +202,7 @@ public:
 		m_eq[0] = "";
 		m_eq[1] = "";
 		m_eq[2] = "";
+		m_rev = 0;
 	}
 
 	//! Create a copy
@@ -130,14 +226,21 @@ public:
 		m_eq[0] = x; 
 		m_eq[1] = y;
 		m_eq[2] = z;
+		m_rev++;
+		m_math.Compile(m_fem, m_eq, 3, m_rev);
 	}
 
-	void SetEquationString(int n, const std::string& eq) { m_eq[n] = eq; }
+	void SetEquationString(int n, const std::string& eq) { m_eq[n] = eq; m_rev++; m_math.Compile(m_fem, m_eq, 3, m_rev); }
 
 	const std::string& EquationString(int n) const { return m_eq[n]; }
 
+	//! the compiled equations
+	std::shared_ptr<const FEMathEquations> Equations() { return m_math.Get(m_fem, m_eq, 3, m_rev); }
+
 private:
 	std::string	m_eq[3];		//!< equation string
+	int			m_rev;			//!< revision of equation strings
+	FEMathFieldEquations	m_math;		//!< compiled equations
 };
 
 class FEMathMat3DataField : public ModelDataField
@@ -145,6 +248,7 @@ class FEMathMat3DataField : public ModelDataField
 public:
 	FEMathMat3DataField(Post::FEPostModel* fem, unsigned int flag = 0) : ModelDataField(fem, DATA_MAT3, DATA_NODE, NODE_DATA, flag)
 	{
+		m_rev = 0;
 	}
 
 	//! Create a copy
@@ -169,13 +273,20 @@ public:
 		m_eq[0] = m00; m_eq[1] = m01; m_eq[2] = m02;
 		m_eq[3] = m10; m_eq[4] = m11; m_eq[5] = m12;
 		m_eq[6] = m20; m_eq[7] = m21; m_eq[8] = m22;
+		m_rev++;
+		m_math.Compile(m_fem, m_eq, 9, m_rev);
 	}
 
-	void SetEquationString(int n, const std::string& eq) { m_eq[n] = eq; }
+	void SetEquationString(int n, const std::string& eq) { m_eq[n] = eq; m_rev++; m_math.Compile(m_fem, m_eq, 9, m_rev); }
 
 	const std::string& EquationString(int n) const { return m_eq[n]; }
 
+	//! the compiled equations
+	std::shared_ptr<const FEMathEquations> Equations() { return m_math.Get(m_fem, m_eq, 9, m_rev); }
+
 private:
 	std::string	m_eq[9];		//!< equation string
+	int			m_rev;			//!< revision of equation strings
+	FEMathFieldEquations	m_math;		//!< compiled equations
 };
 }
@@ -1433,7 +1433,7 @@ void Curvature::level(int n, int l, set<int>& nl1)
 		for (it = nl1.begin(); it != nl1.end(); ++it)
 		{
 			// get the node-face list
-			const vector<NodeFaceRef>& nfl = pmesh->NodeFaceList(*it);
+			NodeFaceRefList nfl = pmesh->NodeFaceList(*it);
 			int NF = nfl.size();
 
 			// add the other nodes
@@ -1452,7 +1452,7 @@ void Curvature::level(int n, int l, set<int>& nl1)
 		for (it = nl1.begin(); it != nl1.end(); ++it)
 		{
 			// get the node-face list
-			const vector<NodeFaceRef>& nfl = pmesh->NodeFaceList(*it);
+			NodeFaceRefList nfl = pmesh->NodeFaceList(*it);
 			int NF = nfl.size();
 
 			// add the other nodes
@@ -1511,7 +1511,7 @@ float Curvature::nodal_curvature(int n, int measure)
 	vec3f r0 = pfem->NodePosition(n, ntime);
 
 	// get the node-face list
-	const vector<NodeFaceRef>& nfl = pmesh->NodeFaceList(n);
+	NodeFaceRefList nfl = pmesh->NodeFaceList(n);
 	int NF = nfl.size();
 
 	// estimate surface normal
@@ -1576,7 +1576,7 @@ void PrincCurvatureVector::level(int n, int l, set<int>& nl1)
 		for (it = nl1.begin(); it != nl1.end(); ++it)
 		{
 			// get the node-face list
-			const vector<NodeFaceRef>& nfl = pmesh->NodeFaceList(*it);
+			NodeFaceRefList nfl = pmesh->NodeFaceList(*it);
 			int NF = nfl.size();
 
 			// add the other nodes
@@ -1595,7 +1595,7 @@ void PrincCurvatureVector::level(int n, int l, set<int>& nl1)
 		for (it = nl1.begin(); it != nl1.end(); ++it)
 		{
 			// get the node-face list
-			const vector<NodeFaceRef>& nfl = pmesh->NodeFaceList(*it);
+			NodeFaceRefList nfl = pmesh->NodeFaceList(*it);
 			int NF = nfl.size();
 
 			// add the other nodes
@@ -1654,7 +1654,7 @@ vec3f PrincCurvatureVector::nodal_curvature(int n, int m)
 	vec3f r0 = pfem->NodePosition(n, ntime);
 
 	// get the node-face list
-	const vector<NodeFaceRef>& nfl = pmesh->NodeFaceList(n);
+	NodeFaceRefList nfl = pmesh->NodeFaceList(n);
 	int NF = nfl.size();
 
 	// estimate surface normal
@@ -255,7 +255,7 @@ float FEPointCongruency::nodal_curvature(int nid, vec3f& sn, int m)
 	vec3f r0 = to_vec3f(pm->Node(nid).pos());
 
 	// get the node-face list
-	const vector<NodeFaceRef>& nfl = m_NFL.FaceList(nid);
+	NodeFaceRefList nfl = m_NFL.FaceList(nid);
 	int NF = nfl.size();
 
 	// array of nodal points
@@ -497,7 +497,7 @@ void FEPointCongruency::level(int n, int l, set<int>& nl1)
 		for (it = nl1.begin(); it != nl1.end(); ++it)
 		{
 			// get the node-face list
-			const vector<NodeFaceRef>& nfl = m_NFL.FaceList(*it);
+			NodeFaceRefList nfl = m_NFL.FaceList(*it);
 			int NF = nfl.size();
 
 			// add the other nodes
@@ -513,7 +513,7 @@ void FEPointCongruency::level(int n, int l, set<int>& nl1)
 		for (it = nl1.begin(); it != nl1.end(); ++it)
 		{
 			// get the node-face list
-			const vector<NodeFaceRef>& nfl = m_NFL.FaceList(*it);
+			NodeFaceRefList nfl = m_NFL.FaceList(*it);
 			int NF = nfl.size();
 
 			// add the other nodes
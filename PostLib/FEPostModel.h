@@ -226,6 +226,13 @@ public:
 	// evaluate based on point
 	void EvaluateNode(const vec3f& r, int ntime, int nfield, NODEDATA& d);
 
+	// evaluate the time history of a scalar field for a list of items over the states [nmin, nmax].
+	// The item type is one of the HistoryItem values. The result is a (states x items) matrix that is
+	// stored state-major, i.e. the value of item i at state n is vals[(n - nmin)*items.size() + i].
+	// Returns the number of states that were evaluated.
+	enum HistoryItem { NODE_HISTORY, EDGE_HISTORY, FACE_HISTORY, ELEM_HISTORY };
+	int EvaluateHistory(int itemType, const std::vector<int>& items, int nfield, int nmin, int nmax, std::vector<float>& vals);
+
 	// evaluate vector functions
 	vec3f EvaluateNodeVector(int n, int ntime, int nvec);
 	bool EvaluateFaceVector(int n, int ntime, int nvec, vec3f& r);
@@ -288,6 +295,9 @@ protected:
 	void EvalNodeField(int ntime, int nfield);
 	void EvalFaceField(int ntime, int nfield);
 	void EvalElemField(int ntime, int nfield);
+
+	// evaluate the nodal values of a field for a list of nodes at one state
+	void EvalNodeValues(int ntime, int nfield, const int* items, int count, float* vals);
 	
 protected:
 	string	m_name;		// name (as displayed in model viewer)
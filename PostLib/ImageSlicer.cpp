@@ -39,10 +39,35 @@ SOFTWARE.*/
 #include <ImageLib/ImageModel.h>
 #include <assert.h>
 #include <sstream>
+#include <cstring>
+#include <limits>
+#include <type_traits>
 
 using std::stringstream;
 using namespace Post;
 
+// limits of the cache of colorized slices
+static const size_t MAX_CACHED_SLICES = 8;
+static const size_t MAX_SLICE_CACHE_BYTES = (size_t)256 * 1024 * 1024;
+
+// the LUT index of an intensity value
+static inline int lutIndex(double v, double min, double max)
+{
+	if (max <= min) return 0;
+	double f = 255*(v - min)/(max - min);
+	if (f <= 0.0) return 0;
+	if (f >= 255.0) return 255;
+	return (int)f;
+}
+
+static inline uint32_t packRGBA(int r, int g, int b, int a)
+{
+	uint8_t c[4] = { (uint8_t)r, (uint8_t)g, (uint8_t)b, (uint8_t)a };
+	uint32_t v;
+	memcpy(&v, c, 4);
+	return v;
+}
+
 
 CImageSlicer::CImageSlicer(CImageModel* img) : m_imageSlice(nullptr), CGLImageRenderer(img)
 {
@@ -61,6 +86,13 @@ CImageSlicer::CImageSlicer(CImageModel* img) : m_imageSlice(nullptr), CGLImageRe
 	m_texID = 0;
 	m_reloadTexture = true;
 
+	memset(m_LUTC, 0, sizeof(m_LUTC));
+	m_lutVersion = 0;
+	m_min = 0.0; m_max = 1.0;
+	m_rangeValid = false;
+	m_tableVersion = 0;
+	m_tableType = -1;
+
 	UpdateData(false);
 }
 
@@ -109,62 +141,157 @@ void CImageSlicer::Create()
 
 void CImageSlicer::Update()
 {
+	// the image may have changed, so the cached slices can't be used
+	m_sliceCache.clear();
+	m_rangeValid = false;
+
 	UpdateData();
 	UpdateSlice();
 }
 
-template<class pType> void CImageSlicer::CreateCRGBAImage(CImage& slice)
+void CImageSlicer::UpdateRange()
 {
-    auto imgModel = GetImageModel();
+	double min = 0.0, max = 1.0;
+	C3DImage* im3d = GetImageModel()->Get3DImage();
+	if (im3d) im3d->GetMinMax(min, max);
+
+	// The image settings panel isn't available in the post view, so the full range is used
+	if ((min != m_min) || (max != m_max)) m_lutVersion++;
+	m_min = min;
+	m_max = max;
+	m_rangeValid = true;
+}
 
-    size_t N  = slice.Width() * slice.Height();
-    if(slice.IsRGB())
-    {
-        N *= 3;
-    }
+// Builds the lookup tables that map every value of an 8- or 16-bit pixel type 
+// directly to its color (or LUT index), combining the intensity window and the LUT.
+template<class pType> void CImageSlicer::BuildWindowTables()
+{
+	typedef typename std::make_unsigned<pType>::type uType;
+	const size_t N = (size_t)std::numeric_limits<uType>::max() + 1;
 
-    pType* imgData = (pType*)imgModel->Get3DImage()->GetBytes();
+	int pixelType = GetImageModel()->Get3DImage()->PixelType();
+	if ((m_tableVersion == m_lutVersion) && (m_tableType == pixelType) && (m_index.size() == N)) return;
 
-    double min, max;
-    imgModel->Get3DImage()->GetMinMax(min, max);
+	m_index.resize(N);
+	m_rgba.resize(N);
+	for (size_t u = 0; u < N; ++u)
+	{
+		pType v = (pType)(uType)u;
+		int val = lutIndex((double)v, m_min, m_max);
+		m_index[u] = (uint8_t)val;
+		m_rgba[u] = packRGBA(m_LUTC[0][val], m_LUTC[1][val], m_LUTC[2][val], m_LUTC[3][val]);
+	}
 
-    // The Image settings panel isn't available in the post view
-    // double minThresh = m_imgModel->GetViewSettings()->GetFloatValue(CImageViewSettings::MIN_INTENSITY);
-    // double maxThresh = m_imgModel->GetViewSettings()->GetFloatValue(CImageViewSettings::MAX_INTENSITY);
+	m_tableVersion = m_lutVersion;
+	m_tableType = pixelType;
+}
 
+template<class pType> void CImageSlicer::CreateCRGBAImage(CImage& slice)
+{
 	// create the 2D image
 	m_im.Create(slice.Width(), slice.Height());
 
-	// colorize the image
-	pType* ps = (pType*)slice.GetBytes();
+	const int N = slice.Width() * slice.Height();
+	const double min = m_min, max = m_max;
 	uint8_t* pd = m_im.GetBytes();
 
-    if(slice.IsRGB())
-    {
-        for (int i = 0; i<N; i++, ps+=3, pd += 4)
-        {
-            int val1 = 255*(((double)ps[0])-min)/(max-min);
-            int val2 = 255*(((double)ps[1])-min)/(max-min);
-            int val3 = 255*(((double)ps[2])-min)/(max-min);
-
-            pd[0] = m_LUTC[0][val1];
-            pd[1] = m_LUTC[1][val2];
-            pd[2] = m_LUTC[2][val3];
-            pd[3] = m_LUTC[3][255];
-        }
-    }
-    else
-    {
-        for (int i = 0; i<N; i++, ps++, pd += 4)
-        {
-            int val = 255*(((double)*ps)-min)/(max-min);
-            pd[0] = m_LUTC[0][val];
-            pd[1] = m_LUTC[1][val];
-            pd[2] = m_LUTC[2][val];
-            pd[3] = m_LUTC[3][val];
-        }
-    }
-	
+	if constexpr (std::numeric_limits<pType>::is_integer && (sizeof(pType) <= 2))
+	{
+		// 8- and 16-bit data is mapped through the windowed tables
+		BuildWindowTables<pType>();
+
+		typedef typename std::make_unsigned<pType>::type uType;
+		const uType* ps = (const uType*)slice.GetBytes();
+
+		if (slice.IsRGB())
+		{
+			const uint8_t* index = m_index.data();
+			const int a = m_LUTC[3][255];
+
+			#pragma omp parallel for
+			for (int i = 0; i < N; i++)
+			{
+				const uType* p = ps + 3 * i;
+				uint8_t* d = pd + 4 * i;
+				d[0] = m_LUTC[0][index[p[0]]];
+				d[1] = m_LUTC[1][index[p[1]]];
+				d[2] = m_LUTC[2][index[p[2]]];
+				d[3] = a;
+			}
+		}
+		else
+		{
+			const uint32_t* rgba = m_rgba.data();
+			uint32_t* pd32 = (uint32_t*)pd;
+
+			#pragma omp parallel for
+			for (int i = 0; i < N; i++) pd32[i] = rgba[ps[i]];
+		}
+	}
+	else
+	{
+		// other types are mapped pixel by pixel
+		const pType* ps = (const pType*)slice.GetBytes();
+
+		if (slice.IsRGB())
+		{
+			#pragma omp parallel for
+			for (int i = 0; i < N; i++)
+			{
+				const pType* p = ps + 3 * i;
+				uint8_t* d = pd + 4 * i;
+				d[0] = m_LUTC[0][lutIndex((double)p[0], min, max)];
+				d[1] = m_LUTC[1][lutIndex((double)p[1], min, max)];
+				d[2] = m_LUTC[2][lutIndex((double)p[2], min, max)];
+				d[3] = m_LUTC[3][255];
+			}
+		}
+		else
+		{
+			#pragma omp parallel for
+			for (int i = 0; i < N; i++)
+			{
+				int val = lutIndex((double)ps[i], min, max);
+				uint8_t* d = pd + 4 * i;
+				d[0] = m_LUTC[0][val];
+				d[1] = m_LUTC[1][val];
+				d[2] = m_LUTC[2][val];
+				d[3] = m_LUTC[3][val];
+			}
+		}
+	}
+}
+
+bool CImageSlicer::FindCachedSlice(int orient, double offset)
+{
+	for (auto it = m_sliceCache.begin(); it != m_sliceCache.end(); ++it)
+	{
+		if ((it->orient == orient) && (it->offset == offset) && (it->version == m_lutVersion))
+		{
+			// move it to the front
+			m_sliceCache.splice(m_sliceCache.begin(), m_sliceCache, it);
+			m_im = m_sliceCache.front().im;
+			return true;
+		}
+	}
+	return false;
+}
+
+void CImageSlicer::CacheSlice(int orient, double offset)
+{
+	// slices that were colorized with an older LUT can't be used anymore
+	m_sliceCache.remove_if([=](const SLICE& s) { return s.version != m_lutVersion; });
+
+	m_sliceCache.push_front(SLICE());
+	SLICE& s = m_sliceCache.front();
+	s.orient = orient;
+	s.offset = offset;
+	s.version = m_lutVersion;
+	s.im = m_im;
+
+	size_t sliceBytes = (size_t)m_im.Width() * (size_t)m_im.Height() * 4;
+	while (!m_sliceCache.empty() && ((m_sliceCache.size() > MAX_CACHED_SLICES) || (m_sliceCache.size() * sliceBytes > MAX_SLICE_CACHE_BYTES)))
+		m_sliceCache.pop_back();
 }
 
 void CImageSlicer::UpdateSlice()
@@ -173,6 +300,7 @@ void CImageSlicer::UpdateSlice()
 
     // build the looktp table
 	BuildLUT();
+	if (m_rangeValid == false) UpdateRange();
 
 	int nop = GetOrientation();
 	double off = GetOffset();
@@ -229,17 +357,26 @@ void CImageSlicer::UpdateSlice()
             nop = 2;
         }
 
+        // see if we colorized this slice recently
+        if (FindCachedSlice(nop, off))
+        {
+            m_reloadTexture = true;
+            return;
+        }
+
+        m_reslicer.SetImage(&im3d);
+
         CImage slice;
         switch (nop)
         {
         case 0: // X
-            im3d.GetSampledSliceX(slice, off);
+            m_reslicer.GetSliceX(slice, off);
             break;
         case 1: // Y
-            im3d.GetSampledSliceY(slice, off);
+            m_reslicer.GetSliceY(slice, off);
             break;
         case 2: // Z
-            im3d.GetSampledSliceZ(slice, off);
+            m_reslicer.GetSliceZ(slice, off);
             break;
         default:
             assert(false);
@@ -286,6 +423,8 @@ void CImageSlicer::UpdateSlice()
         default:
             assert(false);
         }
+
+        CacheSlice(nop, off);
     }
 
 	m_reloadTexture = true;
@@ -301,14 +440,22 @@ void CImageSlicer::BuildLUT()
 	uint8_t a = uint8_t(255.f * f);
 
 	// build the LUT
+	int lut[4][256];
 	for (int i = 0; i<256; ++i)
 	{
 		float w = (float)i / 255.f;
 		GLColor c = map.map(w);
-		m_LUTC[0][i] = c.r;
-		m_LUTC[1][i] = c.g;
-		m_LUTC[2][i] = c.b;
-		m_LUTC[3][i] = a;
+		lut[0][i] = c.r;
+		lut[1][i] = c.g;
+		lut[2][i] = c.b;
+		lut[3][i] = a;
+	}
+
+	// the colorized slices and tables are only rebuilt when the LUT changed
+	if (memcmp(lut, m_LUTC, sizeof(lut)) != 0)
+	{
+		memcpy(m_LUTC, lut, sizeof(lut));
+		m_lutVersion++;
 	}
 }
 
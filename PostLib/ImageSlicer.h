@@ -29,7 +29,10 @@ SOFTWARE.*/
 #include <FSCore/box.h>
 #include "GLImageRenderer.h"
 #include <ImageLib/RGBAImage.h>
+#include <ImageLib/ImageReslicer.h>
 #include "ColorMap.h"
+#include <vector>
+#include <list>
 
 class CImageModel;
 class CImage;
@@ -68,16 +71,48 @@ private:
 
 	void UpdateSlice();
 
+	void UpdateRange();
+
     template<class pType>
     void CreateCRGBAImage(CImage& slice);
 
+    template<class pType>
+    void BuildWindowTables();
+
+	bool FindCachedSlice(int orient, double offset);
+	void CacheSlice(int orient, double offset);
+
 private:
 	CRGBAImage		m_im;	// 2D image that will be displayed
 	int				m_LUTC[4][256];	// color lookup table
+	unsigned int	m_lutVersion;	// incremented when the LUT or the intensity range changes
 	bool			m_reloadTexture;
 
     CImage* m_imageSlice; // optional slice of image to be rendered instead of the calculated slice
 
+	CImageReslicer	m_reslicer;	// samples the slices of the 3D image
+
+	// intensity range of the 3D image
+	double	m_min, m_max;
+	bool	m_rangeValid;
+
+	// Windowed lookup tables for 8- and 16-bit images, indexed by the pixel value.
+	// m_rgba holds the (packed) colors of gray scale pixels, and m_index the LUT index of RGB channels.
+	std::vector<uint32_t>	m_rgba;
+	std::vector<uint8_t>	m_index;
+	unsigned int			m_tableVersion;	// LUT version the tables were built for
+	int						m_tableType;	// pixel type the tables were built for
+
+	// recently colorized slices
+	struct SLICE
+	{
+		int				orient;
+		double			offset;
+		unsigned int	version;
+		CRGBAImage		im;
+	};
+	std::list<SLICE>	m_sliceCache;
+
 	Post::CColorTexture	m_Col;
 
 	unsigned int m_texID;
@@ -53,6 +53,9 @@ extern int ET_HEX[12][2];
 extern int LUT2D_tri[16][9];
 extern int ET2D[4][2];
 
+// the maximum memory that is used for the precomputed gradient of the smooth surface
+static const size_t MAX_GRADIENT_MEMORY = (size_t)2 * 1024 * 1024 * 1024;
+
 TriMesh::TriMesh()
 {
 }
@@ -105,6 +108,7 @@ CMarchingCubes::CMarchingCubes(CImageModel* img) : CGLImageRenderer(img)
 	m_col = GLColor(200, 185, 185);
 	m_spc = GLColor(85, 85, 85);
 	m_shininess = 0.25;
+	m_grad = nullptr;
 
     m_del8BitImage = true;
     switch (GetImageModel()->Get3DImage()->PixelType())
@@ -160,6 +164,7 @@ CMarchingCubes::CMarchingCubes(CImageModel* img) : CGLImageRenderer(img)
 
 CMarchingCubes::~CMarchingCubes()
 {
+	delete m_grad;
     if(m_del8BitImage)
     {
         delete m_8bitImage;
@@ -254,7 +259,21 @@ void CMarchingCubes::CreateSurface()
 	float fref = (float)ref;
 	m_ref = ref;
 
-	C3DGradientMap grad(im3d, b);
+	// The gradient does not depend on the iso-value, so it is precomputed once and reused
+	// when the surface is rebuilt. The 8-bit image's gradient is stored as 16-bit integers, 
+	// unless that requires too much memory, in which case it is calculated on the fly.
+	if (m_bsmooth)
+	{
+		if (m_grad == nullptr)
+		{
+			size_t voxels = (size_t)NX * (size_t)NY * (size_t)NZ;
+			int storage = (voxels * 3 * sizeof(int16_t) <= MAX_GRADIENT_MEMORY ? C3DGradientMap::INT16 : C3DGradientMap::ON_THE_FLY);
+			m_grad = new C3DGradientMap(im3d, b, storage);
+		}
+		else m_grad->SetBoundingBox(b);
+		m_grad->Update();
+	}
+	C3DGradientMap* grad = m_grad;
 
 	// construct a mesh object
 	TriMesh mesh;
@@ -330,14 +349,14 @@ void CMarchingCubes::CreateSurface()
 						// calculate gradients
 						if (m_bsmooth)
 						{
-							g[0] = grad.Value(i, j, k);
-							g[1] = grad.Value(i + 1, j, k);
-							g[2] = grad.Value(i + 1, j + 1, k);
-							g[3] = grad.Value(i, j + 1, k);
-							g[4] = grad.Value(i, j, k + 1);
-							g[5] = grad.Value(i + 1, j, k + 1);
-							g[6] = grad.Value(i + 1, j + 1, k + 1);
-							g[7] = grad.Value(i, j + 1, k + 1);
+							g[0] = grad->Value(i, j, k);
+							g[1] = grad->Value(i + 1, j, k);
+							g[2] = grad->Value(i + 1, j + 1, k);
+							g[3] = grad->Value(i, j + 1, k);
+							g[4] = grad->Value(i, j, k + 1);
+							g[5] = grad->Value(i + 1, j, k + 1);
+							g[6] = grad->Value(i + 1, j + 1, k + 1);
+							g[7] = grad->Value(i, j + 1, k + 1);
 						}
 
 						// loop over faces
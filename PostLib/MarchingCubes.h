@@ -34,6 +34,7 @@ SOFTWARE.*/
 class FSMesh;
 class CImageModel;
 class C3DImage;
+class C3DGradientMap;
 
 namespace Post {
 
@@ -123,5 +124,7 @@ private:
 
     C3DImage* m_8bitImage;
     bool m_del8BitImage;
+
+	C3DGradientMap*	m_grad;	// (precomputed) gradient for smooth surfaces
 };
 }
@@ -55,6 +55,8 @@ CVolumeRenderer::CVolumeRenderer(CImageModel* img) : CGLImageRenderer(img)
 
 	m_vrInit = false;
 	m_vrReset = false;
+	m_texLevel = -1;
+	m_maxLevel = 0;
 
 }
 
@@ -87,24 +89,43 @@ void CVolumeRenderer::Init()
 	// generate a texture ID
 	if (m_texID == 0) glGenTextures(1, &m_texID);
 
-	ReloadTexture();
+	ReloadTexture(-1);
 
 	m_vrInit = true;
 	m_vrReset = false;
 	InitShaders();
 }
 
-void CVolumeRenderer::ReloadTexture()
+// Loads the given level of the image pyramid into the texture. If level is -1, a coarse 
+// draft level is loaded instead, so that the first frame is quick. Render refines it to 
+// the finest level that fits in a 3D texture on the next frame.
+void CVolumeRenderer::ReloadTexture(int level)
 {
+	m_texLevel = -1;
+
 	// load texture data
 	CImageModel& img = *GetImageModel();
 	CImageSource* src = img.GetImageSource();
 	if (src == nullptr) return;
 
 	if (src->Get3DImage() == nullptr) return;
-	C3DImage& im3d = *src->Get3DImage();
+	C3DImage& im0 = *src->Get3DImage();
 
-	// get the original image dimensions
+	// Larger images cannot be uploaded at full resolution.
+	GLint maxTexSize = 0;
+	glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, &maxTexSize);
+	m_maxLevel = (maxTexSize > 0 ? im0.LevelForSize(maxTexSize, maxTexSize, maxTexSize) : 0);
+
+	if (level < 0)
+	{
+		const size_t maxDraftVoxels = (size_t)128 * 128 * 128;
+		level = im0.LevelForVoxels(maxDraftVoxels);
+	}
+	if (level < m_maxLevel) level = m_maxLevel;
+	C3DImage& im3d = *im0.GetLevel(level);
+	m_texLevel = level;
+
+	// get the texture dimensions
 	int nx = im3d.Width();
 	int ny = im3d.Height();
 	int nz = im3d.Depth();
@@ -122,8 +143,9 @@ void CVolumeRenderer::ReloadTexture()
     constexpr int max16 = std::numeric_limits<unsigned short>::max();
     constexpr uint32_t max32 = std::numeric_limits<unsigned int>::max();
 
+    // (the range of the full resolution image is used, so that the intensities don't change with the level)
     double min, max;
-    im3d.GetMinMax(min, max);
+    im0.GetMinMax(min, max);
 	switch (pType)
 	{
 	case CImage::INT_8:
@@ -446,13 +468,21 @@ void CVolumeRenderer::Render(CGLContext& rc)
 	if (m_vrInit == false) Init();
 	else if (m_vrReset) 
 	{
-		ReloadTexture();
+		ReloadTexture(-1);
 		m_vrReset = false;
 	}
+	else if (m_texLevel > m_maxLevel)
+	{
+		// replace the draft texture with the final one
+		ReloadTexture(m_maxLevel);
+	}
 
 	// If we failed to initialize, we're done
 	if (m_vrInit == false) return;
 
+	// ask for another frame if the texture still needs to be refined
+	if (m_texLevel > m_maxLevel) rc.m_redraw = true;
+
 	// load texture data
 	CImageModel& img = *GetImageModel();
 	CImageSource* src = img.GetImageSource();
@@ -51,7 +51,7 @@ public:
 private:
 	void Init();
 	void InitShaders();
-	void ReloadTexture();
+	void ReloadTexture(int level);
 	void UpdateGeometry(const vec3d& view);
 
 private:
@@ -60,6 +60,8 @@ private:
     float 	m_Iscale;
 	bool	m_vrInit;
 	bool	m_vrReset;
+	int		m_texLevel;		// the pyramid level that is in the texture
+	int		m_maxLevel;		// the finest pyramid level that fits in a 3D texture
 
 	int	m_nslices = 0;
 	GLTriMesh m_mesh;
@@ -27,6 +27,7 @@ SOFTWARE.*/
 #include "FEPostModel.h"
 #include "constants.h"
 #include "FEMeshData_T.h"
+#include "FEMathData.h"
 #include <MeshLib/MeshMetrics.h>
 #include <MeshLib/MeshTools.h>
 using namespace Post;
@@ -225,6 +226,59 @@ bool FEPostModel::Evaluate(int nfield, int ntime, bool breset)
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+// Math data fields are evaluated for many nodes at once, so that the compiled 
+// equations are looked up only once. These return false for other data fields.
+static bool evalMathNodes(FEMeshData& rd, int ncomp, vector<float>& val)
+{
+	if (FEMathData* pd = dynamic_cast<FEMathData*>(&rd))
+	{
+		pd->evalNodes(val);
+		return true;
+	}
+	if (FEMathVec3Data* pd = dynamic_cast<FEMathVec3Data*>(&rd))
+	{
+		vector<vec3f> v;
+		pd->evalNodes(v);
+		val.resize(v.size());
+		for (size_t i = 0; i < v.size(); ++i) val[i] = component(v[i], ncomp);
+		return true;
+	}
+	if (FEMathMat3Data* pd = dynamic_cast<FEMathMat3Data*>(&rd))
+	{
+		vector<mat3f> m;
+		pd->evalNodes(m);
+		val.resize(m.size());
+		for (size_t i = 0; i < m.size(); ++i) val[i] = component(m[i], ncomp);
+		return true;
+	}
+	return false;
+}
+
+static bool evalMathItems(FEMeshData& rd, int ncomp, const int* items, int count, float* vals)
+{
+	if (FEMathData* pd = dynamic_cast<FEMathData*>(&rd))
+	{
+		pd->evalItems(items, count, vals);
+		return true;
+	}
+	if (FEMathVec3Data* pd = dynamic_cast<FEMathVec3Data*>(&rd))
+	{
+		vector<vec3f> v(count);
+		pd->evalItems(items, count, v.data());
+		for (int i = 0; i < count; ++i) vals[i] = component(v[i], ncomp);
+		return true;
+	}
+	if (FEMathMat3Data* pd = dynamic_cast<FEMathMat3Data*>(&rd))
+	{
+		vector<mat3f> m(count);
+		pd->evalItems(items, count, m.data());
+		for (int i = 0; i < count; ++i) vals[i] = component(m[i], ncomp);
+		return true;
+	}
+	return false;
+}
+
 //-----------------------------------------------------------------------------
 // Evaluate a nodal field
 void FEPostModel::EvalNodeField(int ntime, int nfield)
@@ -237,13 +291,28 @@ void FEPostModel::EvalNodeField(int ntime, int nfield)
 
 	// first, we evaluate all the nodes
 	int i, j;
-	for (i=0; i<mesh->Nodes(); ++i)
+	vector<float> val;
+	if ((state.m_Data.size() > 0) && evalMathNodes(state.m_Data[FIELD_CODE(nfield)], FIELD_COMP(nfield), val))
 	{
-		FSNode& node = mesh->Node(i);
-		NODEDATA& d = state.m_NODE[i];
-		d.m_val = 0;
-		d.m_ntag = 0;
-		if (node.IsEnabled()) EvaluateNode(i, ntime, nfield, d);
+		// math fields are evaluated for all nodes at once
+		for (i=0; i<mesh->Nodes(); ++i)
+		{
+			FSNode& node = mesh->Node(i);
+			NODEDATA& d = state.m_NODE[i];
+			d.m_val = (node.IsEnabled() ? val[i] : 0.f);
+			d.m_ntag = (node.IsEnabled() ? 1 : 0);
+		}
+	}
+	else
+	{
+		for (i=0; i<mesh->Nodes(); ++i)
+		{
+			FSNode& node = mesh->Node(i);
+			NODEDATA& d = state.m_NODE[i];
+			d.m_val = 0;
+			d.m_ntag = 0;
+			if (node.IsEnabled()) EvaluateNode(i, ntime, nfield, d);
+		}
 	}
 
 	// Next, we project the nodal data onto the faces
@@ -366,7 +435,7 @@ void FEPostModel::EvalFaceField(int ntime, int nfield)
 		for (i=0; i<mesh->Nodes(); ++i)
 		{
 			NODEDATA& node = state.m_NODE[i];
-			const vector<NodeFaceRef>& nfl = mesh->NodeFaceList(i);
+			NodeFaceRefList nfl = mesh->NodeFaceList(i);
 			node.m_val = 0.f; 
 			node.m_ntag = 0;
 			int n = 0;
@@ -439,7 +508,7 @@ void FEPostModel::EvalElemField(int ntime, int nfield)
 		state.m_NODE[i].m_ntag = 0;
 		if (node.IsEnabled())
 		{
-			const vector<NodeElemRef>& nel = mesh->NodeElemList(i);
+			NodeElemRefList nel = mesh->NodeElemList(i);
 			int m = (int) nel.size(), n=0;
 			float val = 0.f;
 			for (int j=0; j<m; ++j)
@@ -828,7 +897,7 @@ void FEPostModel::EvaluateNode(int n, int ntime, int nfield, NODEDATA& d)
 	else if (IS_FACE_FIELD(nfield))
 	{
 		// we take the average of the adjacent face values
-		const vector<NodeFaceRef>& nfl = mesh->NodeFaceList(n);
+		NodeFaceRefList nfl = mesh->NodeFaceList(n);
 		if (!nfl.empty())
 		{
 			int nf = (int)nfl.size(), n = 0;
@@ -847,7 +916,7 @@ void FEPostModel::EvaluateNode(int n, int ntime, int nfield, NODEDATA& d)
 	else if (IS_ELEM_FIELD(nfield))
 	{
 		// we take the average of the elements that contain this element
-		const vector<NodeElemRef>& nel = mesh->NodeElemList(n);
+		NodeElemRefList nel = mesh->NodeElemList(n);
 		float data[FSElement::MAX_NODES] = {0.f}, val;
 		int ne = (int)nel.size(), n = 0;
 		if (!nel.empty())
@@ -888,6 +957,148 @@ void FEPostModel::EvaluateNode(const vec3f& p, int ntime, int nfield, NODEDATA&
 	d.m_val = el.eval(v, r[0], r[1], r[2]);
 }
 
+//-----------------------------------------------------------------------------
+// helper function for evaluating nodal data of a particular type for a list of nodes
+template <typename T> static void evalNodeValues(FEMeshData& rd, int ncomp, const int* items, int count, float* vals)
+{
+	FENodeData_T<T>& df = dynamic_cast<FENodeData_T<T>&>(rd);
+	T v;
+	for (int i = 0; i < count; ++i)
+	{
+		df.eval(items[i], &v);
+		vals[i] = component(v, ncomp);
+	}
+}
+
+template <> void evalNodeValues<float>(FEMeshData& rd, int ncomp, const int* items, int count, float* vals)
+{
+	FENodeData_T<float>& df = dynamic_cast<FENodeData_T<float>&>(rd);
+	for (int i = 0; i < count; ++i) df.eval(items[i], vals + i);
+}
+
+//-----------------------------------------------------------------------------
+// Evaluate the nodal values for a list of nodes. For node fields, the data field is 
+// only looked up once, otherwise this falls back to EvaluateNode.
+void FEPostModel::EvalNodeValues(int ntime, int nfield, const int* items, int count, float* vals)
+{
+	FEState& state = *GetState(ntime);
+	if (state.m_Data.size() == 0)
+	{
+		for (int i = 0; i < count; ++i) vals[i] = 0.f;
+		return;
+	}
+
+	if (IS_NODE_FIELD(nfield))
+	{
+		int ndata = FIELD_CODE(nfield);
+		assert((ndata >= 0) && (ndata < state.m_Data.size()));
+		int ncomp = FIELD_COMP(nfield);
+
+		FEMeshData& rd = state.m_Data[ndata];
+		if (evalMathItems(rd, ncomp, items, count, vals)) return;
+
+		switch (rd.GetType())
+		{
+		case DATA_SCALAR: evalNodeValues<float  >(rd, ncomp, items, count, vals); return;
+		case DATA_VEC3  : evalNodeValues<vec3f  >(rd, ncomp, items, count, vals); return;
+		case DATA_MAT3  : evalNodeValues<mat3f  >(rd, ncomp, items, count, vals); return;
+		case DATA_MAT3S : evalNodeValues<mat3fs >(rd, ncomp, items, count, vals); return;
+		case DATA_MAT3SD: evalNodeValues<mat3fd >(rd, ncomp, items, count, vals); return;
+		case DATA_TENS4S: evalNodeValues<tens4fs>(rd, ncomp, items, count, vals); return;
+		case DATA_ARRAY:
+			{
+				FENodeArrayData& dm = dynamic_cast<FENodeArrayData&>(rd);
+				for (int i = 0; i < count; ++i) vals[i] = dm.eval(items[i], ncomp);
+			}
+			return;
+		default:
+			break;
+		}
+	}
+
+	NODEDATA nd;
+	for (int i = 0; i < count; ++i)
+	{
+		EvaluateNode(items[i], ntime, nfield, nd);
+		vals[i] = nd.m_val;
+	}
+}
+
+//-----------------------------------------------------------------------------
+int FEPostModel::EvaluateHistory(int itemType, const std::vector<int>& items, int nfield, int nmin, int nmax, std::vector<float>& vals)
+{
+	int nsteps = GetStates();
+	if (nsteps == 0) { vals.clear(); return 0; }
+	if (nmin <       0) nmin = 0;
+	if (nmax == -1) nmax = nsteps - 1;
+	if (nmax >= nsteps) nmax = nsteps - 1;
+	if (nmax <    nmin) nmax = nmin;
+	int nn = nmax - nmin + 1;
+
+	int NI = (int)items.size();
+	vals.assign((size_t)nn * NI, 0.f);
+	if (NI == 0) return nn;
+
+	// Split the items in blocks, so that there is enough work to go around
+	// when only a few states are evaluated. Each task writes to its own part of the matrix.
+	const int blockSize = 1024;
+	int nblocks = (NI + blockSize - 1) / blockSize;
+	int ntasks = nn * nblocks;
+
+#pragma omp parallel for schedule(dynamic)
+	for (int task = 0; task < ntasks; ++task)
+	{
+		int n = task / nblocks;
+		int i0 = (task % nblocks) * blockSize;
+		int i1 = (i0 + blockSize < NI ? i0 + blockSize : NI);
+		int ntime = n + nmin;
+		float* v = &vals[(size_t)n * NI];
+
+		switch (itemType)
+		{
+		case NODE_HISTORY:
+			EvalNodeValues(ntime, nfield, &items[i0], i1 - i0, v + i0);
+			break;
+		case EDGE_HISTORY:
+			{
+				EDGEDATA ed;
+				for (int i = i0; i < i1; ++i)
+				{
+					EvaluateEdge(items[i], ntime, nfield, ed);
+					v[i] = ed.m_val;
+				}
+			}
+			break;
+		case FACE_HISTORY:
+			{
+				float data[FSFace::MAX_NODES], val;
+				for (int i = i0; i < i1; ++i)
+				{
+					val = 0.f;
+					EvaluateFace(items[i], ntime, nfield, data, val);
+					v[i] = val;
+				}
+			}
+			break;
+		case ELEM_HISTORY:
+			{
+				float data[FSElement::MAX_NODES] = { 0.f }, val;
+				for (int i = i0; i < i1; ++i)
+				{
+					val = 0.f;
+					EvaluateElement(items[i], ntime, nfield, data, val);
+					v[i] = val;
+				}
+			}
+			break;
+		default:
+			assert(false);
+		}
+	}
+
+	return nn;
+}
+
 //-----------------------------------------------------------------------------
 // Calculate field value of edge n at time ntime
 void FEPostModel::EvaluateEdge(int n, int ntime, int nfield, EDGEDATA& d)
@@ -2076,7 +2287,7 @@ vec3f FEPostModel::EvaluateNodeVector(int n, int ntime, int nvec)
 	else if (IS_ELEM_FIELD(nvec))
 	{
 		// we take the average of the elements that contain this element
-		const vector<NodeElemRef>& nel = mesh->NodeElemList(n);
+		NodeElemRefList nel = mesh->NodeElemList(n);
 		if (!nel.empty())
 		{
 			int n = 0;
@@ -2097,7 +2308,7 @@ vec3f FEPostModel::EvaluateNodeVector(int n, int ntime, int nvec)
 	else if (IS_FACE_FIELD(nvec))
 	{
 		// we take the average of the elements that contain this element
-		const vector<NodeFaceRef>& nfl = mesh->NodeFaceList(n);
+		NodeFaceRefList nfl = mesh->NodeFaceList(n);
 		if (!nfl.empty())
 		{
 			int n = 0;
@@ -2399,7 +2610,7 @@ mat3f FEPostModel::EvaluateNodeTensor(int n, int ntime, int nten, int ntype)
 	else 
 	{
 		// we take the average of the elements that contain this element
-		const vector<NodeElemRef>& nel = mesh->NodeElemList(n);
+		NodeElemRefList nel = mesh->NodeElemList(n);
 		if (!nel.empty())
 		{
 			for (int i=0; i<(int) nel.size(); ++i) m += EvaluateElemTensor(nel[i].eid, ntime, nten, ntype);